@@ -107,6 +107,7 @@ vst2       = $(TARGET_DIR)/$(NAME)-vst$(LIB_EXT)
 ifneq ($(VST3_FILENAME),)
 vst3       = $(TARGET_DIR)/$(NAME).vst3/Contents/$(VST3_FILENAME)
 endif
+clap       = $(TARGET_DIR)/$(NAME).clap
 
 # ---------------------------------------------------------------------------------------------------------------------
 # Set plugin symbols to export
@@ -118,6 +119,7 @@ SYMBOLS_LV2    = -Wl,-exported_symbol,_lv2_descriptor -Wl,-exported_symbol,_lv2_
 SYMBOLS_LV2UI  = -Wl,-exported_symbol,_lv2ui_descriptor
 SYMBOLS_VST2   = -Wl,-exported_symbol,_VSTPluginMain
 SYMBOLS_VST3   = -Wl,-exported_symbol,_GetPluginFactory -Wl,-exported_symbol,_bundleEntry -Wl,-exported_symbol,_bundleExit
+SYMBOLS_CLAP   = -Wl,-exported_symbol,_clap_entry
 endif
 
 # ---------------------------------------------------------------------------------------------------------------------
@@ -252,7 +254,7 @@ $(BUILD_DIR)/%.cpp.o: %.cpp
 
 clean:
 	rm -rf $(BUILD_DIR)
-	rm -rf $(TARGET_DIR)/$(NAME) $(TARGET_DIR)/$(NAME)-* $(TARGET_DIR)/$(NAME).lv2
+	rm -rf $(TARGET_DIR)/$(NAME) $(TARGET_DIR)/$(NAME)-* $(TARGET_DIR)/$(NAME).lv2 $(TARGET_DIR)/$(NAME).clap
 
 # ---------------------------------------------------------------------------------------------------------------------
 # DGL
@@ -389,6 +391,16 @@ $(vst3): $(OBJS_DSP) $(BUILD_DIR)/DistrhoPluginMain_VST3.cpp.o
 	@echo "Creating VST3 plugin for $(NAME)"
 	$(SILENT)$(CXX) $^ $(BUILD_CXX_FLAGS) $(LINK_FLAGS) $(DGL_LIBS) $(SHARED) $(SYMBOLS_VST3) -o $@
 
+# ---------------------------------------------------------------------------------------------------------------------
+# CLAP
+
+clap: $(clap)
+
+$(clap): $(OBJS_DSP) $(BUILD_DIR)/DistrhoPluginMain_CLAP.cpp.o
+	-@mkdir -p $(shell dirname $@)
+	@echo "Creating CLAP plugin for $(NAME)"
+	$(SILENT)$(CXX) $^ $(BUILD_CXX_FLAGS) $(LINK_FLAGS) $(SHARED) $(SYMBOLS_CLAP) -o $@
+
 # ---------------------------------------------------------------------------------------------------------------------
 
 -include $(OBJS_DSP:%.o=%.d)
@@ -402,6 +414,7 @@ endif
 -include $(BUILD_DIR)/DistrhoPluginMain_LV2.cpp.d
 -include $(BUILD_DIR)/DistrhoPluginMain_VST2.cpp.d
 -include $(BUILD_DIR)/DistrhoPluginMain_VST3.cpp.d
+-include $(BUILD_DIR)/DistrhoPluginMain_CLAP.cpp.d
 
 -include $(BUILD_DIR)/DistrhoUIMain_JACK.cpp.d
 -include $(BUILD_DIR)/DistrhoUIMain_DSSI.cpp.d
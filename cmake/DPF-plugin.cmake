@@ -71,7 +71,7 @@ include(CMakeParseArguments)
 #
 #   `TARGETS` <tgt1>...<tgtN>
 #       a list of one of more of the following target types:
-#       `jack`, `ladspa`, `dssi`, `lv2`, `vst2`
+#       `jack`, `ladspa`, `dssi`, `lv2`, `vst2`, `clap`
 #
 #   `UI_TYPE` <type>
 #       the user interface type: `opengl` (default), `cairo`
@@ -153,6 +153,8 @@ function(dpf_add_plugin NAME)
       dpf__build_lv2("${NAME}" "${_dgl_library}" "${_dpf_plugin_MONOLITHIC}")
     elseif(_target STREQUAL "vst2")
       dpf__build_vst2("${NAME}" "${_dgl_library}")
+    elseif(_target STREQUAL "clap")
+      dpf__build_clap("${NAME}")
     else()
       message(FATAL_ERROR "Unrecognized target type for plugin: ${_target}")
     endif()
@@ -319,6 +321,25 @@ function(dpf__build_vst2 NAME DGL_LIBRARY)
     PREFIX "")
 endfunction()
 
+# dpf__build_clap
+# ------------------------------------------------------------------------------
+#
+# Add build rules for a CLAP plugin.
+#
+function(dpf__build_clap NAME)
+  dpf__create_dummy_source_list(_no_srcs)
+
+  dpf__add_module("${NAME}-clap" ${_no_srcs})
+  dpf__add_plugin_main("${NAME}-clap" "clap")
+  target_link_libraries("${NAME}-clap" PRIVATE "${NAME}-dsp")
+  set_target_properties("${NAME}-clap" PROPERTIES
+    LIBRARY_OUTPUT_DIRECTORY "${PROJECT_BINARY_DIR}/bin/$<0:>"
+    ARCHIVE_OUTPUT_DIRECTORY "${PROJECT_BINARY_DIR}/obj/clap/$<0:>"
+    OUTPUT_NAME "${NAME}"
+    SUFFIX ".clap"
+    PREFIX "")
+endfunction()
+
 # dpf__add_dgl_cairo
 # ------------------------------------------------------------------------------
 #
@@ -487,6 +487,12 @@ START_NAMESPACE_DISTRHO
  */
 #define DISTRHO_PLUGIN_URI "urn:distrho:name"
 
+/**
+   The plugin id when exporting in CLAP format, in reverse URI form.@n
+   Defaults to DISTRHO_PLUGIN_URI.
+ */
+#define DISTRHO_PLUGIN_CLAP_ID "studio.kx.distrho.name"
+
 /**
    Whether the plugin has a custom %UI.
    @see DISTRHO_UI_USE_NANOVG
@@ -515,6 +521,15 @@ START_NAMESPACE_DISTRHO
  */
 #define DISTRHO_PLUGIN_WANT_DIRECT_ACCESS 0
 
+/**
+   Whether the plugin processes audio in double-precision.@n
+   When enabled, run() receives double buffers instead of float ones.@n
+   Formats that support it (like VST2 processDoubleReplacing) pass double buffers directly,
+   all others get their audio converted from and to float by DPF.
+   @see AudioSample
+ */
+#define DISTRHO_PLUGIN_WANT_DOUBLE_PRECISION 1
+
 /**
    Whether the plugin introduces latency during audio or midi processing.
    @see Plugin::setLatency(uint32_t)
@@ -533,6 +548,23 @@ START_NAMESPACE_DISTRHO
  */
 #define DISTRHO_PLUGIN_WANT_MIDI_OUTPUT 1
 
+/**
+   Whether the plugin reports changes to its output parameters by itself.@n
+   By default DPF compares the value of every output parameter after each run() call.@n
+   When enabled, only output parameters marked with Plugin::setOutputParameterChanged(uint32_t) are read back,
+   which avoids per-block scans for plugins with many output parameters.
+   @see Plugin::setOutputParameterChanged(uint32_t)
+ */
+#define DISTRHO_PLUGIN_WANT_OUTPUT_PARAMETER_CHANGES 1
+
+/**
+   Whether the plugin wants to receive timestamped parameter changes during run().@n
+   When enabled, the run() function gets an extra list of ParameterEvent, sorted by frame,
+   which describes where in the current block each parameter change happened.
+   @see ParameterEvent
+ */
+#define DISTRHO_PLUGIN_WANT_PARAMETER_EVENTS 1
+
 /**
    Whether the plugin wants to change its own parameter inputs.@n
    Not all hosts or plugin formats support this,
@@ -571,6 +603,60 @@ START_NAMESPACE_DISTRHO
  */
 #define DISTRHO_PLUGIN_WANT_TIMEPOS 1
 
+/**
+   Whether the plugin wants to offload work from run() to a non-realtime thread.@n
+   Under LV2 this uses the host worker, other formats use a background thread owned by DPF.
+   @see Plugin::scheduleWork(const void*, uint32_t)
+   @see Plugin::work(const void*, uint32_t)
+ */
+#define DISTRHO_PLUGIN_WANT_WORKER 1
+
+/**
+   Whether the plugin wants to split some of its processing into tasks that can run in parallel.@n
+   Under CLAP the tasks are spread over the host thread pool, other formats run them one after the other.
+   @see Plugin::runParallelTasks(uint32_t)
+   @see Plugin::runParallelTask(uint32_t)
+ */
+#define DISTRHO_PLUGIN_WANT_THREAD_POOL 1
+
+/**
+   Maximum number of frames the plugin run() function will be called with.@n
+   When set to a value bigger than 0, host buffers that are bigger than this are split into smaller slices,
+   with audio pointers, MIDI and parameter events adjusted to match each slice.@n
+   This allows plugin code to use small, fixed-size scratch buffers regardless of the host buffer size.
+   @note getBufferSize() and getTimePosition() still refer to the full host buffer.
+ */
+#define DISTRHO_PLUGIN_MAX_SUBBLOCK_SIZE 64
+
+/**
+   Number of MIDI input events the plugin can receive per run() call, 512 by default.@n
+   The event pool is allocated once per instance with this size,
+   plugins that only need a few events (like a note trigger) can set it lower to save memory.@n
+   Events that do not fit are dropped and counted, the pool then doubles in size on the next activation.
+   @see Plugin::getDroppedMidiEventCount()
+ */
+#define DISTRHO_PLUGIN_MIDI_EVENT_CAPACITY 512
+
+/**
+   Whether denormal numbers are flushed to zero while the plugin run() function is called, enabled by default.@n
+   This avoids CPU spikes on decaying signals, the host floating-point state is restored after each run().@n
+   Set this to 0 if the plugin needs exact denormal handling or manages the floating-point state by itself.
+   @see ScopedDenormalDisable
+ */
+#define DISTRHO_PLUGIN_FLUSH_DENORMALS 1
+
+/**
+   Whether DPF handles the bypass parameter by itself, instead of the plugin.@n
+   When the parameter designated as kParameterDesignationBypass is turned on,
+   the outputs crossfade to the audio inputs delayed by the current latency, so the change is click-free.@n
+   After the fade the plugin runs on silent inputs for the length of its tail, and then run() is no longer called
+   until bypass is turned off again, at which point the outputs fade back to the processed audio.@n
+   Plugins with MIDI input receive "sustain off" and "all notes off" on all channels when their output fades out.
+   @note The plugin still receives bypass parameter changes, but does not need to act on them.
+   @see Plugin::getTailLength()
+ */
+#define DISTRHO_PLUGIN_WANT_AUTOMATIC_BYPASS 1
+
 /**
    Whether the %UI uses a custom toolkit implementation based on OpenGL.@n
    When enabled, the macros @ref DISTRHO_UI_CUSTOM_INCLUDE_PATH and @ref DISTRHO_UI_CUSTOM_WIDGET_TYPE are required.
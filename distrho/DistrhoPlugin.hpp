@@ -129,6 +129,12 @@ static const uint32_t kParameterIsTrigger = 0x20 | kParameterIsBoolean;
 
 /** @} */
 
+/**
+   Tail length meaning the plugin output never becomes silent on its own.@n
+   This is the default return value of Plugin::getTailLength().
+ */
+static const uint32_t kTailLengthInfinite = 0xffffffff;
+
 /* ------------------------------------------------------------------------------------------------------------
  * Base Plugin structs */
 
@@ -187,6 +193,16 @@ enum PredefinedPortGroupsIds {
     kPortGroupStereo = (uint32_t)-3
 };
 
+/**
+   Audio sample type used in Plugin::run().@n
+   This is double when DISTRHO_PLUGIN_WANT_DOUBLE_PRECISION is enabled, float otherwise.
+ */
+#if DISTRHO_PLUGIN_WANT_DOUBLE_PRECISION
+typedef double AudioSample;
+#else
+typedef float AudioSample;
+#endif
+
 /**
    Audio Port.
 
@@ -637,6 +653,31 @@ struct MidiEvent {
     const uint8_t* dataExt;
 };
 
+/**
+   Parameter event.@n
+   Describes a parameter change that happened at a specific time offset within the current block.
+
+   Parameter events are only used if DISTRHO_PLUGIN_WANT_PARAMETER_EVENTS is enabled.@n
+   The events given to run() are sorted by frame.@n
+   Plugin formats without timestamped automation (LADSPA, DSSI, LV2 control ports and VST2) report their changes at frame 0.
+ */
+struct ParameterEvent {
+   /**
+      Time offset in frames.
+    */
+    uint32_t frame;
+
+   /**
+      Parameter index.
+    */
+    uint32_t index;
+
+   /**
+      New parameter value.
+    */
+    float value;
+};
+
 /**
    Time position.@n
    The @a playing and @a frame values are always valid.@n
@@ -798,6 +839,12 @@ struct TimePosition {
 
    The process function run() changes wherever DISTRHO_PLUGIN_WANT_MIDI_INPUT is enabled or not.@n
    When enabled it provides midi input events.
+
+   The process function run() also changes wherever DISTRHO_PLUGIN_WANT_PARAMETER_EVENTS is enabled or not.@n
+   When enabled it provides timestamped parameter events.
+
+   DISTRHO_PLUGIN_WANT_DOUBLE_PRECISION makes run() use double-precision audio buffers.@n
+   Hosts that only provide single-precision buffers have their audio converted by DPF.
  */
 class Plugin
 {
@@ -825,6 +872,27 @@ public:
     */
     uint32_t getBufferSize() const noexcept;
 
+   /**
+      Check if the host guarantees that every run() call uses exactly getBufferSize() frames.@n
+      Plugins can then use fixed-size kernels (like FFTs) directly, without internal re-blocking.
+      When the host only provides a maximum block length, that is the fixed block size.
+      @note Only supported in LV2 (through bufsz:fixedBlockLength), always returns false in other formats.
+    */
+    bool isFixedBlockSize() const noexcept;
+
+   /**
+      Check if the host guarantees that the frame count of every run() call is a power of 2.
+      @note Only supported in LV2 (through bufsz:powerOf2BlockLength) and JACK, always returns false in other formats.
+    */
+    bool isPowerOf2BlockSize() const noexcept;
+
+   /**
+      Check if the host avoids splitting blocks into small pieces, for example at parameter changes.@n
+      run() can still be called with fewer frames, but only rarely.
+      @note Only supported in LV2 (through bufsz:coarseBlockLength), always returns false in other formats.
+    */
+    bool isCoarseBlockSize() const noexcept;
+
    /**
       Get the current sample rate that will be used during processing.@n
       This value will remain constant between activate and deactivate.
@@ -832,6 +900,15 @@ public:
     */
     double getSampleRate() const noexcept;
 
+   /**
+      Check if the host is currently rendering offline, also known as freewheeling or bouncing.@n
+      During offline rendering run() is not bound to realtime deadlines,
+      so the plugin can choose higher quality processing that would be too expensive for live use.
+      @note Only supported in LV2, VST2, VST3, CLAP and JACK, always returns false in other formats.
+      @see renderModeChanged(bool)
+    */
+    bool isOfflineRendering() const noexcept;
+
 #if DISTRHO_PLUGIN_WANT_TIMEPOS
    /**
       Get the current host transport time position.@n
@@ -842,6 +919,26 @@ public:
     const TimePosition& getTimePosition() const noexcept;
 #endif
 
+#if DISTRHO_PLUGIN_WANT_MIDI_INPUT
+   /**
+      Get the number of MIDI input events dropped so far because they did not fit into the event pool.@n
+      A non-zero value means the host sent more events in a single run() than DISTRHO_PLUGIN_MIDI_EVENT_CAPACITY,
+      the pool grows automatically on the next activation so this is mostly useful for diagnostics.
+      @note This function is only available if DISTRHO_PLUGIN_WANT_MIDI_INPUT is enabled.
+    */
+    uint32_t getDroppedMidiEventCount() const noexcept;
+#endif
+
+#if DISTRHO_PLUGIN_WANT_PARAMETER_EVENTS
+   /**
+      Get the number of parameter events dropped so far because they did not fit into the event pool.@n
+      When the pool is full, intermediate events of a parameter are dropped first so its last value still arrives.
+      The pool grows automatically on the next activation so this is mostly useful for diagnostics.
+      @note This function is only available if DISTRHO_PLUGIN_WANT_PARAMETER_EVENTS is enabled.
+    */
+    uint32_t getDroppedParameterEventCount() const noexcept;
+#endif
+
 #if DISTRHO_PLUGIN_WANT_LATENCY
    /**
       Change the plugin audio output latency to @a frames.@n
@@ -849,6 +946,15 @@ public:
       @note This function is only available if DISTRHO_PLUGIN_WANT_LATENCY is enabled.
     */
     void setLatency(uint32_t frames) noexcept;
+
+   /**
+      Set the highest latency, in frames, that the plugin can report through setLatency().@n
+      Latency-aligned buffers (such as the automatic bypass delay line) are allocated for this amount,
+      so that latency changes done within run() do not need to allocate memory.
+      This function should only be called in the constructor, activate() and sampleRateChanged().
+      @note This function is only available if DISTRHO_PLUGIN_WANT_LATENCY is enabled.
+    */
+    void setMaxLatency(uint32_t frames) noexcept;
 #endif
 
 #if DISTRHO_PLUGIN_WANT_MIDI_OUTPUT
@@ -860,6 +966,17 @@ public:
     bool writeMidiEvent(const MidiEvent& midiEvent) noexcept;
 #endif
 
+#if DISTRHO_PLUGIN_WANT_OUTPUT_PARAMETER_CHANGES
+   /**
+      Notify the host that the output parameter @a index has changed.@n
+      When DISTRHO_PLUGIN_WANT_OUTPUT_PARAMETER_CHANGES is enabled, only output parameters marked with this function
+      are read back with getParameterValue() and reported to the host and %UI.@n
+      This function is realtime-safe and can be called from any thread.
+      @note This function is only available if DISTRHO_PLUGIN_WANT_OUTPUT_PARAMETER_CHANGES is enabled.
+    */
+    void setOutputParameterChanged(uint32_t index) noexcept;
+#endif
+
 #if DISTRHO_PLUGIN_WANT_PARAMETER_VALUE_CHANGE_REQUEST
    /**
       Check if parameter value change requests will work with the current plugin host.
@@ -878,6 +995,35 @@ public:
     bool requestParameterValueChange(uint32_t index, float value) noexcept;
 #endif
 
+#if DISTRHO_PLUGIN_WANT_WORKER
+   /**
+      Schedule work to be done outside of the audio thread.@n
+      @a data is copied, work() will be called later with it from a non-realtime thread.@n
+      This function must only be called during run() or workResponse().@n
+      Returns false if the work queue is full or @a size is bigger than the host allows.
+      @note This function is only available if DISTRHO_PLUGIN_WANT_WORKER is enabled.
+    */
+    bool scheduleWork(const void* data, uint32_t size) noexcept;
+
+   /**
+      Send the result of some work back to the audio thread.@n
+      @a data is copied, workResponse() will be called later with it from the audio thread.@n
+      This function must only be called during work().
+      @note This function is only available if DISTRHO_PLUGIN_WANT_WORKER is enabled.
+    */
+    bool writeWorkResponse(const void* data, uint32_t size) noexcept;
+#endif
+
+#if DISTRHO_PLUGIN_WANT_THREAD_POOL
+   /**
+      Run @a taskCount tasks in parallel, calling runParallelTask() once for each task index.@n
+      Tasks go to the host thread pool if there is one, otherwise they run one after the other on the calling thread.@n
+      This function must only be called during run(), it returns once all tasks are done.
+      @note This function is only available if DISTRHO_PLUGIN_WANT_THREAD_POOL is enabled.
+    */
+    void runParallelTasks(uint32_t taskCount);
+#endif
+
 protected:
    /* --------------------------------------------------------------------------------------------------------
     * Information */
@@ -1034,19 +1180,84 @@ protected:
     */
     virtual void deactivate() {}
 
-#if DISTRHO_PLUGIN_WANT_MIDI_INPUT
+   /**
+      Get the length of the plugin tail, in frames.@n
+      This is how long the output keeps sounding after the audio inputs become silent, like a delay or reverb decay.@n
+      Once the inputs have been silent for longer than this and no MIDI events arrive,
+      run() is no longer called and the outputs are cleared instead.@n
+      Return kTailLengthInfinite (the default) if the output can sound on its own, for example from held notes or an LFO.
+      @note This function can be called from any thread, including the audio thread before each run()
+            and host threads while run() is in progress.
+            It must be realtime-safe and must not lock, so return a value that can be read lock-free,
+            like a plain integer or std::atomic<uint32_t> updated when the parameters that affect the tail change.
+    */
+    virtual uint32_t getTailLength() const { return kTailLengthInfinite; }
+
+#if DISTRHO_PLUGIN_WANT_PARAMETER_EVENTS
+# if DISTRHO_PLUGIN_WANT_MIDI_INPUT
+   /**
+      Run/process function for plugins with MIDI input and parameter events.
+      setParameterValue() is still called for every parameter change before run(),
+      the events describe at which frame each of those changes happened.
+      @note Some parameters might be null if there are no audio inputs/outputs, MIDI or parameter events.
+    */
+    virtual void run(const AudioSample** inputs, AudioSample** outputs, uint32_t frames,
+                     const MidiEvent* midiEvents, uint32_t midiEventCount,
+                     const ParameterEvent* parameterEvents, uint32_t parameterEventCount) = 0;
+# else
+   /**
+      Run/process function for plugins with parameter events but without MIDI input.
+      setParameterValue() is still called for every parameter change before run(),
+      the events describe at which frame each of those changes happened.
+      @note Some parameters might be null if there are no audio inputs/outputs or parameter events.
+    */
+    virtual void run(const AudioSample** inputs, AudioSample** outputs, uint32_t frames,
+                     const ParameterEvent* parameterEvents, uint32_t parameterEventCount) = 0;
+# endif
+#elif DISTRHO_PLUGIN_WANT_MIDI_INPUT
    /**
       Run/process function for plugins with MIDI input.
       @note Some parameters might be null if there are no audio inputs/outputs or MIDI events.
     */
-    virtual void run(const float** inputs, float** outputs, uint32_t frames,
+    virtual void run(const AudioSample** inputs, AudioSample** outputs, uint32_t frames,
                      const MidiEvent* midiEvents, uint32_t midiEventCount) = 0;
 #else
    /**
       Run/process function for plugins without MIDI input.
       @note Some parameters might be null if there are no audio inputs or outputs.
     */
-    virtual void run(const float** inputs, float** outputs, uint32_t frames) = 0;
+    virtual void run(const AudioSample** inputs, AudioSample** outputs, uint32_t frames) = 0;
+#endif
+
+#if DISTRHO_PLUGIN_WANT_WORKER
+   /* --------------------------------------------------------------------------------------------------------
+    * Worker */
+
+   /**
+      Do the work previously requested with scheduleWork().@n
+      This function is called from a non-realtime thread, so it can allocate memory, load files and so on.@n
+      Use writeWorkResponse() to send results back to the audio thread.
+      @note Work requests are handled one at a time, in the order they were scheduled.
+    */
+    virtual void work(const void* data, uint32_t size) = 0;
+
+   /**
+      Receive a response previously sent with writeWorkResponse().@n
+      This function is called from the audio thread outside of run(), it must be realtime-safe.
+    */
+    virtual void workResponse(const void* data, uint32_t size);
+#endif
+
+#if DISTRHO_PLUGIN_WANT_THREAD_POOL
+   /* --------------------------------------------------------------------------------------------------------
+    * Thread pool */
+
+   /**
+      Do the task with index @a taskIndex, as requested with runParallelTasks().@n
+      This function can be called from several threads at the same time, each call with a different task index.@n
+      It must be realtime-safe, and tasks must not depend on each other.
+    */
+    virtual void runParallelTask(uint32_t taskIndex) = 0;
 #endif
 
    /* --------------------------------------------------------------------------------------------------------
@@ -1068,6 +1279,13 @@ protected:
     */
     virtual void sampleRateChanged(double newSampleRate);
 
+   /**
+      Optional callback to inform the plugin about a change between realtime and offline rendering.@n
+      This function is called from the audio thread right before run(), it must be realtime-safe.
+      @see isOfflineRendering()
+    */
+    virtual void renderModeChanged(bool offline);
+
     // -------------------------------------------------------------------------------------------------------
 
 private:
@@ -29,6 +29,8 @@
 # include "src/DistrhoPluginVST2.cpp"
 #elif defined(DISTRHO_PLUGIN_TARGET_VST3)
 # include "src/DistrhoPluginVST3.cpp"
+#elif defined(DISTRHO_PLUGIN_TARGET_CLAP)
+# include "src/DistrhoPluginCLAP.cpp"
 #else
 # error unsupported format
 #endif
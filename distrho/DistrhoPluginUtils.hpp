@@ -19,6 +19,8 @@
 
 #include "DistrhoPlugin.hpp"
 
+#include <limits>
+
 START_NAMESPACE_DISTRHO
 
 // -----------------------------------------------------------------------------------------------------------
@@ -46,6 +48,8 @@ START_NAMESPACE_DISTRHO
     1. MidiEvent::frame retains its original value, but it is useless, do not use it.
     2. The class variables names are be the same as the default ones in the run function.
        Keep that in mind and try to avoid typos. :)
+
+   @see ProcessSlicer for also splitting inputs and on parameter events.
  */
 class AudioMidiSyncHelper {
 public:
@@ -154,6 +158,2269 @@ private:
 
 // -----------------------------------------------------------------------------------------------------------
 
+/**
+   Splits a run() call into slices that start wherever an event happens, advancing all audio buffers along.
+   Like AudioMidiSyncHelper, but also handles inputs (including CV ports), parameter events and custom split points,
+   and can merge slices that would be too short to process efficiently.
+
+   To use it, create a local variable (on the stack), set the events to split on and call next() until it returns false.
+   @code
+    ProcessSlicer slicer(inputs, outputs, frames);
+    slicer.setMidiEvents(midiEvents, midiEventCount);
+    slicer.setParameterEvents(parameterEvents, parameterEventCount);
+    slicer.setMinimumSliceFrames(16);
+
+    while (slicer.next())
+    {
+        for (uint32_t i=0; i<slicer.parameterEventCount; ++i)
+            applyParameter(slicer.parameterEvents[i].index, slicer.parameterEvents[i].value);
+
+        for (uint32_t i=0; i<slicer.midiEventCount; ++i)
+            handleMidi(slicer.midiEvents[i]);
+
+        renderSynth(slicer.inputs[0], slicer.outputs[0], slicer.outputs[1], slicer.frames);
+    }
+   @endcode
+
+   Events of a slice are meant to be applied at its start.
+   With a minimum slice size, events that fall inside a slice are moved to its start, by less than that size.@n
+   The event frame values are kept as-is, relative to the start of the full block.
+   Events must be sorted by frame, as given to run(). Null audio buffers are kept null.
+ */
+class ProcessSlicer {
+public:
+    /** Maximum number of beat start split points, see splitOnBeats(). */
+    static const uint32_t kMaxBeatSplitPoints = 32;
+
+    /** Buffers for the current slice, including CV ports */
+   #if DISTRHO_PLUGIN_NUM_INPUTS > 0
+    const float* inputs[DISTRHO_PLUGIN_NUM_INPUTS];
+   #endif
+   #if DISTRHO_PLUGIN_NUM_OUTPUTS > 0
+    float* outputs[DISTRHO_PLUGIN_NUM_OUTPUTS];
+   #endif
+
+    /** Number of frames in the current slice */
+    uint32_t frames;
+
+    /** Offset of the current slice in frames, from the start of the full block */
+    uint32_t offset;
+
+    /** MIDI events to apply at the start of the current slice */
+    const MidiEvent* midiEvents;
+    uint32_t midiEventCount;
+
+    /** Parameter events to apply at the start of the current slice */
+    const ParameterEvent* parameterEvents;
+    uint32_t parameterEventCount;
+
+    /** Number of split points that fall in the current slice, usually 0 or 1 */
+    uint32_t splitPointCount;
+
+    /**
+       Constructor, using the audio buffers and number of frames from the run function.
+     */
+    ProcessSlicer(const float** const ins, float** const outs, const uint32_t numFrames) noexcept
+        : frames(0),
+          offset(0),
+          midiEvents(nullptr),
+          midiEventCount(0),
+          parameterEvents(nullptr),
+          parameterEventCount(0),
+          splitPointCount(0),
+          fTotalFrames(numFrames),
+          fMinimumSliceFrames(1),
+          fAllMidiEvents(nullptr),
+          fAllMidiEventCount(0),
+          fAllParameterEvents(nullptr),
+          fAllParameterEventCount(0),
+          fSplitPoints(nullptr),
+          fSplitPointCount(0),
+          fUsedMidiEvents(0),
+          fUsedParameterEvents(0),
+          fUsedSplitPoints(0),
+          fStarted(false)
+    {
+       #if DISTRHO_PLUGIN_NUM_INPUTS > 0
+        for (uint32_t i=0; i<DISTRHO_PLUGIN_NUM_INPUTS; ++i)
+            inputs[i] = ins[i];
+       #else
+        // unused
+        (void)ins;
+       #endif
+       #if DISTRHO_PLUGIN_NUM_OUTPUTS > 0
+        for (uint32_t i=0; i<DISTRHO_PLUGIN_NUM_OUTPUTS; ++i)
+            outputs[i] = outs[i];
+       #else
+        // unused
+        (void)outs;
+       #endif
+    }
+
+    /**
+       Split on MIDI events.
+     */
+    void setMidiEvents(const MidiEvent* const events, const uint32_t count) noexcept
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(! fStarted,);
+
+        fAllMidiEvents = events;
+        fAllMidiEventCount = count;
+    }
+
+    /**
+       Split on parameter events.
+     */
+    void setParameterEvents(const ParameterEvent* const events, const uint32_t count) noexcept
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(! fStarted,);
+
+        fAllParameterEvents = events;
+        fAllParameterEventCount = count;
+    }
+
+    /**
+       Split on custom frame offsets, which must be sorted.
+       The array must stay valid until slicing is done.
+     */
+    void setSplitPoints(const uint32_t* const splitPoints, const uint32_t count) noexcept
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(! fStarted,);
+
+        fSplitPoints = splitPoints;
+        fSplitPointCount = count;
+    }
+
+    /**
+       Split wherever a new beat starts according to @a timePos, replacing any custom split points.
+       Does nothing if the transport is stopped or the BBT information is not valid.
+     */
+    void splitOnBeats(const TimePosition& timePos, const double sampleRate) noexcept
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(! fStarted,);
+
+        fSplitPoints = fBeatSplitPoints;
+        fSplitPointCount = 0;
+
+        if (! timePos.playing || ! timePos.bbt.valid)
+            return;
+        if (timePos.bbt.beatsPerMinute <= 0.0 || timePos.bbt.ticksPerBeat <= 0.0 || sampleRate <= 0.0)
+            return;
+
+        const double framesPerBeat = 60.0 * sampleRate / timePos.bbt.beatsPerMinute;
+        double beatFrame = (timePos.bbt.tick == 0.0 ? 0.0 : 1.0 - timePos.bbt.tick / timePos.bbt.ticksPerBeat)
+                         * framesPerBeat;
+
+        for (; beatFrame < fTotalFrames && fSplitPointCount < kMaxBeatSplitPoints; beatFrame += framesPerBeat)
+            fBeatSplitPoints[fSplitPointCount++] = static_cast<uint32_t>(beatFrame + 0.5);
+    }
+
+    /**
+       Merge slices shorter than @a minFrames with the following ones.
+       The last slice of a block can still be shorter.
+     */
+    void setMinimumSliceFrames(const uint32_t minFrames) noexcept
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(! fStarted,);
+
+        fMinimumSliceFrames = minFrames != 0 ? minFrames : 1;
+    }
+
+    /**
+       Move to the next slice.
+       You must not read any more values from this class after this function returns false.
+     */
+    bool next() noexcept
+    {
+        if (fStarted)
+        {
+            offset += frames;
+
+           #if DISTRHO_PLUGIN_NUM_INPUTS > 0
+            for (uint32_t i=0; i<DISTRHO_PLUGIN_NUM_INPUTS; ++i)
+                if (inputs[i] != nullptr)
+                    inputs[i] += frames;
+           #endif
+           #if DISTRHO_PLUGIN_NUM_OUTPUTS > 0
+            for (uint32_t i=0; i<DISTRHO_PLUGIN_NUM_OUTPUTS; ++i)
+                if (outputs[i] != nullptr)
+                    outputs[i] += frames;
+           #endif
+        }
+
+        fStarted = true;
+
+        if (offset >= fTotalFrames)
+            return false;
+
+        // the slice ends at the first event that is far enough from its start
+        const uint32_t minEnd = offset + fMinimumSliceFrames;
+        uint32_t end = fTotalFrames;
+
+        end = findEnd(fAllMidiEvents, fUsedMidiEvents, fAllMidiEventCount, minEnd, end);
+        end = findEnd(fAllParameterEvents, fUsedParameterEvents, fAllParameterEventCount, minEnd, end);
+        end = findEnd(fSplitPoints, fUsedSplitPoints, fSplitPointCount, minEnd, end);
+
+        // events before the end belong to this slice, the last slice also takes any events past the block size
+        const uint32_t eventLimit = end == fTotalFrames ? std::numeric_limits<uint32_t>::max() : end;
+
+        midiEvents = fAllMidiEvents != nullptr ? fAllMidiEvents + fUsedMidiEvents : nullptr;
+        midiEventCount = takeEvents(fAllMidiEvents, fUsedMidiEvents, fAllMidiEventCount, eventLimit);
+
+        parameterEvents = fAllParameterEvents != nullptr ? fAllParameterEvents + fUsedParameterEvents : nullptr;
+        parameterEventCount = takeEvents(fAllParameterEvents, fUsedParameterEvents, fAllParameterEventCount, eventLimit);
+
+        splitPointCount = takeEvents(fSplitPoints, fUsedSplitPoints, fSplitPointCount, eventLimit);
+
+        frames = end - offset;
+        return true;
+    }
+
+private:
+    /** @internal */
+    const uint32_t fTotalFrames;
+    uint32_t fMinimumSliceFrames;
+    const MidiEvent* fAllMidiEvents;
+    uint32_t fAllMidiEventCount;
+    const ParameterEvent* fAllParameterEvents;
+    uint32_t fAllParameterEventCount;
+    const uint32_t* fSplitPoints;
+    uint32_t fSplitPointCount;
+    uint32_t fUsedMidiEvents;
+    uint32_t fUsedParameterEvents;
+    uint32_t fUsedSplitPoints;
+    bool fStarted;
+    uint32_t fBeatSplitPoints[kMaxBeatSplitPoints];
+
+    static uint32_t getFrame(const MidiEvent& event) noexcept { return event.frame; }
+    static uint32_t getFrame(const ParameterEvent& event) noexcept { return event.frame; }
+    static uint32_t getFrame(const uint32_t frame) noexcept { return frame; }
+
+    template <typename T>
+    static uint32_t findEnd(const T* const events, uint32_t index, const uint32_t count,
+                            const uint32_t minEnd, const uint32_t end) noexcept
+    {
+        for (; index < count; ++index)
+        {
+            const uint32_t frame = getFrame(events[index]);
+
+            if (frame >= minEnd)
+                return frame < end ? frame : end;
+        }
+
+        return end;
+    }
+
+    template <typename T>
+    static uint32_t takeEvents(const T* const events, uint32_t& index, const uint32_t count,
+                               const uint32_t limit) noexcept
+    {
+        uint32_t taken = 0;
+
+        for (; index < count && getFrame(events[index]) < limit; ++index)
+            ++taken;
+
+        return taken;
+    }
+
+    DISTRHO_DECLARE_NON_COPYABLE(ProcessSlicer)
+    DISTRHO_PREVENT_HEAP_ALLOCATION
+};
+
+// -----------------------------------------------------------------------------------------------------------
+
+/**
+   Voice allocation for polyphonic synths, with a fixed number of voices.
+
+   Voice state is kept as separate arrays (note, channel, velocity, age and so on) inside the class,
+   so looking for free or stealable voices only touches a few cache lines, and nothing is ever allocated.@n
+   Notes are identified by both channel and note number, which makes MPE (one note per MIDI channel) work as-is,
+   with per-note pitch bend, pressure and timbre (CC74) coming from the voice channel.
+   When MPE is enabled, the master channel values are added on top of the voice channel ones.
+
+   Sustain (CC64) and sostenuto (CC66) pedals, all notes off (CC123) and all sound off (CC120) are handled internally.
+   All sound off frees all voices right away, without asking the renderer.
+
+   The easiest way to use this class is through process(), which splits the block on MIDI events with
+   ProcessSlicer and renders all active voices in between. The @a renderer argument must provide:
+   @code
+    // a voice is starting a new note, retrigger is true if it was already playing (stolen or same note again)
+    void voiceStarted(uint32_t voice, bool retrigger);
+
+    // the note of a voice was released, the voice keeps playing until renderVoice() returns false
+    void voiceReleased(uint32_t voice);
+
+    // add the sound of a voice into outputs, return false once the voice is finished
+    bool renderVoice(uint32_t voice, float** outputs, uint32_t frames);
+   @endcode
+
+   For example:
+   @code
+    VoiceManager<16> fVoices;
+
+    void run(const float**, float** outputs, uint32_t frames,
+             const MidiEvent* midiEvents, uint32_t midiEventCount) override
+    {
+        fVoices.process(outputs, frames, midiEvents, midiEventCount, *this);
+    }
+   @endcode
+ */
+template <uint32_t kMaxVoices>
+class VoiceManager {
+public:
+    /**
+       How to find a voice for a new note when all voices are in use.@n
+       Voices with released notes are always stolen first.
+     */
+    enum StealingMode {
+        /** Do not steal, new notes are ignored. */
+        kStealingNone,
+        /** Steal the voice that started first. */
+        kStealingOldest,
+        /** Steal the voice with the lowest level, as reported by setVoiceLevel(). */
+        kStealingQuietest,
+        /** Steal the voice playing the lowest note. */
+        kStealingLowestNote,
+        /** Steal the voice playing the highest note. */
+        kStealingHighestNote
+    };
+
+    /**
+       Constructor.
+     */
+    VoiceManager() noexcept
+        : fStealingMode(kStealingOldest),
+          fPitchBendRange(2.0f),
+          fMPEEnabled(false),
+          fMPEMasterChannel(0),
+          fMPEPitchBendRange(48.0f),
+          fActiveVoiceCount(0),
+          fNoteCounter(0)
+    {
+        reset();
+    }
+
+    // -------------------------------------------------------------------------------------------------------
+    // setup
+
+    /**
+       Set the voice stealing mode, kStealingOldest by default.
+     */
+    void setStealingMode(const StealingMode mode) noexcept
+    {
+        fStealingMode = mode;
+    }
+
+    /**
+       Set the pitch bend range in semitones, 2 by default.
+     */
+    void setPitchBendRange(const float semitones) noexcept
+    {
+        fPitchBendRange = semitones;
+    }
+
+    /**
+       Enable or disable MPE mode, using @a masterChannel (0 or 15) for global expression.
+       Per-note channels use a pitch bend range of 48 semitones by default, see setMPEPitchBendRange().
+     */
+    void setMPEEnabled(const bool enabled, const uint8_t masterChannel = 0) noexcept
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(masterChannel < 16,);
+
+        fMPEEnabled = enabled;
+        fMPEMasterChannel = masterChannel;
+    }
+
+    /**
+       Set the pitch bend range of MPE per-note channels, in semitones.
+     */
+    void setMPEPitchBendRange(const float semitones) noexcept
+    {
+        fMPEPitchBendRange = semitones;
+    }
+
+    /**
+       Stop all voices immediately and clear all controller state, without calling the renderer.
+     */
+    void reset() noexcept
+    {
+        fActiveVoiceCount = 0;
+
+        for (uint32_t v=0; v<kMaxVoices; ++v)
+        {
+            fNotes[v] = 0;
+            fChannels[v] = 0;
+            fVelocities[v] = 0.0f;
+            fPolyPressures[v] = 0.0f;
+            fLevels[v] = 0.0f;
+            fAges[v] = 0;
+            fFlags[v] = 0;
+        }
+
+        for (uint32_t c=0; c<16; ++c)
+        {
+            fPitchBends[c] = 0.0f;
+            fPressures[c] = 0.0f;
+            fTimbres[c] = 0.5f;
+            fSustain[c] = false;
+            fSostenuto[c] = false;
+        }
+    }
+
+    // -------------------------------------------------------------------------------------------------------
+    // processing
+
+    /**
+       Handle MIDI events and render all active voices in between them, see the class description for details.
+       @a outputs are cleared before rendering.
+     */
+    template <class Renderer>
+    void process(float** const outputs, const uint32_t frames,
+                 const MidiEvent* const midiEvents, const uint32_t midiEventCount, Renderer& renderer)
+    {
+        for (uint32_t i=0; i<DISTRHO_PLUGIN_NUM_OUTPUTS; ++i)
+            std::memset(outputs[i], 0, sizeof(float)*frames);
+
+        // voices only write to the outputs
+       #if DISTRHO_PLUGIN_NUM_INPUTS > 0
+        const float* inputs[DISTRHO_PLUGIN_NUM_INPUTS] = {};
+       #else
+        const float** const inputs = nullptr;
+       #endif
+
+        ProcessSlicer slicer(inputs, outputs, frames);
+        slicer.setMidiEvents(midiEvents, midiEventCount);
+
+        while (slicer.next())
+        {
+            for (uint32_t i=0; i<slicer.midiEventCount; ++i)
+                handleMidiEvent(slicer.midiEvents[i], renderer);
+
+           #if DISTRHO_PLUGIN_NUM_OUTPUTS > 0
+            render(slicer.outputs, slicer.frames, renderer);
+           #else
+            render(outputs, slicer.frames, renderer);
+           #endif
+        }
+    }
+
+    /**
+       Render all active voices for @a frames, freeing those that are finished.
+       Only needed when not using process().
+     */
+    template <class Renderer>
+    void render(float** const outputs, const uint32_t frames, Renderer& renderer)
+    {
+        if (frames == 0)
+            return;
+
+        for (uint32_t i=0; i<fActiveVoiceCount;)
+        {
+            const uint32_t voice = fActiveVoices[i];
+
+            if (renderer.renderVoice(voice, outputs, frames))
+            {
+                ++i;
+                continue;
+            }
+
+            // voice finished, the last active voice takes its place in the list
+            fFlags[voice] = 0;
+            fActiveVoices[i] = fActiveVoices[--fActiveVoiceCount];
+        }
+    }
+
+    /**
+       Handle a single MIDI event, calling the renderer for started and released voices.
+       Only needed when not using process().
+     */
+    template <class Renderer>
+    void handleMidiEvent(const MidiEvent& event, Renderer& renderer)
+    {
+        if (event.size > 3 || event.size == 0)
+            return;
+
+        const uint8_t status  = event.data[0] & 0xF0;
+        const uint8_t channel = event.data[0] & 0x0F;
+        const uint8_t data1   = event.size > 1 ? event.data[1] & 0x7F : 0;
+        const uint8_t data2   = event.size > 2 ? event.data[2] & 0x7F : 0;
+
+        switch (status)
+        {
+        case 0x90:
+            if (data2 != 0)
+            {
+                noteOn(channel, data1, data2, renderer);
+                break;
+            }
+            // fall through
+        case 0x80:
+            noteOff(channel, data1, renderer);
+            break;
+        case 0xA0:
+            for (uint32_t i=0; i<fActiveVoiceCount; ++i)
+            {
+                const uint32_t voice = fActiveVoices[i];
+                if (fChannels[voice] == channel && fNotes[voice] == data1)
+                    fPolyPressures[voice] = static_cast<float>(data2) / 127.0f;
+            }
+            break;
+        case 0xB0:
+            handleControlChange(channel, data1, data2, renderer);
+            break;
+        case 0xD0:
+            fPressures[channel] = static_cast<float>(data1) / 127.0f;
+            break;
+        case 0xE0:
+            fPitchBends[channel] = static_cast<float>((data2 << 7 | data1) - 8192) / 8192.0f;
+            break;
+        }
+    }
+
+    // -------------------------------------------------------------------------------------------------------
+    // voice state
+
+    /**
+       Get the number of voices currently in use.
+     */
+    uint32_t getActiveVoiceCount() const noexcept
+    {
+        return fActiveVoiceCount;
+    }
+
+    /**
+       Get the voice index of the active voice number @a index, which must be lower than getActiveVoiceCount().
+     */
+    uint32_t getActiveVoice(const uint32_t index) const noexcept
+    {
+        DISTRHO_SAFE_ASSERT_UINT2_RETURN(index < fActiveVoiceCount, index, fActiveVoiceCount, 0);
+
+        return fActiveVoices[index];
+    }
+
+    /**
+       Check if @a voice is in use.
+     */
+    bool isVoiceActive(const uint32_t voice) const noexcept
+    {
+        return fFlags[voice] & kFlagActive;
+    }
+
+    /**
+       Check if the note of @a voice was released, including the sustain and sostenuto pedals.
+     */
+    bool isVoiceReleased(const uint32_t voice) const noexcept
+    {
+        return fFlags[voice] & kFlagReleased;
+    }
+
+    /**
+       Get the MIDI note number of @a voice.
+     */
+    uint8_t getVoiceNote(const uint32_t voice) const noexcept
+    {
+        return fNotes[voice];
+    }
+
+    /**
+       Get the MIDI channel of @a voice, from 0 to 15.
+     */
+    uint8_t getVoiceChannel(const uint32_t voice) const noexcept
+    {
+        return fChannels[voice];
+    }
+
+    /**
+       Get the note-on velocity of @a voice, from 0 to 1.
+     */
+    float getVoiceVelocity(const uint32_t voice) const noexcept
+    {
+        return fVelocities[voice];
+    }
+
+    /**
+       Get the current pitch bend of @a voice, in semitones.
+     */
+    float getVoicePitchBend(const uint32_t voice) const noexcept
+    {
+        const uint8_t channel = fChannels[voice];
+
+        if (! fMPEEnabled)
+            return fPitchBends[channel] * fPitchBendRange;
+
+        if (channel == fMPEMasterChannel)
+            return fPitchBends[channel] * fPitchBendRange;
+
+        return fPitchBends[channel] * fMPEPitchBendRange + fPitchBends[fMPEMasterChannel] * fPitchBendRange;
+    }
+
+    /**
+       Get the current pitch of @a voice as a fractional MIDI note number, including pitch bend.
+     */
+    float getVoicePitch(const uint32_t voice) const noexcept
+    {
+        return static_cast<float>(fNotes[voice]) + getVoicePitchBend(voice);
+    }
+
+    /**
+       Get the current pressure of @a voice, from 0 to 1.
+       This is the highest of polyphonic aftertouch and channel pressure.
+     */
+    float getVoicePressure(const uint32_t voice) const noexcept
+    {
+        const float pressure = fPressures[fChannels[voice]];
+        return pressure > fPolyPressures[voice] ? pressure : fPolyPressures[voice];
+    }
+
+    /**
+       Get the current timbre (CC74) of @a voice, from 0 to 1.
+     */
+    float getVoiceTimbre(const uint32_t voice) const noexcept
+    {
+        return fTimbres[fChannels[voice]];
+    }
+
+    /**
+       Report the current output level of @a voice, used for kStealingQuietest.
+     */
+    void setVoiceLevel(const uint32_t voice, const float level) noexcept
+    {
+        fLevels[voice] = level;
+    }
+
+private:
+    enum Flags {
+        kFlagActive    = 1 << 0,
+        kFlagKeyDown   = 1 << 1,
+        kFlagSostenuto = 1 << 2,
+        kFlagReleased  = 1 << 3
+    };
+
+    // settings
+    StealingMode fStealingMode;
+    float fPitchBendRange;
+    bool fMPEEnabled;
+    uint8_t fMPEMasterChannel;
+    float fMPEPitchBendRange;
+
+    // per-voice state
+    uint8_t fNotes[kMaxVoices];
+    uint8_t fChannels[kMaxVoices];
+    uint8_t fFlags[kMaxVoices];
+    float fVelocities[kMaxVoices];
+    float fPolyPressures[kMaxVoices];
+    float fLevels[kMaxVoices];
+    uint32_t fAges[kMaxVoices];
+
+    // active voices, in no particular order
+    uint32_t fActiveVoices[kMaxVoices];
+    uint32_t fActiveVoiceCount;
+    uint32_t fNoteCounter;
+
+    // per-channel state
+    float fPitchBends[16];
+    float fPressures[16];
+    float fTimbres[16];
+    bool fSustain[16];
+    bool fSostenuto[16];
+
+    template <class Renderer>
+    void noteOn(const uint8_t channel, const uint8_t note, const uint8_t velocity, Renderer& renderer)
+    {
+        bool retrigger = true;
+        uint32_t voice = findVoice(channel, note, false);
+
+        if (voice == kMaxVoices)
+        {
+            if (fActiveVoiceCount < kMaxVoices)
+            {
+                for (voice=0; voice<kMaxVoices && (fFlags[voice] & kFlagActive) != 0; ++voice) {}
+
+                fActiveVoices[fActiveVoiceCount++] = voice;
+                retrigger = false;
+            }
+            else
+            {
+                voice = findVoiceToSteal();
+
+                if (voice == kMaxVoices)
+                    return;
+            }
+        }
+
+        fNotes[voice] = note;
+        fChannels[voice] = channel;
+        fFlags[voice] = kFlagActive | kFlagKeyDown;
+        fVelocities[voice] = static_cast<float>(velocity) / 127.0f;
+        fPolyPressures[voice] = 0.0f;
+        fLevels[voice] = 0.0f;
+        fAges[voice] = fNoteCounter++;
+
+        renderer.voiceStarted(voice, retrigger);
+    }
+
+    template <class Renderer>
+    void noteOff(const uint8_t channel, const uint8_t note, Renderer& renderer)
+    {
+        const uint32_t voice = findVoice(channel, note, true);
+
+        if (voice == kMaxVoices)
+            return;
+
+        fFlags[voice] &= ~kFlagKeyDown;
+        releaseIfNotHeld(voice, renderer);
+    }
+
+    template <class Renderer>
+    void handleControlChange(const uint8_t channel, const uint8_t control, const uint8_t value, Renderer& renderer)
+    {
+        switch (control)
+        {
+        case 64: // sustain
+            fSustain[channel] = value >= 64;
+
+            if (! fSustain[channel])
+                releaseChannel(channel, renderer);
+            break;
+
+        case 66: // sostenuto, holds the notes that are down when pressed
+            if (value >= 64 && ! fSostenuto[channel])
+            {
+                for (uint32_t i=0; i<fActiveVoiceCount; ++i)
+                {
+                    const uint32_t voice = fActiveVoices[i];
+                    if (fChannels[voice] == channel && (fFlags[voice] & kFlagKeyDown) != 0)
+                        fFlags[voice] |= kFlagSostenuto;
+                }
+            }
+            else if (value < 64 && fSostenuto[channel])
+            {
+                for (uint32_t i=0; i<fActiveVoiceCount; ++i)
+                {
+                    const uint32_t voice = fActiveVoices[i];
+                    if (fChannels[voice] == channel)
+                        fFlags[voice] &= ~kFlagSostenuto;
+                }
+
+                releaseChannel(channel, renderer);
+            }
+
+            fSostenuto[channel] = value >= 64;
+            break;
+
+        case 74: // timbre
+            fTimbres[channel] = static_cast<float>(value) / 127.0f;
+            break;
+
+        case 120: // all sound off
+            for (uint32_t i=0; i<fActiveVoiceCount; ++i)
+                fFlags[fActiveVoices[i]] = 0;
+            fActiveVoiceCount = 0;
+            break;
+
+        case 123: // all notes off, pedals still apply
+            for (uint32_t i=0; i<fActiveVoiceCount; ++i)
+            {
+                const uint32_t voice = fActiveVoices[i];
+                if (fChannels[voice] == channel)
+                {
+                    fFlags[voice] &= ~kFlagKeyDown;
+                    releaseIfNotHeld(voice, renderer);
+                }
+            }
+            break;
+        }
+    }
+
+    template <class Renderer>
+    void releaseChannel(const uint8_t channel, Renderer& renderer)
+    {
+        for (uint32_t i=0; i<fActiveVoiceCount; ++i)
+        {
+            const uint32_t voice = fActiveVoices[i];
+            if (fChannels[voice] == channel)
+                releaseIfNotHeld(voice, renderer);
+        }
+    }
+
+    template <class Renderer>
+    void releaseIfNotHeld(const uint32_t voice, Renderer& renderer)
+    {
+        if ((fFlags[voice] & (kFlagKeyDown|kFlagSostenuto|kFlagReleased)) != 0)
+            return;
+        if (fSustain[fChannels[voice]])
+            return;
+
+        fFlags[voice] |= kFlagReleased;
+        renderer.voiceReleased(voice);
+    }
+
+    // find an active voice playing a note, optionally only one where the key is still down
+    uint32_t findVoice(const uint8_t channel, const uint8_t note, const bool keyDownOnly) const noexcept
+    {
+        for (uint32_t i=0; i<fActiveVoiceCount; ++i)
+        {
+            const uint32_t voice = fActiveVoices[i];
+
+            if (fNotes[voice] != note || fChannels[voice] != channel)
+                continue;
+            if (keyDownOnly && (fFlags[voice] & kFlagKeyDown) == 0)
+                continue;
+
+            return voice;
+        }
+
+        return kMaxVoices;
+    }
+
+    uint32_t findVoiceToSteal() const noexcept
+    {
+        if (fStealingMode == kStealingNone)
+            return kMaxVoices;
+
+        uint32_t best = kMaxVoices;
+        bool bestReleased = false;
+
+        for (uint32_t voice=0; voice<kMaxVoices; ++voice)
+        {
+            const bool released = fFlags[voice] & kFlagReleased;
+
+            if (best == kMaxVoices || (released && ! bestReleased))
+            {
+                best = voice;
+                bestReleased = released;
+                continue;
+            }
+
+            if (released != bestReleased)
+                continue;
+
+            bool better;
+
+            switch (fStealingMode)
+            {
+            case kStealingQuietest:
+                better = fLevels[voice] < fLevels[best];
+                break;
+            case kStealingLowestNote:
+                better = fNotes[voice] < fNotes[best];
+                break;
+            case kStealingHighestNote:
+                better = fNotes[voice] > fNotes[best];
+                break;
+            default:
+                // ages wrap around, compare their distance to the current counter
+                better = fNoteCounter - fAges[voice] > fNoteCounter - fAges[best];
+                break;
+            }
+
+            if (better)
+                best = voice;
+        }
+
+        return best;
+    }
+
+    DISTRHO_DECLARE_NON_COPYABLE(VoiceManager)
+};
+
+// -----------------------------------------------------------------------------------------------------------
+
+/**
+   Ramps a single value towards a target over a fixed amount of time, one block at a time.
+   Use it to remove zipper noise from parameter changes without branching on every sample.
+
+   Call setTarget() whenever a new value arrives, and process() once per block.
+   process() returns false when the value is settled, in which case the buffer is left untouched
+   and getCurrentValue() can be used as a constant for the whole block.
+   @code
+    if (fGainSmoother.process(fGainRamp, frames))
+    {
+        for (uint32_t i=0; i<frames; ++i)
+            outputs[0][i] = inputs[0][i] * fGainRamp[i];
+    }
+    else
+    {
+        const float gain = fGainSmoother.getCurrentValue();
+
+        for (uint32_t i=0; i<frames; ++i)
+            outputs[0][i] = inputs[0][i] * gain;
+    }
+   @endcode
+
+   Ramps always reach their target after the configured time, including the one-pole type,
+   which snaps to the target once it is within -60dB of it.
+ */
+class ParameterSmoother {
+public:
+    /**
+       Smoothing curve.
+     */
+    enum Type {
+        /** No smoothing, new values are applied immediately. */
+        kTypeNone,
+        /** Constant step per sample. */
+        kTypeLinear,
+        /** Exponential approach, fast at first and slower near the target. */
+        kTypeOnePole,
+        /** Constant ratio per sample, for frequencies and gains.
+            Falls back to linear when either end of the ramp is not positive. */
+        kTypeLogarithmic
+    };
+
+    /**
+       Constructor, with linear smoothing over 20ms.
+       setup() or setSampleRate() must be called before the smoother does any ramping.
+     */
+    ParameterSmoother() noexcept
+        : fType(kTypeLinear),
+          fRampType(kTypeNone),
+          fSampleRate(0.0),
+          fTimeInMs(20.0f),
+          fRampFrames(0),
+          fRemainingFrames(0),
+          fCoefficient(0.0f),
+          fStep(0.0f),
+          fCurrentValue(0.0f),
+          fTargetValue(0.0f) {}
+
+    /**
+       Set up the smoothing type and time.
+       Any ramp in progress is finished immediately.
+     */
+    void setup(const Type type, const double sampleRate, const float timeInMs) noexcept
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(timeInMs >= 0.0f,);
+
+        fType = type;
+        fTimeInMs = timeInMs;
+        setValue(fTargetValue);
+        setSampleRate(sampleRate);
+    }
+
+    /**
+       Set up the smoothing using a parameter's hints and ranges.
+       Boolean and integer parameters are not smoothed, logarithmic ones use a logarithmic ramp.
+       The current value is set to the parameter default.
+     */
+    void setup(const Parameter& parameter, const double sampleRate, const float timeInMs = 20.0f) noexcept
+    {
+        Type type;
+
+        /**/ if (parameter.hints & (kParameterIsBoolean|kParameterIsInteger|kParameterIsTrigger))
+            type = kTypeNone;
+        else if ((parameter.hints & kParameterIsLogarithmic) != 0 && parameter.ranges.min > 0.0f)
+            type = kTypeLogarithmic;
+        else
+            type = kTypeLinear;
+
+        fTargetValue = parameter.ranges.def;
+        setup(type, sampleRate, timeInMs);
+    }
+
+    /**
+       Change the sample rate.
+       A ramp in progress is restarted from the current value with the new timing.
+     */
+    void setSampleRate(const double sampleRate) noexcept
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(sampleRate >= 0.0,);
+
+        fSampleRate = sampleRate;
+        fRampFrames = static_cast<uint32_t>(sampleRate * fTimeInMs / 1000.0 + 0.5);
+        fCoefficient = fRampFrames != 0 ? std::exp(std::log(0.001f) / static_cast<float>(fRampFrames)) : 0.0f;
+
+        if (fRemainingFrames != 0)
+            startRamp();
+    }
+
+    /**
+       Set a new target value, starting a ramp from the current value.
+     */
+    void setTarget(const float value) noexcept
+    {
+        if (d_isEqual(fTargetValue, value))
+            return;
+
+        fTargetValue = value;
+        startRamp();
+    }
+
+    /**
+       Set both current and target values, skipping any ramp.
+     */
+    void setValue(const float value) noexcept
+    {
+        fCurrentValue = fTargetValue = value;
+        fRemainingFrames = 0;
+    }
+
+    /**
+       Get the target value, as last given to setTarget() or setValue().
+     */
+    float getTarget() const noexcept
+    {
+        return fTargetValue;
+    }
+
+    /**
+       Get the current smoothed value.
+     */
+    float getCurrentValue() const noexcept
+    {
+        return fCurrentValue;
+    }
+
+    /**
+       Check if the current value has reached the target.
+     */
+    bool isSettled() const noexcept
+    {
+        return fRemainingFrames == 0;
+    }
+
+    /**
+       Advance the ramp by one sample and return the new current value.
+     */
+    float next() noexcept
+    {
+        if (fRemainingFrames == 0)
+            return fCurrentValue;
+
+        if (--fRemainingFrames == 0)
+            return fCurrentValue = fTargetValue;
+
+        switch (fRampType)
+        {
+        case kTypeLinear:
+            fCurrentValue += fStep;
+            break;
+        case kTypeOnePole:
+            fCurrentValue = fTargetValue + (fCurrentValue - fTargetValue) * fCoefficient;
+            break;
+        case kTypeLogarithmic:
+            fCurrentValue *= fStep;
+            break;
+        default:
+            fCurrentValue = fTargetValue;
+            fRemainingFrames = 0;
+            break;
+        }
+
+        return fCurrentValue;
+    }
+
+    /**
+       Advance the ramp by @a frames samples without writing any values.
+     */
+    void skip(const uint32_t frames) noexcept
+    {
+        if (fRemainingFrames == 0)
+            return;
+
+        if (frames >= fRemainingFrames)
+        {
+            fCurrentValue = fTargetValue;
+            fRemainingFrames = 0;
+            return;
+        }
+
+        switch (fRampType)
+        {
+        case kTypeLinear:
+            fCurrentValue += fStep * static_cast<float>(frames);
+            break;
+        case kTypeOnePole:
+            fCurrentValue = fTargetValue + (fCurrentValue - fTargetValue)
+                                         * std::pow(fCoefficient, static_cast<float>(frames));
+            break;
+        case kTypeLogarithmic:
+            fCurrentValue *= std::pow(fStep, static_cast<float>(frames));
+            break;
+        default:
+            break;
+        }
+
+        fRemainingFrames -= frames;
+    }
+
+    /**
+       Write the next @a frames smoothed values into @a buffer.
+       Returns false, without touching the buffer, if the value is already settled.
+     */
+    bool process(float* const buffer, const uint32_t frames) noexcept
+    {
+        if (fRemainingFrames == 0)
+            return false;
+
+        DISTRHO_SAFE_ASSERT_RETURN(buffer != nullptr, false);
+
+        const uint32_t rampFrames = frames < fRemainingFrames ? frames : fRemainingFrames;
+
+        switch (fRampType)
+        {
+        case kTypeLinear: {
+            // no dependency between samples, so the compiler can vectorize this
+            const float start = fCurrentValue;
+            const float step = fStep;
+
+            for (uint32_t i=0; i<rampFrames; ++i)
+                buffer[i] = start + step * static_cast<float>(i + 1);
+
+            fCurrentValue = start + step * static_cast<float>(rampFrames);
+            break;
+        }
+        case kTypeOnePole: {
+            const float target = fTargetValue;
+            const float coeff = fCoefficient;
+            float value = fCurrentValue - target;
+
+            for (uint32_t i=0; i<rampFrames; ++i)
+            {
+                value *= coeff;
+                buffer[i] = target + value;
+            }
+
+            fCurrentValue = target + value;
+            break;
+        }
+        case kTypeLogarithmic: {
+            const float ratio = fStep;
+            float value = fCurrentValue;
+
+            for (uint32_t i=0; i<rampFrames; ++i)
+                buffer[i] = (value *= ratio);
+
+            fCurrentValue = value;
+            break;
+        }
+        default:
+            // unknown ramp, finish it now
+            for (uint32_t i=0; i<rampFrames; ++i)
+                buffer[i] = fTargetValue;
+            fRemainingFrames = rampFrames;
+            break;
+        }
+
+        fRemainingFrames -= rampFrames;
+
+        if (fRemainingFrames == 0)
+        {
+            fCurrentValue = fTargetValue;
+            buffer[rampFrames - 1] = fTargetValue;
+        }
+
+        // rest of the block is already settled
+        for (uint32_t i=rampFrames; i<frames; ++i)
+            buffer[i] = fTargetValue;
+
+        return true;
+    }
+
+private:
+    Type     fType;
+    Type     fRampType;
+    double   fSampleRate;
+    float    fTimeInMs;
+    uint32_t fRampFrames;
+    uint32_t fRemainingFrames;
+    float    fCoefficient;
+    float    fStep;
+    float    fCurrentValue;
+    float    fTargetValue;
+
+    /** @internal */
+    void startRamp() noexcept
+    {
+        if (fType == kTypeNone || fRampFrames == 0)
+        {
+            fCurrentValue = fTargetValue;
+            fRemainingFrames = 0;
+            return;
+        }
+
+        fRampType = fType;
+        fRemainingFrames = fRampFrames;
+
+        switch (fType)
+        {
+        case kTypeLinear:
+            fStep = (fTargetValue - fCurrentValue) / static_cast<float>(fRampFrames);
+            break;
+        case kTypeLogarithmic:
+            if (fCurrentValue > 0.0f && fTargetValue > 0.0f)
+            {
+                fStep = std::pow(fTargetValue / fCurrentValue, 1.0f / static_cast<float>(fRampFrames));
+            }
+            else
+            {
+                fRampType = kTypeLinear;
+                fStep = (fTargetValue - fCurrentValue) / static_cast<float>(fRampFrames);
+            }
+            break;
+        default:
+            break;
+        }
+    }
+};
+
+// -----------------------------------------------------------------------------------------------------------
+
+/**
+   A set of ParameterSmoother, one per parameter index.
+   Forward the plugin's getParameterValue() and setParameterValue() to this class,
+   so that every new value becomes the target of the matching smoother.
+   @code
+    SmoothedParameters<kParameterCount> fParams;
+
+    void initParameter(uint32_t index, Parameter& parameter) override
+    {
+        // ... fill in parameter details
+        fParams.init(index, parameter, getSampleRate());
+    }
+
+    float getParameterValue(uint32_t index) const override
+    {
+        return fParams.getParameterValue(index);
+    }
+
+    void setParameterValue(uint32_t index, float value) override
+    {
+        fParams.setParameterValue(index, value);
+    }
+
+    void sampleRateChanged(double newSampleRate) override
+    {
+        fParams.setSampleRate(newSampleRate);
+    }
+   @endcode
+
+   Inside run(), use fParams[index].process() as with a single ParameterSmoother.
+ */
+template <uint32_t numParameters>
+class SmoothedParameters {
+public:
+    /**
+       Set up the smoother for parameter @a index from its hints and ranges.
+     */
+    void init(const uint32_t index, const Parameter& parameter, const double sampleRate, const float timeInMs = 20.0f) noexcept
+    {
+        DISTRHO_SAFE_ASSERT_UINT2_RETURN(index < numParameters, index, numParameters,);
+
+        fSmoothers[index].setup(parameter, sampleRate, timeInMs);
+    }
+
+    /**
+       Change the sample rate of all smoothers.
+     */
+    void setSampleRate(const double sampleRate) noexcept
+    {
+        for (uint32_t i=0; i<numParameters; ++i)
+            fSmoothers[i].setSampleRate(sampleRate);
+    }
+
+    /**
+       Get the last value set for parameter @a index.
+     */
+    float getParameterValue(const uint32_t index) const noexcept
+    {
+        DISTRHO_SAFE_ASSERT_UINT2_RETURN(index < numParameters, index, numParameters, 0.0f);
+
+        return fSmoothers[index].getTarget();
+    }
+
+    /**
+       Set a new target value for parameter @a index.
+     */
+    void setParameterValue(const uint32_t index, const float value) noexcept
+    {
+        DISTRHO_SAFE_ASSERT_UINT2_RETURN(index < numParameters, index, numParameters,);
+
+        fSmoothers[index].setTarget(value);
+    }
+
+    /**
+       Access the smoother for parameter @a index.
+     */
+    ParameterSmoother& operator[](const uint32_t index) noexcept
+    {
+        return fSmoothers[index];
+    }
+
+    const ParameterSmoother& operator[](const uint32_t index) const noexcept
+    {
+        return fSmoothers[index];
+    }
+
+private:
+    ParameterSmoother fSmoothers[numParameters];
+};
+
+// -----------------------------------------------------------------------------------------------------------
+
+/**
+   Oversampler filter coefficients, used internally.
+
+   The FIR tables are the odd-phase taps of Kaiser-windowed half-band filters, the even-phase ones being
+   a single center tap of 0.5. They have over 94dB of stopband attenuation, with the first stage
+   (the one running at base sample rate) keeping the passband flat up to 0.4 of the base sample rate.
+
+   The IIR tables are for polyphase allpass half-band filters (elliptic, in the style of hiir),
+   with coefficients alternating between the two allpass paths. They have over 96dB of stopband attenuation.
+
+   There is one table per 2x stage, the later stages have a wider transition band and so are shorter.
+ */
+static const float kOversamplerFIR2x[32] = {
+    -1.0450027920e-05f, 7.5764400381e-05f, -2.5630600172e-04f, 6.5625947385e-04f, -1.4301866770e-03f,
+    2.7924069389e-03f, -5.0262534612e-03f, 8.4968510481e-03f, -1.3676738935e-02f, 2.1205872530e-02f,
+    -3.2037689793e-02f, 4.7810902700e-02f, -7.1898513055e-02f, 1.1301882813e-01f, -2.0332854299e-01f,
+    6.3360779572e-01f, 6.3360779572e-01f, -2.0332854299e-01f, 1.1301882813e-01f, -7.1898513055e-02f,
+    4.7810902700e-02f, -3.2037689793e-02f, 2.1205872530e-02f, -1.3676738935e-02f, 8.4968510481e-03f,
+    -5.0262534612e-03f, 2.7924069389e-03f, -1.4301866770e-03f, 6.5625947385e-04f, -2.5630600172e-04f,
+    7.5764400381e-05f, -1.0450027920e-05f
+};
+
+static const float kOversamplerFIR4x[16] = {
+    -1.4221804092e-05f, 4.5483248633e-04f, -2.8208675131e-03f, 1.0609979158e-02f, -3.0287778726e-02f,
+    7.3818252472e-02f, -1.7499650806e-01f, 6.2323631199e-01f, 6.2323631199e-01f, -1.7499650806e-01f,
+    7.3818252472e-02f, -3.0287778726e-02f, 1.0609979158e-02f, -2.8208675131e-03f, 4.5483248633e-04f,
+    -1.4221804092e-05f
+};
+
+static const float kOversamplerFIR8x[12] = {
+    -1.9393663368e-05f, 1.3100860166e-03f, -1.0424332341e-02f, 4.5009035360e-02f, -1.4782529069e-01f,
+    6.1194989532e-01f, 6.1194989532e-01f, -1.4782529069e-01f, 4.5009035360e-02f, -1.0424332341e-02f,
+    1.3100860166e-03f, -1.9393663368e-05f
+};
+
+static const float kOversamplerIIR2x[8] = {
+    4.0633460924e-02f, 1.5050512902e-01f, 3.0075705599e-01f, 4.6077450496e-01f, 6.0952431490e-01f,
+    7.3850384112e-01f, 8.4922381039e-01f, 9.4974278371e-01f
+};
+
+static const float kOversamplerIIR4x[5] = {
+    4.3001451727e-02f, 1.6349855424e-01f, 3.4245098967e-01f, 5.6496199737e-01f, 8.3567833193e-01f
+};
+
+static const float kOversamplerIIR8x[4] = {
+    5.1377485983e-02f, 1.9932959954e-01f, 4.3492124830e-01f, 7.7212380986e-01f
+};
+
+/**
+   Multi-channel 2x, 4x or 8x oversampler, made of a cascade of polyphase half-band 2x stages.
+
+   Memory is allocated in setup(), which should be called from activate() with the current buffer size
+   (bufferSizeChanged() is always followed by activate()), so upsample() and downsample() are realtime-safe.@n
+   If the plugin was built with DISTRHO_PLUGIN_WANT_LATENCY and a plugin pointer was given in the constructor,
+   the round-trip latency is reported to the host via Plugin::setLatency() during setup().
+   Pass nullptr instead if the plugin has other sources of latency, and add getLatency() to them.
+   @code
+    Oversampler fOversampler;  // initialized with fOversampler(this) in the plugin constructor
+
+    void activate() override
+    {
+        fOversampler.setup(4, DISTRHO_PLUGIN_NUM_INPUTS, getBufferSize());
+    }
+
+    void run(const float** inputs, float** outputs, uint32_t frames) override
+    {
+        float** const buffers = fOversampler.upsample(inputs, frames);
+        DISTRHO_SAFE_ASSERT_RETURN(buffers != nullptr,);
+
+        for (uint32_t c=0; c<DISTRHO_PLUGIN_NUM_INPUTS; ++c)
+            for (uint32_t i=0; i<frames*4; ++i)
+                buffers[c][i] = std::tanh(buffers[c][i]);
+
+        fOversampler.downsample(outputs, frames);
+    }
+   @endcode
+
+   FIR filters are linear-phase, IIR filters have much lower latency and CPU usage but non-linear phase.
+   Inner loops work on contiguous memory so that the compiler can vectorize them.
+   @note Hosts may call run() with more frames than the buffer size, which upsample() rejects.
+         Plugins that cannot rely on the buffer size should use DISTRHO_PLUGIN_MAX_SUBBLOCK_SIZE.
+ */
+class Oversampler {
+public:
+    /**
+       Filter type used for all 2x stages.
+     */
+    enum FilterType {
+        /** Linear-phase FIR filters. */
+        kFilterTypeFIR,
+        /** Polyphase allpass IIR filters, lower latency but non-linear phase. */
+        kFilterTypeIIR
+    };
+
+    /** Maximum oversampling factor. */
+    static const uint32_t kMaxFactor = 8;
+
+    /**
+       Constructor.
+       @a plugin is used for reporting latency, can be null.
+     */
+    explicit Oversampler(Plugin* const plugin = nullptr) noexcept
+        : fPlugin(plugin),
+          fFilterType(kFilterTypeFIR),
+          fFactor(0),
+          fNumStages(0),
+          fNumChannels(0),
+          fMaxFrames(0),
+          fBufferSize(0),
+          fBufferData(nullptr),
+          fBuffers(nullptr),
+          fStates(nullptr)
+    {
+        fScratch[0] = fScratch[1] = nullptr;
+    }
+
+    /**
+       Destructor.
+     */
+    ~Oversampler() noexcept
+    {
+        clear();
+    }
+
+    /**
+       Set up the oversampling @a factor (1, 2, 4 or 8), number of channels, maximum frames per block and filter type.
+       Memory is only reallocated if needed, filter state is always reset.
+       Must not be called during run().
+     */
+    bool setup(const uint32_t factor, const uint32_t numChannels, const uint32_t maxFrames,
+               const FilterType filterType = kFilterTypeFIR) noexcept
+    {
+        DISTRHO_SAFE_ASSERT_UINT_RETURN(factor == 1 || factor == 2 || factor == 4 || factor == 8, factor, false);
+        DISTRHO_SAFE_ASSERT_RETURN(numChannels != 0, false);
+        DISTRHO_SAFE_ASSERT_RETURN(maxFrames != 0, false);
+
+        const uint32_t bufferSize = maxFrames * factor;
+
+        if (numChannels != fNumChannels || bufferSize > fBufferSize)
+        {
+            clear();
+
+            try {
+                // one oversampled buffer per channel, plus 2 scratch buffers shared by all channels for the stages
+                fBufferData = new float[bufferSize * (numChannels + 1)];
+                fBuffers = new float*[numChannels];
+                fStates = new StageState[numChannels * kMaxStages];
+            } catch(...) {
+                d_safe_exception("Oversampler::setup", __FILE__, __LINE__);
+                clear();
+                return false;
+            }
+
+            for (uint32_t c=0; c<numChannels; ++c)
+                fBuffers[c] = fBufferData + bufferSize * c;
+
+            fScratch[0] = fBufferData + bufferSize * numChannels;
+            fScratch[1] = fScratch[0] + bufferSize / 2;
+            fNumChannels = numChannels;
+            fBufferSize = bufferSize;
+        }
+
+        fFilterType = filterType;
+        fFactor = factor;
+        fNumStages = factor == 8 ? 3 : factor == 4 ? 2 : factor == 2 ? 1 : 0;
+        fMaxFrames = fBufferSize / factor;
+
+        reset();
+
+       #if DISTRHO_PLUGIN_WANT_LATENCY
+        if (fPlugin != nullptr)
+            fPlugin->setLatency(getLatency());
+       #endif
+
+        return true;
+    }
+
+    /**
+       Clear the filter state, as if silence was processed.
+     */
+    void reset() noexcept
+    {
+        if (fStates != nullptr)
+            std::memset(fStates, 0, sizeof(StageState) * fNumChannels * kMaxStages);
+    }
+
+    /**
+       Get the current oversampling factor, or 0 if not set up.
+     */
+    uint32_t getFactor() const noexcept
+    {
+        return fFactor;
+    }
+
+    /**
+       Get the round-trip latency of upsample() followed by downsample(), in frames at base sample rate.
+       For IIR filters this is the delay at low frequencies, rounded to the nearest frame.
+     */
+    uint32_t getLatency() const noexcept
+    {
+        float latency = 0.0f;
+
+        for (uint32_t s=0; s<fNumStages; ++s)
+        {
+            const float delay = fFilterType == kFilterTypeFIR ? getFIRDelay(s) : getIIRDelay(s);
+            latency += delay / static_cast<float>(1 << s);
+        }
+
+        return static_cast<uint32_t>(latency + 0.5f);
+    }
+
+    /**
+       Get the oversampled buffer for @a channel, valid after setup().
+       It holds frames * factor samples after upsample(), and is read by downsample().
+     */
+    float* getBuffer(const uint32_t channel) const noexcept
+    {
+        DISTRHO_SAFE_ASSERT_UINT2_RETURN(channel < fNumChannels, channel, fNumChannels, nullptr);
+
+        return fBuffers[channel];
+    }
+
+    /**
+       Upsample @a frames of audio from @a inputs into the internal buffers.
+       Returns the buffers, with frames * factor samples per channel, which the plugin can process in place.
+       Returns nullptr if not set up or if @a frames is bigger than the maximum given in setup().
+     */
+    float** upsample(const float* const* const inputs, const uint32_t frames) noexcept
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(fBuffers != nullptr, nullptr);
+        DISTRHO_SAFE_ASSERT_UINT2_RETURN(frames <= fMaxFrames, frames, fMaxFrames, nullptr);
+
+        for (uint32_t c=0; c<fNumChannels; ++c)
+        {
+            if (fNumStages == 0)
+            {
+                std::memcpy(fBuffers[c], inputs[c], sizeof(float) * frames);
+                continue;
+            }
+
+            const float* src = inputs[c];
+            uint32_t srcFrames = frames;
+
+            for (uint32_t s=0; s<fNumStages; ++s)
+            {
+                float* const dst = s + 1 == fNumStages ? fBuffers[c] : fScratch[s % 2];
+                StageState& state(fStates[c * kMaxStages + s]);
+
+                if (fFilterType == kFilterTypeFIR)
+                    upsampleFIR(state, getFIRCoefficients(s), getFIRHalfLength(s), src, dst, srcFrames);
+                else
+                    upsampleIIR(state, getIIRCoefficients(s), getIIRLength(s), src, dst, srcFrames);
+
+                src = dst;
+                srcFrames *= 2;
+            }
+        }
+
+        return fBuffers;
+    }
+
+    /**
+       Downsample the internal buffers into @a frames of audio at base sample rate.
+       @a frames must match the last upsample() call.
+     */
+    void downsample(float** const outputs, const uint32_t frames) noexcept
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(fBuffers != nullptr,);
+        DISTRHO_SAFE_ASSERT_UINT2_RETURN(frames <= fMaxFrames, frames, fMaxFrames,);
+
+        for (uint32_t c=0; c<fNumChannels; ++c)
+        {
+            if (fNumStages == 0)
+            {
+                std::memcpy(outputs[c], fBuffers[c], sizeof(float) * frames);
+                continue;
+            }
+
+            const float* src = fBuffers[c];
+            uint32_t dstFrames = frames << (fNumStages - 1);
+
+            for (uint32_t s=fNumStages; s-- != 0;)
+            {
+                float* const dst = s == 0 ? outputs[c] : fScratch[s % 2];
+                StageState& state(fStates[c * kMaxStages + s]);
+
+                if (fFilterType == kFilterTypeFIR)
+                    downsampleFIR(state, getFIRCoefficients(s), getFIRHalfLength(s), src, dst, dstFrames);
+                else
+                    downsampleIIR(state, getIIRCoefficients(s), getIIRLength(s), src, dst, dstFrames);
+
+                src = dst;
+                dstFrames /= 2;
+            }
+        }
+    }
+
+private:
+    static const uint32_t kMaxStages = 3;
+    static const uint32_t kMaxFIRLength = 32;
+    static const uint32_t kMaxIIRLength = 8;
+
+    /*
+     * Filter state for a single channel and 2x stage.
+     * FIR history is written twice, at pos and pos + length, so that filters always read contiguous memory.
+     */
+    struct StageState {
+        float upHistory[kMaxFIRLength * 2];
+        float downOddHistory[kMaxFIRLength * 2];
+        float downEvenHistory[kMaxFIRLength];
+        uint32_t upPos, downOddPos, downEvenPos;
+        float upX[kMaxIIRLength], upY[kMaxIIRLength];
+        float downX[kMaxIIRLength], downY[kMaxIIRLength];
+    };
+
+    Plugin* const fPlugin;
+    FilterType fFilterType;
+    uint32_t fFactor;
+    uint32_t fNumStages;
+    uint32_t fNumChannels;
+    uint32_t fMaxFrames;
+    uint32_t fBufferSize;
+    float* fBufferData;
+    float** fBuffers;
+    float* fScratch[2];
+    StageState* fStates;
+
+    void clear() noexcept
+    {
+        delete[] fBufferData;
+        delete[] fBuffers;
+        delete[] fStates;
+        fBufferData = nullptr;
+        fBuffers = nullptr;
+        fStates = nullptr;
+        fScratch[0] = fScratch[1] = nullptr;
+        fFactor = fNumStages = fNumChannels = fMaxFrames = fBufferSize = 0;
+    }
+
+    // -------------------------------------------------------------------------------------------------------
+    // coefficient tables
+
+    static const float* getFIRCoefficients(const uint32_t stage) noexcept
+    {
+        return stage == 0 ? kOversamplerFIR2x : stage == 1 ? kOversamplerFIR4x : kOversamplerFIR8x;
+    }
+
+    static uint32_t getFIRHalfLength(const uint32_t stage) noexcept
+    {
+        return stage == 0 ? 16 : stage == 1 ? 8 : 6;
+    }
+
+    // round-trip delays are in samples at the stage input rate,
+    // with downsampling keeping the odd samples and so removing half a sample
+    static float getFIRDelay(const uint32_t stage) noexcept
+    {
+        return static_cast<float>(getFIRHalfLength(stage) * 2) - 1.5f;
+    }
+
+    static const float* getIIRCoefficients(const uint32_t stage) noexcept
+    {
+        return stage == 0 ? kOversamplerIIR2x : stage == 1 ? kOversamplerIIR4x : kOversamplerIIR8x;
+    }
+
+    static uint32_t getIIRLength(const uint32_t stage) noexcept
+    {
+        return stage == 0 ? 8 : stage == 1 ? 5 : 4;
+    }
+
+    static float getIIRDelay(const uint32_t stage) noexcept
+    {
+        const float* const coefs = getIIRCoefficients(stage);
+
+        // each allpass section delays by (1-a)/(1+a) at DC, averaged over both paths and both directions
+        float delay = 0.0f;
+
+        for (uint32_t i=0, count=getIIRLength(stage); i<count; ++i)
+            delay += (1.0f - coefs[i]) / (1.0f + coefs[i]);
+
+        return delay;
+    }
+
+    // -------------------------------------------------------------------------------------------------------
+    // FIR stages, halfLength is the number of odd-phase taps per side
+
+    static void upsampleFIR(StageState& state, const float* const coefs, const uint32_t halfLength,
+                            const float* const src, float* const dst, const uint32_t frames) noexcept
+    {
+        const uint32_t length = halfLength * 2;
+
+        for (uint32_t i=0; i<frames; ++i)
+        {
+            state.upPos = (state.upPos == 0 ? length : state.upPos) - 1;
+            state.upHistory[state.upPos] = state.upHistory[state.upPos + length] = src[i];
+
+            const float* const history = state.upHistory + state.upPos;
+            float sum = 0.0f;
+
+            for (uint32_t j=0; j<length; ++j)
+                sum += coefs[j] * history[j];
+
+            dst[i * 2] = sum;
+            dst[i * 2 + 1] = history[halfLength - 1];
+        }
+    }
+
+    static void downsampleFIR(StageState& state, const float* const coefs, const uint32_t halfLength,
+                              const float* const src, float* const dst, const uint32_t frames) noexcept
+    {
+        const uint32_t length = halfLength * 2;
+
+        for (uint32_t i=0; i<frames; ++i)
+        {
+            state.downOddPos = (state.downOddPos == 0 ? length : state.downOddPos) - 1;
+            state.downOddHistory[state.downOddPos] = state.downOddHistory[state.downOddPos + length] = src[i * 2 + 1];
+
+            state.downEvenPos = (state.downEvenPos == 0 ? halfLength : state.downEvenPos) - 1;
+            state.downEvenHistory[state.downEvenPos] = state.downEvenHistory[state.downEvenPos + halfLength] = src[i * 2];
+
+            const float* const history = state.downOddHistory + state.downOddPos;
+            float sum = 0.0f;
+
+            for (uint32_t j=0; j<length; ++j)
+                sum += coefs[j] * history[j];
+
+            dst[i] = 0.5f * (sum + state.downEvenHistory[state.downEvenPos + halfLength - 1]);
+        }
+    }
+
+    // -------------------------------------------------------------------------------------------------------
+    // IIR stages, even coefficients belong to the first allpass path and odd ones to the second
+
+    static void upsampleIIR(StageState& state, const float* const coefs, const uint32_t length,
+                            const float* const src, float* const dst, const uint32_t frames) noexcept
+    {
+        for (uint32_t i=0; i<frames; ++i)
+        {
+            float path[2] = { src[i], src[i] };
+
+            for (uint32_t j=0; j<length; ++j)
+            {
+                float& x(path[j % 2]);
+                const float y = (x - state.upY[j]) * coefs[j] + state.upX[j];
+                state.upX[j] = x;
+                state.upY[j] = x = y;
+            }
+
+            dst[i * 2] = path[0];
+            dst[i * 2 + 1] = path[1];
+        }
+    }
+
+    static void downsampleIIR(StageState& state, const float* const coefs, const uint32_t length,
+                              const float* const src, float* const dst, const uint32_t frames) noexcept
+    {
+        for (uint32_t i=0; i<frames; ++i)
+        {
+            float path[2] = { src[i * 2 + 1], src[i * 2] };
+
+            for (uint32_t j=0; j<length; ++j)
+            {
+                float& x(path[j % 2]);
+                const float y = (x - state.downY[j]) * coefs[j] + state.downX[j];
+                state.downX[j] = x;
+                state.downY[j] = x = y;
+            }
+
+            dst[i] = 0.5f * (path[0] + path[1]);
+        }
+    }
+
+    DISTRHO_DECLARE_NON_COPYABLE(Oversampler)
+};
+
+// -----------------------------------------------------------------------------------------------------------
+
+/**
+   Circular delay line with a power-of-two size, for sample types like float and double.
+
+   Writing and reading costs the same no matter how long the delay is, as nothing is ever moved around.
+   Memory is allocated in setMaxDelay(), which must be called outside of run(), usually in activate() or
+   sampleRateChanged(). All other functions are realtime-safe.
+
+   Delays are in frames, counted back from the last written sample, so that read(0) returns that same sample.
+   A plugin compensating for its own latency only needs the block version of process():
+   @code
+    // in activate()
+    fDelay.setMaxDelay(getSampleRate() * 2);
+
+    // in run()
+    fDelay.process(inputs[0], outputs[0], frames, fDelayInFrames);
+   @endcode
+
+   Per-sample code can use write() followed by any number of read(), readFractional() or readTaps() calls.
+ */
+template <typename T>
+class DelayLine {
+public:
+    /**
+       Constructor, setMaxDelay() must be called before using the delay line.
+     */
+    DelayLine() noexcept
+        : fBuffer(nullptr),
+          fSize(0),
+          fMask(0),
+          fWritePos(0) {}
+
+    /**
+       Destructor.
+     */
+    ~DelayLine() noexcept
+    {
+        delete[] fBuffer;
+    }
+
+    /**
+       Make room for delays of up to @a maxDelay frames, and clear the delay line.
+       Memory is only reallocated if the current buffer is too small.
+     */
+    bool setMaxDelay(const uint32_t maxDelay) noexcept
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(maxDelay < 0x80000000, false);
+
+        uint32_t size = 1;
+        while (size <= maxDelay)
+            size <<= 1;
+
+        if (size > fSize)
+        {
+            delete[] fBuffer;
+            fBuffer = nullptr;
+            fSize = fMask = 0;
+
+            try {
+                fBuffer = new T[size];
+            } DISTRHO_SAFE_EXCEPTION_RETURN("DelayLine::setMaxDelay", false);
+
+            fSize = size;
+            fMask = size - 1;
+        }
+
+        clear();
+        return true;
+    }
+
+    /**
+       Get the longest possible delay, which can be higher than requested in setMaxDelay().
+     */
+    uint32_t getMaxDelay() const noexcept
+    {
+        return fMask;
+    }
+
+    /**
+       Fill the delay line with silence.
+     */
+    void clear() noexcept
+    {
+        if (fBuffer != nullptr)
+            std::memset(fBuffer, 0, sizeof(T)*fSize);
+
+        fWritePos = 0;
+    }
+
+    /**
+       Add a new sample to the delay line.
+     */
+    void write(const T sample) noexcept
+    {
+        fBuffer[fWritePos] = sample;
+        fWritePos = (fWritePos + 1) & fMask;
+    }
+
+    /**
+       Get the sample written @a delay frames before the last one.
+     */
+    T read(const uint32_t delay) const noexcept
+    {
+        DISTRHO_SAFE_ASSERT_UINT2_RETURN(delay <= fMask, delay, fMask, T());
+
+        return fBuffer[(fWritePos - 1 - delay) & fMask];
+    }
+
+    /**
+       Get a sample between two frames, using linear interpolation.
+       @a delay is clamped to the valid range.
+     */
+    T readFractional(const float delay) const noexcept
+    {
+        if (delay <= 0.0f)
+            return read(0);
+
+        const uint32_t delayInt = static_cast<uint32_t>(delay);
+
+        if (delayInt >= fMask)
+            return read(fMask);
+
+        const T frac = static_cast<T>(delay - static_cast<float>(delayInt));
+        const T a = fBuffer[(fWritePos - 1 - delayInt) & fMask];
+        const T b = fBuffer[(fWritePos - 2 - delayInt) & fMask];
+        return a + (b - a) * frac;
+    }
+
+    /**
+       Read several taps at once, one for each of the @a count values in @a delays.
+     */
+    void readTaps(const uint32_t* const delays, T* const values, const uint32_t count) const noexcept
+    {
+        for (uint32_t i=0; i < count; ++i)
+            values[i] = read(delays[i]);
+    }
+
+    /**
+       Write @a frames samples at once.
+     */
+    void writeBlock(const T* const input, const uint32_t frames) noexcept
+    {
+        DISTRHO_SAFE_ASSERT_UINT2_RETURN(frames <= fSize, frames, fSize,);
+
+        const uint32_t firstSpan = frames < fSize - fWritePos ? frames : fSize - fWritePos;
+
+        std::memcpy(fBuffer + fWritePos, input, sizeof(T)*firstSpan);
+        std::memcpy(fBuffer, input + firstSpan, sizeof(T)*(frames - firstSpan));
+
+        fWritePos = (fWritePos + frames) & fMask;
+    }
+
+    /**
+       Read @a frames samples at once, ending @a delay frames before the last written sample.
+       After a writeBlock() of the same size, this gives that block delayed by @a delay frames.
+       @a delay + @a frames must not be bigger than the size of the delay line, which is getMaxDelay() + 1.
+     */
+    void readBlock(T* const output, const uint32_t frames, const uint32_t delay) const noexcept
+    {
+        DISTRHO_SAFE_ASSERT_UINT2_RETURN(delay + frames <= fSize, delay + frames, fSize,);
+
+        const uint32_t readPos = (fWritePos - frames - delay) & fMask;
+        const uint32_t firstSpan = frames < fSize - readPos ? frames : fSize - readPos;
+
+        std::memcpy(output, fBuffer + readPos, sizeof(T)*firstSpan);
+        std::memcpy(output + firstSpan, fBuffer, sizeof(T)*(frames - firstSpan));
+    }
+
+    /**
+       Delay a block of audio by @a delay frames, any number of frames at a time.
+       @a input and @a output can be the same buffer.
+     */
+    void process(const T* input, T* output, uint32_t frames, const uint32_t delay) noexcept
+    {
+        DISTRHO_SAFE_ASSERT_UINT2_RETURN(delay <= fMask, delay, fMask,);
+
+        // each chunk must be read before newer samples overwrite it
+        const uint32_t maxChunk = fSize - delay;
+
+        while (frames != 0)
+        {
+            const uint32_t chunk = frames < maxChunk ? frames : maxChunk;
+
+            writeBlock(input, chunk);
+            readBlock(output, chunk, delay);
+
+            input += chunk;
+            output += chunk;
+            frames -= chunk;
+        }
+    }
+
+private:
+    T* fBuffer;
+    uint32_t fSize;
+    uint32_t fMask;
+    uint32_t fWritePos;
+
+    DISTRHO_DECLARE_NON_COPYABLE(DelayLine)
+};
+
+// -----------------------------------------------------------------------------------------------------------
+
+/**
+   Band-limited wavetable oscillator, a cheap replacement for calling std::sin() or similar on every sample.
+
+   Each waveform is stored as a set of tables with fewer and fewer harmonics (mip-maps, a sine only needs one),
+   and the oscillator picks the one that has no harmonics above Nyquist for its current frequency.
+   The tables are created the first time a waveform is used and shared by all oscillators in the same binary,
+   so the constructor and setWaveform() should be called outside of run(). Everything else is realtime-safe.
+   @code
+    WavetableOscillator fOsc;
+
+    void sampleRateChanged(double newSampleRate) override
+    {
+        fOsc.setSampleRate(newSampleRate);
+    }
+
+    void run(const float**, float** outputs, uint32_t frames) override
+    {
+        fOsc.setFrequency(440.0f);
+        fOsc.process(outputs[0], frames);
+    }
+   @endcode
+
+   Block processing first computes the phase of several samples at once in a loop the compiler can vectorize,
+   and then reads the tables with linear interpolation.
+ */
+class WavetableOscillator {
+public:
+    /**
+       Available waveforms.
+     */
+    enum Waveform {
+        kWaveformSine,
+        kWaveformTriangle,
+        kWaveformSawtooth,
+        kWaveformSquare
+    };
+
+    /** Number of samples in each table. */
+    static const uint32_t kTableSize = 2048;
+
+    /** Number of tables per waveform, the first has 1024 harmonics and each next one half of the previous. */
+    static const uint32_t kNumLevels = 11;
+
+    /**
+       Constructor, creates the shared tables for @a waveform if needed.
+     */
+    explicit WavetableOscillator(const Waveform waveform = kWaveformSine)
+        : fTable(&getTable(waveform)),
+          fSampleRate(44100.0),
+          fPhase(0.0f),
+          fIncrement(0.0f),
+          fLevel(0) {}
+
+    /**
+       Change the waveform, creating its shared tables if needed.
+       This is only realtime-safe if the waveform was used before.
+     */
+    void setWaveform(const Waveform waveform)
+    {
+        fTable = &getTable(waveform);
+    }
+
+    /**
+       Set the sample rate used by setFrequency().
+     */
+    void setSampleRate(const double sampleRate) noexcept
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(sampleRate > 0.0,);
+
+        fSampleRate = sampleRate;
+    }
+
+    /**
+       Set the frequency in Hz.
+     */
+    void setFrequency(const float frequency) noexcept
+    {
+        setPhaseIncrement(static_cast<float>(frequency / fSampleRate));
+    }
+
+    /**
+       Set the frequency as a phase increment per sample, that is the frequency divided by the sample rate.
+     */
+    void setPhaseIncrement(float increment) noexcept
+    {
+        if (increment < 0.0f)
+            increment = 0.0f;
+        else if (increment > 0.5f)
+            increment = 0.5f;
+
+        fIncrement = increment;
+
+        // use the table with the most harmonics that stay below Nyquist
+        const float maxHarmonics = increment > 0.0f ? 0.5f / increment : static_cast<float>(kTableSize);
+
+        fLevel = 0;
+        while (fLevel + 1 < kNumLevels && static_cast<float>((kTableSize / 2) >> fLevel) > maxHarmonics)
+            ++fLevel;
+    }
+
+    /**
+       Restart the oscillator at @a phase, from 0 to 1.
+     */
+    void reset(const float phase = 0.0f) noexcept
+    {
+        fPhase = phase - std::floor(phase);
+    }
+
+    /**
+       Get the current phase, from 0 to 1.
+     */
+    float getPhase() const noexcept
+    {
+        return fPhase;
+    }
+
+    /**
+       Render a single sample.
+     */
+    float next() noexcept
+    {
+        const float value = read(fTable->levels[fLevel], fPhase);
+
+        fPhase += fIncrement;
+        if (fPhase >= 1.0f)
+            fPhase -= 1.0f;
+
+        return value;
+    }
+
+    /**
+       Render @a frames samples into @a output.
+     */
+    void process(float* const output, const uint32_t frames) noexcept
+    {
+        render<false>(output, frames, 1.0f);
+    }
+
+    /**
+       Render @a frames samples multiplied by @a gain, adding them to @a output.
+       Handy for summing voices or partials.
+     */
+    void processAdd(float* const output, const uint32_t frames, const float gain) noexcept
+    {
+        render<true>(output, frames, gain);
+    }
+
+private:
+    struct Table {
+        const float* levels[kNumLevels];
+        float* data;
+
+        explicit Table(const Waveform waveform)
+            : data(nullptr)
+        {
+            // a sine has no harmonics to remove, so all levels share the same table
+            const uint32_t numTables = waveform == kWaveformSine ? 1 : kNumLevels;
+
+            data = new float[numTables * (kTableSize + 1)];
+
+            // a single sine cycle, read at different speeds for all harmonics
+            float sine[kTableSize];
+
+            for (uint32_t i=0; i<kTableSize; ++i)
+                sine[i] = static_cast<float>(std::sin(2.0 * M_PI * i / kTableSize));
+
+            for (uint32_t level=0; level<numTables; ++level)
+            {
+                const uint32_t numHarmonics = (kTableSize / 2) >> level;
+                float* const table = data + level * (kTableSize + 1);
+
+                for (uint32_t i=0; i<kTableSize; ++i)
+                {
+                    double value = 0.0;
+
+                    for (uint32_t h=1; h<=numHarmonics; ++h)
+                        value += getHarmonicAmplitude(waveform, h) * sine[(h * i) % kTableSize];
+
+                    table[i] = static_cast<float>(value);
+                }
+
+                // extra sample for interpolation
+                table[kTableSize] = table[0];
+            }
+
+            for (uint32_t level=0; level<kNumLevels; ++level)
+                levels[level] = data + (level < numTables ? level : numTables - 1) * (kTableSize + 1);
+        }
+
+        ~Table()
+        {
+            delete[] data;
+        }
+
+        static double getHarmonicAmplitude(const Waveform waveform, const uint32_t h) noexcept
+        {
+            switch (waveform)
+            {
+            case kWaveformSine:
+                return h == 1 ? 1.0 : 0.0;
+            case kWaveformTriangle:
+                if (h % 2 == 0)
+                    return 0.0;
+                return (h % 4 == 1 ? 8.0 : -8.0) / (M_PI * M_PI * h * h);
+            case kWaveformSawtooth:
+                return 2.0 / (M_PI * h);
+            case kWaveformSquare:
+                return h % 2 == 0 ? 0.0 : 4.0 / (M_PI * h);
+            }
+
+            return 0.0;
+        }
+
+        DISTRHO_DECLARE_NON_COPYABLE(Table)
+    };
+
+    const Table* fTable;
+    double fSampleRate;
+    float fPhase;
+    float fIncrement;
+    uint32_t fLevel;
+
+    static const Table& getTable(const Waveform waveform)
+    {
+        // created on first use and shared, the compiler makes sure this happens only once
+        switch (waveform)
+        {
+        case kWaveformTriangle: { static const Table table(kWaveformTriangle); return table; }
+        case kWaveformSawtooth: { static const Table table(kWaveformSawtooth); return table; }
+        case kWaveformSquare:   { static const Table table(kWaveformSquare);   return table; }
+        default: break;
+        }
+
+        static const Table table(kWaveformSine);
+        return table;
+    }
+
+    static float read(const float* const table, const float phase) noexcept
+    {
+        const float pos = phase * static_cast<float>(kTableSize);
+        const uint32_t index = static_cast<uint32_t>(pos);
+        const float frac = pos - static_cast<float>(index);
+
+        return table[index] + frac * (table[index + 1] - table[index]);
+    }
+
+    template <bool add>
+    void render(float* const output, const uint32_t frames, const float gain) noexcept
+    {
+        static const uint32_t kChunkSize = 32;
+
+        const float* const table = fTable->levels[fLevel];
+        float phases[kChunkSize];
+
+        for (uint32_t offset=0; offset<frames; offset+=kChunkSize)
+        {
+            const uint32_t count = frames - offset < kChunkSize ? frames - offset : kChunkSize;
+
+            // all phases of the chunk at once, wrapped back into 0 to 1
+            for (uint32_t i=0; i<count; ++i)
+            {
+                const float phase = fPhase + fIncrement * static_cast<float>(i);
+                phases[i] = phase - static_cast<float>(static_cast<int32_t>(phase));
+            }
+
+            for (uint32_t i=0; i<count; ++i)
+            {
+                const float value = read(table, phases[i]);
+
+                if (add)
+                    output[offset + i] += value * gain;
+                else
+                    output[offset + i] = value;
+            }
+
+            fPhase += fIncrement * static_cast<float>(count);
+            fPhase -= static_cast<float>(static_cast<int32_t>(fPhase));
+        }
+    }
+
+    DISTRHO_DECLARE_NON_COPYABLE(WavetableOscillator)
+};
+
+// -----------------------------------------------------------------------------------------------------------
+
 END_NAMESPACE_DISTRHO
 
 #endif // DISTRHO_PLUGIN_UTILS_HPP_INCLUDED
@@ -0,0 +1,110 @@
+/*
+ * DISTRHO Plugin Framework (DPF)
+ * Copyright (C) 2012-2021 Filipe Coelho <falktx@falktx.com>
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any purpose with
+ * or without fee is hereby granted, provided that the above copyright notice and this
+ * permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+ * TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+ * DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+ * IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef DISTRHO_ATOMIC_OPS_HPP_INCLUDED
+#define DISTRHO_ATOMIC_OPS_HPP_INCLUDED
+
+#include "../DistrhoUtils.hpp"
+
+#if defined(_MSC_VER) && ! defined(__clang__)
+# include <intrin.h>
+#endif
+
+START_NAMESPACE_DISTRHO
+
+// -----------------------------------------------------------------------
+// AtomicOps class
+
+/**
+   Acquire/release operations on plain integers, for the lock-free structures in DPF.
+
+   A value published with storeRelease() makes all memory writes done before it
+   visible to the thread that reads the same value with loadAcquire().
+
+   GCC and clang use their atomic builtins.
+   MSVC only orders volatile accesses with /volatile:ms, which is not the default on ARM,
+   so explicit ARM instructions or barriers are used there instead.
+ */
+class AtomicOps
+{
+public:
+   /**
+      Load a value written by another thread, pairs with storeRelease().
+    */
+    static uint32_t loadAcquire(const uint32_t& value) noexcept
+    {
+#if defined(_MSC_VER) && ! defined(__clang__)
+# if defined(_M_ARM64)
+        return __ldar32(reinterpret_cast<volatile unsigned __int32*>(const_cast<uint32_t*>(&value)));
+# elif defined(_M_ARM)
+        const uint32_t ret = *static_cast<const volatile uint32_t*>(&value);
+        __dmb(_ARM_BARRIER_ISH);
+        return ret;
+# else
+        // x86 loads already have acquire semantics, only the compiler must not reorder them
+        const uint32_t ret = *static_cast<const volatile uint32_t*>(&value);
+        _ReadWriteBarrier();
+        return ret;
+# endif
+#else
+        return __atomic_load_n(&value, __ATOMIC_ACQUIRE);
+#endif
+    }
+
+   /**
+      Store a value for another thread, after all memory accesses before it.
+    */
+    static void storeRelease(uint32_t& value, const uint32_t newValue) noexcept
+    {
+#if defined(_MSC_VER) && ! defined(__clang__)
+# if defined(_M_ARM64)
+        __stlr32(reinterpret_cast<volatile unsigned __int32*>(&value), newValue);
+# elif defined(_M_ARM)
+        __dmb(_ARM_BARRIER_ISH);
+        *static_cast<volatile uint32_t*>(&value) = newValue;
+# else
+        // x86 stores already have release semantics, only the compiler must not reorder them
+        _ReadWriteBarrier();
+        *static_cast<volatile uint32_t*>(&value) = newValue;
+# endif
+#else
+        __atomic_store_n(&value, newValue, __ATOMIC_RELEASE);
+#endif
+    }
+
+   /**
+      Atomically replace @a value with @a newValue if it still matches @a expected.
+      Returns true if the value was replaced.
+    */
+    static bool compareAndSwap(uint32_t& value, const uint32_t expected, const uint32_t newValue) noexcept
+    {
+#if defined(_MSC_VER) && ! defined(__clang__)
+        // interlocked functions are full barriers on all architectures
+        return static_cast<uint32_t>(_InterlockedCompareExchange(reinterpret_cast<volatile long*>(&value),
+                                                                 static_cast<long>(newValue),
+                                                                 static_cast<long>(expected))) == expected;
+#else
+        uint32_t current = expected;
+        return __atomic_compare_exchange_n(&value, &current, newValue, false, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED);
+#endif
+    }
+};
+
+// -----------------------------------------------------------------------
+
+END_NAMESPACE_DISTRHO
+
+#endif // DISTRHO_ATOMIC_OPS_HPP_INCLUDED
@@ -0,0 +1,835 @@
+/*
+ * DISTRHO Plugin Framework (DPF)
+ * Copyright (C) 2012-2021 Filipe Coelho <falktx@falktx.com>
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any purpose with
+ * or without fee is hereby granted, provided that the above copyright notice and this
+ * permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+ * TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+ * DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+ * IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef DISTRHO_AUDIO_BUFFER_OPS_HPP_INCLUDED
+#define DISTRHO_AUDIO_BUFFER_OPS_HPP_INCLUDED
+
+#include "../DistrhoUtils.hpp"
+
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+# define DISTRHO_AUDIO_BUFFER_OPS_SSE2
+# include <emmintrin.h>
+# if (defined(__GNUC__) || defined(__clang__)) && ! defined(_MSC_VER)
+#  define DISTRHO_AUDIO_BUFFER_OPS_AVX2
+#  define DISTRHO_AUDIO_BUFFER_OPS_AVX2_TARGET __attribute__((target("avx2")))
+#  include <cpuid.h>
+#  include <immintrin.h>
+# endif
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+# define DISTRHO_AUDIO_BUFFER_OPS_NEON
+# include <arm_neon.h>
+#endif
+
+START_NAMESPACE_DISTRHO
+
+// -----------------------------------------------------------------------
+// AudioBufferOps class
+
+/**
+   Vectorized operations on audio buffers, for the loops found in most plugin run() functions.
+
+   All functions are realtime-safe and work on non-interleaved buffers of @a frames samples.@n
+   Float operations use SSE2 or NEON when the compiler targets them, with AVX2 chosen at runtime on CPUs that support it.
+   SSE2 and NEON are always available on x86-64 and ARM64, so only AVX2 needs a runtime check.
+   Other systems and double-precision buffers use plain loops, which the compiler can still vectorize.
+
+   Source and destination buffers may be the same, but must not partially overlap.
+
+   Typical usage:
+   ```
+   void run(const float** inputs, float** outputs, uint32_t frames) override
+   {
+       // copy input to output, applying a smooth gain change
+       AudioBufferOps::copyWithGainRamp(outputs[0], inputs[0], fLastGain, fGain, frames);
+       fLastGain = fGain;
+
+       // meter the result
+       fPeak = AudioBufferOps::getPeak(outputs[0], frames);
+   }
+   ```
+ */
+class AudioBufferOps
+{
+public:
+    // -------------------------------------------------------------------
+    // simple operations
+
+   /**
+      Fill @a buffer with silence.
+    */
+    template <typename T>
+    static void clear(T* const buffer, const uint32_t frames) noexcept
+    {
+        std::memset(buffer, 0, sizeof(T)*frames);
+    }
+
+   /**
+      Copy @a src into @a dst, does nothing if both are the same buffer.
+    */
+    template <typename T>
+    static void copy(T* const dst, const T* const src, const uint32_t frames) noexcept
+    {
+        if (dst != src)
+            std::memcpy(dst, src, sizeof(T)*frames);
+    }
+
+   /**
+      Copy @a src into @a dst, converting between sample types (for example float and double).
+    */
+    template <typename DstType, typename SrcType>
+    static void convert(DstType* const dst, const SrcType* const src, const uint32_t frames) noexcept
+    {
+        for (uint32_t i=0; i < frames; ++i)
+            dst[i] = static_cast<DstType>(src[i]);
+    }
+
+    // -------------------------------------------------------------------
+    // gain
+
+   /**
+      Multiply @a buffer by @a gain.
+    */
+    static void applyGain(float* const buffer, const float gain, const uint32_t frames) noexcept
+    {
+        copyWithGain(buffer, buffer, gain, frames);
+    }
+
+   /**
+      Copy @a src multiplied by @a gain into @a dst.
+    */
+    static void copyWithGain(float* const dst, const float* const src, const float gain, const uint32_t frames) noexcept
+    {
+        if (d_isEqual(gain, 1.0f))
+            return copy(dst, src, frames);
+
+        getFunctions().copyWithGain(dst, src, gain, frames);
+    }
+
+   /**
+      Multiply @a buffer by a gain going linearly from @a startGain to @a endGain.
+      The ramp is meant to continue in the next block, so @a endGain is the gain for the sample after the last one.
+    */
+    static void applyGainRamp(float* const buffer, const float startGain, const float endGain,
+                              const uint32_t frames) noexcept
+    {
+        copyWithGainRamp(buffer, buffer, startGain, endGain, frames);
+    }
+
+   /**
+      Copy @a src into @a dst, multiplied by a gain going linearly from @a startGain to @a endGain.
+      @see applyGainRamp
+    */
+    static void copyWithGainRamp(float* const dst, const float* const src, const float startGain, const float endGain,
+                                 const uint32_t frames) noexcept
+    {
+        if (d_isEqual(startGain, endGain))
+            return copyWithGain(dst, src, startGain, frames);
+
+        getFunctions().copyWithGainRamp(dst, src, startGain, endGain, frames);
+    }
+
+    // -------------------------------------------------------------------
+    // mixing
+
+   /**
+      Add @a src into @a dst.
+    */
+    static void add(float* const dst, const float* const src, const uint32_t frames) noexcept
+    {
+        getFunctions().addWithGain(dst, src, 1.0f, frames);
+    }
+
+   /**
+      Add @a src multiplied by @a gain into @a dst.
+    */
+    static void addWithGain(float* const dst, const float* const src, const float gain, const uint32_t frames) noexcept
+    {
+        getFunctions().addWithGain(dst, src, gain, frames);
+    }
+
+    // -------------------------------------------------------------------
+    // analysis
+
+   /**
+      Get the highest absolute sample value in @a buffer.
+    */
+    static float getPeak(const float* const buffer, const uint32_t frames) noexcept
+    {
+        return getFunctions().getPeak(buffer, frames);
+    }
+
+   /**
+      Get the root mean square level of @a buffer.
+    */
+    static float getRMS(const float* const buffer, const uint32_t frames) noexcept
+    {
+        if (frames == 0)
+            return 0.0f;
+
+        return std::sqrt(getFunctions().getSumOfSquares(buffer, frames) / static_cast<float>(frames));
+    }
+
+   /**
+      Get the lowest and highest sample values in @a buffer, both are 0 for an empty buffer.
+    */
+    static void getMinMax(const float* const buffer, const uint32_t frames, float& min, float& max) noexcept
+    {
+        if (frames == 0)
+        {
+            min = max = 0.0f;
+            return;
+        }
+
+        getFunctions().getMinMax(buffer, frames, min, max);
+    }
+
+   /**
+      Check if all samples of @a buffer are 0.
+    */
+    static bool isSilent(const float* const buffer, const uint32_t frames) noexcept
+    {
+        return getFunctions().getPeak(buffer, frames) == 0.0f;
+    }
+
+    static bool isSilent(const double* const buffer, const uint32_t frames) noexcept
+    {
+        for (uint32_t i=0; i < frames; ++i)
+        {
+            if (buffer[i] != 0.0)
+                return false;
+        }
+
+        return true;
+    }
+
+    // -------------------------------------------------------------------
+    // channel layout
+
+   /**
+      Interleave @a numChannels buffers from @a src into a single @a dst buffer.
+    */
+    static void interleave(float* const dst, const float* const* const src,
+                           const uint32_t numChannels, const uint32_t frames) noexcept
+    {
+        uint32_t i = 0;
+
+        if (numChannels == 2)
+        {
+            const float* const left  = src[0];
+            const float* const right = src[1];
+
+#if defined(DISTRHO_AUDIO_BUFFER_OPS_SSE2)
+            for (; i + 4 <= frames; i += 4)
+            {
+                const __m128 l = _mm_loadu_ps(left + i);
+                const __m128 r = _mm_loadu_ps(right + i);
+                _mm_storeu_ps(dst + i * 2,     _mm_unpacklo_ps(l, r));
+                _mm_storeu_ps(dst + i * 2 + 4, _mm_unpackhi_ps(l, r));
+            }
+#elif defined(DISTRHO_AUDIO_BUFFER_OPS_NEON)
+            for (; i + 4 <= frames; i += 4)
+            {
+                float32x4x2_t lr;
+                lr.val[0] = vld1q_f32(left + i);
+                lr.val[1] = vld1q_f32(right + i);
+                vst2q_f32(dst + i * 2, lr);
+            }
+#endif
+            for (; i < frames; ++i)
+            {
+                dst[i * 2]     = left[i];
+                dst[i * 2 + 1] = right[i];
+            }
+            return;
+        }
+
+        for (; i < frames; ++i)
+            for (uint32_t c=0; c < numChannels; ++c)
+                dst[i * numChannels + c] = src[c][i];
+    }
+
+   /**
+      Split the interleaved @a src buffer into @a numChannels @a dst buffers.
+    */
+    static void deinterleave(float* const* const dst, const float* const src,
+                             const uint32_t numChannels, const uint32_t frames) noexcept
+    {
+        uint32_t i = 0;
+
+        if (numChannels == 2)
+        {
+            float* const left  = dst[0];
+            float* const right = dst[1];
+
+#if defined(DISTRHO_AUDIO_BUFFER_OPS_SSE2)
+            for (; i + 4 <= frames; i += 4)
+            {
+                const __m128 a = _mm_loadu_ps(src + i * 2);
+                const __m128 b = _mm_loadu_ps(src + i * 2 + 4);
+                _mm_storeu_ps(left + i,  _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+                _mm_storeu_ps(right + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+            }
+#elif defined(DISTRHO_AUDIO_BUFFER_OPS_NEON)
+            for (; i + 4 <= frames; i += 4)
+            {
+                const float32x4x2_t lr = vld2q_f32(src + i * 2);
+                vst1q_f32(left + i,  lr.val[0]);
+                vst1q_f32(right + i, lr.val[1]);
+            }
+#endif
+            for (; i < frames; ++i)
+            {
+                left[i]  = src[i * 2];
+                right[i] = src[i * 2 + 1];
+            }
+            return;
+        }
+
+        for (; i < frames; ++i)
+            for (uint32_t c=0; c < numChannels; ++c)
+                dst[c][i] = src[i * numChannels + c];
+    }
+
+    // -------------------------------------------------------------------
+    // information
+
+   /**
+      Get the name of the instruction set used for float operations, as chosen at runtime.
+    */
+    static const char* getInstructionSetName() noexcept
+    {
+        return getFunctions().name;
+    }
+
+    // -------------------------------------------------------------------
+
+private:
+    struct Functions {
+        const char* name;
+        void (*copyWithGain)(float*, const float*, float, uint32_t);
+        void (*copyWithGainRamp)(float*, const float*, float, float, uint32_t);
+        void (*addWithGain)(float*, const float*, float, uint32_t);
+        float (*getPeak)(const float*, uint32_t);
+        float (*getSumOfSquares)(const float*, uint32_t);
+        void (*getMinMax)(const float*, uint32_t, float&, float&);
+    };
+
+    static const Functions& getFunctions() noexcept
+    {
+        static const Functions functions = selectFunctions();
+        return functions;
+    }
+
+    static Functions selectFunctions() noexcept
+    {
+#if defined(DISTRHO_AUDIO_BUFFER_OPS_AVX2)
+        if (hasAVX2())
+        {
+            const Functions functions = {
+                "AVX2",
+                copyWithGainAVX2, copyWithGainRampAVX2, addWithGainAVX2,
+                getPeakAVX2, getSumOfSquaresAVX2, getMinMaxAVX2
+            };
+            return functions;
+        }
+#endif
+#if defined(DISTRHO_AUDIO_BUFFER_OPS_SSE2)
+        const Functions functions = {
+            "SSE2",
+            copyWithGainSSE2, copyWithGainRampSSE2, addWithGainSSE2,
+            getPeakSSE2, getSumOfSquaresSSE2, getMinMaxSSE2
+        };
+#elif defined(DISTRHO_AUDIO_BUFFER_OPS_NEON)
+        const Functions functions = {
+            "NEON",
+            copyWithGainNEON, copyWithGainRampNEON, addWithGainNEON,
+            getPeakNEON, getSumOfSquaresNEON, getMinMaxNEON
+        };
+#else
+        const Functions functions = {
+            "none",
+            copyWithGainScalar, copyWithGainRampScalar, addWithGainScalar,
+            getPeakScalar, getSumOfSquaresScalar, getMinMaxScalar
+        };
+#endif
+        return functions;
+    }
+
+    // -------------------------------------------------------------------
+    // scalar code, also used for the last samples of vectorized loops
+
+    static void copyWithGainScalar(float* const dst, const float* const src, const float gain,
+                                   const uint32_t frames) noexcept
+    {
+        for (uint32_t i=0; i < frames; ++i)
+            dst[i] = src[i] * gain;
+    }
+
+    static void copyWithGainRampScalar(float* const dst, const float* const src,
+                                       const float startGain, const float endGain, const uint32_t frames) noexcept
+    {
+        const float step = (endGain - startGain) / static_cast<float>(frames);
+
+        for (uint32_t i=0; i < frames; ++i)
+            dst[i] = src[i] * (startGain + step * static_cast<float>(i));
+    }
+
+    static void addWithGainScalar(float* const dst, const float* const src, const float gain,
+                                  const uint32_t frames) noexcept
+    {
+        for (uint32_t i=0; i < frames; ++i)
+            dst[i] += src[i] * gain;
+    }
+
+    static float getPeakScalar(const float* const buffer, const uint32_t frames) noexcept
+    {
+        float peak = 0.0f;
+
+        for (uint32_t i=0; i < frames; ++i)
+            peak = std::max(peak, std::abs(buffer[i]));
+
+        return peak;
+    }
+
+    static float getSumOfSquaresScalar(const float* const buffer, const uint32_t frames) noexcept
+    {
+        float sum = 0.0f;
+
+        for (uint32_t i=0; i < frames; ++i)
+            sum += buffer[i] * buffer[i];
+
+        return sum;
+    }
+
+    static void getMinMaxScalar(const float* const buffer, const uint32_t frames, float& min, float& max) noexcept
+    {
+        float tmpMin = buffer[0];
+        float tmpMax = buffer[0];
+
+        for (uint32_t i=1; i < frames; ++i)
+        {
+            tmpMin = std::min(tmpMin, buffer[i]);
+            tmpMax = std::max(tmpMax, buffer[i]);
+        }
+
+        min = tmpMin;
+        max = tmpMax;
+    }
+
+    // handle the last samples after a vectorized loop, starting from i
+    static void copyWithGainRampTail(float* const dst, const float* const src,
+                                     const float startGain, const float endGain,
+                                     const uint32_t frames, const uint32_t i) noexcept
+    {
+        if (i == frames)
+            return;
+
+        const float gain = startGain + (endGain - startGain) * static_cast<float>(i) / static_cast<float>(frames);
+        copyWithGainRampScalar(dst + i, src + i, gain, endGain, frames - i);
+    }
+
+    static void getMinMaxTail(const float* const buffer, const uint32_t frames, const uint32_t i,
+                              float& min, float& max) noexcept
+    {
+        if (i == frames)
+            return;
+
+        float tmpMin, tmpMax;
+        getMinMaxScalar(buffer + i, frames - i, tmpMin, tmpMax);
+        min = std::min(min, tmpMin);
+        max = std::max(max, tmpMax);
+    }
+
+    // reduce the values of a vector, stored as an array, into a single one
+    template <uint32_t N>
+    static float reduceMax(const float (&values)[N]) noexcept
+    {
+        float ret = values[0];
+        for (uint32_t i=1; i < N; ++i)
+            ret = std::max(ret, values[i]);
+        return ret;
+    }
+
+    template <uint32_t N>
+    static float reduceMin(const float (&values)[N]) noexcept
+    {
+        float ret = values[0];
+        for (uint32_t i=1; i < N; ++i)
+            ret = std::min(ret, values[i]);
+        return ret;
+    }
+
+    template <uint32_t N>
+    static float reduceSum(const float (&values)[N]) noexcept
+    {
+        float ret = values[0];
+        for (uint32_t i=1; i < N; ++i)
+            ret += values[i];
+        return ret;
+    }
+
+#if defined(DISTRHO_AUDIO_BUFFER_OPS_SSE2)
+    // -------------------------------------------------------------------
+    // SSE2 code, 4 floats at a time
+
+    static void copyWithGainSSE2(float* const dst, const float* const src, const float gain,
+                                 const uint32_t frames) noexcept
+    {
+        const __m128 g = _mm_set1_ps(gain);
+        uint32_t i = 0;
+
+        for (; i + 4 <= frames; i += 4)
+            _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_loadu_ps(src + i), g));
+
+        copyWithGainScalar(dst + i, src + i, gain, frames - i);
+    }
+
+    static void copyWithGainRampSSE2(float* const dst, const float* const src,
+                                     const float startGain, const float endGain, const uint32_t frames) noexcept
+    {
+        const float step = (endGain - startGain) / static_cast<float>(frames);
+        const __m128 start = _mm_set1_ps(startGain);
+        const __m128 steps = _mm_mul_ps(_mm_set1_ps(step), _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f));
+        const __m128 blockStep = _mm_set1_ps(step * 4.0f);
+        uint32_t i = 0;
+
+        for (; i + 4 <= frames; i += 4)
+        {
+            // computed from the index every time, so that rounding errors do not accumulate
+            const __m128 g = _mm_add_ps(_mm_add_ps(start, steps),
+                                        _mm_mul_ps(blockStep, _mm_set1_ps(static_cast<float>(i / 4))));
+            _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_loadu_ps(src + i), g));
+        }
+
+        copyWithGainRampTail(dst, src, startGain, endGain, frames, i);
+    }
+
+    static void addWithGainSSE2(float* const dst, const float* const src, const float gain,
+                                const uint32_t frames) noexcept
+    {
+        const __m128 g = _mm_set1_ps(gain);
+        uint32_t i = 0;
+
+        for (; i + 4 <= frames; i += 4)
+            _mm_storeu_ps(dst + i, _mm_add_ps(_mm_loadu_ps(dst + i), _mm_mul_ps(_mm_loadu_ps(src + i), g)));
+
+        addWithGainScalar(dst + i, src + i, gain, frames - i);
+    }
+
+    static float getPeakSSE2(const float* const buffer, const uint32_t frames) noexcept
+    {
+        const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+        __m128 peak = _mm_setzero_ps();
+        uint32_t i = 0;
+
+        for (; i + 4 <= frames; i += 4)
+            peak = _mm_max_ps(peak, _mm_and_ps(_mm_loadu_ps(buffer + i), absMask));
+
+        float values[4];
+        _mm_storeu_ps(values, peak);
+        return std::max(reduceMax(values), getPeakScalar(buffer + i, frames - i));
+    }
+
+    static float getSumOfSquaresSSE2(const float* const buffer, const uint32_t frames) noexcept
+    {
+        __m128 sum = _mm_setzero_ps();
+        uint32_t i = 0;
+
+        for (; i + 4 <= frames; i += 4)
+        {
+            const __m128 v = _mm_loadu_ps(buffer + i);
+            sum = _mm_add_ps(sum, _mm_mul_ps(v, v));
+        }
+
+        float values[4];
+        _mm_storeu_ps(values, sum);
+        return reduceSum(values) + getSumOfSquaresScalar(buffer + i, frames - i);
+    }
+
+    static void getMinMaxSSE2(const float* const buffer, const uint32_t frames, float& min, float& max) noexcept
+    {
+        if (frames < 4)
+            return getMinMaxScalar(buffer, frames, min, max);
+
+        __m128 vmin = _mm_loadu_ps(buffer);
+        __m128 vmax = vmin;
+        uint32_t i = 4;
+
+        for (; i + 4 <= frames; i += 4)
+        {
+            const __m128 v = _mm_loadu_ps(buffer + i);
+            vmin = _mm_min_ps(vmin, v);
+            vmax = _mm_max_ps(vmax, v);
+        }
+
+        float mins[4], maxs[4];
+        _mm_storeu_ps(mins, vmin);
+        _mm_storeu_ps(maxs, vmax);
+        min = reduceMin(mins);
+        max = reduceMax(maxs);
+        getMinMaxTail(buffer, frames, i, min, max);
+    }
+#endif
+
+#if defined(DISTRHO_AUDIO_BUFFER_OPS_AVX2)
+    // -------------------------------------------------------------------
+    // AVX2 code, 8 floats at a time, only used if the CPU and OS support it
+
+    static bool hasAVX2() noexcept
+    {
+        uint32_t eax, ebx, ecx, edx;
+
+        // OS must support saving AVX registers, as reported by OSXSAVE and XCR0
+        if (__get_cpuid(1, &eax, &ebx, &ecx, &edx) == 0)
+            return false;
+        if ((ecx & (1u << 27)) == 0 || (ecx & (1u << 28)) == 0)
+            return false;
+
+        uint32_t xcr0, xcr0high;
+        __asm__ __volatile__("xgetbv" : "=a"(xcr0), "=d"(xcr0high) : "c"(0));
+
+        if ((xcr0 & 0x6) != 0x6)
+            return false;
+
+        if (__get_cpuid_max(0, nullptr) < 7)
+            return false;
+
+        __cpuid_count(7, 0, eax, ebx, ecx, edx);
+        return (ebx & (1u << 5)) != 0;
+    }
+
+    DISTRHO_AUDIO_BUFFER_OPS_AVX2_TARGET
+    static void copyWithGainAVX2(float* const dst, const float* const src, const float gain,
+                                 const uint32_t frames) noexcept
+    {
+        const __m256 g = _mm256_set1_ps(gain);
+        uint32_t i = 0;
+
+        for (; i + 8 <= frames; i += 8)
+            _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_loadu_ps(src + i), g));
+
+        copyWithGainScalar(dst + i, src + i, gain, frames - i);
+    }
+
+    DISTRHO_AUDIO_BUFFER_OPS_AVX2_TARGET
+    static void copyWithGainRampAVX2(float* const dst, const float* const src,
+                                     const float startGain, const float endGain, const uint32_t frames) noexcept
+    {
+        const float step = (endGain - startGain) / static_cast<float>(frames);
+        const __m256 start = _mm256_set1_ps(startGain);
+        const __m256 steps = _mm256_mul_ps(_mm256_set1_ps(step),
+                                           _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f));
+        const __m256 blockStep = _mm256_set1_ps(step * 8.0f);
+        uint32_t i = 0;
+
+        for (; i + 8 <= frames; i += 8)
+        {
+            const __m256 g = _mm256_add_ps(_mm256_add_ps(start, steps),
+                                           _mm256_mul_ps(blockStep, _mm256_set1_ps(static_cast<float>(i / 8))));
+            _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_loadu_ps(src + i), g));
+        }
+
+        copyWithGainRampTail(dst, src, startGain, endGain, frames, i);
+    }
+
+    DISTRHO_AUDIO_BUFFER_OPS_AVX2_TARGET
+    static void addWithGainAVX2(float* const dst, const float* const src, const float gain,
+                                const uint32_t frames) noexcept
+    {
+        const __m256 g = _mm256_set1_ps(gain);
+        uint32_t i = 0;
+
+        for (; i + 8 <= frames; i += 8)
+            _mm256_storeu_ps(dst + i, _mm256_add_ps(_mm256_loadu_ps(dst + i),
+                                                    _mm256_mul_ps(_mm256_loadu_ps(src + i), g)));
+
+        addWithGainScalar(dst + i, src + i, gain, frames - i);
+    }
+
+    DISTRHO_AUDIO_BUFFER_OPS_AVX2_TARGET
+    static float getPeakAVX2(const float* const buffer, const uint32_t frames) noexcept
+    {
+        const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+        __m256 peak = _mm256_setzero_ps();
+        uint32_t i = 0;
+
+        for (; i + 8 <= frames; i += 8)
+            peak = _mm256_max_ps(peak, _mm256_and_ps(_mm256_loadu_ps(buffer + i), absMask));
+
+        float values[8];
+        _mm256_storeu_ps(values, peak);
+        return std::max(reduceMax(values), getPeakScalar(buffer + i, frames - i));
+    }
+
+    DISTRHO_AUDIO_BUFFER_OPS_AVX2_TARGET
+    static float getSumOfSquaresAVX2(const float* const buffer, const uint32_t frames) noexcept
+    {
+        __m256 sum = _mm256_setzero_ps();
+        uint32_t i = 0;
+
+        for (; i + 8 <= frames; i += 8)
+        {
+            const __m256 v = _mm256_loadu_ps(buffer + i);
+            sum = _mm256_add_ps(sum, _mm256_mul_ps(v, v));
+        }
+
+        float values[8];
+        _mm256_storeu_ps(values, sum);
+        return reduceSum(values) + getSumOfSquaresScalar(buffer + i, frames - i);
+    }
+
+    DISTRHO_AUDIO_BUFFER_OPS_AVX2_TARGET
+    static void getMinMaxAVX2(const float* const buffer, const uint32_t frames, float& min, float& max) noexcept
+    {
+        if (frames < 8)
+            return getMinMaxScalar(buffer, frames, min, max);
+
+        __m256 vmin = _mm256_loadu_ps(buffer);
+        __m256 vmax = vmin;
+        uint32_t i = 8;
+
+        for (; i + 8 <= frames; i += 8)
+        {
+            const __m256 v = _mm256_loadu_ps(buffer + i);
+            vmin = _mm256_min_ps(vmin, v);
+            vmax = _mm256_max_ps(vmax, v);
+        }
+
+        float mins[8], maxs[8];
+        _mm256_storeu_ps(mins, vmin);
+        _mm256_storeu_ps(maxs, vmax);
+        min = reduceMin(mins);
+        max = reduceMax(maxs);
+        getMinMaxTail(buffer, frames, i, min, max);
+    }
+#endif
+
+#if defined(DISTRHO_AUDIO_BUFFER_OPS_NEON)
+    // -------------------------------------------------------------------
+    // NEON code, 4 floats at a time
+
+    static void copyWithGainNEON(float* const dst, const float* const src, const float gain,
+                                 const uint32_t frames) noexcept
+    {
+        const float32x4_t g = vdupq_n_f32(gain);
+        uint32_t i = 0;
+
+        for (; i + 4 <= frames; i += 4)
+            vst1q_f32(dst + i, vmulq_f32(vld1q_f32(src + i), g));
+
+        copyWithGainScalar(dst + i, src + i, gain, frames - i);
+    }
+
+    static void copyWithGainRampNEON(float* const dst, const float* const src,
+                                     const float startGain, const float endGain, const uint32_t frames) noexcept
+    {
+        static const float kIndexes[4] = { 0.0f, 1.0f, 2.0f, 3.0f };
+        const float step = (endGain - startGain) / static_cast<float>(frames);
+        const float32x4_t start = vaddq_f32(vdupq_n_f32(startGain), vmulq_n_f32(vld1q_f32(kIndexes), step));
+        const float blockStep = step * 4.0f;
+        uint32_t i = 0;
+
+        for (; i + 4 <= frames; i += 4)
+        {
+            const float32x4_t g = vaddq_f32(start, vdupq_n_f32(blockStep * static_cast<float>(i / 4)));
+            vst1q_f32(dst + i, vmulq_f32(vld1q_f32(src + i), g));
+        }
+
+        copyWithGainRampTail(dst, src, startGain, endGain, frames, i);
+    }
+
+    static void addWithGainNEON(float* const dst, const float* const src, const float gain,
+                                const uint32_t frames) noexcept
+    {
+        const float32x4_t g = vdupq_n_f32(gain);
+        uint32_t i = 0;
+
+        for (; i + 4 <= frames; i += 4)
+            vst1q_f32(dst + i, vmlaq_f32(vld1q_f32(dst + i), vld1q_f32(src + i), g));
+
+        addWithGainScalar(dst + i, src + i, gain, frames - i);
+    }
+
+    static float getPeakNEON(const float* const buffer, const uint32_t frames) noexcept
+    {
+        float32x4_t peak = vdupq_n_f32(0.0f);
+        uint32_t i = 0;
+
+        for (; i + 4 <= frames; i += 4)
+            peak = vmaxq_f32(peak, vabsq_f32(vld1q_f32(buffer + i)));
+
+        float values[4];
+        vst1q_f32(values, peak);
+        return std::max(reduceMax(values), getPeakScalar(buffer + i, frames - i));
+    }
+
+    static float getSumOfSquaresNEON(const float* const buffer, const uint32_t frames) noexcept
+    {
+        float32x4_t sum = vdupq_n_f32(0.0f);
+        uint32_t i = 0;
+
+        for (; i + 4 <= frames; i += 4)
+        {
+            const float32x4_t v = vld1q_f32(buffer + i);
+            sum = vmlaq_f32(sum, v, v);
+        }
+
+        float values[4];
+        vst1q_f32(values, sum);
+        return reduceSum(values) + getSumOfSquaresScalar(buffer + i, frames - i);
+    }
+
+    static void getMinMaxNEON(const float* const buffer, const uint32_t frames, float& min, float& max) noexcept
+    {
+        if (frames < 4)
+            return getMinMaxScalar(buffer, frames, min, max);
+
+        float32x4_t vmin = vld1q_f32(buffer);
+        float32x4_t vmax = vmin;
+        uint32_t i = 4;
+
+        for (; i + 4 <= frames; i += 4)
+        {
+            const float32x4_t v = vld1q_f32(buffer + i);
+            vmin = vminq_f32(vmin, v);
+            vmax = vmaxq_f32(vmax, v);
+        }
+
+        float mins[4], maxs[4];
+        vst1q_f32(mins, vmin);
+        vst1q_f32(maxs, vmax);
+        min = reduceMin(mins);
+        max = reduceMax(maxs);
+        getMinMaxTail(buffer, frames, i, min, max);
+    }
+#endif
+
+    DISTRHO_DECLARE_NON_COPYABLE(AudioBufferOps)
+    DISTRHO_PREVENT_HEAP_ALLOCATION
+};
+
+// -----------------------------------------------------------------------
+
+#undef DISTRHO_AUDIO_BUFFER_OPS_AVX2_TARGET
+#undef DISTRHO_AUDIO_BUFFER_OPS_AVX2
+#undef DISTRHO_AUDIO_BUFFER_OPS_NEON
+#undef DISTRHO_AUDIO_BUFFER_OPS_SSE2
+
+END_NAMESPACE_DISTRHO
+
+#endif // DISTRHO_AUDIO_BUFFER_OPS_HPP_INCLUDED
@@ -0,0 +1,326 @@
+/*
+ * DISTRHO Plugin Framework (DPF)
+ * Copyright (C) 2012-2021 Filipe Coelho <falktx@falktx.com>
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any purpose with
+ * or without fee is hereby granted, provided that the above copyright notice and this
+ * permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+ * TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+ * DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+ * IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef DISTRHO_MESSAGE_QUEUE_HPP_INCLUDED
+#define DISTRHO_MESSAGE_QUEUE_HPP_INCLUDED
+
+#include "AtomicOps.hpp"
+
+START_NAMESPACE_DISTRHO
+
+// -----------------------------------------------------------------------
+// MessageQueue common code
+
+/**
+   Atomic helpers and constants shared by all MessageQueue classes.
+ */
+class MessageQueueBase
+{
+protected:
+    /** Size used to keep producer and consumer data on separate cache lines. */
+    static const uint32_t kCacheLineSize = 64;
+
+    /** @internal load a value written by another thread, pairs with storeRelease(). */
+    static uint32_t loadAcquire(const uint32_t& value) noexcept
+    {
+        return AtomicOps::loadAcquire(value);
+    }
+
+    /** @internal store a value for another thread, after all data accesses before it. */
+    static void storeRelease(uint32_t& value, const uint32_t newValue) noexcept
+    {
+        AtomicOps::storeRelease(value, newValue);
+    }
+
+    /** @internal atomically replace @a value with @a newValue if it still matches @a expected. */
+    static bool compareAndSwap(uint32_t& value, const uint32_t expected, const uint32_t newValue) noexcept
+    {
+        return AtomicOps::compareAndSwap(value, expected, newValue);
+    }
+};
+
+// -----------------------------------------------------------------------
+// MessageQueue class, single producer and single consumer
+
+/**
+   Fixed-capacity queue of typed messages, for one producer thread and one consumer thread.
+
+   Both sides are wait-free, never allocate and never block,
+   so this can be used to send messages to or from the audio thread.@n
+   Messages are copied in and out, @a T should be a small trivially copyable type.@n
+   @a N is the maximum number of queued messages, it must be a power of 2.
+
+   Typical usage:
+   ```
+   // definition
+   MessageQueue<MidiEvent, 128> myQueue;
+
+   // producer side
+   if (! myQueue.push(event))
+   {
+       // queue is full, try again later
+   }
+
+   // consumer side, get up to 64 messages at once
+   MidiEvent events[64];
+   const uint32_t count = myQueue.popBatch(events, 64);
+   ```
+
+   @see MultiProducerMessageQueue
+ */
+template <typename T, uint32_t N>
+class MessageQueue : private MessageQueueBase
+{
+#ifdef DISTRHO_PROPER_CPP11_SUPPORT
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "MessageQueue size must be a power of 2");
+#endif
+
+public:
+    /*
+     * Constructor, creates an empty queue.
+     */
+    MessageQueue() noexcept
+        : fWriteIndex(0),
+          fCachedReadIndex(0),
+          fReadIndex(0),
+          fCachedWriteIndex(0) {}
+
+    // -------------------------------------------------------------------
+    // producer side
+
+    /*
+     * Add a message to the queue.
+     * Returns false if the queue is full.
+     */
+    bool push(const T& message) noexcept
+    {
+        const uint32_t writeIndex = fWriteIndex;
+
+        if (writeIndex - fCachedReadIndex == N)
+        {
+            fCachedReadIndex = loadAcquire(fReadIndex);
+
+            if (writeIndex - fCachedReadIndex == N)
+                return false;
+        }
+
+        fMessages[writeIndex & (N - 1)] = message;
+        storeRelease(fWriteIndex, writeIndex + 1);
+        return true;
+    }
+
+    // -------------------------------------------------------------------
+    // consumer side
+
+    /*
+     * Check if there are no messages to read.
+     */
+    bool isEmpty() const noexcept
+    {
+        return loadAcquire(fWriteIndex) == fReadIndex;
+    }
+
+    /*
+     * Take the oldest message from the queue.
+     * Returns false if the queue is empty.
+     */
+    bool pop(T& message) noexcept
+    {
+        return popBatch(&message, 1) == 1;
+    }
+
+    /*
+     * Take up to @a maxCount messages from the queue, in order.
+     * Returns the number of messages written into @a messages.
+     */
+    uint32_t popBatch(T* const messages, const uint32_t maxCount) noexcept
+    {
+        const uint32_t readIndex = fReadIndex;
+
+        if (fCachedWriteIndex == readIndex)
+        {
+            fCachedWriteIndex = loadAcquire(fWriteIndex);
+
+            if (fCachedWriteIndex == readIndex)
+                return 0;
+        }
+
+        const uint32_t available = fCachedWriteIndex - readIndex;
+        const uint32_t count = available < maxCount ? available : maxCount;
+
+        for (uint32_t i=0; i < count; ++i)
+            messages[i] = fMessages[(readIndex + i) & (N - 1)];
+
+        storeRelease(fReadIndex, readIndex + count);
+        return count;
+    }
+
+    // -------------------------------------------------------------------
+
+private:
+    // producer data
+    uint32_t fWriteIndex;
+    uint32_t fCachedReadIndex;
+    uint8_t  fPadding1[kCacheLineSize - 2 * sizeof(uint32_t)];
+
+    // consumer data
+    uint32_t fReadIndex;
+    uint32_t fCachedWriteIndex;
+    uint8_t  fPadding2[kCacheLineSize - 2 * sizeof(uint32_t)];
+
+    T fMessages[N];
+
+    DISTRHO_DECLARE_NON_COPYABLE(MessageQueue)
+};
+
+// -----------------------------------------------------------------------
+// MultiProducerMessageQueue class, multiple producers and single consumer
+
+/**
+   Fixed-capacity queue of typed messages, for many producer threads and one consumer thread.
+
+   Same as MessageQueue, except that push() can be called from several threads at the same time.@n
+   Producers are lock-free, a push() only retries when another producer claimed the same slot first.@n
+   The consumer side is wait-free and safe to use from the audio thread.
+
+   @see MessageQueue
+ */
+template <typename T, uint32_t N>
+class MultiProducerMessageQueue : private MessageQueueBase
+{
+#ifdef DISTRHO_PROPER_CPP11_SUPPORT
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "MultiProducerMessageQueue size must be a power of 2");
+#endif
+
+public:
+    /*
+     * Constructor, creates an empty queue.
+     */
+    MultiProducerMessageQueue() noexcept
+        : fWriteIndex(0),
+          fReadIndex(0)
+    {
+        for (uint32_t i=0; i < N; ++i)
+            fCells[i].sequence = i;
+    }
+
+    // -------------------------------------------------------------------
+    // producer side
+
+    /*
+     * Add a message to the queue, can be called from any thread.
+     * Returns false if the queue is full.
+     */
+    bool push(const T& message) noexcept
+    {
+        uint32_t writeIndex = loadAcquire(fWriteIndex);
+
+        for (;;)
+        {
+            Cell& cell(fCells[writeIndex & (N - 1)]);
+            const int32_t diff = static_cast<int32_t>(loadAcquire(cell.sequence) - writeIndex);
+
+            if (diff == 0)
+            {
+                // slot is free, try to claim it
+                if (compareAndSwap(fWriteIndex, writeIndex, writeIndex + 1))
+                {
+                    cell.message = message;
+                    storeRelease(cell.sequence, writeIndex + 1);
+                    return true;
+                }
+            }
+            else if (diff < 0)
+            {
+                // slot still holds an unread message
+                return false;
+            }
+
+            writeIndex = loadAcquire(fWriteIndex);
+        }
+    }
+
+    // -------------------------------------------------------------------
+    // consumer side
+
+    /*
+     * Check if there are no messages to read.
+     */
+    bool isEmpty() const noexcept
+    {
+        return loadAcquire(fCells[fReadIndex & (N - 1)].sequence) != fReadIndex + 1;
+    }
+
+    /*
+     * Take the oldest message from the queue.
+     * Returns false if the queue is empty.
+     */
+    bool pop(T& message) noexcept
+    {
+        return popBatch(&message, 1) == 1;
+    }
+
+    /*
+     * Take up to @a maxCount messages from the queue, in order.
+     * Returns the number of messages written into @a messages.
+     */
+    uint32_t popBatch(T* const messages, const uint32_t maxCount) noexcept
+    {
+        uint32_t readIndex = fReadIndex;
+        uint32_t count = 0;
+
+        for (; count < maxCount; ++count, ++readIndex)
+        {
+            Cell& cell(fCells[readIndex & (N - 1)]);
+
+            // stop at the first message that is not completely written yet
+            if (loadAcquire(cell.sequence) != readIndex + 1)
+                break;
+
+            messages[count] = cell.message;
+            storeRelease(cell.sequence, readIndex + N);
+        }
+
+        fReadIndex = readIndex;
+        return count;
+    }
+
+    // -------------------------------------------------------------------
+
+private:
+    struct Cell {
+        uint32_t sequence;
+        T message;
+    };
+
+    // shared by all producers
+    uint32_t fWriteIndex;
+    uint8_t  fPadding1[kCacheLineSize - sizeof(uint32_t)];
+
+    // consumer data
+    uint32_t fReadIndex;
+    uint8_t  fPadding2[kCacheLineSize - sizeof(uint32_t)];
+
+    Cell fCells[N];
+
+    DISTRHO_DECLARE_NON_COPYABLE(MultiProducerMessageQueue)
+};
+
+// -----------------------------------------------------------------------
+
+END_NAMESPACE_DISTRHO
+
+#endif // DISTRHO_MESSAGE_QUEUE_HPP_INCLUDED
@@ -29,6 +29,13 @@
 
 #include <pthread.h>
 
+#if defined(DISTRHO_OS_MAC)
+# include <mach/mach.h>
+#elif ! defined(DISTRHO_OS_WINDOWS)
+# include <cerrno>
+# include <semaphore.h>
+#endif
+
 START_NAMESPACE_DISTRHO
 
 class Signal;
@@ -261,6 +268,85 @@ private:
     DISTRHO_DECLARE_NON_COPYABLE(Signal)
 };
 
+// -----------------------------------------------------------------------
+// Semaphore class, unlike Signal it can be posted from a realtime thread
+
+class Semaphore
+{
+public:
+    /*
+     * Constructor.
+     */
+    Semaphore() noexcept
+#if defined(DISTRHO_OS_MAC)
+        : fSemaphore()
+    {
+        semaphore_create(mach_task_self(), &fSemaphore, SYNC_POLICY_FIFO, 0);
+    }
+#elif defined(DISTRHO_OS_WINDOWS)
+        : fSemaphore(::CreateSemaphoreA(nullptr, 0, LONG_MAX, nullptr)) {}
+#else
+        : fSemaphore()
+    {
+        sem_init(&fSemaphore, 0, 0);
+    }
+#endif
+
+    /*
+     * Destructor.
+     */
+    ~Semaphore() noexcept
+    {
+#if defined(DISTRHO_OS_MAC)
+        semaphore_destroy(mach_task_self(), fSemaphore);
+#elif defined(DISTRHO_OS_WINDOWS)
+        ::CloseHandle(fSemaphore);
+#else
+        sem_destroy(&fSemaphore);
+#endif
+    }
+
+    /*
+     * Wait until the semaphore is posted.
+     */
+    void wait() noexcept
+    {
+#if defined(DISTRHO_OS_MAC)
+        while (semaphore_wait(fSemaphore) == KERN_ABORTED) {}
+#elif defined(DISTRHO_OS_WINDOWS)
+        ::WaitForSingleObject(fSemaphore, INFINITE);
+#else
+        while (sem_wait(&fSemaphore) != 0 && errno == EINTR) {}
+#endif
+    }
+
+    /*
+     * Wake up one waiting thread, never blocks.
+     */
+    void post() noexcept
+    {
+#if defined(DISTRHO_OS_MAC)
+        semaphore_signal(fSemaphore);
+#elif defined(DISTRHO_OS_WINDOWS)
+        ::ReleaseSemaphore(fSemaphore, 1, nullptr);
+#else
+        sem_post(&fSemaphore);
+#endif
+    }
+
+private:
+#if defined(DISTRHO_OS_MAC)
+    semaphore_t fSemaphore;
+#elif defined(DISTRHO_OS_WINDOWS)
+    HANDLE fSemaphore;
+#else
+    sem_t fSemaphore;
+#endif
+
+    DISTRHO_PREVENT_HEAP_ALLOCATION
+    DISTRHO_DECLARE_NON_COPYABLE(Semaphore)
+};
+
 // -----------------------------------------------------------------------
 // Helper class to lock&unlock a mutex during a function scope.
 
@@ -0,0 +1,223 @@
+/*
+ * DISTRHO Plugin Framework (DPF)
+ * Copyright (C) 2012-2021 Filipe Coelho <falktx@falktx.com>
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any purpose with
+ * or without fee is hereby granted, provided that the above copyright notice and this
+ * permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+ * TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+ * DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+ * IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef DISTRHO_REALTIME_ARENA_HPP_INCLUDED
+#define DISTRHO_REALTIME_ARENA_HPP_INCLUDED
+
+#include "../DistrhoUtils.hpp"
+
+START_NAMESPACE_DISTRHO
+
+// -----------------------------------------------------------------------
+// RealtimeArena class
+
+/**
+   Scratch memory allocator for use inside the audio thread.
+
+   A single block of memory is allocated up-front, outside of run(), from which aligned pieces are handed out
+   by simply moving an offset forward.@n
+   There is no way to free individual pieces, instead all of them are released at once with reset(),
+   typically at the start of every run() call.@n
+   This makes allocations O(1), lock-free and keeps the scratch data of a single block close together in memory.
+
+   The arena must be (re)created when the amount of needed memory changes,
+   usually in activate() and bufferSizeChanged() based on getBufferSize() and getSampleRate().
+
+   Typical usage:
+   ```
+   // plugin members
+   RealtimeArena fArena;
+
+   // in activate() and bufferSizeChanged(), for 2 channels of float scratch audio
+   fArena.createBuffer(2 * RealtimeArena::getRequiredSize<float>(getBufferSize()));
+
+   // in run()
+   fArena.reset();
+
+   float* const tmpL = fArena.allocate<float>(frames);
+   float* const tmpR = fArena.allocate<float>(frames);
+   DISTRHO_SAFE_ASSERT_RETURN(tmpL != nullptr && tmpR != nullptr,);
+   ```
+
+   @note Memory is not initialized and no constructors are called, use it only for trivial types.
+ */
+class RealtimeArena
+{
+public:
+    /** Alignment used by default, enough for any SIMD float or double vector operation. */
+    static const std::size_t kDefaultAlignment = 32;
+
+    /** Maximum alignment allowed for allocations. */
+    static const std::size_t kMaxAlignment = 64;
+
+    /*
+     * Constructor, creates an empty arena.
+     */
+    RealtimeArena() noexcept
+        : fRawBuffer(nullptr),
+          fBuffer(nullptr),
+          fSize(0),
+          fOffset(0),
+          fPeakOffset(0) {}
+
+    /*
+     * Destructor.
+     */
+    ~RealtimeArena() noexcept
+    {
+        delete[] fRawBuffer;
+    }
+
+    // -------------------------------------------------------------------
+    // setup, must not be called during run()
+
+    /*
+     * Make sure the arena can hold at least @a size bytes, also resets it.
+     * Existing memory is kept if it is already big enough.
+     */
+    bool createBuffer(const std::size_t size) noexcept
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(size > 0, false);
+
+        fOffset = 0;
+
+        if (size <= fSize)
+            return true;
+
+        deleteBuffer();
+
+        try {
+            fRawBuffer = new uint8_t[size + kMaxAlignment - 1];
+        } DISTRHO_SAFE_EXCEPTION_RETURN("RealtimeArena::createBuffer", false);
+
+        fBuffer = fRawBuffer + getPadding(fRawBuffer, kMaxAlignment);
+        fSize   = size;
+        return true;
+    }
+
+    /*
+     * Delete the previously allocated memory.
+     */
+    void deleteBuffer() noexcept
+    {
+        delete[] fRawBuffer;
+        fRawBuffer = nullptr;
+        fBuffer = nullptr;
+        fSize = fOffset = fPeakOffset = 0;
+    }
+
+    /*
+     * Get the number of bytes needed to allocate @a count items of type @a T, including alignment padding.
+     * Useful for calculating the size passed to createBuffer().
+     */
+    template <typename T>
+    static std::size_t getRequiredSize(const std::size_t count, const std::size_t alignment = kDefaultAlignment) noexcept
+    {
+        return count * sizeof(T) + alignment - 1;
+    }
+
+    // -------------------------------------------------------------------
+    // realtime-safe calls
+
+    /*
+     * Release all previous allocations at once.
+     */
+    void reset() noexcept
+    {
+        fOffset = 0;
+    }
+
+    /*
+     * Allocate @a size bytes aligned to @a alignment, which must be a power of 2 not bigger than kMaxAlignment.
+     * Returns nullptr if the arena does not have enough free space.
+     */
+    void* allocate(const std::size_t size, const std::size_t alignment = kDefaultAlignment) noexcept
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(alignment != 0 && alignment <= kMaxAlignment, nullptr);
+        DISTRHO_SAFE_ASSERT_RETURN((alignment & (alignment - 1)) == 0, nullptr);
+
+        const std::size_t start = fOffset + getPadding(fBuffer + fOffset, alignment);
+
+        DISTRHO_SAFE_ASSERT_RETURN(start <= fSize && size <= fSize - start, nullptr);
+
+        fOffset = start + size;
+
+        if (fOffset > fPeakOffset)
+            fPeakOffset = fOffset;
+
+        return fBuffer + start;
+    }
+
+    /*
+     * Allocate an array of @a count items of type @a T.
+     * Returns nullptr if the arena does not have enough free space.
+     */
+    template <typename T>
+    T* allocate(const std::size_t count, const std::size_t alignment = kDefaultAlignment) noexcept
+    {
+        return static_cast<T*>(allocate(count * sizeof(T), alignment));
+    }
+
+    // -------------------------------------------------------------------
+    // information
+
+    /*
+     * Get the total size of the arena, in bytes.
+     */
+    std::size_t getSize() const noexcept
+    {
+        return fSize;
+    }
+
+    /*
+     * Get the number of bytes used since the last reset(), including alignment padding.
+     */
+    std::size_t getUsedSize() const noexcept
+    {
+        return fOffset;
+    }
+
+    /*
+     * Get the highest number of bytes ever used between resets, useful to tune the size given to createBuffer().
+     */
+    std::size_t getPeakUsedSize() const noexcept
+    {
+        return fPeakOffset;
+    }
+
+    // -------------------------------------------------------------------
+
+private:
+    uint8_t*    fRawBuffer;
+    uint8_t*    fBuffer;
+    std::size_t fSize;
+    std::size_t fOffset;
+    std::size_t fPeakOffset;
+
+    static std::size_t getPadding(const uint8_t* const ptr, const std::size_t alignment) noexcept
+    {
+        return (alignment - reinterpret_cast<uintptr_t>(ptr) % alignment) % alignment;
+    }
+
+    DISTRHO_PREVENT_HEAP_ALLOCATION
+    DISTRHO_DECLARE_NON_COPYABLE(RealtimeArena)
+};
+
+// -----------------------------------------------------------------------
+
+END_NAMESPACE_DISTRHO
+
+#endif // DISTRHO_REALTIME_ARENA_HPP_INCLUDED
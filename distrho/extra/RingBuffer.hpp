@@ -17,7 +17,7 @@
 #ifndef DISTRHO_RING_BUFFER_HPP_INCLUDED
 #define DISTRHO_RING_BUFFER_HPP_INCLUDED
 
-#include "../DistrhoUtils.hpp"
+#include "AtomicOps.hpp"
 
 START_NAMESPACE_DISTRHO
 
@@ -127,6 +127,20 @@ struct HugeStackBuffer {
 # define StackBuffer_INIT
 #endif
 
+/**
+   A region of ring buffer memory, as returned by RingBufferControl::reserveWrite() and RingBufferControl::peekRead().
+   When the region wraps around the end of the buffer it is split in two parts, otherwise @a size2 is 0.
+ */
+struct RingBufferSpan {
+    /** First part of the region. */
+    uint8_t* data1;
+    uint32_t size1;
+
+    /** Second part of the region, starting at the beginning of the buffer. */
+    uint8_t* data2;
+    uint32_t size2;
+};
+
 // -----------------------------------------------------------------------
 // RingBufferControl templated class
 
@@ -161,6 +175,27 @@ struct HugeStackBuffer {
    }
    ```
 
+   Big payloads can be written and read in place, without the extra copy:
+   ```
+   // writing data
+   RingBufferSpan span;
+   if (myHeapBuffer.reserveWrite(size, span))
+   {
+      // fill span.data1 with span.size1 bytes, then span.data2 with span.size2 bytes
+      myHeapBuffer.commitWrite();
+   }
+
+   // reading data
+   if (myHeapBuffer.peekRead(size, span))
+   {
+      // use span.data1 and span.data2
+      myHeapBuffer.consumeRead(size);
+   }
+   ```
+
+   The writer publishes data with release semantics and the reader acquires it before use,
+   so the buffer is safe to use across threads on weakly ordered CPUs too.
+
    @see HeapBuffer
  */
 template <class BufferStruct>
@@ -197,7 +232,7 @@ public:
     {
         DISTRHO_SAFE_ASSERT_RETURN(buffer != nullptr, false);
 
-        return (buffer->buf == nullptr || buffer->head == buffer->tail);
+        return (buffer->buf == nullptr || loadAcquire(buffer->head) == buffer->tail);
     }
 
     /*
@@ -207,9 +242,23 @@ public:
     {
         DISTRHO_SAFE_ASSERT_RETURN(buffer != nullptr, 0);
 
-        const uint32_t wrap((buffer->tail > buffer->wrtn) ? 0 : buffer->size);
+        const uint32_t tail(loadAcquire(buffer->tail));
+        const uint32_t wrap((tail > buffer->wrtn) ? 0 : buffer->size);
 
-        return wrap + buffer->tail - buffer->wrtn;
+        return wrap + tail - buffer->wrtn;
+    }
+
+    /*
+     * Get the size of the committed data that can be read right now.
+     */
+    uint32_t getReadableDataSize() const noexcept
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(buffer != nullptr, 0);
+
+        const uint32_t head(loadAcquire(buffer->head));
+        const uint32_t tail(buffer->tail);
+
+        return head >= tail ? head - tail : buffer->size + head - tail;
     }
 
     // -------------------------------------------------------------------
@@ -370,6 +419,60 @@ public:
         return false;
     }
 
+    /*!
+     * Get the next @a size bytes of data without copying or consuming them.
+     * The data stays valid until consumeRead() is called.
+     *
+     * Returns false if less than @a size bytes are available.
+     */
+    bool peekRead(const uint32_t size, RingBufferSpan& span) noexcept
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(buffer != nullptr, false);
+        DISTRHO_SAFE_ASSERT_RETURN(size > 0, false);
+        DISTRHO_SAFE_ASSERT_RETURN(size < buffer->size, false);
+
+        if (size > getReadableDataSize())
+            return false;
+
+        const uint32_t tail(buffer->tail);
+        const uint32_t firstpart(buffer->size - tail);
+
+        span.data1 = buffer->buf + tail;
+
+        if (size > firstpart)
+        {
+            span.size1 = firstpart;
+            span.data2 = buffer->buf;
+            span.size2 = size - firstpart;
+        }
+        else
+        {
+            span.size1 = size;
+            span.data2 = nullptr;
+            span.size2 = 0;
+        }
+
+        return true;
+    }
+
+    /*!
+     * Mark @a size bytes of data as read, usually after a successful peekRead().
+     */
+    bool consumeRead(const uint32_t size) noexcept
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(buffer != nullptr, false);
+        DISTRHO_SAFE_ASSERT_RETURN(size > 0, false);
+        DISTRHO_SAFE_ASSERT_UINT2_RETURN(size <= getReadableDataSize(), size, getReadableDataSize(), false);
+
+        uint32_t readto(buffer->tail + size);
+
+        if (readto >= buffer->size)
+            readto -= buffer->size;
+
+        storeRelease(buffer->tail, readto);
+        return true;
+    }
+
     // -------------------------------------------------------------------
     // write operations
 
@@ -475,6 +578,59 @@ public:
         return tryWrite(&type, sizeof(T));
     }
 
+    /*!
+     * Reserve space for @a size bytes of data, to be written in place.
+     * The reserved space becomes readable on the next commitWrite(), like regular write operations.
+     *
+     * Returns false if there is not enough space, in which case the next commitWrite() will fail.
+     */
+    bool reserveWrite(const uint32_t size, RingBufferSpan& span) noexcept
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(buffer != nullptr, false);
+        DISTRHO_SAFE_ASSERT_RETURN(size > 0, false);
+        DISTRHO_SAFE_ASSERT_UINT2_RETURN(size < buffer->size, size, buffer->size, false);
+
+        const uint32_t tail(loadAcquire(buffer->tail));
+        const uint32_t wrtn(buffer->wrtn);
+        const uint32_t wrap((tail > wrtn) ? 0 : buffer->size);
+
+        if (size >= wrap + tail - wrtn)
+        {
+            if (! errorWriting)
+            {
+                errorWriting = true;
+                d_stderr2("RingBuffer::reserveWrite(%lu): failed, not enough space", (ulong)size);
+            }
+            buffer->invalidateCommit = true;
+            return false;
+        }
+
+        const uint32_t firstpart(buffer->size - wrtn);
+        uint32_t writeto(wrtn + size);
+
+        span.data1 = buffer->buf + wrtn;
+
+        if (size > firstpart)
+        {
+            span.size1 = firstpart;
+            span.data2 = buffer->buf;
+            span.size2 = size - firstpart;
+            writeto -= buffer->size;
+        }
+        else
+        {
+            span.size1 = size;
+            span.data2 = nullptr;
+            span.size2 = 0;
+
+            if (writeto == buffer->size)
+                writeto = 0;
+        }
+
+        buffer->wrtn = writeto;
+        return true;
+    }
+
     // -------------------------------------------------------------------
 
     /*!
@@ -495,8 +651,8 @@ public:
         // nothing to commit?
         DISTRHO_SAFE_ASSERT_RETURN(buffer->head != buffer->wrtn, false);
 
-        // all ok
-        buffer->head = buffer->wrtn;
+        // all ok, make written data visible to the reader
+        storeRelease(buffer->head, buffer->wrtn);
         errorWriting = false;
         return true;
     }
@@ -519,6 +675,18 @@ public:
     // -------------------------------------------------------------------
 
 protected:
+    /** @internal load a position written by the other side, pairs with storeRelease(). */
+    static uint32_t loadAcquire(const uint32_t& value) noexcept
+    {
+        return AtomicOps::loadAcquire(value);
+    }
+
+    /** @internal store a position for the other side, after all data accesses before it. */
+    static void storeRelease(uint32_t& value, const uint32_t newValue) noexcept
+    {
+        AtomicOps::storeRelease(value, newValue);
+    }
+
     /** @internal try reading from the buffer, can fail. */
     bool tryRead(void* const buf, const uint32_t size) noexcept
     {
@@ -535,14 +703,15 @@ protected:
         DISTRHO_SAFE_ASSERT_RETURN(size > 0, false);
         DISTRHO_SAFE_ASSERT_RETURN(size < buffer->size, false);
 
+        const uint32_t head(loadAcquire(buffer->head));
+        const uint32_t tail(buffer->tail);
+
         // empty
-        if (buffer->head == buffer->tail)
+        if (head == tail)
             return false;
 
         uint8_t* const bytebuf(static_cast<uint8_t*>(buf));
 
-        const uint32_t head(buffer->head);
-        const uint32_t tail(buffer->tail);
         const uint32_t wrap((head > tail) ? 0 : buffer->size);
 
         if (size > wrap + head - tail)
@@ -580,7 +749,8 @@ protected:
                 readto = 0;
         }
 
-        buffer->tail = readto;
+        // done with the data, let the writer reuse this space
+        storeRelease(buffer->tail, readto);
         errorReading = false;
         return true;
     }
@@ -595,7 +765,7 @@ protected:
 
         const uint8_t* const bytebuf(static_cast<const uint8_t*>(buf));
 
-        const uint32_t tail(buffer->tail);
+        const uint32_t tail(loadAcquire(buffer->tail));
         const uint32_t wrtn(buffer->wrtn);
         const uint32_t wrap((tail > wrtn) ? 0 : buffer->size);
 
@@ -656,13 +826,13 @@ private:
 template <class BufferStruct>
 inline bool RingBufferControl<BufferStruct>::isDataAvailableForReading() const noexcept
 {
-    return (buffer != nullptr && buffer->head != buffer->tail);
+    return (buffer != nullptr && loadAcquire(buffer->head) != buffer->tail);
 }
 
 template <>
 inline bool RingBufferControl<HeapBuffer>::isDataAvailableForReading() const noexcept
 {
-    return (buffer != nullptr && buffer->buf != nullptr && buffer->head != buffer->tail);
+    return (buffer != nullptr && buffer->buf != nullptr && loadAcquire(buffer->head) != buffer->tail);
 }
 
 // -----------------------------------------------------------------------
@@ -0,0 +1,155 @@
+/*
+ * DISTRHO Plugin Framework (DPF)
+ * Copyright (C) 2012-2021 Filipe Coelho <falktx@falktx.com>
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any purpose with
+ * or without fee is hereby granted, provided that the above copyright notice and this
+ * permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+ * TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+ * DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+ * IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef DISTRHO_SCOPED_DENORMAL_DISABLE_HPP_INCLUDED
+#define DISTRHO_SCOPED_DENORMAL_DISABLE_HPP_INCLUDED
+
+#include "../DistrhoUtils.hpp"
+
+#if defined(__SSE2_MATH__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+# define DISTRHO_DENORMAL_USE_SSE
+# include <xmmintrin.h>
+#elif defined(__aarch64__) && (defined(__GNUC__) || defined(__clang__))
+# define DISTRHO_DENORMAL_USE_FPCR
+#elif defined(__arm__) && defined(__ARM_FP) && (defined(__GNUC__) || defined(__clang__))
+# define DISTRHO_DENORMAL_USE_FPSCR
+#endif
+
+START_NAMESPACE_DISTRHO
+
+// -----------------------------------------------------------------------
+// ScopedDenormalDisable class definition
+
+/**
+   ScopedDenormalDisable is a handy class for making the CPU treat denormal floats as zero during a scope of code,
+   reverting back to the previous floating-point state on destructor.
+
+   Denormals are very small numbers that show up in decaying signals, like filter and reverb tails.
+   Many CPUs process them a lot slower than regular numbers, causing sudden spikes in CPU usage.
+
+   This sets flush-to-zero and denormals-are-zero on x86 SSE, and flush-to-zero on ARM.
+   On other systems this class does nothing.
+
+   DPF already uses this around the plugin run() call, unless DISTRHO_PLUGIN_FLUSH_DENORMALS is disabled.
+   It can be useful for other realtime threads owned by the plugin, for example:
+
+   ```
+      void MyThread::run()
+      {
+          // denormals are flushed to zero during this scope
+          const ScopedDenormalDisable sdd;
+
+          processSomething();
+      }
+   ```
+ */
+class ScopedDenormalDisable {
+public:
+    /*
+     * Constructor.
+     * Current floating-point state is saved, with denormal flushing enabled.
+     */
+    inline ScopedDenormalDisable() noexcept;
+
+    /*
+     * Destructor.
+     * Floating-point state reverts back to the one saved during constructor.
+     */
+    inline ~ScopedDenormalDisable() noexcept;
+
+private:
+#if defined(DISTRHO_DENORMAL_USE_SSE)
+    const uint32_t oldstate;
+    static const uint32_t kFlags = 0x8040; // FTZ | DAZ
+#elif defined(DISTRHO_DENORMAL_USE_FPCR)
+    const uint64_t oldstate;
+    static const uint64_t kFlags = 1 << 24; // FZ
+#elif defined(DISTRHO_DENORMAL_USE_FPSCR)
+    const uint32_t oldstate;
+    static const uint32_t kFlags = 1 << 24; // FZ
+#endif
+
+#if defined(DISTRHO_DENORMAL_USE_FPCR)
+    static uint64_t getState() noexcept
+    {
+        uint64_t state;
+        __asm__ __volatile__("mrs %0, fpcr" : "=r"(state));
+        return state;
+    }
+
+    static void setState(const uint64_t state) noexcept
+    {
+        __asm__ __volatile__("msr fpcr, %0" : : "r"(state));
+    }
+#elif defined(DISTRHO_DENORMAL_USE_FPSCR)
+    static uint32_t getState() noexcept
+    {
+        uint32_t state;
+        __asm__ __volatile__("vmrs %0, fpscr" : "=r"(state));
+        return state;
+    }
+
+    static void setState(const uint32_t state) noexcept
+    {
+        __asm__ __volatile__("vmsr fpscr, %0" : : "r"(state));
+    }
+#elif defined(DISTRHO_DENORMAL_USE_SSE)
+    static uint32_t getState() noexcept
+    {
+        return _mm_getcsr();
+    }
+
+    static void setState(const uint32_t state) noexcept
+    {
+        _mm_setcsr(state);
+    }
+#endif
+
+    DISTRHO_DECLARE_NON_COPYABLE(ScopedDenormalDisable)
+    DISTRHO_PREVENT_HEAP_ALLOCATION
+};
+
+// -----------------------------------------------------------------------
+// ScopedDenormalDisable class implementation
+
+#if defined(DISTRHO_DENORMAL_USE_SSE) || defined(DISTRHO_DENORMAL_USE_FPCR) || defined(DISTRHO_DENORMAL_USE_FPSCR)
+inline ScopedDenormalDisable::ScopedDenormalDisable() noexcept
+    : oldstate(getState())
+{
+    // writing the control register can be slow, skip it if the host already did the same
+    if ((oldstate & kFlags) != kFlags)
+        setState(oldstate | kFlags);
+}
+
+inline ScopedDenormalDisable::~ScopedDenormalDisable() noexcept
+{
+    if ((oldstate & kFlags) != kFlags)
+        setState(oldstate);
+}
+#else
+inline ScopedDenormalDisable::ScopedDenormalDisable() noexcept {}
+inline ScopedDenormalDisable::~ScopedDenormalDisable() noexcept {}
+#endif
+
+// -----------------------------------------------------------------------
+
+#undef DISTRHO_DENORMAL_USE_FPSCR
+#undef DISTRHO_DENORMAL_USE_FPCR
+#undef DISTRHO_DENORMAL_USE_SSE
+
+END_NAMESPACE_DISTRHO
+
+#endif // DISTRHO_SCOPED_DENORMAL_DISABLE_HPP_INCLUDED
@@ -16,6 +16,10 @@
 
 #include "DistrhoPluginInternal.hpp"
 
+#if DISTRHO_PLUGIN_CHECK_RT_ALLOCATIONS
+# include <new>
+#endif
+
 START_NAMESPACE_DISTRHO
 
 /* ------------------------------------------------------------------------------------------------------------
@@ -24,6 +28,11 @@ START_NAMESPACE_DISTRHO
 uint32_t d_lastBufferSize = 0;
 double   d_lastSampleRate = 0.0;
 bool     d_lastCanRequestParameterValueChanges = false;
+uint32_t d_lastBlockSizeHints = 0x0;
+
+#if DISTRHO_PLUGIN_CHECK_RT_ALLOCATIONS
+__thread bool d_isInsideRun = false;
+#endif
 
 /* ------------------------------------------------------------------------------------------------------------
  * Static fallback data, see DistrhoPluginInternal.hpp */
@@ -48,6 +57,17 @@ Plugin::Plugin(uint32_t parameterCount, uint32_t programCount, uint32_t stateCou
     {
         pData->parameterCount = parameterCount;
         pData->parameters     = new Parameter[parameterCount];
+
+        pData->changedOutputParameters.init(parameterCount);
+        pData->changedTriggerParameters.init(parameterCount);
+
+#if DISTRHO_PLUGIN_WANT_PARAMETER_EVENTS
+        // enough for one change per parameter plus one per MIDI event (for MIDI CC mapped parameters)
+        pData->parameterEventCapacity = parameterCount + DISTRHO_PLUGIN_MIDI_EVENT_CAPACITY;
+        pData->parameterEvents        = new ParameterEvent[pData->parameterEventCapacity];
+        pData->parameterEventQueued   = new uint32_t[parameterCount];
+        std::memset(pData->parameterEventQueued, 0, sizeof(uint32_t)*parameterCount);
+#endif
     }
 
 #if DISTRHO_PLUGIN_WANT_PROGRAMS
@@ -60,6 +80,14 @@ Plugin::Plugin(uint32_t parameterCount, uint32_t programCount, uint32_t stateCou
     DISTRHO_SAFE_ASSERT(programCount == 0);
 #endif
 
+#if DISTRHO_PLUGIN_WANT_MIDI_INPUT
+    pData->midiEventCapacity = DISTRHO_PLUGIN_MIDI_EVENT_CAPACITY;
+    pData->midiEvents        = new MidiEvent[DISTRHO_PLUGIN_MIDI_EVENT_CAPACITY];
+# if DISTRHO_PLUGIN_MAX_SUBBLOCK_SIZE > 0 || DISTRHO_PLUGIN_WANT_DOUBLE_PRECISION
+    pData->subBlockMidiEvents = new MidiEvent[DISTRHO_PLUGIN_MIDI_EVENT_CAPACITY];
+# endif
+#endif
+
 #if DISTRHO_PLUGIN_WANT_STATE
     if (stateCount > 0)
     {
@@ -85,11 +113,31 @@ uint32_t Plugin::getBufferSize() const noexcept
     return pData->bufferSize;
 }
 
+bool Plugin::isFixedBlockSize() const noexcept
+{
+    return (pData->blockSizeHints & kBlockSizeIsFixed) != 0;
+}
+
+bool Plugin::isPowerOf2BlockSize() const noexcept
+{
+    return (pData->blockSizeHints & kBlockSizeIsPowerOf2) != 0;
+}
+
+bool Plugin::isCoarseBlockSize() const noexcept
+{
+    return (pData->blockSizeHints & kBlockSizeIsCoarse) != 0;
+}
+
 double Plugin::getSampleRate() const noexcept
 {
     return pData->sampleRate;
 }
 
+bool Plugin::isOfflineRendering() const noexcept
+{
+    return pData->isOfflineRendering;
+}
+
 #if DISTRHO_PLUGIN_WANT_TIMEPOS
 const TimePosition& Plugin::getTimePosition() const noexcept
 {
@@ -97,11 +145,30 @@ const TimePosition& Plugin::getTimePosition() const noexcept
 }
 #endif
 
+#if DISTRHO_PLUGIN_WANT_MIDI_INPUT
+uint32_t Plugin::getDroppedMidiEventCount() const noexcept
+{
+    return pData->droppedMidiEventCount;
+}
+#endif
+
+#if DISTRHO_PLUGIN_WANT_PARAMETER_EVENTS
+uint32_t Plugin::getDroppedParameterEventCount() const noexcept
+{
+    return pData->droppedParameterEventCount;
+}
+#endif
+
 #if DISTRHO_PLUGIN_WANT_LATENCY
 void Plugin::setLatency(uint32_t frames) noexcept
 {
     pData->latency = frames;
 }
+
+void Plugin::setMaxLatency(uint32_t frames) noexcept
+{
+    pData->maxLatency = frames;
+}
 #endif
 
 #if DISTRHO_PLUGIN_WANT_MIDI_OUTPUT
@@ -111,6 +178,15 @@ bool Plugin::writeMidiEvent(const MidiEvent& midiEvent) noexcept
 }
 #endif
 
+#if DISTRHO_PLUGIN_WANT_OUTPUT_PARAMETER_CHANGES
+void Plugin::setOutputParameterChanged(const uint32_t index) noexcept
+{
+    DISTRHO_SAFE_ASSERT_RETURN(index < pData->parameterCount,);
+
+    pData->changedOutputParameters.set(index);
+}
+#endif
+
 #if DISTRHO_PLUGIN_WANT_PARAMETER_VALUE_CHANGE_REQUEST
 bool Plugin::canRequestParameterValueChanges() const noexcept
 {
@@ -123,6 +199,39 @@ bool Plugin::requestParameterValueChange(const uint32_t index, const float value
 }
 #endif
 
+#if DISTRHO_PLUGIN_WANT_WORKER
+bool Plugin::scheduleWork(const void* const data, const uint32_t size) noexcept
+{
+    DISTRHO_SAFE_ASSERT_RETURN(data != nullptr, false);
+    DISTRHO_SAFE_ASSERT_RETURN(size != 0, false);
+
+    return pData->scheduleWorkCallback(data, size);
+}
+
+bool Plugin::writeWorkResponse(const void* const data, const uint32_t size) noexcept
+{
+    DISTRHO_SAFE_ASSERT_RETURN(data != nullptr, false);
+    DISTRHO_SAFE_ASSERT_RETURN(size != 0, false);
+
+    return pData->writeWorkResponseCallback(data, size);
+}
+#endif
+
+#if DISTRHO_PLUGIN_WANT_THREAD_POOL
+void Plugin::runParallelTasks(const uint32_t taskCount)
+{
+    if (taskCount == 0)
+        return;
+
+    // the host returns once all tasks are done
+    if (pData->requestParallelTasksCallback(taskCount))
+        return;
+
+    for (uint32_t i=0; i < taskCount; ++i)
+        runParallelTask(i);
+}
+#endif
+
 /* ------------------------------------------------------------------------------------------------------------
  * Init */
 
@@ -154,7 +263,70 @@ void Plugin::initPortGroup(const uint32_t groupId, PortGroup& portGroup)
 
 void Plugin::bufferSizeChanged(uint32_t) {}
 void Plugin::sampleRateChanged(double)   {}
+void Plugin::renderModeChanged(bool)     {}
+
+#if DISTRHO_PLUGIN_WANT_WORKER
+void Plugin::workResponse(const void*, uint32_t) {}
+#endif
 
 // -----------------------------------------------------------------------------------------------------------
 
 END_NAMESPACE_DISTRHO
+
+#if DISTRHO_PLUGIN_CHECK_RT_ALLOCATIONS
+/* ------------------------------------------------------------------------------------------------------------
+ * Debug heap allocation check, see DistrhoPluginInternal.hpp
+ * All operator new and delete variants used by DPF are replaced together, so memory always goes back to the
+ * allocator that gave it out, whatever the host does with its own operators. */
+
+# ifndef DISTRHO_PLUGIN_TARGET_JACK
+// hidden, so that plugin and wrapper code binds to these instead of the host's operators, and the host is left alone
+#  ifdef __LP64__
+__asm__(".hidden _Znwm\n.hidden _Znam\n.hidden _ZdlPv\n.hidden _ZdaPv\n.hidden _ZdlPvm\n.hidden _ZdaPvm");
+#  else
+__asm__(".hidden _Znwj\n.hidden _Znaj\n.hidden _ZdlPv\n.hidden _ZdaPv\n.hidden _ZdlPvj\n.hidden _ZdaPvj");
+#  endif
+# endif
+
+static void* d_checkedNew(const std::size_t size)
+{
+    if (DISTRHO_NAMESPACE::d_isInsideRun)
+        d_stderr2("assertion failure: heap allocation of %lu bytes during run()", static_cast<ulong>(size));
+
+    if (void* const ptr = std::malloc(size != 0 ? size : 1))
+        return ptr;
+
+    throw std::bad_alloc();
+}
+
+void* operator new(const std::size_t size)
+{
+    return d_checkedNew(size);
+}
+
+void* operator new[](const std::size_t size)
+{
+    return d_checkedNew(size);
+}
+
+void operator delete(void* const ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void* const ptr) noexcept
+{
+    std::free(ptr);
+}
+
+// sized variants, used instead of the ones above by code built as C++14 or later
+void operator delete(void* const ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void* const ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+#endif
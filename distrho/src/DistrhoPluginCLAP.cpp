@@ -0,0 +1,1251 @@
+/*
+ * DISTRHO Plugin Framework (DPF)
+ * Copyright (C) 2012-2021 Filipe Coelho <falktx@falktx.com>
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any purpose with
+ * or without fee is hereby granted, provided that the above copyright notice and this
+ * permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+ * TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+ * DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+ * IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include "DistrhoPluginInternal.hpp"
+#include "../extra/ScopedPointer.hpp"
+
+#include "clap/entry.h"
+#include "clap/ext/audio-ports.h"
+#include "clap/ext/latency.h"
+#include "clap/ext/note-ports.h"
+#include "clap/ext/params.h"
+#include "clap/ext/render.h"
+#include "clap/ext/tail.h"
+#include "clap/ext/thread-pool.h"
+
+START_NAMESPACE_DISTRHO
+
+#if ! DISTRHO_PLUGIN_WANT_MIDI_OUTPUT
+static const writeMidiFunc writeMidiCallback = nullptr;
+#endif
+#if ! DISTRHO_PLUGIN_WANT_PARAMETER_VALUE_CHANGE_REQUEST
+static const requestParameterValueChangeFunc requestParameterValueChangeCallback = nullptr;
+#endif
+#if ! DISTRHO_PLUGIN_WANT_THREAD_POOL
+static const requestParallelTasksFunc requestParallelTasksCallback = nullptr;
+#endif
+
+// -----------------------------------------------------------------------
+
+static void strncpy(char* const dst, const char* const src, const size_t size)
+{
+    DISTRHO_SAFE_ASSERT_RETURN(size > 0,);
+
+    if (const size_t len = std::min(std::strlen(src), size-1U))
+    {
+        std::memcpy(dst, src, len);
+        dst[len] = '\0';
+    }
+    else
+    {
+        dst[0] = '\0';
+    }
+}
+
+// -----------------------------------------------------------------------
+// PluginCLAP, a single plugin instance
+//
+// CLAP parameters use plain values, so the ranges given to the host are the DPF ones.
+// Parameter and note events come interleaved and sorted by time inside a single list,
+// the block is split at each parameter change unless the plugin handles parameter events by itself.
+
+class PluginCLAP
+{
+public:
+    PluginCLAP(const clap_host_t* const host)
+        : fPlugin(this, writeMidiCallback, requestParameterValueChangeCallback, nullptr, requestParallelTasksCallback),
+          fHost(host),
+#if DISTRHO_PLUGIN_WANT_THREAD_POOL
+          fHostThreadPool(nullptr),
+#endif
+          fDummyBuffer(nullptr),
+          fDummyBufferSize(0),
+          fFrameOffset(0),
+          fOutputEvents(nullptr),
+          fOfflineRendering(false)
+#if DISTRHO_PLUGIN_WANT_LATENCY
+        , fLastKnownLatency(0)
+#endif
+    {
+    }
+
+    ~PluginCLAP()
+    {
+        delete[] fDummyBuffer;
+    }
+
+    // ----------------------------------------------------------------------------------------------------------------
+    // clap_plugin interface calls
+
+    bool init()
+    {
+        // host extensions can only be queried from here on
+#if DISTRHO_PLUGIN_WANT_THREAD_POOL
+        fHostThreadPool = (const clap_host_thread_pool_t*)fHost->get_extension(fHost, CLAP_EXT_THREAD_POOL);
+#endif
+        return true;
+    }
+
+    bool activate(const double sampleRate, const uint32_t maxFrames)
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(sampleRate > 0.0, false);
+        DISTRHO_SAFE_ASSERT_RETURN(maxFrames > 0, false);
+
+        fPlugin.setSampleRate(sampleRate, true);
+        fPlugin.setBufferSize(maxFrames, true);
+
+        // silence for missing inputs, followed by scratch space for missing outputs
+        if (fDummyBufferSize < maxFrames)
+        {
+            delete[] fDummyBuffer;
+            fDummyBuffer = new double[maxFrames * 2];
+            fDummyBufferSize = maxFrames;
+        }
+
+        std::memset(fDummyBuffer, 0, sizeof(double) * maxFrames);
+
+        fPlugin.activate();
+#if DISTRHO_PLUGIN_WANT_LATENCY
+        fLastKnownLatency = fPlugin.getLatency();
+#endif
+        return true;
+    }
+
+    void deactivate()
+    {
+        fPlugin.deactivateIfNeeded();
+    }
+
+    // called from the audio thread, pools and buffers keep their current size
+    void reset()
+    {
+        if (! fPlugin.isActive())
+            return;
+
+        fPlugin.reset();
+    }
+
+    clap_process_status process(const clap_process_t* const process)
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(process != nullptr, CLAP_PROCESS_ERROR);
+        DISTRHO_SAFE_ASSERT_RETURN(fPlugin.isActive(), CLAP_PROCESS_ERROR);
+        DISTRHO_SAFE_ASSERT_RETURN(fDummyBuffer != nullptr, CLAP_PROCESS_ERROR);
+
+        const uint32_t frames = process->frames_count;
+        DISTRHO_SAFE_ASSERT_UINT2_RETURN(frames <= fDummyBufferSize, frames, fDummyBufferSize, CLAP_PROCESS_ERROR);
+
+        const clap_input_events_t* const inEvents = process->in_events;
+        const uint32_t eventCount = inEvents != nullptr ? inEvents->size(inEvents) : 0;
+
+        // parameter flush, or nothing else to do
+        if (frames == 0)
+        {
+            flush(inEvents, process->out_events);
+            return CLAP_PROCESS_CONTINUE;
+        }
+
+        fPlugin.setOfflineRendering(fOfflineRendering);
+
+#if DISTRHO_PLUGIN_WANT_TIMEPOS
+        updateTimePosition(process->transport);
+#endif
+
+        fOutputEvents = process->out_events;
+
+#if DISTRHO_PLUGIN_WANT_DOUBLE_PRECISION
+        if (usesDoublePrecision(process))
+            processAudio<double>(process, frames, eventCount);
+        else
+#endif
+        processAudio<float>(process, frames, eventCount);
+
+        fOutputEvents = nullptr;
+
+        writeOutputParameters(process->out_events, frames - 1);
+
+#if DISTRHO_PLUGIN_WANT_LATENCY
+        // a new latency value needs the plugin to be re-activated
+        const uint32_t latency = fPlugin.getLatency();
+
+        if (fLastKnownLatency != latency)
+        {
+            fLastKnownLatency = latency;
+            fHost->request_restart(fHost);
+        }
+#endif
+
+#if DISTRHO_PLUGIN_NUM_INPUTS > 0
+        // the tail has run out after silent input, nothing to do until new input or events arrive
+        if (fPlugin.areOutputsSilent())
+            return CLAP_PROCESS_SLEEP;
+#endif
+
+        return CLAP_PROCESS_CONTINUE;
+    }
+
+    // ----------------------------------------------------------------------------------------------------------------
+    // clap_plugin_params interface calls
+
+    uint32_t getParameterCount() const noexcept
+    {
+        return fPlugin.getParameterCount();
+    }
+
+    bool getParameterInfo(const uint32_t index, clap_param_info_t* const info) const
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(info != nullptr, false);
+        DISTRHO_SAFE_ASSERT_RETURN(index < fPlugin.getParameterCount(), false);
+
+        const uint32_t hints = fPlugin.getParameterHints(index);
+        const ParameterRanges& ranges(fPlugin.getParameterRanges(index));
+
+        std::memset(info, 0, sizeof(clap_param_info_t));
+        info->id = index;
+        info->min_value = ranges.min;
+        info->max_value = ranges.max;
+        info->default_value = ranges.def;
+
+        if (hints & (kParameterIsBoolean|kParameterIsInteger))
+            info->flags |= CLAP_PARAM_IS_STEPPED;
+
+        if (hints & kParameterIsOutput)
+            info->flags |= CLAP_PARAM_IS_READONLY;
+        else if (hints & kParameterIsAutomable)
+            info->flags |= CLAP_PARAM_IS_AUTOMATABLE;
+
+        if (fPlugin.getParameterDesignation(index) == kParameterDesignationBypass)
+            info->flags |= CLAP_PARAM_IS_BYPASS;
+
+        DISTRHO_NAMESPACE::strncpy(info->name, fPlugin.getParameterName(index), CLAP_NAME_SIZE);
+        return true;
+    }
+
+    bool getParameterValue(const clap_id index, double* const value) const
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(value != nullptr, false);
+        DISTRHO_SAFE_ASSERT_RETURN(index < fPlugin.getParameterCount(), false);
+
+        *value = fPlugin.getParameterValue(index);
+        return true;
+    }
+
+    bool getParameterStringForValue(const clap_id index, const double value, char* const output, const uint32_t size) const
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(output != nullptr && size != 0, false);
+        DISTRHO_SAFE_ASSERT_RETURN(index < fPlugin.getParameterCount(), false);
+
+        const ParameterEnumerationValues& enumValues(fPlugin.getParameterEnumValues(index));
+
+        for (uint8_t i=0; i < enumValues.count; ++i)
+        {
+            if (d_isEqual(static_cast<double>(enumValues.values[i].value), value))
+            {
+                DISTRHO_NAMESPACE::strncpy(output, enumValues.values[i].label.buffer(), size);
+                return true;
+            }
+        }
+
+        String text;
+
+        if (fPlugin.getParameterHints(index) & kParameterIsInteger)
+            text = String(static_cast<int>(std::round(value)));
+        else
+            text = String(static_cast<float>(value));
+
+        if (const char* const unit = fPlugin.getParameterUnit(index))
+        {
+            if (unit[0] != '\0')
+            {
+                text += " ";
+                text += unit;
+            }
+        }
+
+        DISTRHO_NAMESPACE::strncpy(output, text.buffer(), size);
+        return true;
+    }
+
+    bool getParameterValueForString(const clap_id index, const char* const input, double* const output) const
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(input != nullptr && output != nullptr, false);
+        DISTRHO_SAFE_ASSERT_RETURN(index < fPlugin.getParameterCount(), false);
+
+        const ParameterEnumerationValues& enumValues(fPlugin.getParameterEnumValues(index));
+
+        for (uint8_t i=0; i < enumValues.count; ++i)
+        {
+            if (enumValues.values[i].label == input)
+            {
+                *output = enumValues.values[i].value;
+                return true;
+            }
+        }
+
+        *output = fPlugin.getParameterRanges(index).getFixedValue(static_cast<float>(std::atof(input)));
+        return true;
+    }
+
+    void flush(const clap_input_events_t* const inEvents, const clap_output_events_t* const outEvents)
+    {
+        const uint32_t eventCount = inEvents != nullptr ? inEvents->size(inEvents) : 0;
+
+        for (uint32_t i=0; i < eventCount; ++i)
+        {
+            const clap_event_header_t* const event = inEvents->get(inEvents, i);
+
+            if (event == nullptr || event->space_id != CLAP_CORE_EVENT_SPACE_ID || event->type != CLAP_EVENT_PARAM_VALUE)
+                continue;
+
+            const clap_event_param_value_t* const paramEvent = (const clap_event_param_value_t*)event;
+            setParameterValueFromHost(paramEvent->param_id, paramEvent->value);
+        }
+
+        writeOutputParameters(outEvents, 0);
+    }
+
+    // ----------------------------------------------------------------------------------------------------------------
+    // clap_plugin_latency, clap_plugin_tail and clap_plugin_thread_pool interface calls
+
+#if DISTRHO_PLUGIN_WANT_LATENCY
+    uint32_t getLatency() const noexcept
+    {
+        return fPlugin.getLatency();
+    }
+#endif
+
+    uint32_t getTailLength() const
+    {
+        // kTailLengthInfinite is also infinite for CLAP
+        return std::min(fPlugin.getTailLength(), static_cast<uint32_t>(INT32_MAX));
+    }
+
+    // ----------------------------------------------------------------------------------------------------------------
+    // clap_plugin_render interface calls
+
+    bool setRenderMode(const clap_plugin_render_mode mode)
+    {
+        fOfflineRendering = mode == CLAP_RENDER_OFFLINE;
+        return true;
+    }
+
+#if DISTRHO_PLUGIN_WANT_THREAD_POOL
+    void runParallelTask(const uint32_t taskIndex)
+    {
+        fPlugin.runParallelTask(taskIndex);
+    }
+#endif
+
+private:
+    // Plugin
+    PluginExporter fPlugin;
+
+    // CLAP stuff
+    const clap_host_t* const fHost;
+#if DISTRHO_PLUGIN_WANT_THREAD_POOL
+    const clap_host_thread_pool_t* fHostThreadPool;
+#endif
+
+    // Temporary data
+    double* fDummyBuffer;
+    uint32_t fDummyBufferSize;
+    uint32_t fFrameOffset; // start of the current plugin run() inside the host block
+    const clap_output_events_t* fOutputEvents;
+    volatile bool fOfflineRendering; // set from the main thread, given to the plugin on the next process
+#if DISTRHO_PLUGIN_WANT_LATENCY
+    uint32_t fLastKnownLatency;
+#endif
+#if DISTRHO_PLUGIN_WANT_TIMEPOS
+    TimePosition fTimePosition;
+#endif
+
+    // ----------------------------------------------------------------------------------------------------------------
+    // processing helpers
+
+    static float* const* getChannelBuffers(const clap_audio_buffer_t& buffer, float*) noexcept
+    {
+        return buffer.data32;
+    }
+
+    static double* const* getChannelBuffers(const clap_audio_buffer_t& buffer, double*) noexcept
+    {
+        return buffer.data64;
+    }
+
+#if DISTRHO_PLUGIN_WANT_DOUBLE_PRECISION
+    // the host gives either 32 or 64 bit buffers, the same for all ports
+    static bool usesDoublePrecision(const clap_process_t* const process) noexcept
+    {
+        if (process->audio_outputs_count != 0 && process->audio_outputs != nullptr)
+            return process->audio_outputs[0].data32 == nullptr && process->audio_outputs[0].data64 != nullptr;
+        if (process->audio_inputs_count != 0 && process->audio_inputs != nullptr)
+            return process->audio_inputs[0].data32 == nullptr && process->audio_inputs[0].data64 != nullptr;
+        return false;
+    }
+#endif
+
+    void setParameterValueFromHost(const clap_id index, const double value)
+    {
+        DISTRHO_SAFE_ASSERT_UINT_RETURN(index < fPlugin.getParameterCount(), index,);
+
+        if (fPlugin.isParameterOutput(index))
+            return;
+
+        const uint32_t hints = fPlugin.getParameterHints(index);
+        const ParameterRanges& ranges(fPlugin.getParameterRanges(index));
+        float realValue = ranges.getFixedValue(static_cast<float>(value));
+
+        if (hints & kParameterIsBoolean)
+        {
+            const float midRange = ranges.min + (ranges.max - ranges.min) / 2.0f;
+            realValue = realValue > midRange ? ranges.max : ranges.min;
+        }
+
+        if (hints & kParameterIsInteger)
+        {
+            realValue = std::round(realValue);
+        }
+
+        fPlugin.setParameterValue(index, realValue);
+    }
+
+    // report changed output parameters through the host output events
+    void writeOutputParameters(const clap_output_events_t* const outEvents, const uint32_t time)
+    {
+        for (uint32_t i=0; fPlugin.takeNextChangedOutputParameter(i); ++i)
+        {
+            if (outEvents == nullptr)
+                continue;
+
+            clap_event_param_value_t event;
+            std::memset(&event, 0, sizeof(event));
+            event.header.size = sizeof(event);
+            event.header.time = time;
+            event.header.space_id = CLAP_CORE_EVENT_SPACE_ID;
+            event.header.type = CLAP_EVENT_PARAM_VALUE;
+            event.param_id = i;
+            event.note_id = -1;
+            event.port_index = -1;
+            event.channel = -1;
+            event.key = -1;
+            event.value = fPlugin.getParameterValue(i);
+
+            outEvents->try_push(outEvents, &event.header);
+        }
+    }
+
+    template <typename T>
+    void processAudio(const clap_process_t* const process, const uint32_t frames, const uint32_t eventCount)
+    {
+        // host buffers are given to the plugin as-is, missing ones are replaced by silence or scratch space
+#if DISTRHO_PLUGIN_NUM_INPUTS > 0
+        const T* inputs[DISTRHO_PLUGIN_NUM_INPUTS];
+        const T* const silence = reinterpret_cast<const T*>(fDummyBuffer);
+        bool inputsSilent = true;
+
+        {
+            const bool hasPort = process->audio_inputs_count != 0 && process->audio_inputs != nullptr;
+            const T* const* const buffers = hasPort ? getChannelBuffers(process->audio_inputs[0], static_cast<T*>(nullptr)) : nullptr;
+            const uint32_t channels = buffers != nullptr ? process->audio_inputs[0].channel_count : 0;
+
+            for (uint32_t i=0; i < DISTRHO_PLUGIN_NUM_INPUTS; ++i)
+            {
+                if (i < channels && buffers[i] != nullptr)
+                {
+                    inputs[i] = buffers[i];
+
+                    // a constant channel is silent only if its constant value is zero
+                    if (i >= 64 || (process->audio_inputs[0].constant_mask & (static_cast<uint64_t>(1) << i)) == 0
+                        || buffers[i][0] != 0)
+                        inputsSilent = false;
+                }
+                else
+                {
+                    inputs[i] = silence;
+                }
+            }
+        }
+#else
+        const T** const inputs = nullptr;
+        static const bool inputsSilent = false;
+#endif
+
+#if DISTRHO_PLUGIN_NUM_OUTPUTS > 0
+        T* outputs[DISTRHO_PLUGIN_NUM_OUTPUTS];
+        T* const scratch = reinterpret_cast<T*>(fDummyBuffer + fDummyBufferSize);
+
+        {
+            const bool hasPort = process->audio_outputs_count != 0 && process->audio_outputs != nullptr;
+            T* const* const buffers = hasPort ? getChannelBuffers(process->audio_outputs[0], static_cast<T*>(nullptr)) : nullptr;
+            const uint32_t channels = buffers != nullptr ? process->audio_outputs[0].channel_count : 0;
+
+            for (uint32_t i=0; i < DISTRHO_PLUGIN_NUM_OUTPUTS; ++i)
+                outputs[i] = i < channels && buffers[i] != nullptr ? buffers[i] : scratch;
+        }
+#else
+        T** const outputs = nullptr;
+#endif
+
+#if DISTRHO_PLUGIN_WANT_MIDI_INPUT
+        MidiEvent* const midiEvents = fPlugin.getMidiEventBuffer();
+#else
+        MidiEvent* const midiEvents = nullptr;
+#endif
+        const clap_input_events_t* const inEvents = process->in_events;
+        uint32_t midiEventCount;
+
+#if DISTRHO_PLUGIN_WANT_PARAMETER_EVENTS
+        // the plugin splits the block by itself
+        midiEventCount = 0;
+
+        for (uint32_t i=0; i < eventCount; ++i)
+            readInputEvent(inEvents->get(inEvents, i), 0, frames, midiEventCount);
+
+        runPlugin(inputs, outputs, frames, midiEvents, midiEventCount, inputsSilent);
+#else
+        // run the plugin in slices, events are sorted so each parameter change ends the current one
+        uint32_t eventIndex = 0;
+
+        for (uint32_t offset = 0, end; offset < frames; offset = end)
+        {
+            end = frames;
+            midiEventCount = 0;
+
+            for (; eventIndex < eventCount; ++eventIndex)
+            {
+                const clap_event_header_t* const event = inEvents->get(inEvents, eventIndex);
+
+                if (event != nullptr && event->type == CLAP_EVENT_PARAM_VALUE && event->time > offset && event->time < frames)
+                {
+                    end = event->time;
+                    break;
+                }
+
+                readInputEvent(event, offset, frames, midiEventCount);
+            }
+
+# if DISTRHO_PLUGIN_NUM_INPUTS > 0
+            const T* sliceInputs[DISTRHO_PLUGIN_NUM_INPUTS];
+
+            for (uint32_t i=0; i < DISTRHO_PLUGIN_NUM_INPUTS; ++i)
+                sliceInputs[i] = inputs[i] + offset;
+# else
+            const T** const sliceInputs = inputs;
+# endif
+# if DISTRHO_PLUGIN_NUM_OUTPUTS > 0
+            T* sliceOutputs[DISTRHO_PLUGIN_NUM_OUTPUTS];
+
+            for (uint32_t i=0; i < DISTRHO_PLUGIN_NUM_OUTPUTS; ++i)
+                sliceOutputs[i] = outputs[i] + offset;
+# else
+            T** const sliceOutputs = outputs;
+# endif
+
+            fFrameOffset = offset;
+            runPlugin(sliceInputs, sliceOutputs, end - offset, midiEvents, midiEventCount, inputsSilent);
+        }
+
+        fFrameOffset = 0;
+#endif
+
+#if DISTRHO_PLUGIN_NUM_OUTPUTS > 0
+        if (process->audio_outputs_count != 0 && process->audio_outputs != nullptr)
+            process->audio_outputs[0].constant_mask = fPlugin.areOutputsSilent() ? ~static_cast<uint64_t>(0) : 0;
+#endif
+    }
+
+    template <typename T>
+    void runPlugin(const T** const inputs, T** const outputs, const uint32_t frames,
+                   const MidiEvent* const midiEvents, const uint32_t midiEventCount, const bool inputsSilent)
+    {
+        if (inputsSilent)
+            fPlugin.setInputsSilent();
+
+#if DISTRHO_PLUGIN_WANT_MIDI_INPUT
+        fPlugin.run(inputs, outputs, frames, midiEvents, midiEventCount);
+#else
+        fPlugin.run(inputs, outputs, frames);
+        // unused
+        (void)midiEvents;
+        (void)midiEventCount;
+#endif
+    }
+
+    // handle a single host event, MIDI ones are added to the plugin pool relative to the run() at offset
+    void readInputEvent(const clap_event_header_t* const event, const uint32_t offset, const uint32_t frames,
+                        uint32_t& midiEventCount)
+    {
+        if (event == nullptr || event->space_id != CLAP_CORE_EVENT_SPACE_ID)
+            return;
+
+        const uint32_t frame = std::min(std::max(event->time, offset), frames - 1) - offset;
+
+        if (event->type == CLAP_EVENT_PARAM_VALUE)
+        {
+            const clap_event_param_value_t* const paramEvent = (const clap_event_param_value_t*)event;
+            setParameterValueFromHost(paramEvent->param_id, paramEvent->value);
+#if DISTRHO_PLUGIN_WANT_PARAMETER_EVENTS
+            if (paramEvent->param_id < fPlugin.getParameterCount() && ! fPlugin.isParameterOutput(paramEvent->param_id))
+                fPlugin.addParameterEvent(frame, paramEvent->param_id, fPlugin.getParameterValue(paramEvent->param_id));
+#endif
+            return;
+        }
+
+#if DISTRHO_PLUGIN_WANT_MIDI_INPUT
+        if (midiEventCount == fPlugin.getMidiEventCapacity())
+        {
+            switch (event->type)
+            {
+            case CLAP_EVENT_NOTE_ON:
+            case CLAP_EVENT_NOTE_OFF:
+            case CLAP_EVENT_NOTE_CHOKE:
+            case CLAP_EVENT_MIDI:
+            case CLAP_EVENT_MIDI_SYSEX:
+                fPlugin.addDroppedMidiEvents(1);
+                break;
+            }
+            return;
+        }
+
+        MidiEvent& midiEvent(fPlugin.getMidiEventBuffer()[midiEventCount]);
+        midiEvent.frame = frame;
+        midiEvent.size = 3;
+        midiEvent.dataExt = nullptr;
+
+        switch (event->type)
+        {
+        case CLAP_EVENT_NOTE_ON:
+        case CLAP_EVENT_NOTE_OFF:
+        case CLAP_EVENT_NOTE_CHOKE: {
+            const clap_event_note_t* const noteEvent = (const clap_event_note_t*)event;
+
+            // wildcard notes cannot be expressed as MIDI
+            if (noteEvent->key < 0 || noteEvent->channel < 0)
+                return;
+
+            const double velocity = std::max(0.0, std::min(1.0, noteEvent->velocity));
+
+            if (event->type == CLAP_EVENT_NOTE_ON)
+            {
+                midiEvent.data[0] = 0x90 | (noteEvent->channel & 0xF);
+                midiEvent.data[2] = static_cast<uint8_t>(std::max(1L, std::lround(velocity * 127.0)));
+            }
+            else
+            {
+                midiEvent.data[0] = 0x80 | (noteEvent->channel & 0xF);
+                midiEvent.data[2] = event->type == CLAP_EVENT_NOTE_OFF ? static_cast<uint8_t>(std::lround(velocity * 127.0)) : 0;
+            }
+
+            midiEvent.data[1] = noteEvent->key & 0x7F;
+            break;
+        }
+        case CLAP_EVENT_MIDI: {
+            const clap_event_midi_t* const midiData = (const clap_event_midi_t*)event;
+
+            switch (midiData->data[0] & 0xF0)
+            {
+            case 0xC0:
+            case 0xD0:
+                midiEvent.size = 2;
+                break;
+            case 0xF0:
+                midiEvent.size = midiData->data[0] == 0xF2 ? 3 : midiData->data[0] == 0xF1 || midiData->data[0] == 0xF3 ? 2 : 1;
+                break;
+            }
+
+            std::memcpy(midiEvent.data, midiData->data, midiEvent.size);
+            break;
+        }
+        case CLAP_EVENT_MIDI_SYSEX: {
+            // its data stays valid during process
+            const clap_event_midi_sysex_t* const sysexEvent = (const clap_event_midi_sysex_t*)event;
+
+            if (sysexEvent->buffer == nullptr || sysexEvent->size == 0)
+                return;
+
+            midiEvent.size = sysexEvent->size;
+
+            if (midiEvent.size > MidiEvent::kDataSize)
+                midiEvent.dataExt = sysexEvent->buffer;
+            else
+                std::memcpy(midiEvent.data, sysexEvent->buffer, midiEvent.size);
+            break;
+        }
+        default:
+            return;
+        }
+
+        ++midiEventCount;
+#else
+        // unused
+        (void)frame;
+        (void)midiEventCount;
+#endif
+    }
+
+#if DISTRHO_PLUGIN_WANT_TIMEPOS
+    void updateTimePosition(const clap_event_transport_t* const transport)
+    {
+        if (transport == nullptr)
+        {
+            // free-running, keep the last position but stop
+            fTimePosition.playing = false;
+            fPlugin.setTimePosition(fTimePosition);
+            return;
+        }
+
+        fTimePosition.playing = (transport->flags & CLAP_TRANSPORT_IS_PLAYING) != 0;
+        fTimePosition.bbt.valid = (transport->flags & CLAP_TRANSPORT_HAS_TEMPO) != 0;
+
+        if (transport->flags & CLAP_TRANSPORT_HAS_SECONDS_TIMELINE)
+        {
+            const double seconds = static_cast<double>(transport->song_pos_seconds) / CLAP_SECTIME_FACTOR;
+            fTimePosition.frame = seconds > 0.0 ? static_cast<uint64_t>(seconds * fPlugin.getSampleRate() + 0.5) : 0;
+        }
+
+        // ticksPerBeat is not possible with CLAP
+        fTimePosition.bbt.ticksPerBeat = 1920.0;
+
+        if (transport->flags & CLAP_TRANSPORT_HAS_TEMPO)
+            fTimePosition.bbt.beatsPerMinute = transport->tempo;
+        else
+            fTimePosition.bbt.beatsPerMinute = 120.0;
+
+        if ((transport->flags & CLAP_TRANSPORT_HAS_BEATS_TIMELINE) != 0
+            && (transport->flags & CLAP_TRANSPORT_HAS_TIME_SIGNATURE) != 0
+            && transport->tsig_num > 0 && transport->tsig_denom > 0)
+        {
+            // positions are in quarter notes, the bar start comes from the host
+            const double ppqPos   = static_cast<double>(transport->song_pos_beats) / CLAP_BEATTIME_FACTOR;
+            const double ppqBar   = static_cast<double>(transport->bar_start) / CLAP_BEATTIME_FACTOR;
+            const double barBeats = std::max(0.0, ppqPos - ppqBar) * transport->tsig_denom / 4.0;
+            const double rest     = std::fmod(barBeats, 1.0);
+
+            fTimePosition.bbt.bar         = transport->bar_number + 1;
+            fTimePosition.bbt.beat        = static_cast<int32_t>(barBeats - rest + 0.5) + 1;
+            fTimePosition.bbt.tick        = rest * fTimePosition.bbt.ticksPerBeat;
+            fTimePosition.bbt.beatsPerBar = transport->tsig_num;
+            fTimePosition.bbt.beatType    = transport->tsig_denom;
+        }
+        else
+        {
+            fTimePosition.bbt.bar         = 1;
+            fTimePosition.bbt.beat        = 1;
+            fTimePosition.bbt.tick        = 0.0;
+            fTimePosition.bbt.beatsPerBar = 4.0f;
+            fTimePosition.bbt.beatType    = 4.0f;
+        }
+
+        fTimePosition.bbt.barStartTick = fTimePosition.bbt.ticksPerBeat*
+                                         fTimePosition.bbt.beatsPerBar*
+                                         (fTimePosition.bbt.bar-1);
+
+        fPlugin.setTimePosition(fTimePosition);
+    }
+#endif
+
+#if DISTRHO_PLUGIN_WANT_PARAMETER_VALUE_CHANGE_REQUEST
+    // only possible during process, where the change is sent as a full gesture
+    bool requestParameterValueChange(const uint32_t index, const float value)
+    {
+        if (fOutputEvents == nullptr)
+            return false;
+
+        const uint32_t time = fFrameOffset + fPlugin.getSliceFrameOffset();
+
+        clap_event_param_gesture_t gesture;
+        std::memset(&gesture, 0, sizeof(gesture));
+        gesture.header.size = sizeof(gesture);
+        gesture.header.time = time;
+        gesture.header.space_id = CLAP_CORE_EVENT_SPACE_ID;
+        gesture.header.type = CLAP_EVENT_PARAM_GESTURE_BEGIN;
+        gesture.param_id = index;
+
+        clap_event_param_value_t event;
+        std::memset(&event, 0, sizeof(event));
+        event.header.size = sizeof(event);
+        event.header.time = time;
+        event.header.space_id = CLAP_CORE_EVENT_SPACE_ID;
+        event.header.type = CLAP_EVENT_PARAM_VALUE;
+        event.param_id = index;
+        event.note_id = -1;
+        event.port_index = -1;
+        event.channel = -1;
+        event.key = -1;
+        event.value = value;
+
+        if (! fOutputEvents->try_push(fOutputEvents, &gesture.header))
+            return false;
+
+        const bool ok = fOutputEvents->try_push(fOutputEvents, &event.header);
+
+        gesture.header.type = CLAP_EVENT_PARAM_GESTURE_END;
+        fOutputEvents->try_push(fOutputEvents, &gesture.header);
+
+        if (ok)
+            fPlugin.setParameterValue(index, value);
+
+        return ok;
+    }
+
+    static bool requestParameterValueChangeCallback(void* const ptr, const uint32_t index, const float value)
+    {
+        return ((PluginCLAP*)ptr)->requestParameterValueChange(index, value);
+    }
+#endif
+
+#if DISTRHO_PLUGIN_WANT_MIDI_OUTPUT
+    bool writeMidi(const MidiEvent& midiEvent)
+    {
+        if (fOutputEvents == nullptr)
+            return false;
+
+        const uint8_t* const data = midiEvent.size > MidiEvent::kDataSize ? midiEvent.dataExt : midiEvent.data;
+        const uint32_t time = fFrameOffset + midiEvent.frame;
+
+        if (data[0] == 0xF0)
+        {
+            clap_event_midi_sysex_t event;
+            std::memset(&event, 0, sizeof(event));
+            event.header.size = sizeof(event);
+            event.header.time = time;
+            event.header.space_id = CLAP_CORE_EVENT_SPACE_ID;
+            event.header.type = CLAP_EVENT_MIDI_SYSEX;
+            event.buffer = data;
+            event.size = midiEvent.size;
+
+            return fOutputEvents->try_push(fOutputEvents, &event.header);
+        }
+
+        if (midiEvent.size > 3)
+            return false;
+
+        clap_event_midi_t event;
+        std::memset(&event, 0, sizeof(event));
+        event.header.size = sizeof(event);
+        event.header.time = time;
+        event.header.space_id = CLAP_CORE_EVENT_SPACE_ID;
+        event.header.type = CLAP_EVENT_MIDI;
+        std::memcpy(event.data, data, midiEvent.size);
+
+        return fOutputEvents->try_push(fOutputEvents, &event.header);
+    }
+
+    static bool writeMidiCallback(void* ptr, const MidiEvent& midiEvent)
+    {
+        return ((PluginCLAP*)ptr)->writeMidi(midiEvent);
+    }
+#endif
+
+#if DISTRHO_PLUGIN_WANT_THREAD_POOL
+    // serial fallback is handled by the plugin when the host has no thread pool
+    bool requestParallelTasks(const uint32_t taskCount)
+    {
+        if (fHostThreadPool == nullptr)
+            return false;
+
+        return fHostThreadPool->request_exec(fHost, taskCount);
+    }
+
+    static bool requestParallelTasksCallback(void* const ptr, const uint32_t taskCount)
+    {
+        return ((PluginCLAP*)ptr)->requestParallelTasks(taskCount);
+    }
+#endif
+
+    DISTRHO_DECLARE_NON_COPYABLE(PluginCLAP)
+};
+
+// -----------------------------------------------------------------------
+// Dummy plugin to get data from
+
+static ScopedPointer<PluginExporter> gPluginInfo;
+static clap_plugin_descriptor_t gPluginDescriptor;
+static char gPluginVersion[32];
+
+static const char* const kPluginFeatures[] = {
+#if DISTRHO_PLUGIN_IS_SYNTH || (DISTRHO_PLUGIN_WANT_MIDI_INPUT && DISTRHO_PLUGIN_NUM_INPUTS == 0 && DISTRHO_PLUGIN_NUM_OUTPUTS > 0)
+    CLAP_PLUGIN_FEATURE_INSTRUMENT,
+#elif DISTRHO_PLUGIN_NUM_INPUTS > 0
+    CLAP_PLUGIN_FEATURE_AUDIO_EFFECT,
+#elif DISTRHO_PLUGIN_WANT_MIDI_INPUT || DISTRHO_PLUGIN_WANT_MIDI_OUTPUT
+    CLAP_PLUGIN_FEATURE_NOTE_EFFECT,
+#else
+    CLAP_PLUGIN_FEATURE_UTILITY,
+#endif
+#if DISTRHO_PLUGIN_NUM_OUTPUTS == 1
+    CLAP_PLUGIN_FEATURE_MONO,
+#elif DISTRHO_PLUGIN_NUM_OUTPUTS == 2
+    CLAP_PLUGIN_FEATURE_STEREO,
+#endif
+    nullptr
+};
+
+static void gPluginInit()
+{
+    if (gPluginInfo != nullptr)
+        return;
+
+    d_lastBufferSize = 512;
+    d_lastSampleRate = 44100.0;
+    gPluginInfo = new PluginExporter(nullptr, nullptr, nullptr);
+    d_lastBufferSize = 0;
+    d_lastSampleRate = 0.0;
+
+    const uint32_t version = gPluginInfo->getVersion();
+    std::snprintf(gPluginVersion, sizeof(gPluginVersion), "%u.%u.%u",
+                  (version & 0xFF0000) >> 16, (version & 0x00FF00) >> 8, version & 0x0000FF);
+
+    const clap_version_t clapVersion = CLAP_VERSION_INIT;
+    gPluginDescriptor.clap_version = clapVersion;
+    gPluginDescriptor.id = DISTRHO_PLUGIN_CLAP_ID;
+    gPluginDescriptor.name = gPluginInfo->getName();
+    gPluginDescriptor.vendor = gPluginInfo->getMaker();
+    gPluginDescriptor.url = gPluginInfo->getHomePage();
+    gPluginDescriptor.manual_url = "";
+    gPluginDescriptor.support_url = "";
+    gPluginDescriptor.version = gPluginVersion;
+    gPluginDescriptor.description = gPluginInfo->getDescription();
+    gPluginDescriptor.features = kPluginFeatures;
+}
+
+// -----------------------------------------------------------------------
+// dpf_plugin, the object given to the host
+
+struct dpf_plugin {
+    clap_plugin_t clap;
+    const clap_host_t* host;
+    ScopedPointer<PluginCLAP> plugin;
+};
+
+#define pluginPtr (((dpf_plugin*)plugin->plugin_data)->plugin)
+
+static bool CLAP_ABI clap_plugin_init(const clap_plugin_t* const plugin)
+{
+    dpf_plugin* const self = (dpf_plugin*)plugin->plugin_data;
+
+    // default early values
+    if (d_lastBufferSize == 0)
+        d_lastBufferSize = 1024;
+    if (d_isZero(d_lastSampleRate))
+        d_lastSampleRate = 44100.0;
+
+    d_lastCanRequestParameterValueChanges = true;
+
+    self->plugin = new PluginCLAP(self->host);
+
+    d_lastBufferSize = 0;
+    d_lastSampleRate = 0.0;
+    d_lastCanRequestParameterValueChanges = false;
+
+    return self->plugin->init();
+}
+
+static void CLAP_ABI clap_plugin_destroy(const clap_plugin_t* const plugin)
+{
+    delete (dpf_plugin*)plugin->plugin_data;
+}
+
+static bool CLAP_ABI clap_plugin_activate(const clap_plugin_t* const plugin, const double sampleRate,
+                                          const uint32_t, const uint32_t maxFrames)
+{
+    return pluginPtr->activate(sampleRate, maxFrames);
+}
+
+static void CLAP_ABI clap_plugin_deactivate(const clap_plugin_t* const plugin)
+{
+    pluginPtr->deactivate();
+}
+
+static bool CLAP_ABI clap_plugin_start_processing(const clap_plugin_t*)
+{
+    return true;
+}
+
+static void CLAP_ABI clap_plugin_stop_processing(const clap_plugin_t*)
+{
+}
+
+static void CLAP_ABI clap_plugin_reset(const clap_plugin_t* const plugin)
+{
+    pluginPtr->reset();
+}
+
+static clap_process_status CLAP_ABI clap_plugin_process(const clap_plugin_t* const plugin, const clap_process_t* const process)
+{
+    return pluginPtr->process(process);
+}
+
+static void CLAP_ABI clap_plugin_on_main_thread(const clap_plugin_t*)
+{
+}
+
+// -----------------------------------------------------------------------
+// plugin extensions
+
+static uint32_t CLAP_ABI clap_plugin_audio_ports_count(const clap_plugin_t*, const bool isInput)
+{
+    return (isInput ? DISTRHO_PLUGIN_NUM_INPUTS : DISTRHO_PLUGIN_NUM_OUTPUTS) != 0 ? 1 : 0;
+}
+
+static bool CLAP_ABI clap_plugin_audio_ports_get(const clap_plugin_t*, const uint32_t index, const bool isInput,
+                                                 clap_audio_port_info_t* const info)
+{
+    const uint32_t channels = isInput ? DISTRHO_PLUGIN_NUM_INPUTS : DISTRHO_PLUGIN_NUM_OUTPUTS;
+    DISTRHO_SAFE_ASSERT_RETURN(index == 0 && channels != 0, false);
+
+    std::memset(info, 0, sizeof(clap_audio_port_info_t));
+    info->id = isInput ? 0 : 1;
+    info->flags = CLAP_AUDIO_PORT_IS_MAIN;
+#if DISTRHO_PLUGIN_WANT_DOUBLE_PRECISION
+    info->flags |= CLAP_AUDIO_PORT_SUPPORTS_64BITS;
+#endif
+    info->channel_count = channels;
+    info->port_type = channels == 1 ? CLAP_PORT_MONO : channels == 2 ? CLAP_PORT_STEREO : nullptr;
+    info->in_place_pair = CLAP_INVALID_ID;
+    DISTRHO_NAMESPACE::strncpy(info->name, isInput ? "Audio Input" : "Audio Output", CLAP_NAME_SIZE);
+    return true;
+}
+
+static const clap_plugin_audio_ports_t kAudioPorts = {
+    clap_plugin_audio_ports_count,
+    clap_plugin_audio_ports_get
+};
+
+static uint32_t CLAP_ABI clap_plugin_note_ports_count(const clap_plugin_t*, const bool isInput)
+{
+    return (isInput ? DISTRHO_PLUGIN_WANT_MIDI_INPUT : DISTRHO_PLUGIN_WANT_MIDI_OUTPUT) != 0 ? 1 : 0;
+}
+
+static bool CLAP_ABI clap_plugin_note_ports_get(const clap_plugin_t*, const uint32_t index, const bool isInput,
+                                                clap_note_port_info_t* const info)
+{
+    DISTRHO_SAFE_ASSERT_RETURN(index == 0, false);
+    DISTRHO_SAFE_ASSERT_RETURN((isInput ? DISTRHO_PLUGIN_WANT_MIDI_INPUT : DISTRHO_PLUGIN_WANT_MIDI_OUTPUT) != 0, false);
+
+    std::memset(info, 0, sizeof(clap_note_port_info_t));
+    info->id = isInput ? 0 : 1;
+    info->supported_dialects = isInput ? (CLAP_NOTE_DIALECT_CLAP|CLAP_NOTE_DIALECT_MIDI) : CLAP_NOTE_DIALECT_MIDI;
+    info->preferred_dialect = CLAP_NOTE_DIALECT_MIDI;
+    DISTRHO_NAMESPACE::strncpy(info->name, isInput ? "Event Input" : "Event Output", CLAP_NAME_SIZE);
+    return true;
+}
+
+static const clap_plugin_note_ports_t kNotePorts = {
+    clap_plugin_note_ports_count,
+    clap_plugin_note_ports_get
+};
+
+static uint32_t CLAP_ABI clap_plugin_params_count(const clap_plugin_t* const plugin)
+{
+    return pluginPtr->getParameterCount();
+}
+
+static bool CLAP_ABI clap_plugin_params_get_info(const clap_plugin_t* const plugin, const uint32_t index,
+                                                 clap_param_info_t* const info)
+{
+    return pluginPtr->getParameterInfo(index, info);
+}
+
+static bool CLAP_ABI clap_plugin_params_get_value(const clap_plugin_t* const plugin, const clap_id id, double* const value)
+{
+    return pluginPtr->getParameterValue(id, value);
+}
+
+static bool CLAP_ABI clap_plugin_params_value_to_text(const clap_plugin_t* const plugin, const clap_id id,
+                                                      const double value, char* const output, const uint32_t size)
+{
+    return pluginPtr->getParameterStringForValue(id, value, output, size);
+}
+
+static bool CLAP_ABI clap_plugin_params_text_to_value(const clap_plugin_t* const plugin, const clap_id id,
+                                                      const char* const input, double* const output)
+{
+    return pluginPtr->getParameterValueForString(id, input, output);
+}
+
+static void CLAP_ABI clap_plugin_params_flush(const clap_plugin_t* const plugin,
+                                              const clap_input_events_t* const inEvents,
+                                              const clap_output_events_t* const outEvents)
+{
+    pluginPtr->flush(inEvents, outEvents);
+}
+
+static const clap_plugin_params_t kParams = {
+    clap_plugin_params_count,
+    clap_plugin_params_get_info,
+    clap_plugin_params_get_value,
+    clap_plugin_params_value_to_text,
+    clap_plugin_params_text_to_value,
+    clap_plugin_params_flush
+};
+
+#if DISTRHO_PLUGIN_WANT_LATENCY
+static uint32_t CLAP_ABI clap_plugin_latency_get(const clap_plugin_t* const plugin)
+{
+    return pluginPtr->getLatency();
+}
+
+static const clap_plugin_latency_t kLatency = {
+    clap_plugin_latency_get
+};
+#endif
+
+static uint32_t CLAP_ABI clap_plugin_tail_get(const clap_plugin_t* const plugin)
+{
+    return pluginPtr->getTailLength();
+}
+
+static const clap_plugin_tail_t kTail = {
+    clap_plugin_tail_get
+};
+
+static bool CLAP_ABI clap_plugin_render_has_hard_realtime_requirement(const clap_plugin_t*)
+{
+    return false;
+}
+
+static bool CLAP_ABI clap_plugin_render_set(const clap_plugin_t* const plugin, const clap_plugin_render_mode mode)
+{
+    return pluginPtr->setRenderMode(mode);
+}
+
+static const clap_plugin_render_t kRender = {
+    clap_plugin_render_has_hard_realtime_requirement,
+    clap_plugin_render_set
+};
+
+#if DISTRHO_PLUGIN_WANT_THREAD_POOL
+static void CLAP_ABI clap_plugin_thread_pool_exec(const clap_plugin_t* const plugin, const uint32_t taskIndex)
+{
+    pluginPtr->runParallelTask(taskIndex);
+}
+
+static const clap_plugin_thread_pool_t kThreadPool = {
+    clap_plugin_thread_pool_exec
+};
+#endif
+
+static const void* CLAP_ABI clap_plugin_get_extension(const clap_plugin_t*, const char* const id)
+{
+    if (std::strcmp(id, CLAP_EXT_AUDIO_PORTS) == 0)
+        return &kAudioPorts;
+    if (std::strcmp(id, CLAP_EXT_NOTE_PORTS) == 0)
+        return &kNotePorts;
+    if (std::strcmp(id, CLAP_EXT_PARAMS) == 0)
+        return &kParams;
+#if DISTRHO_PLUGIN_WANT_LATENCY
+    if (std::strcmp(id, CLAP_EXT_LATENCY) == 0)
+        return &kLatency;
+#endif
+    if (std::strcmp(id, CLAP_EXT_TAIL) == 0)
+        return &kTail;
+    if (std::strcmp(id, CLAP_EXT_RENDER) == 0)
+        return &kRender;
+#if DISTRHO_PLUGIN_WANT_THREAD_POOL
+    if (std::strcmp(id, CLAP_EXT_THREAD_POOL) == 0)
+        return &kThreadPool;
+#endif
+    return nullptr;
+}
+
+#undef pluginPtr
+
+// -----------------------------------------------------------------------
+// plugin factory
+
+static uint32_t CLAP_ABI clap_factory_get_plugin_count(const clap_plugin_factory_t*)
+{
+    return 1;
+}
+
+static const clap_plugin_descriptor_t* CLAP_ABI clap_factory_get_plugin_descriptor(const clap_plugin_factory_t*,
+                                                                                   const uint32_t index)
+{
+    DISTRHO_SAFE_ASSERT_UINT_RETURN(index == 0, index, nullptr);
+
+    return &gPluginDescriptor;
+}
+
+static const clap_plugin_t* CLAP_ABI clap_factory_create_plugin(const clap_plugin_factory_t*,
+                                                                const clap_host_t* const host,
+                                                                const char* const pluginId)
+{
+    DISTRHO_SAFE_ASSERT_RETURN(host != nullptr, nullptr);
+    DISTRHO_SAFE_ASSERT_RETURN(pluginId != nullptr, nullptr);
+
+    if (std::strcmp(pluginId, gPluginDescriptor.id) != 0 || ! clap_version_is_compatible(host->clap_version))
+        return nullptr;
+
+    dpf_plugin* const self = new dpf_plugin;
+    self->host = host;
+
+    clap_plugin_t& clap(self->clap);
+    clap.desc = &gPluginDescriptor;
+    clap.plugin_data = self;
+    clap.init = clap_plugin_init;
+    clap.destroy = clap_plugin_destroy;
+    clap.activate = clap_plugin_activate;
+    clap.deactivate = clap_plugin_deactivate;
+    clap.start_processing = clap_plugin_start_processing;
+    clap.stop_processing = clap_plugin_stop_processing;
+    clap.reset = clap_plugin_reset;
+    clap.process = clap_plugin_process;
+    clap.get_extension = clap_plugin_get_extension;
+    clap.on_main_thread = clap_plugin_on_main_thread;
+
+    return &self->clap;
+}
+
+static const clap_plugin_factory_t kPluginFactory = {
+    clap_factory_get_plugin_count,
+    clap_factory_get_plugin_descriptor,
+    clap_factory_create_plugin
+};
+
+// -----------------------------------------------------------------------
+// plugin entry
+
+static bool CLAP_ABI clap_entry_init(const char*)
+{
+    gPluginInit();
+    return true;
+}
+
+static void CLAP_ABI clap_entry_deinit()
+{
+}
+
+static const void* CLAP_ABI clap_entry_get_factory(const char* const factoryId)
+{
+    if (std::strcmp(factoryId, CLAP_PLUGIN_FACTORY_ID) == 0)
+        return &kPluginFactory;
+
+    return nullptr;
+}
+
+END_NAMESPACE_DISTRHO
+
+// -----------------------------------------------------------------------
+
+DISTRHO_PLUGIN_EXPORT
+const clap_plugin_entry_t clap_entry = {
+    CLAP_VERSION_INIT,
+    DISTRHO_NAMESPACE::clap_entry_init,
+    DISTRHO_NAMESPACE::clap_entry_deinit,
+    DISTRHO_NAMESPACE::clap_entry_get_factory
+};
+
+// -----------------------------------------------------------------------
@@ -65,6 +65,10 @@
 # define DISTRHO_PLUGIN_WANT_DIRECT_ACCESS 0
 #endif
 
+#ifndef DISTRHO_PLUGIN_WANT_DOUBLE_PRECISION
+# define DISTRHO_PLUGIN_WANT_DOUBLE_PRECISION 0
+#endif
+
 #ifndef DISTRHO_PLUGIN_WANT_LATENCY
 # define DISTRHO_PLUGIN_WANT_LATENCY 0
 #endif
@@ -73,6 +77,14 @@
 # define DISTRHO_PLUGIN_WANT_MIDI_OUTPUT 0
 #endif
 
+#ifndef DISTRHO_PLUGIN_WANT_OUTPUT_PARAMETER_CHANGES
+# define DISTRHO_PLUGIN_WANT_OUTPUT_PARAMETER_CHANGES 0
+#endif
+
+#ifndef DISTRHO_PLUGIN_WANT_PARAMETER_EVENTS
+# define DISTRHO_PLUGIN_WANT_PARAMETER_EVENTS 0
+#endif
+
 #ifndef DISTRHO_PLUGIN_WANT_PARAMETER_VALUE_CHANGE_REQUEST
 # define DISTRHO_PLUGIN_WANT_PARAMETER_VALUE_CHANGE_REQUEST 0
 #endif
@@ -97,6 +109,30 @@
 # define DISTRHO_PLUGIN_WANT_TIMEPOS 0
 #endif
 
+#ifndef DISTRHO_PLUGIN_WANT_WORKER
+# define DISTRHO_PLUGIN_WANT_WORKER 0
+#endif
+
+#ifndef DISTRHO_PLUGIN_WANT_THREAD_POOL
+# define DISTRHO_PLUGIN_WANT_THREAD_POOL 0
+#endif
+
+#ifndef DISTRHO_PLUGIN_MAX_SUBBLOCK_SIZE
+# define DISTRHO_PLUGIN_MAX_SUBBLOCK_SIZE 0
+#endif
+
+#ifndef DISTRHO_PLUGIN_MIDI_EVENT_CAPACITY
+# define DISTRHO_PLUGIN_MIDI_EVENT_CAPACITY 512
+#endif
+
+#ifndef DISTRHO_PLUGIN_FLUSH_DENORMALS
+# define DISTRHO_PLUGIN_FLUSH_DENORMALS 1
+#endif
+
+#ifndef DISTRHO_PLUGIN_WANT_AUTOMATIC_BYPASS
+# define DISTRHO_PLUGIN_WANT_AUTOMATIC_BYPASS 0
+#endif
+
 #ifndef DISTRHO_UI_USER_RESIZABLE
 # define DISTRHO_UI_USER_RESIZABLE 0
 #endif
@@ -123,6 +159,13 @@
 # define DISTRHO_UI_URI DISTRHO_PLUGIN_URI "#DPF_UI"
 #endif
 
+// -----------------------------------------------------------------------
+// Define DISTRHO_PLUGIN_CLAP_ID if needed
+
+#ifndef DISTRHO_PLUGIN_CLAP_ID
+# define DISTRHO_PLUGIN_CLAP_ID DISTRHO_PLUGIN_URI
+#endif
+
 // -----------------------------------------------------------------------
 // Test if synth has audio outputs
 
@@ -139,6 +182,17 @@
 # error Synths need MIDI input to work!
 #endif
 
+// -----------------------------------------------------------------------
+// Test if sub-block size is valid
+
+#if DISTRHO_PLUGIN_MAX_SUBBLOCK_SIZE < 0
+# error DISTRHO_PLUGIN_MAX_SUBBLOCK_SIZE must not be negative
+#endif
+
+#if DISTRHO_PLUGIN_MIDI_EVENT_CAPACITY < 1
+# error DISTRHO_PLUGIN_MIDI_EVENT_CAPACITY must be at least 1
+#endif
+
 // -----------------------------------------------------------------------
 // Enable state if plugin wants state files
 
@@ -18,15 +18,56 @@
 #define DISTRHO_PLUGIN_INTERNAL_HPP_INCLUDED
 
 #include "../DistrhoPlugin.hpp"
+#include "../extra/AudioBufferOps.hpp"
+
+#if DISTRHO_PLUGIN_FLUSH_DENORMALS
+# include "../extra/ScopedDenormalDisable.hpp"
+#endif
+#if DISTRHO_PLUGIN_WANT_WORKER
+# include "../extra/RingBuffer.hpp"
+# include "../extra/Thread.hpp"
+#endif
+
+#if defined(_MSC_VER) && ! defined(__clang__)
+# include <intrin.h>
+#endif
 
 #include <set>
 
+// Debug builds report heap allocations made while the plugin is running.
+// The standalone replaces the global operator new, plugin libraries use a replacement local to the library (ELF only).
+// Not for Carla, where many plugins are built into a single library.
+#if defined(DEBUG) && defined(__GNUC__) && ! defined(DISTRHO_PLUGIN_TARGET_CARLA) && \
+    (defined(DISTRHO_PLUGIN_TARGET_JACK) || defined(__ELF__))
+# define DISTRHO_PLUGIN_CHECK_RT_ALLOCATIONS 1
+#else
+# define DISTRHO_PLUGIN_CHECK_RT_ALLOCATIONS 0
+#endif
+
 START_NAMESPACE_DISTRHO
 
 // -----------------------------------------------------------------------
 // Maxmimum values
 
-static const uint32_t kMaxMidiEvents = 512;
+#if DISTRHO_PLUGIN_WANT_MIDI_INPUT
+// the MIDI event pool stops growing at this size
+static const uint32_t kMaxMidiEventCapacity = 65536;
+#endif
+
+#if DISTRHO_PLUGIN_WANT_WORKER
+static const uint32_t kMaxWorkDataSize = 8192;
+static const uint32_t kWorkQueueSize   = 32768;
+#endif
+
+#if DISTRHO_PLUGIN_WANT_AUTOMATIC_BYPASS
+// duration of the crossfade between processed and bypassed audio
+static const uint32_t kBypassFadeTimeInMs = 10;
+#endif
+
+// block size guarantees given by the host, set through d_lastBlockSizeHints
+static const uint32_t kBlockSizeIsFixed    = 0x1;
+static const uint32_t kBlockSizeIsPowerOf2 = 0x2;
+static const uint32_t kBlockSizeIsCoarse   = 0x4;
 
 // -----------------------------------------------------------------------
 // Static data, see DistrhoPlugin.cpp
@@ -34,12 +75,26 @@ static const uint32_t kMaxMidiEvents = 512;
 extern uint32_t d_lastBufferSize;
 extern double   d_lastSampleRate;
 extern bool     d_lastCanRequestParameterValueChanges;
+extern uint32_t d_lastBlockSizeHints;
+
+#if DISTRHO_PLUGIN_CHECK_RT_ALLOCATIONS
+extern __thread bool d_isInsideRun;
+
+// marks the current thread as running the plugin while in scope
+struct ScopedRealtimeSection {
+    ScopedRealtimeSection() noexcept { d_isInsideRun = true; }
+    ~ScopedRealtimeSection() noexcept { d_isInsideRun = false; }
+};
+#endif
 
 // -----------------------------------------------------------------------
 // DSP callbacks
 
 typedef bool (*writeMidiFunc) (void* ptr, const MidiEvent& midiEvent);
 typedef bool (*requestParameterValueChangeFunc) (void* ptr, uint32_t index, float value);
+typedef bool (*scheduleWorkFunc) (void* ptr, const void* data, uint32_t size);
+typedef bool (*writeWorkResponseFunc) (void* ptr, const void* data, uint32_t size);
+typedef bool (*requestParallelTasksFunc) (void* ptr, uint32_t taskCount);
 
 // -----------------------------------------------------------------------
 // Helpers
@@ -71,6 +126,191 @@ static void fillInPredefinedPortGroupData(const uint32_t groupId, PortGroup& por
     }
 }
 
+// -----------------------------------------------------------------------
+// Parameter change tracking
+
+/**
+   Set of parameter indices, one bit per parameter.
+   Bits can be set and taken from different threads, each bit is set and cleared atomically.
+ */
+class ParameterBitSet
+{
+public:
+    ParameterBitSet() noexcept
+        : fWords(nullptr),
+          fWordCount(0) {}
+
+    ~ParameterBitSet() noexcept
+    {
+        if (fWords != nullptr)
+        {
+            delete[] fWords;
+            fWords = nullptr;
+        }
+    }
+
+    void init(const uint32_t count)
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(fWords == nullptr,);
+
+        if (count == 0)
+            return;
+
+        fWordCount = (count + 31) / 32;
+        fWords = new uint32_t[fWordCount];
+        std::memset(fWords, 0, sizeof(uint32_t)*fWordCount);
+    }
+
+    void set(const uint32_t index) noexcept
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(index / 32 < fWordCount,);
+
+#if defined(_MSC_VER) && ! defined(__clang__)
+        _InterlockedOr(reinterpret_cast<volatile long*>(&fWords[index / 32]), static_cast<long>(1U << (index % 32)));
+#else
+        __sync_fetch_and_or(&fWords[index / 32], 1U << (index % 32));
+#endif
+    }
+
+   /**
+      Find the first set bit starting from @a index (inclusive), clear it and return its position in @a index.
+      Usage: `for (uint32_t i=0; bits.takeNext(i); ++i) { ... }`
+    */
+    bool takeNext(uint32_t& index) noexcept
+    {
+        for (uint32_t w = index / 32, mask = ~0U << (index % 32); w < fWordCount; ++w, mask = ~0U)
+        {
+            const uint32_t word = fWords[w] & mask;
+
+            if (word == 0)
+                continue;
+
+#if defined(_MSC_VER) && ! defined(__clang__)
+            unsigned long bit;
+            _BitScanForward(&bit, word);
+            _InterlockedAnd(reinterpret_cast<volatile long*>(&fWords[w]), static_cast<long>(~(1U << bit)));
+#else
+            const uint32_t bit = static_cast<uint32_t>(__builtin_ctz(word));
+            __sync_fetch_and_and(&fWords[w], ~(1U << bit));
+#endif
+
+            index = w * 32 + static_cast<uint32_t>(bit);
+            return true;
+        }
+
+        return false;
+    }
+
+private:
+    uint32_t* fWords;
+    uint32_t  fWordCount;
+
+    DISTRHO_DECLARE_NON_COPYABLE(ParameterBitSet)
+};
+
+#if DISTRHO_PLUGIN_WANT_STATE
+// -----------------------------------------------------------------------
+// State key lookup
+
+/**
+   Open-addressing hash table mapping state keys to their indices.
+   Built once after the plugin has initialized its states, lookups are O(1) and allocation free.
+ */
+class StateKeyTable
+{
+public:
+    StateKeyTable() noexcept
+        : fKeys(nullptr),
+          fSlots(nullptr),
+          fMask(0) {}
+
+    ~StateKeyTable() noexcept
+    {
+        if (fSlots != nullptr)
+        {
+            delete[] fSlots;
+            fSlots = nullptr;
+        }
+    }
+
+    void init(const String* const keys, const uint32_t count)
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(fSlots == nullptr,);
+
+        if (count == 0)
+            return;
+
+        // keep the load factor at or below 50%
+        uint32_t size = 4;
+        while (size < count * 2)
+            size *= 2;
+
+        fKeys  = keys;
+        fMask  = size - 1;
+        fSlots = new uint32_t[size];
+        std::memset(fSlots, 0, sizeof(uint32_t)*size);
+
+        for (uint32_t i=0; i < count; ++i)
+        {
+            uint32_t slot = hash(keys[i].buffer()) & fMask;
+
+            // slots store index + 1, 0 means empty
+            for (; fSlots[slot] != 0; slot = (slot + 1) & fMask)
+            {
+                if (fKeys[fSlots[slot] - 1] == keys[i])
+                {
+                    d_stderr2("Duplicate state key \"%s\"", keys[i].buffer());
+                    break;
+                }
+            }
+
+            if (fSlots[slot] == 0)
+                fSlots[slot] = i + 1;
+        }
+    }
+
+   /**
+      Get the index of the state matching @a key, or -1 if there is none.
+    */
+    int32_t find(const char* const key) const noexcept
+    {
+        if (fSlots == nullptr)
+            return -1;
+
+        for (uint32_t slot = hash(key) & fMask; fSlots[slot] != 0; slot = (slot + 1) & fMask)
+        {
+            const uint32_t index = fSlots[slot] - 1;
+
+            if (fKeys[index] == key)
+                return static_cast<int32_t>(index);
+        }
+
+        return -1;
+    }
+
+private:
+    const String* fKeys;
+    uint32_t* fSlots;
+    uint32_t  fMask;
+
+    // FNV-1a
+    static uint32_t hash(const char* key) noexcept
+    {
+        uint32_t h = 2166136261U;
+
+        for (; *key != '\0'; ++key)
+        {
+            h ^= static_cast<uint8_t>(*key);
+            h *= 16777619U;
+        }
+
+        return h;
+    }
+
+    DISTRHO_DECLARE_NON_COPYABLE(StateKeyTable)
+};
+#endif
+
 // -----------------------------------------------------------------------
 // Plugin private data
 
@@ -85,6 +325,17 @@ struct Plugin::PrivateData {
     uint32_t   parameterOffset;
     Parameter* parameters;
 
+    // output parameters changed by the plugin, and triggers that need to be reset
+    ParameterBitSet changedOutputParameters;
+    ParameterBitSet changedTriggerParameters;
+
+#if ! DISTRHO_PLUGIN_WANT_OUTPUT_PARAMETER_CHANGES
+    // used to detect output parameter changes when the plugin does not report them
+    uint32_t  outputParameterCount;
+    uint32_t* outputParameterIndices;
+    float*    lastOutputParameterValues;
+#endif
+
     uint32_t         portGroupCount;
     PortGroupWithId* portGroups;
 
@@ -97,23 +348,71 @@ struct Plugin::PrivateData {
     uint32_t stateCount;
     String*  stateKeys;
     String*  stateDefValues;
+    StateKeyTable stateKeyTable;
 #endif
 
 #if DISTRHO_PLUGIN_WANT_LATENCY
     uint32_t latency;
+    uint32_t maxLatency;
 #endif
 
 #if DISTRHO_PLUGIN_WANT_TIMEPOS
     TimePosition timePosition;
 #endif
 
+#if DISTRHO_PLUGIN_WANT_PARAMETER_EVENTS
+    // parameter event pool filled by the wrappers, only resized while inactive
+    uint32_t        parameterEventCount;
+    uint32_t        parameterEventCapacity;
+    ParameterEvent* parameterEvents;
+    uint32_t*       parameterEventQueued; // number of queued events per parameter
+    uint32_t        parameterEventRequestCount;
+    uint32_t        parameterEventPeakCount;
+    uint32_t        droppedParameterEventCount;
+#endif
+
+#if DISTRHO_PLUGIN_WANT_MIDI_INPUT
+    // MIDI input pool filled by the wrappers, only resized while inactive
+    uint32_t   midiEventCapacity;
+    MidiEvent* midiEvents;
+    uint32_t   droppedMidiEventCount;
+    bool       midiEventPoolTooSmall;
+#endif
+
+#if DISTRHO_PLUGIN_MAX_SUBBLOCK_SIZE > 0 || DISTRHO_PLUGIN_WANT_DOUBLE_PRECISION
+    MidiEvent* subBlockMidiEvents;
+#endif
+
+#if DISTRHO_PLUGIN_WANT_DOUBLE_PRECISION
+    uint32_t doubleBufferSize;
+    double*  doubleBuffer;
+#endif
+
     // Callbacks
     void*         callbacksPtr;
     writeMidiFunc writeMidiCallbackFunc;
     requestParameterValueChangeFunc requestParameterValueChangeCallbackFunc;
 
+    // start of the current slice inside the host block, when PluginExporter splits a block
+    uint32_t sliceFrameOffset;
+
+#if DISTRHO_PLUGIN_WANT_WORKER
+    // worker callbacks, the response one is only valid during work()
+    void*                 scheduleWorkCallbacksPtr;
+    scheduleWorkFunc      scheduleWorkCallbackFunc;
+    void*                 workResponseCallbacksPtr;
+    writeWorkResponseFunc writeWorkResponseCallbackFunc;
+#endif
+
+#if DISTRHO_PLUGIN_WANT_THREAD_POOL
+    // host thread pool, tasks run serially on the calling thread if unset
+    requestParallelTasksFunc requestParallelTasksCallbackFunc;
+#endif
+
     uint32_t bufferSize;
+    uint32_t blockSizeHints;
     double   sampleRate;
+    bool     isOfflineRendering;
     bool     canRequestParameterValueChanges;
 
     PrivateData() noexcept
@@ -124,6 +423,13 @@ struct Plugin::PrivateData {
           parameterCount(0),
           parameterOffset(0),
           parameters(nullptr),
+          changedOutputParameters(),
+          changedTriggerParameters(),
+#if ! DISTRHO_PLUGIN_WANT_OUTPUT_PARAMETER_CHANGES
+          outputParameterCount(0),
+          outputParameterIndices(nullptr),
+          lastOutputParameterValues(nullptr),
+#endif
           portGroupCount(0),
           portGroups(nullptr),
 #if DISTRHO_PLUGIN_WANT_PROGRAMS
@@ -137,12 +443,47 @@ struct Plugin::PrivateData {
 #endif
 #if DISTRHO_PLUGIN_WANT_LATENCY
           latency(0),
+          maxLatency(0),
+#endif
+#if DISTRHO_PLUGIN_WANT_PARAMETER_EVENTS
+          parameterEventCount(0),
+          parameterEventCapacity(0),
+          parameterEvents(nullptr),
+          parameterEventQueued(nullptr),
+          parameterEventRequestCount(0),
+          parameterEventPeakCount(0),
+          droppedParameterEventCount(0),
+#endif
+#if DISTRHO_PLUGIN_WANT_MIDI_INPUT
+          midiEventCapacity(0),
+          midiEvents(nullptr),
+          droppedMidiEventCount(0),
+          midiEventPoolTooSmall(false),
+#endif
+#if DISTRHO_PLUGIN_MAX_SUBBLOCK_SIZE > 0 || DISTRHO_PLUGIN_WANT_DOUBLE_PRECISION
+          subBlockMidiEvents(nullptr),
+#endif
+#if DISTRHO_PLUGIN_WANT_DOUBLE_PRECISION
+          doubleBufferSize(0),
+          doubleBuffer(nullptr),
 #endif
           callbacksPtr(nullptr),
           writeMidiCallbackFunc(nullptr),
           requestParameterValueChangeCallbackFunc(nullptr),
+          sliceFrameOffset(0),
+#if DISTRHO_PLUGIN_WANT_WORKER
+          scheduleWorkCallbacksPtr(nullptr),
+          scheduleWorkCallbackFunc(nullptr),
+          workResponseCallbacksPtr(nullptr),
+          writeWorkResponseCallbackFunc(nullptr),
+#endif
+#if DISTRHO_PLUGIN_WANT_THREAD_POOL
+          requestParallelTasksCallbackFunc(nullptr),
+#endif
           bufferSize(d_lastBufferSize),
+          blockSizeHints(d_lastBlockSizeHints),
           sampleRate(d_lastSampleRate),
+          isOfflineRendering(false),
           canRequestParameterValueChanges(d_lastCanRequestParameterValueChanges)
     {
         DISTRHO_SAFE_ASSERT(bufferSize != 0);
@@ -181,6 +522,20 @@ struct Plugin::PrivateData {
             parameters = nullptr;
         }
 
+#if ! DISTRHO_PLUGIN_WANT_OUTPUT_PARAMETER_CHANGES
+        if (outputParameterIndices != nullptr)
+        {
+            delete[] outputParameterIndices;
+            outputParameterIndices = nullptr;
+        }
+
+        if (lastOutputParameterValues != nullptr)
+        {
+            delete[] lastOutputParameterValues;
+            lastOutputParameterValues = nullptr;
+        }
+#endif
+
         if (portGroups != nullptr)
         {
             delete[] portGroups;
@@ -208,15 +563,59 @@ struct Plugin::PrivateData {
             stateDefValues = nullptr;
         }
 #endif
+
+#if DISTRHO_PLUGIN_WANT_PARAMETER_EVENTS
+        if (parameterEvents != nullptr)
+        {
+            delete[] parameterEvents;
+            parameterEvents = nullptr;
+        }
+
+        if (parameterEventQueued != nullptr)
+        {
+            delete[] parameterEventQueued;
+            parameterEventQueued = nullptr;
+        }
+#endif
+
+#if DISTRHO_PLUGIN_WANT_MIDI_INPUT
+        if (midiEvents != nullptr)
+        {
+            delete[] midiEvents;
+            midiEvents = nullptr;
+        }
+#endif
+
+#if DISTRHO_PLUGIN_MAX_SUBBLOCK_SIZE > 0 || DISTRHO_PLUGIN_WANT_DOUBLE_PRECISION
+        if (subBlockMidiEvents != nullptr)
+        {
+            delete[] subBlockMidiEvents;
+            subBlockMidiEvents = nullptr;
+        }
+#endif
+
+#if DISTRHO_PLUGIN_WANT_DOUBLE_PRECISION
+        if (doubleBuffer != nullptr)
+        {
+            delete[] doubleBuffer;
+            doubleBuffer = nullptr;
+        }
+#endif
     }
 
 #if DISTRHO_PLUGIN_WANT_MIDI_OUTPUT
     bool writeMidiCallback(const MidiEvent& midiEvent)
     {
-        if (writeMidiCallbackFunc != nullptr)
+        if (writeMidiCallbackFunc == nullptr)
+            return false;
+
+        if (sliceFrameOffset == 0)
             return writeMidiCallbackFunc(callbacksPtr, midiEvent);
 
-        return false;
+        // plugin frames are relative to the current slice, hosts expect them relative to their block
+        MidiEvent hostMidiEvent(midiEvent);
+        hostMidiEvent.frame += sliceFrameOffset;
+        return writeMidiCallbackFunc(callbacksPtr, hostMidiEvent);
     }
 #endif
 
@@ -229,6 +628,34 @@ struct Plugin::PrivateData {
         return false;
     }
 #endif
+
+#if DISTRHO_PLUGIN_WANT_WORKER
+    bool scheduleWorkCallback(const void* const data, const uint32_t size)
+    {
+        if (scheduleWorkCallbackFunc != nullptr)
+            return scheduleWorkCallbackFunc(scheduleWorkCallbacksPtr, data, size);
+
+        return false;
+    }
+
+    bool writeWorkResponseCallback(const void* const data, const uint32_t size)
+    {
+        if (writeWorkResponseCallbackFunc != nullptr)
+            return writeWorkResponseCallbackFunc(workResponseCallbacksPtr, data, size);
+
+        return false;
+    }
+#endif
+
+#if DISTRHO_PLUGIN_WANT_THREAD_POOL
+    bool requestParallelTasksCallback(const uint32_t taskCount)
+    {
+        if (requestParallelTasksCallbackFunc != nullptr)
+            return requestParallelTasksCallbackFunc(callbacksPtr, taskCount);
+
+        return false;
+    }
+#endif
 };
 
 // -----------------------------------------------------------------------
@@ -239,10 +666,34 @@ class PluginExporter
 public:
     PluginExporter(void* const callbacksPtr,
                    const writeMidiFunc writeMidiCall,
-                   const requestParameterValueChangeFunc requestParameterValueChangeCall)
+                   const requestParameterValueChangeFunc requestParameterValueChangeCall,
+                   const scheduleWorkFunc scheduleWorkCall = nullptr,
+                   const requestParallelTasksFunc requestParallelTasksCall = nullptr)
         : fPlugin(createPlugin()),
           fData((fPlugin != nullptr) ? fPlugin->pData : nullptr),
-          fIsActive(false)
+#if DISTRHO_PLUGIN_WANT_WORKER
+          fWorker(nullptr),
+#endif
+          fIsActive(false),
+          fInputsSilent(false),
+          fOutputsSilent(false),
+          fSilentFrames(0)
+#if DISTRHO_PLUGIN_WANT_AUTOMATIC_BYPASS
+        , fBypassIndex(-1),
+          fBypassTarget(false),
+          fBypassStopped(false),
+          fBypassMix(0.0f),
+          fBypassMixStep(0.0f),
+          fBypassTailFrames(0),
+          fBypassHoldFrames(0),
+          fBypassBuffer(nullptr),
+          fBypassBufferSize(0),
+          fBypassWritePos(0)
+# if DISTRHO_PLUGIN_WANT_MIDI_INPUT
+        , fBypassSliceMidiEvents(nullptr),
+          fBypassSliceMidiEventCapacity(0)
+# endif
+#endif
     {
         DISTRHO_SAFE_ASSERT_RETURN(fPlugin != nullptr,);
         DISTRHO_SAFE_ASSERT_RETURN(fData != nullptr,);
@@ -264,6 +715,75 @@ public:
         for (uint32_t i=0, count=fData->parameterCount; i < count; ++i)
             fPlugin->initParameter(i, fData->parameters[i]);
 
+#if DISTRHO_PLUGIN_WANT_AUTOMATIC_BYPASS
+        for (uint32_t i=0, count=fData->parameterCount; i < count; ++i)
+        {
+            if (fData->parameters[i].designation != kParameterDesignationBypass)
+                continue;
+            if (fData->parameters[i].hints & kParameterIsOutput)
+                continue;
+
+            fBypassIndex = static_cast<int32_t>(i);
+            fBypassTarget = fData->parameters[i].ranges.def > 0.5f;
+            break;
+        }
+
+# if DISTRHO_PLUGIN_WANT_MIDI_INPUT
+        // sent to the plugin after bypass fades out
+        for (uint8_t channel=0; channel < 16; ++channel)
+        {
+            MidiEvent& sustainOff(fBypassMidiEvents[channel * 2]);
+            sustainOff.frame   = 0;
+            sustainOff.size    = 3;
+            sustainOff.data[0] = 0xB0 | channel;
+            sustainOff.data[1] = 64;
+            sustainOff.data[2] = 0;
+            sustainOff.data[3] = 0;
+            sustainOff.dataExt = nullptr;
+
+            MidiEvent& allNotesOff(fBypassMidiEvents[channel * 2 + 1]);
+            std::memcpy(&allNotesOff, &sustainOff, sizeof(MidiEvent));
+            allNotesOff.data[1] = 123;
+        }
+# endif
+#endif
+
+#if ! DISTRHO_PLUGIN_WANT_OUTPUT_PARAMETER_CHANGES
+        {
+            uint32_t outputCount = 0;
+
+            for (uint32_t i=0, count=fData->parameterCount; i < count; ++i)
+            {
+                if (fData->parameters[i].hints & kParameterIsOutput)
+                    ++outputCount;
+            }
+
+            if (outputCount != 0)
+            {
+                fData->outputParameterCount      = outputCount;
+                fData->outputParameterIndices    = new uint32_t[outputCount];
+                fData->lastOutputParameterValues = new float[outputCount];
+
+                for (uint32_t i=0, j=0, count=fData->parameterCount; i < count; ++i)
+                {
+                    if ((fData->parameters[i].hints & kParameterIsOutput) == 0)
+                        continue;
+
+                    fData->outputParameterIndices[j] = i;
+                    fData->lastOutputParameterValues[j] = fPlugin->getParameterValue(i);
+                    ++j;
+                }
+            }
+        }
+#endif
+
+        // report initial values of all outputs
+        for (uint32_t i=0, count=fData->parameterCount; i < count; ++i)
+        {
+            if (fData->parameters[i].hints & kParameterIsOutput)
+                fData->changedOutputParameters.set(i);
+        }
+
         {
             std::set<uint32_t> portGroupIndices;
 
@@ -303,15 +823,56 @@ public:
 #if DISTRHO_PLUGIN_WANT_STATE
         for (uint32_t i=0, count=fData->stateCount; i < count; ++i)
             fPlugin->initState(i, fData->stateKeys[i], fData->stateDefValues[i]);
+
+        fData->stateKeyTable.init(fData->stateKeys, fData->stateCount);
+#endif
+
+#if DISTRHO_PLUGIN_WANT_DOUBLE_PRECISION
+        resizeDoubleBuffer(fData->bufferSize);
 #endif
 
         fData->callbacksPtr = callbacksPtr;
         fData->writeMidiCallbackFunc = writeMidiCall;
         fData->requestParameterValueChangeCallbackFunc = requestParameterValueChangeCall;
+
+#if DISTRHO_PLUGIN_WANT_WORKER
+        // use the host worker if there is one, our own thread otherwise
+        if (scheduleWorkCall != nullptr)
+        {
+            fData->scheduleWorkCallbacksPtr = callbacksPtr;
+            fData->scheduleWorkCallbackFunc = scheduleWorkCall;
+        }
+        else
+        {
+            fWorker = new Worker(this);
+            fData->scheduleWorkCallbacksPtr = fWorker;
+            fData->scheduleWorkCallbackFunc = Worker::scheduleWorkCallback;
+        }
+#else
+        // unused
+        (void)scheduleWorkCall;
+#endif
+
+#if DISTRHO_PLUGIN_WANT_THREAD_POOL
+        fData->requestParallelTasksCallbackFunc = requestParallelTasksCall;
+#else
+        // unused
+        (void)requestParallelTasksCall;
+#endif
     }
 
     ~PluginExporter()
     {
+#if DISTRHO_PLUGIN_WANT_WORKER
+        // worker thread must be stopped before the plugin goes away
+        delete fWorker;
+#endif
+#if DISTRHO_PLUGIN_WANT_AUTOMATIC_BYPASS
+        delete[] fBypassBuffer;
+# if DISTRHO_PLUGIN_WANT_MIDI_INPUT
+        delete[] fBypassSliceMidiEvents;
+# endif
+#endif
         delete fPlugin;
     }
 
@@ -538,48 +1099,122 @@ public:
         DISTRHO_SAFE_ASSERT_RETURN(fData != nullptr && index < fData->parameterCount,);
 
         fPlugin->setParameterValue(index, value);
-    }
 
-    uint32_t getPortGroupCount() const noexcept
-    {
-        DISTRHO_SAFE_ASSERT_RETURN(fData != nullptr, 0);
+#if DISTRHO_PLUGIN_WANT_AUTOMATIC_BYPASS
+        if (static_cast<int32_t>(index) == fBypassIndex)
+            fBypassTarget = value > 0.5f;
+#endif
 
-        return fData->portGroupCount;
+        const Parameter& param(fData->parameters[index]);
+
+        if ((param.hints & kParameterIsTrigger) == kParameterIsTrigger && d_isNotEqual(value, param.ranges.def))
+            fData->changedTriggerParameters.set(index);
     }
 
-    const PortGroupWithId& getPortGroupById(const uint32_t groupId) const noexcept
+    // mark an output parameter as changed, so that wrappers report its value again
+    void setOutputParameterChanged(const uint32_t index) noexcept
     {
-        DISTRHO_SAFE_ASSERT_RETURN(fData != nullptr && fData->portGroupCount != 0, sFallbackPortGroup);
-
-        for (uint32_t i=0; i < fData->portGroupCount; ++i)
-        {
-            const PortGroupWithId& portGroup(fData->portGroups[i]);
-
-            if (portGroup.groupId == groupId)
-                return portGroup;
-        }
+        DISTRHO_SAFE_ASSERT_RETURN(fData != nullptr,);
 
-        return sFallbackPortGroup;
+        fData->changedOutputParameters.set(index);
     }
 
-    const PortGroupWithId& getPortGroupByIndex(const uint32_t index) const noexcept
+    // take the next changed output parameter, starting from index
+    bool takeNextChangedOutputParameter(uint32_t& index) noexcept
     {
-        DISTRHO_SAFE_ASSERT_RETURN(fData != nullptr && index < fData->portGroupCount, sFallbackPortGroup);
+        DISTRHO_SAFE_ASSERT_RETURN(fData != nullptr, false);
 
-        return fData->portGroups[index];
+        return fData->changedOutputParameters.takeNext(index);
     }
 
-    const String& getPortGroupSymbolForId(const uint32_t groupId) const noexcept
+    // take the next trigger parameter that was set to a non-default value, starting from index
+    bool takeNextChangedTriggerParameter(uint32_t& index) noexcept
     {
-        DISTRHO_SAFE_ASSERT_RETURN(fData != nullptr, sFallbackString);
+        DISTRHO_SAFE_ASSERT_RETURN(fData != nullptr, false);
 
-        return getPortGroupById(groupId).symbol;
+        return fData->changedTriggerParameters.takeNext(index);
     }
 
-#if DISTRHO_PLUGIN_WANT_PROGRAMS
-    uint32_t getProgramCount() const noexcept
+#if DISTRHO_PLUGIN_WANT_PARAMETER_EVENTS
+    // queue a parameter event for the next run(), does not change the parameter value
+    void addParameterEvent(const uint32_t frame, const uint32_t index, const float value) noexcept
     {
-        DISTRHO_SAFE_ASSERT_RETURN(fData != nullptr, 0);
+        DISTRHO_SAFE_ASSERT_RETURN(fData != nullptr && index < fData->parameterCount,);
+
+        // remember how many events were needed, the pool grows to that on the next activation
+        if (++fData->parameterEventRequestCount > fData->parameterEventPeakCount)
+            fData->parameterEventPeakCount = fData->parameterEventRequestCount;
+
+        if (fData->parameterEventCount == fData->parameterEventCapacity)
+        {
+            ++fData->droppedParameterEventCount;
+
+            if (! dropSupersededParameterEvent(frame, index))
+                return;
+        }
+
+        // keep events sorted by frame, new events are usually appended at the end
+        uint32_t pos = fData->parameterEventCount++;
+
+        for (; pos != 0 && fData->parameterEvents[pos-1].frame > frame; --pos)
+            fData->parameterEvents[pos] = fData->parameterEvents[pos-1];
+
+        ParameterEvent& event(fData->parameterEvents[pos]);
+        event.frame = frame;
+        event.index = index;
+        event.value = value;
+
+        ++fData->parameterEventQueued[index];
+    }
+
+    uint32_t getDroppedParameterEventCount() const noexcept
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(fData != nullptr, 0);
+
+        return fData->droppedParameterEventCount;
+    }
+#endif
+
+    uint32_t getPortGroupCount() const noexcept
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(fData != nullptr, 0);
+
+        return fData->portGroupCount;
+    }
+
+    const PortGroupWithId& getPortGroupById(const uint32_t groupId) const noexcept
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(fData != nullptr && fData->portGroupCount != 0, sFallbackPortGroup);
+
+        for (uint32_t i=0; i < fData->portGroupCount; ++i)
+        {
+            const PortGroupWithId& portGroup(fData->portGroups[i]);
+
+            if (portGroup.groupId == groupId)
+                return portGroup;
+        }
+
+        return sFallbackPortGroup;
+    }
+
+    const PortGroupWithId& getPortGroupByIndex(const uint32_t index) const noexcept
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(fData != nullptr && index < fData->portGroupCount, sFallbackPortGroup);
+
+        return fData->portGroups[index];
+    }
+
+    const String& getPortGroupSymbolForId(const uint32_t groupId) const noexcept
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(fData != nullptr, sFallbackString);
+
+        return getPortGroupById(groupId).symbol;
+    }
+
+#if DISTRHO_PLUGIN_WANT_PROGRAMS
+    uint32_t getProgramCount() const noexcept
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(fData != nullptr, 0);
 
         return fData->programCount;
     }
@@ -655,13 +1290,15 @@ public:
         DISTRHO_SAFE_ASSERT_RETURN(fData != nullptr, false);
         DISTRHO_SAFE_ASSERT_RETURN(key != nullptr && key[0] != '\0', false);
 
-        for (uint32_t i=0; i < fData->stateCount; ++i)
-        {
-            if (fData->stateKeys[i] == key)
-                return true;
-        }
+        return fData->stateKeyTable.find(key) >= 0;
+    }
 
-        return false;
+    int32_t getStateIndex(const char* const key) const noexcept
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(fData != nullptr, -1);
+        DISTRHO_SAFE_ASSERT_RETURN(key != nullptr && key[0] != '\0', -1);
+
+        return fData->stateKeyTable.find(key);
     }
 #endif
 
@@ -676,6 +1313,14 @@ public:
 
     // -------------------------------------------------------------------
 
+    // start of the current slice inside the host block, for wrappers timing events the plugin sends during run()
+    uint32_t getSliceFrameOffset() const noexcept
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(fData != nullptr, 0);
+
+        return fData->sliceFrameOffset;
+    }
+
     bool isActive() const noexcept
     {
         return fIsActive;
@@ -686,8 +1331,25 @@ public:
         DISTRHO_SAFE_ASSERT_RETURN(fPlugin != nullptr,);
         DISTRHO_SAFE_ASSERT_RETURN(! fIsActive,);
 
+#if DISTRHO_PLUGIN_WANT_MIDI_INPUT
+        growMidiEventPoolIfNeeded();
+#endif
+#if DISTRHO_PLUGIN_WANT_PARAMETER_EVENTS
+        growParameterEventPoolIfNeeded();
+#endif
+
         fIsActive = true;
+        fSilentFrames = 0;
         fPlugin->activate();
+#if DISTRHO_PLUGIN_WANT_AUTOMATIC_BYPASS
+        // after activate(), as the plugin might set its latency there
+        resetBypass();
+#endif
+
+#if DISTRHO_PLUGIN_WANT_WORKER
+        if (fWorker != nullptr)
+            fWorker->start();
+#endif
     }
 
     void deactivate()
@@ -710,39 +1372,133 @@ public:
         }
     }
 
+    // clear the plugin DSP state by re-activating it, without growing any pools so it can be called while processing
+    void reset()
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(fPlugin != nullptr,);
+        DISTRHO_SAFE_ASSERT_RETURN(fIsActive,);
+
+        fPlugin->deactivate();
+        fSilentFrames = 0;
+        fPlugin->activate();
+#if DISTRHO_PLUGIN_WANT_AUTOMATIC_BYPASS
+        resetBypassState();
+#endif
+    }
+
+    // -------------------------------------------------------------------
+
 #if DISTRHO_PLUGIN_WANT_MIDI_INPUT
-    void run(const float** const inputs, float** const outputs, const uint32_t frames,
-             const MidiEvent* const midiEvents, const uint32_t midiEventCount)
+    // pool for the MIDI events of the next run, may move on activate()
+    MidiEvent* getMidiEventBuffer() const noexcept
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(fData != nullptr, nullptr);
+
+        return fData->midiEvents;
+    }
+
+    uint32_t getMidiEventCapacity() const noexcept
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(fData != nullptr, 0);
+
+        return fData->midiEventCapacity;
+    }
+
+    // called from run() by the wrappers for events that did not fit into the pool
+    void addDroppedMidiEvents(const uint32_t count) noexcept
     {
         DISTRHO_SAFE_ASSERT_RETURN(fData != nullptr,);
-        DISTRHO_SAFE_ASSERT_RETURN(fPlugin != nullptr,);
 
-        if (! fIsActive)
-        {
-            fIsActive = true;
-            fPlugin->activate();
-        }
+        fData->droppedMidiEventCount += count;
+        fData->midiEventPoolTooSmall = true;
+    }
 
-        fData->isProcessing = true;
-        fPlugin->run(inputs, outputs, frames, midiEvents, midiEventCount);
-        fData->isProcessing = false;
+    // -------------------------------------------------------------------
+#endif
+
+    uint32_t getTailLength() const
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(fPlugin != nullptr, kTailLengthInfinite);
+
+        return fPlugin->getTailLength();
     }
-#else
-    void run(const float** const inputs, float** const outputs, const uint32_t frames)
+
+    // the host has flagged the inputs of the next run as silent, saves scanning them
+    void setInputsSilent() noexcept
+    {
+        fInputsSilent = true;
+    }
+
+    // true if the last run skipped the plugin and cleared the outputs
+    bool areOutputsSilent() const noexcept
+    {
+        return fOutputsSilent;
+    }
+
+#if DISTRHO_PLUGIN_WANT_WORKER
+    // -------------------------------------------------------------------
+
+    // called from the host or DPF worker thread, responses go through respondCall
+    void work(const void* const data, const uint32_t size,
+              const writeWorkResponseFunc respondCall, void* const respondPtr)
     {
         DISTRHO_SAFE_ASSERT_RETURN(fData != nullptr,);
         DISTRHO_SAFE_ASSERT_RETURN(fPlugin != nullptr,);
 
-        if (! fIsActive)
-        {
-            fIsActive = true;
-            fPlugin->activate();
-        }
+        fData->workResponseCallbacksPtr = respondPtr;
+        fData->writeWorkResponseCallbackFunc = respondCall;
 
-        fData->isProcessing = true;
-        fPlugin->run(inputs, outputs, frames);
-        fData->isProcessing = false;
+        fPlugin->work(data, size);
+
+        fData->workResponseCallbacksPtr = nullptr;
+        fData->writeWorkResponseCallbackFunc = nullptr;
+    }
+
+    // called from the audio thread
+    void workResponse(const void* const data, const uint32_t size)
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(fPlugin != nullptr,);
+
+        fPlugin->workResponse(data, size);
+    }
+#endif
+
+#if DISTRHO_PLUGIN_WANT_THREAD_POOL
+    // called from the host thread pool, while the plugin is inside run()
+    void runParallelTask(const uint32_t taskIndex)
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(fPlugin != nullptr,);
+
+        fPlugin->runParallelTask(taskIndex);
+    }
+#endif
+
+#if DISTRHO_PLUGIN_WANT_MIDI_INPUT
+    void run(const float** const inputs, float** const outputs, const uint32_t frames,
+             const MidiEvent* const midiEvents, const uint32_t midiEventCount)
+    {
+        runInternal(inputs, outputs, frames, midiEvents, midiEventCount);
+    }
+
+# if DISTRHO_PLUGIN_WANT_DOUBLE_PRECISION
+    void run(const double** const inputs, double** const outputs, const uint32_t frames,
+             const MidiEvent* const midiEvents, const uint32_t midiEventCount)
+    {
+        runInternal(inputs, outputs, frames, midiEvents, midiEventCount);
+    }
+# endif
+#else
+    void run(const float** const inputs, float** const outputs, const uint32_t frames)
+    {
+        runInternal(inputs, outputs, frames, nullptr, 0);
     }
+
+# if DISTRHO_PLUGIN_WANT_DOUBLE_PRECISION
+    void run(const double** const inputs, double** const outputs, const uint32_t frames)
+    {
+        runInternal(inputs, outputs, frames, nullptr, 0);
+    }
+# endif
 #endif
 
     // -------------------------------------------------------------------
@@ -759,17 +1515,37 @@ public:
         return fData->sampleRate;
     }
 
+    // for hosts where the block size guarantees change together with the buffer size, call before setBufferSize()
+    void setBlockSizeHints(const uint32_t hints) noexcept
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(fData != nullptr,);
+
+        fData->blockSizeHints = hints;
+    }
+
     void setBufferSize(const uint32_t bufferSize, const bool doCallback = false)
     {
         DISTRHO_SAFE_ASSERT_RETURN(fData != nullptr,);
         DISTRHO_SAFE_ASSERT_RETURN(fPlugin != nullptr,);
         DISTRHO_SAFE_ASSERT(bufferSize >= 2);
 
+#if DISTRHO_PLUGIN_WANT_PARAMETER_EVENTS
+        growParameterEventPoolIfNeeded();
+#endif
+
         if (fData->bufferSize == bufferSize)
             return;
 
         fData->bufferSize = bufferSize;
 
+#if DISTRHO_PLUGIN_WANT_DOUBLE_PRECISION
+        resizeDoubleBuffer(bufferSize);
+#endif
+#if DISTRHO_PLUGIN_WANT_AUTOMATIC_BYPASS
+        if (fIsActive)
+            resizeBypassBuffer();
+#endif
+
         if (doCallback)
         {
             if (fIsActive) fPlugin->deactivate();
@@ -778,6 +1554,19 @@ public:
         }
     }
 
+    // must be called from the audio thread, before run()
+    void setOfflineRendering(const bool offline)
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(fData != nullptr,);
+        DISTRHO_SAFE_ASSERT_RETURN(fPlugin != nullptr,);
+
+        if (fData->isOfflineRendering == offline)
+            return;
+
+        fData->isOfflineRendering = offline;
+        fPlugin->renderModeChanged(offline);
+    }
+
     void setSampleRate(const double sampleRate, const bool doCallback = false)
     {
         DISTRHO_SAFE_ASSERT_RETURN(fData != nullptr,);
@@ -799,26 +1588,1168 @@ public:
 
 private:
     // -------------------------------------------------------------------
-    // Plugin and DistrhoPlugin data
+    // Processing helpers
 
-    Plugin* const fPlugin;
-    Plugin::PrivateData* const fData;
-    bool fIsActive;
+    template <typename T>
+    void runInternal(const T** const inputs, T** const outputs, const uint32_t frames,
+                     const MidiEvent* const midiEvents, const uint32_t midiEventCount)
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(fData != nullptr,);
+        DISTRHO_SAFE_ASSERT_RETURN(fPlugin != nullptr,);
 
-    // -------------------------------------------------------------------
-    // Static fallback data, see DistrhoPlugin.cpp
+#if DISTRHO_PLUGIN_FLUSH_DENORMALS
+        const ScopedDenormalDisable sdd;
+#endif
 
-    static const String                     sFallbackString;
-    static const AudioPort                  sFallbackAudioPort;
-    static const ParameterRanges            sFallbackRanges;
-    static const ParameterEnumerationValues sFallbackEnumValues;
-    static const PortGroupWithId            sFallbackPortGroup;
+        if (! fIsActive)
+        {
+            fIsActive = true;
+            fSilentFrames = 0;
+            fPlugin->activate();
+#if DISTRHO_PLUGIN_WANT_AUTOMATIC_BYPASS
+            resetBypass();
+#endif
 
-    DISTRHO_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PluginExporter)
-#ifndef DISTRHO_PLUGIN_TARGET_VST3 /* there is no way around this for VST3 */
-    DISTRHO_PREVENT_HEAP_ALLOCATION
+#if DISTRHO_PLUGIN_WANT_WORKER
+            if (fWorker != nullptr)
+                fWorker->start();
+#endif
+        }
+
+#if DISTRHO_PLUGIN_CHECK_RT_ALLOCATIONS
+        const ScopedRealtimeSection srs;
+#endif
+
+#if DISTRHO_PLUGIN_WANT_WORKER
+        if (fWorker != nullptr)
+            fWorker->deliverResponses();
+#endif
+
+#if DISTRHO_PLUGIN_WANT_AUTOMATIC_BYPASS
+        if (runBypass(inputs, outputs, frames, midiEvents, midiEventCount))
+        {
+# if DISTRHO_PLUGIN_WANT_PARAMETER_EVENTS
+            clearParameterEvents();
+# endif
+            return;
+        }
+#endif
+
+#if DISTRHO_PLUGIN_NUM_INPUTS > 0
+        if (skipSilentBlock(inputs, outputs, frames, midiEventCount))
+        {
+# if DISTRHO_PLUGIN_WANT_PARAMETER_EVENTS
+            clearParameterEvents();
+# endif
+            return;
+        }
+#else
+        fInputsSilent = false;
+#endif
+
+        processBlock(inputs, outputs, frames, midiEvents, midiEventCount);
+
+#if DISTRHO_PLUGIN_WANT_PARAMETER_EVENTS
+        clearParameterEvents();
+#endif
+    }
+
+    // run the plugin, splitting the block if needed
+    template <typename T>
+    void processBlock(const T** const inputs, T** const outputs, const uint32_t frames,
+                      const MidiEvent* const midiEvents, const uint32_t midiEventCount)
+    {
+#if DISTRHO_PLUGIN_WANT_PARAMETER_EVENTS
+        processBlock(inputs, outputs, frames, midiEvents, midiEventCount,
+                     fData->parameterEvents, fData->parameterEventCount);
+#else
+        processBlock(inputs, outputs, frames, midiEvents, midiEventCount, nullptr, 0);
+#endif
+    }
+
+    template <typename T>
+    void processBlock(const T** const inputs, T** const outputs, const uint32_t frames,
+                      const MidiEvent* const midiEvents, const uint32_t midiEventCount,
+                      ParameterEvent* const parameterEvents, const uint32_t parameterEventCount)
+    {
+        fData->isProcessing = true;
+#if DISTRHO_PLUGIN_MAX_SUBBLOCK_SIZE > 0
+        if (frames > DISTRHO_PLUGIN_MAX_SUBBLOCK_SIZE)
+            runSubBlocks(inputs, outputs, frames, DISTRHO_PLUGIN_MAX_SUBBLOCK_SIZE,
+                         midiEvents, midiEventCount, parameterEvents, parameterEventCount);
+        else
+#endif
+        runPlugin(inputs, outputs, frames, midiEvents, midiEventCount, parameterEvents, parameterEventCount);
+        fData->isProcessing = false;
+
+#if ! DISTRHO_PLUGIN_WANT_OUTPUT_PARAMETER_CHANGES
+        checkOutputParameterChanges();
+#endif
+    }
+
+#if DISTRHO_PLUGIN_NUM_INPUTS > 0
+    // clear outputs instead of running the plugin once inputs have been silent for longer than its tail
+    template <typename T>
+    bool skipSilentBlock(const T** const inputs, T** const outputs, const uint32_t frames,
+                         const uint32_t midiEventCount)
+    {
+        const bool inputsSilent = fInputsSilent;
+        fInputsSilent = false;
+        fOutputsSilent = false;
+
+        const uint32_t tailLength = fPlugin->getTailLength();
+
+        if (tailLength == kTailLengthInfinite || midiEventCount != 0)
+        {
+            fSilentFrames = 0;
+            return false;
+        }
+
+        if (! inputsSilent)
+        {
+            for (uint32_t i=0; i < DISTRHO_PLUGIN_NUM_INPUTS; ++i)
+            {
+                if (inputs[i] != nullptr && ! AudioBufferOps::isSilent(inputs[i], frames))
+                {
+                    fSilentFrames = 0;
+                    return false;
+                }
+            }
+        }
+
+        if (fSilentFrames < tailLength)
+        {
+            fSilentFrames = tailLength - fSilentFrames > frames ? fSilentFrames + frames : tailLength;
+            return false;
+        }
+
+# if DISTRHO_PLUGIN_NUM_OUTPUTS > 0
+        for (uint32_t i=0; i < DISTRHO_PLUGIN_NUM_OUTPUTS; ++i)
+        {
+            if (outputs[i] != nullptr)
+                AudioBufferOps::clear(outputs[i], frames);
+        }
+# else
+        // unused
+        (void)outputs;
+# endif
+
+        fOutputsSilent = true;
+        return true;
+    }
+#endif
+
+#if DISTRHO_PLUGIN_WANT_AUTOMATIC_BYPASS
+    // -------------------------------------------------------------------
+    // Automatic bypass
+    // When the bypass parameter is on, outputs crossfade to the inputs delayed by the plugin latency.
+    // Once fully bypassed, the plugin runs on silence until its tail is over and is then no longer called.
+
+# if DISTRHO_PLUGIN_WANT_DOUBLE_PRECISION
+    typedef double BypassSample;
+# else
+    typedef float BypassSample;
+# endif
+
+    uint32_t getBypassLatency() const noexcept
+    {
+# if DISTRHO_PLUGIN_WANT_LATENCY
+        return fData->latency;
+# else
+        return 0;
+# endif
+    }
+
+    // one delay line per input, plus a block of silence used as plugin input during its tail
+    // must not be called while processing, the delay lines are sized for the maximum latency set by the plugin
+    void resizeBypassBuffer()
+    {
+        if (fBypassIndex < 0)
+            return;
+
+# if DISTRHO_PLUGIN_WANT_MIDI_INPUT
+        if (fBypassSliceMidiEventCapacity < fData->midiEventCapacity)
+        {
+            delete[] fBypassSliceMidiEvents;
+            fBypassSliceMidiEvents = new MidiEvent[fData->midiEventCapacity];
+            fBypassSliceMidiEventCapacity = fData->midiEventCapacity;
+        }
+# endif
+
+# if DISTRHO_PLUGIN_WANT_LATENCY
+        const uint32_t maxLatency = std::max(fData->latency, fData->maxLatency);
+# else
+        static const uint32_t maxLatency = 0;
+# endif
+        const uint32_t minSize = maxLatency + std::max(fData->bufferSize, 1U);
+        uint32_t size = 1;
+
+        while (size < minSize)
+            size *= 2;
+
+        if (size <= fBypassBufferSize)
+            return;
+
+        delete[] fBypassBuffer;
+        fBypassBuffer = nullptr;
+        fBypassBufferSize = 0;
+
+        fBypassBuffer = new BypassSample[(DISTRHO_PLUGIN_NUM_INPUTS + 1) * size]();
+        fBypassBufferSize = size;
+        fBypassWritePos = 0;
+    }
+
+    // start in the current bypass state without any fade, called on activation
+    void resetBypass()
+    {
+        if (fBypassIndex < 0)
+            return;
+
+        resizeBypassBuffer();
+        resetBypassState();
+    }
+
+    // same as resetBypass() but keeps the current delay lines, so it does not allocate
+    void resetBypassState()
+    {
+        if (fBypassIndex < 0)
+            return;
+
+        if (fBypassBuffer != nullptr)
+            AudioBufferOps::clear(fBypassBuffer, DISTRHO_PLUGIN_NUM_INPUTS * fBypassBufferSize);
+
+        fBypassStopped = fBypassTarget;
+        fBypassMix = fBypassTarget ? 1.0f : 0.0f;
+        fBypassMixStep = static_cast<float>(1000.0 / (kBypassFadeTimeInMs * fData->sampleRate));
+        fBypassTailFrames = 0;
+        fBypassHoldFrames = fBypassTarget ? getBypassLatency() : 0;
+        fBypassWritePos = 0;
+    }
+
+    // returns false when not bypassed, so that the plugin is processed as usual
+    template <typename T>
+    bool runBypass(const T** const inputs, T** const outputs, const uint32_t frames,
+                   const MidiEvent* const midiEvents, const uint32_t midiEventCount)
+    {
+        if (fBypassIndex < 0 || fBypassBuffer == nullptr)
+            return false;
+
+        // keep recent input around for when bypass gets turned on
+        if (! fBypassTarget && fBypassMix == 0.0f)
+        {
+            if (getBypassLatency() != 0)
+                writeBypassInputs(inputs, frames);
+            return false;
+        }
+
+# if DISTRHO_PLUGIN_WANT_PARAMETER_EVENTS
+        ParameterEvent* const parameterEvents = fData->parameterEvents;
+        const uint32_t parameterEventCount = fData->parameterEventCount;
+# else
+        static ParameterEvent* const parameterEvents = nullptr;
+        static const uint32_t parameterEventCount = 0;
+# endif
+
+        // the delay line must hold a full block on top of the latency, otherwise the dry path is not aligned.
+        // a latency beyond the buffer size only happens without setMaxLatency(), it is caught up on the next activation.
+        const uint32_t latency = getBypassLatency();
+        const uint32_t maxFrames = latency < fBypassBufferSize ? fBypassBufferSize - latency : fBypassBufferSize / 2;
+
+        if (frames <= maxFrames)
+            runBypassBlock(inputs, outputs, frames, midiEvents, midiEventCount, parameterEvents, parameterEventCount);
+        else
+            runBypassSlices(inputs, outputs, frames, maxFrames, midiEvents, midiEventCount, parameterEvents, parameterEventCount);
+
+        return true;
+    }
+
+    // process a block that is too large for the delay line in slices, re-basing the events of each slice
+    template <typename T>
+    void runBypassSlices(const T** const inputs, T** const outputs, const uint32_t frames, const uint32_t maxFrames,
+                         const MidiEvent* const midiEvents, const uint32_t midiEventCount,
+                         ParameterEvent* const parameterEvents, const uint32_t parameterEventCount)
+    {
+# if DISTRHO_PLUGIN_NUM_INPUTS > 0
+        const T* sliceInputs[DISTRHO_PLUGIN_NUM_INPUTS];
+# else
+        const T** const sliceInputs = nullptr;
+# endif
+# if DISTRHO_PLUGIN_NUM_OUTPUTS > 0
+        T* sliceOutputs[DISTRHO_PLUGIN_NUM_OUTPUTS];
+# else
+        T** const sliceOutputs = nullptr;
+# endif
+# if DISTRHO_PLUGIN_WANT_MIDI_INPUT
+        MidiEvent* const sliceMidiEvents = fBypassSliceMidiEvents;
+        const uint32_t sliceMidiEventCapacity = fBypassSliceMidiEventCapacity;
+# else
+        static MidiEvent* const sliceMidiEvents = nullptr;
+        static const uint32_t sliceMidiEventCapacity = 0;
+# endif
+
+        uint32_t midiEventIndex = 0, parameterEventIndex = 0;
+        const uint32_t baseFrameOffset = fData->sliceFrameOffset;
+
+        for (uint32_t offset = 0, sliceFrames; offset < frames; offset += sliceFrames)
+        {
+            sliceFrames = std::min(frames - offset, maxFrames);
+            fData->sliceFrameOffset = baseFrameOffset + offset;
+
+# if DISTRHO_PLUGIN_NUM_INPUTS > 0
+            for (uint32_t i=0; i < DISTRHO_PLUGIN_NUM_INPUTS; ++i)
+                sliceInputs[i] = inputs[i] != nullptr ? inputs[i] + offset : nullptr;
+# endif
+# if DISTRHO_PLUGIN_NUM_OUTPUTS > 0
+            for (uint32_t i=0; i < DISTRHO_PLUGIN_NUM_OUTPUTS; ++i)
+                sliceOutputs[i] = outputs[i] != nullptr ? outputs[i] + offset : nullptr;
+# endif
+
+            const uint32_t firstParameterEventIndex = parameterEventIndex;
+            const uint32_t sliceMidiEventCount = rebaseSliceEvents(offset, sliceFrames, frames,
+                                                                   midiEvents, midiEventCount, midiEventIndex,
+                                                                   sliceMidiEvents, sliceMidiEventCapacity,
+                                                                   parameterEvents, parameterEventCount, parameterEventIndex);
+
+            runBypassBlock(sliceInputs, sliceOutputs, sliceFrames,
+                           sliceMidiEvents, sliceMidiEventCount,
+                           parameterEvents != nullptr ? parameterEvents + firstParameterEventIndex : nullptr,
+                           parameterEventIndex - firstParameterEventIndex);
+        }
+
+        fData->sliceFrameOffset = baseFrameOffset;
+    }
+
+    template <typename T>
+    void runBypassBlock(const T** const inputs, T** const outputs, const uint32_t frames,
+                        const MidiEvent* const midiEvents, const uint32_t midiEventCount,
+                        ParameterEvent* const parameterEvents, const uint32_t parameterEventCount)
+    {
+        fInputsSilent = false;
+        fOutputsSilent = false;
+
+        // must be done before running the plugin, as inputs and outputs might share memory
+        writeBypassInputs(inputs, frames);
+
+        if (fBypassStopped && ! fBypassTarget)
+        {
+            fBypassStopped = false;
+            fSilentFrames = 0;
+        }
+
+        if (fBypassStopped)
+        {
+            // plugin is not running, outputs only get the inputs
+        }
+        else if (fBypassMix < 1.0f || ! fBypassTarget)
+        {
+            processBlock(inputs, outputs, frames, midiEvents, midiEventCount, parameterEvents, parameterEventCount);
+        }
+        else
+        {
+            // plugin output is not heard anymore, let it decay on silent input
+            const T* const silence = reinterpret_cast<const T*>(fBypassBuffer
+                                                                + DISTRHO_PLUGIN_NUM_INPUTS * fBypassBufferSize);
+# if DISTRHO_PLUGIN_NUM_INPUTS > 0
+            const T* silentInputs[DISTRHO_PLUGIN_NUM_INPUTS];
+
+            for (uint32_t i=0; i < DISTRHO_PLUGIN_NUM_INPUTS; ++i)
+                silentInputs[i] = silence;
+# else
+            const T** const silentInputs = nullptr;
+            // unused
+            (void)silence;
+# endif
+
+            // first block after the fade, an infinite tail means the plugin stops right after it
+            const bool firstTailBlock = fBypassTailFrames == kTailLengthInfinite;
+
+            if (firstTailBlock)
+            {
+                fBypassTailFrames = fPlugin->getTailLength();
+
+                if (fBypassTailFrames == kTailLengthInfinite)
+                    fBypassTailFrames = 0;
+            }
+
+# if DISTRHO_PLUGIN_WANT_MIDI_INPUT
+            // release all notes, so none are left hanging when the plugin runs again
+            if (firstTailBlock)
+                processBlock(silentInputs, outputs, frames, fBypassMidiEvents, kBypassMidiEventCount,
+                             parameterEvents, parameterEventCount);
+            else
+# endif
+            processBlock(silentInputs, outputs, frames, nullptr, 0, parameterEvents, parameterEventCount);
+
+            if (fBypassTailFrames > frames)
+            {
+                fBypassTailFrames -= frames;
+            }
+            else
+            {
+                fBypassTailFrames = 0;
+                fBypassStopped = true;
+            }
+        }
+
+        mixBypassInputs(outputs, frames);
+    }
+
+    template <typename T>
+    void writeBypassInputs(const T** const inputs, const uint32_t frames)
+    {
+        const uint32_t size = fBypassBufferSize;
+        const uint32_t writePos = fBypassWritePos;
+
+# if DISTRHO_PLUGIN_NUM_INPUTS > 0
+        // only the most recent frames fit when the block is larger than the delay line
+        const uint32_t skip = frames > size ? frames - size : 0;
+        const uint32_t startPos = (writePos + skip) & (size - 1);
+        const uint32_t writeFrames = frames - skip;
+        const uint32_t firstFrames = std::min(writeFrames, size - startPos);
+
+        for (uint32_t i=0; i < DISTRHO_PLUGIN_NUM_INPUTS; ++i)
+        {
+            BypassSample* const buffer = fBypassBuffer + i * size;
+
+            if (inputs[i] == nullptr)
+            {
+                AudioBufferOps::clear(buffer + startPos, firstFrames);
+                AudioBufferOps::clear(buffer, writeFrames - firstFrames);
+                continue;
+            }
+
+            AudioBufferOps::convert(buffer + startPos, inputs[i] + skip, firstFrames);
+            AudioBufferOps::convert(buffer, inputs[i] + skip + firstFrames, writeFrames - firstFrames);
+        }
+# else
+        // unused
+        (void)inputs;
+# endif
+
+        fBypassWritePos = (writePos + frames) & (size - 1);
+    }
+
+    // crossfade plugin outputs towards the delayed inputs, missing inputs count as silence
+    template <typename T>
+    void mixBypassInputs(T** const outputs, const uint32_t frames)
+    {
+        const uint32_t size = fBypassBufferSize;
+        const uint32_t mask = size - 1;
+        const uint32_t delay = std::min(getBypassLatency(), size - frames);
+        const uint32_t readPos = (fBypassWritePos - frames - delay) & mask;
+        const float step = fBypassTarget ? fBypassMixStep : -fBypassMixStep;
+        const bool fullyBypassed = fBypassTarget && fBypassMix >= 1.0f;
+
+        // when resuming, wait for the plugin latency to fill with new audio before fading in
+        const uint32_t holdFrames = fBypassTarget ? 0 : std::min(fBypassHoldFrames, frames);
+
+# if DISTRHO_PLUGIN_NUM_OUTPUTS > 0
+        for (uint32_t i=0; i < DISTRHO_PLUGIN_NUM_OUTPUTS; ++i)
+        {
+            T* const output = outputs[i];
+
+            if (output == nullptr)
+                continue;
+
+#  if DISTRHO_PLUGIN_NUM_INPUTS > 0
+            const BypassSample* const buffer = i < DISTRHO_PLUGIN_NUM_INPUTS ? fBypassBuffer + i * size : nullptr;
+#  else
+            static const BypassSample* const buffer = nullptr;
+#  endif
+
+            if (fullyBypassed)
+            {
+                if (buffer != nullptr)
+                {
+                    const uint32_t firstFrames = std::min(frames, size - readPos);
+                    AudioBufferOps::convert(output, buffer + readPos, firstFrames);
+                    AudioBufferOps::convert(output + firstFrames, buffer, frames - firstFrames);
+                }
+                else
+                {
+                    AudioBufferOps::clear(output, frames);
+                }
+                continue;
+            }
+
+            float mix = fBypassMix;
+
+            for (uint32_t j=0; j < frames; ++j)
+            {
+                if (j >= holdFrames)
+                    mix = std::max(0.0f, std::min(1.0f, mix + step));
+
+                const T input = buffer != nullptr ? static_cast<T>(buffer[(readPos + j) & mask]) : T(0);
+                output[j] += (input - output[j]) * mix;
+            }
+        }
+# else
+        // unused
+        (void)outputs;
+        (void)readPos;
+# endif
+
+        if (fullyBypassed)
+            return;
+
+        fBypassMix = std::max(0.0f, std::min(1.0f, fBypassMix + step * static_cast<float>(frames - holdFrames)));
+        fBypassHoldFrames -= holdFrames;
+
+        // fade is complete, the tail starts on the next block
+        if (fBypassMix >= 1.0f)
+        {
+            fBypassTailFrames = kTailLengthInfinite;
+            fBypassHoldFrames = getBypassLatency();
+        }
+    }
+#endif
+
+#if ! DISTRHO_PLUGIN_WANT_OUTPUT_PARAMETER_CHANGES
+    // the plugin does not report output changes, compare their values after each run
+    void checkOutputParameterChanges()
+    {
+        float value;
+
+        for (uint32_t i=0, index; i < fData->outputParameterCount; ++i)
+        {
+            index = fData->outputParameterIndices[i];
+            value = fPlugin->getParameterValue(index);
+
+            if (d_isEqual(fData->lastOutputParameterValues[i], value))
+                continue;
+
+            fData->lastOutputParameterValues[i] = value;
+            fData->changedOutputParameters.set(index);
+        }
+    }
+#endif
+
+    template <typename T>
+    void runPlugin(const T** const inputs, T** const outputs, const uint32_t frames,
+                   const MidiEvent* const midiEvents, const uint32_t midiEventCount,
+                   const ParameterEvent* const parameterEvents, const uint32_t parameterEventCount)
+    {
+#if DISTRHO_PLUGIN_WANT_PARAMETER_EVENTS
+# if DISTRHO_PLUGIN_WANT_MIDI_INPUT
+        fPlugin->run(inputs, outputs, frames, midiEvents, midiEventCount, parameterEvents, parameterEventCount);
+# else
+        fPlugin->run(inputs, outputs, frames, parameterEvents, parameterEventCount);
+        // unused
+        (void)midiEvents;
+        (void)midiEventCount;
+# endif
+#else
+# if DISTRHO_PLUGIN_WANT_MIDI_INPUT
+        fPlugin->run(inputs, outputs, frames, midiEvents, midiEventCount);
+# else
+        fPlugin->run(inputs, outputs, frames);
+        // unused
+        (void)midiEvents;
+        (void)midiEventCount;
+# endif
+        // unused
+        (void)parameterEvents;
+        (void)parameterEventCount;
+#endif
+    }
+
+#if DISTRHO_PLUGIN_WANT_DOUBLE_PRECISION
+    // conversion shim for formats that only provide single-precision buffers
+    void runPlugin(const float** const inputs, float** const outputs, const uint32_t frames,
+                   const MidiEvent* const midiEvents, const uint32_t midiEventCount,
+                   const ParameterEvent* const parameterEvents, const uint32_t parameterEventCount)
+    {
+        const uint32_t bufferSize = fData->doubleBufferSize;
+        DISTRHO_SAFE_ASSERT_RETURN(bufferSize != 0,);
+
+        if (frames > bufferSize)
+            return runSubBlocks(inputs, outputs, frames, bufferSize,
+                                midiEvents, midiEventCount,
+                                const_cast<ParameterEvent*>(parameterEvents), parameterEventCount);
+
+# if DISTRHO_PLUGIN_NUM_INPUTS > 0
+        const double* doubleInputs[DISTRHO_PLUGIN_NUM_INPUTS];
+
+        for (uint32_t i=0; i < DISTRHO_PLUGIN_NUM_INPUTS; ++i)
+        {
+            double* const doubleInput = fData->doubleBuffer + i * bufferSize;
+
+            if (inputs[i] != nullptr)
+                AudioBufferOps::convert(doubleInput, inputs[i], frames);
+            else
+                AudioBufferOps::clear(doubleInput, frames);
+
+            doubleInputs[i] = doubleInput;
+        }
+# else
+        const double** const doubleInputs = nullptr;
+        // unused
+        (void)inputs;
+# endif
+
+# if DISTRHO_PLUGIN_NUM_OUTPUTS > 0
+        double* doubleOutputs[DISTRHO_PLUGIN_NUM_OUTPUTS];
+
+        for (uint32_t i=0; i < DISTRHO_PLUGIN_NUM_OUTPUTS; ++i)
+            doubleOutputs[i] = fData->doubleBuffer + (DISTRHO_PLUGIN_NUM_INPUTS + i) * bufferSize;
+# else
+        double** const doubleOutputs = nullptr;
+# endif
+
+        runPlugin(doubleInputs, doubleOutputs, frames, midiEvents, midiEventCount, parameterEvents, parameterEventCount);
+
+# if DISTRHO_PLUGIN_NUM_OUTPUTS > 0
+        for (uint32_t i=0; i < DISTRHO_PLUGIN_NUM_OUTPUTS; ++i)
+        {
+            if (outputs[i] == nullptr)
+                continue;
+
+            AudioBufferOps::convert(outputs[i], doubleOutputs[i], frames);
+        }
+# else
+        // unused
+        (void)outputs;
+# endif
+    }
+
+    void resizeDoubleBuffer(uint32_t bufferSize)
+    {
+# if DISTRHO_PLUGIN_MAX_SUBBLOCK_SIZE > 0
+        // sub-blocks must always fit, so that they are never split again
+        bufferSize = std::max(bufferSize, static_cast<uint32_t>(DISTRHO_PLUGIN_MAX_SUBBLOCK_SIZE));
+# endif
+
+        if (fData->doubleBufferSize >= bufferSize)
+            return;
+
+        delete[] fData->doubleBuffer;
+        fData->doubleBuffer = nullptr;
+        fData->doubleBufferSize = 0;
+
+        if (const uint32_t channels = DISTRHO_PLUGIN_NUM_INPUTS + DISTRHO_PLUGIN_NUM_OUTPUTS)
+            fData->doubleBuffer = new double[channels * bufferSize];
+
+        fData->doubleBufferSize = bufferSize;
+    }
+#endif
+
+#if DISTRHO_PLUGIN_WANT_PARAMETER_EVENTS
+    void clearParameterEvents() noexcept
+    {
+        // only the parameters that have queued events need their count reset
+        for (uint32_t i=0, count=fData->parameterEventCount; i<count; ++i)
+            fData->parameterEventQueued[fData->parameterEvents[i].index] = 0;
+
+        fData->parameterEventCount = 0;
+        fData->parameterEventRequestCount = 0;
+    }
+
+    // the pool is full, make room by dropping the earliest event that a later event of the same parameter overrides.
+    // this loses an intermediate automation point but keeps the last value of every parameter.
+    // returns false if the new event is the one to drop
+    bool dropSupersededParameterEvent(const uint32_t frame, const uint32_t index) noexcept
+    {
+        ParameterEvent* const events = fData->parameterEvents;
+        uint32_t* const queued = fData->parameterEventQueued;
+        const uint32_t count = fData->parameterEventCount;
+
+        // the new event goes after all queued events up to its frame
+        uint32_t newPos = count;
+        while (newPos != 0 && events[newPos-1].frame > frame)
+            --newPos;
+
+        // walk forwards, the first event whose parameter has more events queued is superseded
+        for (uint32_t pos = 0; pos < count; ++pos)
+        {
+            // only later events of the same parameter are left, so the new event is superseded
+            if (pos == newPos && queued[index] != 0)
+                return false;
+
+            const uint32_t eventIndex = events[pos].index;
+
+            if (queued[eventIndex] + (eventIndex == index ? 1 : 0) < 2)
+                continue;
+
+            --queued[eventIndex];
+            std::memmove(events + pos, events + pos + 1, sizeof(ParameterEvent)*(count - pos - 1));
+            --fData->parameterEventCount;
+            return true;
+        }
+
+        return false;
+    }
+
+    // grow the parameter event pool to the highest number of events seen in a single run, must not be called while running
+    void growParameterEventPoolIfNeeded()
+    {
+        if (fData->parameterEventPeakCount <= fData->parameterEventCapacity)
+            return;
+
+        const uint32_t capacity = fData->parameterEventPeakCount;
+
+        clearParameterEvents();
+
+        delete[] fData->parameterEvents;
+        fData->parameterEvents = new ParameterEvent[capacity];
+        fData->parameterEventCapacity = capacity;
+    }
+#endif
+
+#if DISTRHO_PLUGIN_WANT_MIDI_INPUT
+    // double the MIDI event pool after an overflow, must not be called while active
+    void growMidiEventPoolIfNeeded()
+    {
+        if (! fData->midiEventPoolTooSmall || fData->midiEventCapacity >= kMaxMidiEventCapacity)
+            return;
+
+        const uint32_t capacity = std::min(fData->midiEventCapacity * 2, kMaxMidiEventCapacity);
+
+        delete[] fData->midiEvents;
+        fData->midiEvents = new MidiEvent[capacity];
+
+# if DISTRHO_PLUGIN_MAX_SUBBLOCK_SIZE > 0 || DISTRHO_PLUGIN_WANT_DOUBLE_PRECISION
+        delete[] fData->subBlockMidiEvents;
+        fData->subBlockMidiEvents = new MidiEvent[capacity];
+# endif
+
+        fData->midiEventCapacity = capacity;
+        fData->midiEventPoolTooSmall = false;
+    }
+#endif
+
+#if DISTRHO_PLUGIN_MAX_SUBBLOCK_SIZE > 0 || DISTRHO_PLUGIN_WANT_DOUBLE_PRECISION
+    // split a host block into slices of at most maxFrames
+    template <typename T>
+    void runSubBlocks(const T** const inputs, T** const outputs, const uint32_t frames, const uint32_t maxFrames,
+                      const MidiEvent* const midiEvents, const uint32_t midiEventCount,
+                      ParameterEvent* const parameterEvents, const uint32_t parameterEventCount)
+    {
+# if DISTRHO_PLUGIN_NUM_INPUTS > 0
+        const T* subInputs[DISTRHO_PLUGIN_NUM_INPUTS];
+# else
+        const T** const subInputs = nullptr;
+        // unused
+        (void)inputs;
+# endif
+# if DISTRHO_PLUGIN_NUM_OUTPUTS > 0
+        T* subOutputs[DISTRHO_PLUGIN_NUM_OUTPUTS];
+# else
+        T** const subOutputs = nullptr;
+        // unused
+        (void)outputs;
+# endif
+
+# if DISTRHO_PLUGIN_WANT_MIDI_INPUT
+        const uint32_t subMidiEventCapacity = fData->midiEventCapacity;
+# else
+        static const uint32_t subMidiEventCapacity = 0;
+# endif
+
+        uint32_t midiEventIndex = 0, parameterEventIndex = 0;
+
+        // slices can be nested (bypass, sub-blocks and double-precision), offsets add up
+        const uint32_t baseFrameOffset = fData->sliceFrameOffset;
+
+        for (uint32_t offset = 0, subFrames; offset < frames; offset += subFrames)
+        {
+            subFrames = std::min(frames - offset, maxFrames);
+            fData->sliceFrameOffset = baseFrameOffset + offset;
+
+# if DISTRHO_PLUGIN_NUM_INPUTS > 0
+            for (uint32_t i=0; i < DISTRHO_PLUGIN_NUM_INPUTS; ++i)
+                subInputs[i] = inputs[i] != nullptr ? inputs[i] + offset : nullptr;
+# endif
+# if DISTRHO_PLUGIN_NUM_OUTPUTS > 0
+            for (uint32_t i=0; i < DISTRHO_PLUGIN_NUM_OUTPUTS; ++i)
+                subOutputs[i] = outputs[i] != nullptr ? outputs[i] + offset : nullptr;
+# endif
+
+            const uint32_t firstParameterEventIndex = parameterEventIndex;
+            const uint32_t subMidiEventCount = rebaseSliceEvents(offset, subFrames, frames,
+                                                                 midiEvents, midiEventCount, midiEventIndex,
+                                                                 fData->subBlockMidiEvents, subMidiEventCapacity,
+                                                                 parameterEvents, parameterEventCount, parameterEventIndex);
+
+            runPlugin(subInputs, subOutputs, subFrames,
+                      fData->subBlockMidiEvents, subMidiEventCount,
+                      parameterEvents != nullptr ? parameterEvents + firstParameterEventIndex : nullptr,
+                      parameterEventIndex - firstParameterEventIndex);
+        }
+
+        fData->sliceFrameOffset = baseFrameOffset;
+    }
+#endif
+
+    // Re-base the events of the slice starting at @a offset to the slice start, used when splitting blocks.
+    // MIDI events are copied into @a sliceMidiEvents, parameter events are owned by us and re-based in place.
+    // Both indices advance past the events of this slice, anything past the block end goes into the last slice.
+    // Returns the number of MIDI events in the slice.
+    static uint32_t rebaseSliceEvents(const uint32_t offset, const uint32_t sliceFrames, const uint32_t frames,
+                                      const MidiEvent* const midiEvents, const uint32_t midiEventCount,
+                                      uint32_t& midiEventIndex,
+                                      MidiEvent* const sliceMidiEvents, const uint32_t sliceMidiEventCapacity,
+                                      ParameterEvent* const parameterEvents, const uint32_t parameterEventCount,
+                                      uint32_t& parameterEventIndex) noexcept
+    {
+        const uint32_t sliceEnd = offset + sliceFrames;
+        const bool lastSlice = sliceEnd == frames;
+        uint32_t sliceMidiEventCount = 0;
+
+        for (; midiEventIndex < midiEventCount; ++midiEventIndex)
+        {
+            const MidiEvent& midiEvent(midiEvents[midiEventIndex]);
+
+            if (midiEvent.frame >= sliceEnd && ! lastSlice)
+                break;
+            if (sliceMidiEventCount == sliceMidiEventCapacity)
+                continue;
+
+            MidiEvent& sliceMidiEvent(sliceMidiEvents[sliceMidiEventCount++]);
+            std::memcpy(&sliceMidiEvent, &midiEvent, sizeof(MidiEvent));
+            sliceMidiEvent.frame = midiEvent.frame >= offset ? std::min(midiEvent.frame, sliceEnd - 1) - offset : 0;
+        }
+
+        for (; parameterEventIndex < parameterEventCount; ++parameterEventIndex)
+        {
+            ParameterEvent& parameterEvent(parameterEvents[parameterEventIndex]);
+
+            if (parameterEvent.frame >= sliceEnd && ! lastSlice)
+                break;
+
+            parameterEvent.frame = parameterEvent.frame >= offset
+                                 ? std::min(parameterEvent.frame, sliceEnd - 1) - offset
+                                 : 0;
+        }
+
+        return sliceMidiEventCount;
+    }
+
+#if DISTRHO_PLUGIN_WANT_WORKER
+    // -------------------------------------------------------------------
+    // Worker thread, used when the host does not provide one
+
+    class Worker : public Thread
+    {
+    public:
+        Worker(PluginExporter* const exporter)
+            : Thread("DPF Worker"),
+              fExporter(exporter),
+              fSemaphore(),
+              fRequests(),
+              fResponses(),
+              fRequestData(new uint8_t[kMaxWorkDataSize]),
+              fResponseData(new uint8_t[kMaxWorkDataSize])
+        {
+            fRequests.createBuffer(kWorkQueueSize);
+            fResponses.createBuffer(kWorkQueueSize);
+        }
+
+        ~Worker() override
+        {
+            signalThreadShouldExit();
+            fSemaphore.post();
+            stopThread(-1);
+
+            delete[] fRequestData;
+            delete[] fResponseData;
+        }
+
+        void start()
+        {
+            if (! isThreadRunning())
+                startThread();
+        }
+
+        // called from the audio thread before each run
+        void deliverResponses()
+        {
+            for (uint32_t size; readMessage(fResponses, fResponseData, size);)
+                fExporter->workResponse(fResponseData, size);
+        }
+
+        static bool scheduleWorkCallback(void* const ptr, const void* const data, const uint32_t size)
+        {
+            Worker* const worker = (Worker*)ptr;
+
+            if (! writeMessage(worker->fRequests, data, size))
+                return false;
+
+            // posting a semaphore does not lock, unlike Signal
+            worker->fSemaphore.post();
+            return true;
+        }
+
+        static bool writeWorkResponseCallback(void* const ptr, const void* const data, const uint32_t size)
+        {
+            return writeMessage(((Worker*)ptr)->fResponses, data, size);
+        }
+
+    protected:
+        void run() override
+        {
+            while (! shouldThreadExit())
+            {
+                fSemaphore.wait();
+
+                for (uint32_t size; readMessage(fRequests, fRequestData, size);)
+                    fExporter->work(fRequestData, size, writeWorkResponseCallback, this);
+            }
+        }
+
+    private:
+        PluginExporter* const fExporter;
+        Semaphore fSemaphore;
+        HeapRingBuffer fRequests;
+        HeapRingBuffer fResponses;
+        uint8_t* const fRequestData;
+        uint8_t* const fResponseData;
+
+        static bool writeMessage(HeapRingBuffer& ringBuffer, const void* const data, const uint32_t size)
+        {
+            DISTRHO_SAFE_ASSERT_UINT2_RETURN(size <= kMaxWorkDataSize, size, kMaxWorkDataSize, false);
+
+            const bool written = ringBuffer.writeUInt(size) && ringBuffer.writeCustomData(data, size);
+
+            // always commit, this resets the ring buffer state after a failed write
+            return ringBuffer.commitWrite() && written;
+        }
+
+        static bool readMessage(HeapRingBuffer& ringBuffer, uint8_t* const data, uint32_t& size)
+        {
+            while (ringBuffer.isDataAvailableForReading())
+            {
+                size = ringBuffer.readUInt();
+
+                if (size != 0 && size <= kMaxWorkDataSize)
+                    return ringBuffer.readCustomData(data, size);
+
+                d_stderr2("Worker message with invalid size %u, skipped", size);
+
+                // skip the whole record so that the next one is read from the right place,
+                // if it cannot be skipped the queue is out of sync and everything in it is dropped
+                const uint32_t readable = ringBuffer.getReadableDataSize();
+
+                if (size == 0 || size > readable)
+                {
+                    if (readable != 0)
+                        ringBuffer.consumeRead(readable);
+                    return false;
+                }
+
+                ringBuffer.consumeRead(size);
+            }
+
+            return false;
+        }
+
+        DISTRHO_DECLARE_NON_COPYABLE(Worker)
+    };
+#endif
+
+    // -------------------------------------------------------------------
+    // Plugin and DistrhoPlugin data
+
+    Plugin* const fPlugin;
+    Plugin::PrivateData* const fData;
+#if DISTRHO_PLUGIN_WANT_WORKER
+    Worker* fWorker;
+#endif
+    bool fIsActive;
+    bool fInputsSilent;
+    bool fOutputsSilent;
+    uint32_t fSilentFrames;
+
+#if DISTRHO_PLUGIN_WANT_AUTOMATIC_BYPASS
+    int32_t fBypassIndex;
+    bool fBypassTarget;
+    bool fBypassStopped;
+    float fBypassMix;      // 0 is processed, 1 is bypassed
+    float fBypassMixStep;
+    uint32_t fBypassTailFrames;
+    uint32_t fBypassHoldFrames;
+    BypassSample* fBypassBuffer;
+    uint32_t fBypassBufferSize;
+    uint32_t fBypassWritePos;
+# if DISTRHO_PLUGIN_WANT_MIDI_INPUT
+    static const uint32_t kBypassMidiEventCount = 32;
+    MidiEvent fBypassMidiEvents[kBypassMidiEventCount];
+    // MIDI events of the current slice, when a block is too large for the delay line
+    MidiEvent* fBypassSliceMidiEvents;
+    uint32_t fBypassSliceMidiEventCapacity;
+# endif
+#endif
+
+    // -------------------------------------------------------------------
+    // Static fallback data, see DistrhoPlugin.cpp
+
+    static const String                     sFallbackString;
+    static const AudioPort                  sFallbackAudioPort;
+    static const ParameterRanges            sFallbackRanges;
+    static const ParameterEnumerationValues sFallbackEnumValues;
+    static const PortGroupWithId            sFallbackPortGroup;
+
+    DISTRHO_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PluginExporter)
+#if !defined(DISTRHO_PLUGIN_TARGET_VST3) && !defined(DISTRHO_PLUGIN_TARGET_CLAP) /* there is no way around this for VST3 and CLAP */
+    DISTRHO_PREVENT_HEAP_ALLOCATION
+#endif
+};
+
+#if DISTRHO_PLUGIN_WANT_STATE
+// -----------------------------------------------------------------------
+// Plugin state storage, shared by the wrappers that keep a copy of the state values
+
+/**
+   Current state values stored by index, in the same order as the plugin states.
+   Keys are resolved through the plugin's state key table, so lookups and updates are O(1).
+   Also keeps track of which states still need to be sent to the UI,
+   and a generation counter per state that changes every time its value is set.
+ */
+class PluginStateStore
+{
+public:
+    PluginStateStore() noexcept
+        : fPlugin(nullptr),
+          fValues(nullptr),
+          fGenerations(nullptr),
+          fCount(0) {}
+
+    ~PluginStateStore() noexcept
+    {
+        if (fValues != nullptr)
+        {
+            delete[] fValues;
+            fValues = nullptr;
+        }
+
+        if (fGenerations != nullptr)
+        {
+            delete[] fGenerations;
+            fGenerations = nullptr;
+        }
+    }
+
+    void init(const PluginExporter& plugin)
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(fPlugin == nullptr,);
+
+        fPlugin = &plugin;
+        fCount  = plugin.getStateCount();
+
+        if (fCount == 0)
+            return;
+
+        fValues = new String[fCount];
+        fGenerations = new uint32_t[fCount];
+
+        for (uint32_t i=0; i < fCount; ++i)
+        {
+            fValues[i] = plugin.getStateDefaultValue(i);
+            fGenerations[i] = 0;
+        }
+
+        fNeededUiSends.init(fCount);
+    }
+
+    uint32_t getCount() const noexcept
+    {
+        return fCount;
+    }
+
+    const String& getKey(const uint32_t index) const noexcept
+    {
+        return fPlugin->getStateKey(index);
+    }
+
+    const String& getValue(const uint32_t index) const noexcept
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(index < fCount, fPlugin->getStateDefaultValue(index));
+
+        return fValues[index];
+    }
+
+   /**
+      Get the generation of the state at @a index.
+      Compare with a previous generation to know if the value was set in the meantime,
+      even if the new value has the same size.
+    */
+    uint32_t getGeneration(const uint32_t index) const noexcept
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(index < fCount, 0);
+
+        return fGenerations[index];
+    }
+
+    void setValue(const uint32_t index, const char* const value)
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(index < fCount,);
+
+        fValues[index] = value;
+        ++fGenerations[index];
+    }
+
+   /**
+      Store @a value for the state matching @a key.
+      Returns the state index, or -1 if the plugin has no such state.
+    */
+    int32_t setValue(const char* const key, const char* const value)
+    {
+        const int32_t index = fPlugin->getStateIndex(key);
+
+        if (index >= 0)
+        {
+            fValues[index] = value;
+            ++fGenerations[index];
+        }
+
+        return index;
+    }
+
+# if DISTRHO_PLUGIN_WANT_FULL_STATE
+    // Update current state values from the plugin side
+    void updateFromPlugin()
+    {
+        for (uint32_t i=0; i < fCount; ++i)
+        {
+            const String value(fPlugin->getState(fPlugin->getStateKey(i)));
+
+            if (fValues[i] == value)
+                continue;
+
+            fValues[i] = value;
+            ++fGenerations[i];
+        }
+    }
+# endif
+
+    void setNeedsUiSend(const uint32_t index) noexcept
+    {
+        fNeededUiSends.set(index);
+    }
+
+    void setAllNeedUiSend() noexcept
+    {
+        for (uint32_t i=0; i < fCount; ++i)
+            fNeededUiSends.set(i);
+    }
+
+   /**
+      Take the next state that needs to be sent to the UI, starting from @a index (inclusive).
+    */
+    bool takeNextUiSend(uint32_t& index) noexcept
+    {
+        return fNeededUiSends.takeNext(index);
+    }
+
+private:
+    const PluginExporter* fPlugin;
+    String*   fValues;
+    uint32_t* fGenerations;
+    uint32_t  fCount;
+    ParameterBitSet fNeededUiSends;
+
+    DISTRHO_DECLARE_NON_COPYABLE(PluginStateStore)
+};
 #endif
-};
 
 // -----------------------------------------------------------------------
 
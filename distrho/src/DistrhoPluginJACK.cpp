@@ -18,7 +18,7 @@
 
 #if DISTRHO_PLUGIN_HAS_UI
 # include "DistrhoUIInternal.hpp"
-# include "../extra/RingBuffer.hpp"
+# include "../extra/MessageQueue.hpp"
 #else
 # include "../extra/Sleep.hpp"
 #endif
@@ -126,7 +126,8 @@ public:
               fPlugin.getInstancePointer(),
               0.0),
 #endif
-          fClient(client)
+          fClient(client),
+          fFreewheel(false)
     {
 #if DISTRHO_PLUGIN_NUM_INPUTS > 0 || DISTRHO_PLUGIN_NUM_OUTPUTS > 0
         char strBuf[0xff+1];
@@ -171,34 +172,22 @@ public:
 # endif
 #endif
 
+#if DISTRHO_PLUGIN_HAS_UI
         if (const uint32_t count = fPlugin.getParameterCount())
         {
-            fLastOutputValues = new float[count];
-            std::memset(fLastOutputValues, 0, sizeof(float)*count);
-
-#if DISTRHO_PLUGIN_HAS_UI
-            fParametersChanged = new bool[count];
-            std::memset(fParametersChanged, 0, sizeof(bool)*count);
-#endif
+            fParametersChanged.init(count);
 
             for (uint32_t i=0; i < count; ++i)
             {
-#if DISTRHO_PLUGIN_HAS_UI
                 if (! fPlugin.isParameterOutput(i))
                     fUI.parameterChanged(i, fPlugin.getParameterValue(i));
-#endif
             }
         }
-        else
-        {
-            fLastOutputValues = nullptr;
-#if DISTRHO_PLUGIN_HAS_UI
-            fParametersChanged = nullptr;
 #endif
-        }
 
         jackbridge_set_buffer_size_callback(fClient, jackBufferSizeCallback, this);
         jackbridge_set_sample_rate_callback(fClient, jackSampleRateCallback, this);
+        jackbridge_set_freewheel_callback(fClient, jackFreewheelCallback, this);
         jackbridge_set_process_callback(fClient, jackProcessCallback, this);
         jackbridge_on_shutdown(fClient, jackShutdownCallback, this);
 
@@ -226,20 +215,6 @@ public:
         if (fClient != nullptr)
             jackbridge_deactivate(fClient);
 
-        if (fLastOutputValues != nullptr)
-        {
-            delete[] fLastOutputValues;
-            fLastOutputValues = nullptr;
-        }
-
-#if DISTRHO_PLUGIN_HAS_UI
-        if (fParametersChanged != nullptr)
-        {
-            delete[] fParametersChanged;
-            fParametersChanged = nullptr;
-        }
-#endif
-
         fPlugin.deactivate();
 
         if (fClient == nullptr)
@@ -272,6 +247,12 @@ public:
         jackbridge_client_close(fClient);
     }
 
+    // JACK servers normally use powers of 2, but some setups (like PipeWire) do not
+    static uint32_t getBlockSizeHints(const uint32_t bufferSize) noexcept
+    {
+        return bufferSize != 0 && d_nextPowerOf2(bufferSize) == bufferSize ? kBlockSizeIsPowerOf2 : 0x0;
+    }
+
     // -------------------------------------------------------------------
 
 protected:
@@ -289,24 +270,11 @@ protected:
         }
 # endif
 
-        for (uint32_t i=0, count=fPlugin.getParameterCount(); i < count; ++i)
-        {
-            if (fPlugin.isParameterOutput(i))
-            {
-                const float value = fPlugin.getParameterValue(i);
-
-                if (d_isEqual(fLastOutputValues[i], value))
-                    continue;
+        for (uint32_t i=0; fPlugin.takeNextChangedOutputParameter(i); ++i)
+            fUI.parameterChanged(i, fPlugin.getParameterValue(i));
 
-                fLastOutputValues[i] = value;
-                fUI.parameterChanged(i, value);
-            }
-            else if (fParametersChanged[i])
-            {
-                fParametersChanged[i] = false;
-                fUI.parameterChanged(i, fPlugin.getParameterValue(i));
-            }
-        }
+        for (uint32_t i=0; fParametersChanged.takeNext(i); ++i)
+            fUI.parameterChanged(i, fPlugin.getParameterValue(i));
 
         fUI.exec_idle();
     }
@@ -314,6 +282,7 @@ protected:
 
     void jackBufferSize(const jack_nframes_t nframes)
     {
+        fPlugin.setBlockSizeHints(getBlockSizeHints(nframes));
         fPlugin.setBufferSize(nframes, true);
     }
 
@@ -322,8 +291,16 @@ protected:
         fPlugin.setSampleRate(nframes, true);
     }
 
+    void jackFreewheel(const bool starting)
+    {
+        // applied on the next process call, so the plugin sees it from the audio thread
+        fFreewheel = starting;
+    }
+
     void jackProcess(const jack_nframes_t nframes)
     {
+        fPlugin.setOfflineRendering(fFreewheel);
+
 #if DISTRHO_PLUGIN_NUM_INPUTS > 0
         const float* audioIns[DISTRHO_PLUGIN_NUM_INPUTS];
 
@@ -391,32 +368,19 @@ protected:
 #endif
 
 #if DISTRHO_PLUGIN_WANT_MIDI_INPUT
-        uint32_t  midiEventCount = 0;
-        MidiEvent midiEvents[512];
+        MidiEvent* const midiEvents = fPlugin.getMidiEventBuffer();
+        const uint32_t midiEventCapacity = fPlugin.getMidiEventCapacity();
+        uint32_t midiEventCount = 0;
 
 # if DISTRHO_PLUGIN_HAS_UI
-        while (fNotesRingBuffer.isDataAvailableForReading())
-        {
-            uint8_t midiData[3];
-            if (! fNotesRingBuffer.readCustomData(midiData, 3))
-                break;
-
-            MidiEvent& midiEvent(midiEvents[midiEventCount++]);
-            midiEvent.frame = 0;
-            midiEvent.size  = 3;
-            std::memcpy(midiEvent.data, midiData, 3);
-
-            if (midiEventCount == 512)
-                break;
-        }
+        // notes from the UI are queued with frame 0, copy them as-is
+        midiEventCount = fNotesQueue.popBatch(midiEvents, midiEventCapacity);
 # endif
-#else
-        static const uint32_t midiEventCount = 0;
 #endif
 
         void* const midiInBuf = jackbridge_port_get_buffer(fPortEventsIn, nframes);
 
-        if (const uint32_t eventCount = std::min(512u - midiEventCount, jackbridge_midi_get_event_count(midiInBuf)))
+        if (const uint32_t eventCount = jackbridge_midi_get_event_count(midiInBuf))
         {
             jack_midi_event_t jevent;
 
@@ -443,8 +407,11 @@ protected:
                         const float scaled = static_cast<float>(value)/127.0f;
                         const float fvalue = fPlugin.getParameterRanges(j).getUnnormalizedValue(scaled);
                         fPlugin.setParameterValue(j, fvalue);
+#if DISTRHO_PLUGIN_WANT_PARAMETER_EVENTS
+                        fPlugin.addParameterEvent(jevent.time, j, fvalue);
+#endif
 #if DISTRHO_PLUGIN_HAS_UI
-                        fParametersChanged[j] = true;
+                        fParametersChanged.set(j);
 #endif
                         break;
                     }
@@ -466,15 +433,26 @@ protected:
 #endif
 
 #if DISTRHO_PLUGIN_WANT_MIDI_INPUT
+                if (midiEventCount == midiEventCapacity)
+                {
+                    fPlugin.addDroppedMidiEvents(1);
+                    continue;
+                }
+
                 MidiEvent& midiEvent(midiEvents[midiEventCount++]);
 
                 midiEvent.frame = jevent.time;
                 midiEvent.size  = jevent.size;
 
                 if (midiEvent.size > MidiEvent::kDataSize)
+                {
                     midiEvent.dataExt = jevent.buffer;
+                }
                 else
+                {
+                    midiEvent.dataExt = nullptr;
                     std::memcpy(midiEvent.data, jevent.buffer, midiEvent.size);
+                }
 #endif
             }
         }
@@ -510,12 +488,15 @@ protected:
 # if DISTRHO_PLUGIN_WANT_MIDI_INPUT
     void sendNote(const uint8_t channel, const uint8_t note, const uint8_t velocity)
     {
-        uint8_t midiData[3];
-        midiData[0] = (velocity != 0 ? 0x90 : 0x80) | channel;
-        midiData[1] = note;
-        midiData[2] = velocity;
-        fNotesRingBuffer.writeCustomData(midiData, 3);
-        fNotesRingBuffer.commitWrite();
+        MidiEvent midiEvent;
+        midiEvent.frame   = 0;
+        midiEvent.size    = 3;
+        midiEvent.data[0] = (velocity != 0 ? 0x90 : 0x80) | channel;
+        midiEvent.data[1] = note;
+        midiEvent.data[2] = velocity;
+        midiEvent.data[3] = 0;
+        midiEvent.dataExt = nullptr;
+        fNotesQueue.push(midiEvent);
     }
 # endif
 
@@ -532,11 +513,8 @@ protected:
     {
         float defValue;
 
-        for (uint32_t i=0, count=fPlugin.getParameterCount(); i < count; ++i)
+        for (uint32_t i=0; fPlugin.takeNextChangedTriggerParameter(i); ++i)
         {
-            if ((fPlugin.getParameterHints(i) & kParameterIsTrigger) != kParameterIsTrigger)
-                continue;
-
             defValue = fPlugin.getParameterRanges(i).def;
 
             if (d_isNotEqual(defValue, fPlugin.getParameterValue(i)))
@@ -553,6 +531,7 @@ private:
 #endif
 
     jack_client_t* fClient;
+    volatile bool  fFreewheel;
 
 #if DISTRHO_PLUGIN_NUM_INPUTS > 0
     jack_port_t* fPortAudioIns[DISTRHO_PLUGIN_NUM_INPUTS];
@@ -569,17 +548,14 @@ private:
     TimePosition fTimePosition;
 #endif
 
-    // Temporary data
-    float* fLastOutputValues;
-
 #if DISTRHO_PLUGIN_HAS_UI
     // Store DSP changes to send to UI
-    bool* fParametersChanged;
+    ParameterBitSet fParametersChanged;
 # if DISTRHO_PLUGIN_WANT_PROGRAMS
     int fProgramChanged;
 # endif
 # if DISTRHO_PLUGIN_WANT_MIDI_INPUT
-    SmallStackRingBuffer fNotesRingBuffer;
+    MultiProducerMessageQueue<MidiEvent, 128> fNotesQueue;
 # endif
 #endif
 
@@ -677,6 +653,11 @@ private:
         return 0;
     }
 
+    static void jackFreewheelCallback(int starting, void* ptr)
+    {
+        thisPtr->jackFreewheel(starting != 0);
+    }
+
     static int jackProcessCallback(jack_nframes_t nframes, void* ptr)
     {
         thisPtr->jackProcess(nframes);
@@ -716,7 +697,7 @@ private:
 
         fPlugin.setParameterValue(index, value);
 # if DISTRHO_PLUGIN_HAS_UI
-        fParametersChanged[index] = true;
+        fParametersChanged.set(index);
 # endif
         return true;
     }
@@ -807,6 +788,8 @@ int main()
     d_lastBufferSize = jackbridge_get_buffer_size(client);
     d_lastSampleRate = jackbridge_get_sample_rate(client);
     d_lastCanRequestParameterValueChanges = true;
+    // the buffer size can change at any time, checked again on every change
+    d_lastBlockSizeHints = PluginJack::getBlockSizeHints(d_lastBufferSize);
 
     const PluginJack p(client);
 
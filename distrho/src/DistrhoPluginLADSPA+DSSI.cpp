@@ -158,6 +158,10 @@ public:
             if (port == index++)
             {
                 fPortControls[i] = dataLocation;
+
+                // new output buffer, needs its value written on next run
+                if (fPlugin.isParameterOutput(i))
+                    fPlugin.setOutputParameterChanged(i);
                 return;
             }
         }
@@ -194,6 +198,9 @@ public:
             {
                 fLastControlValues[i] = curValue;
                 fPlugin.setParameterValue(i, curValue);
+#if DISTRHO_PLUGIN_WANT_PARAMETER_EVENTS
+                fPlugin.addParameterEvent(0, i, curValue);
+#endif
             }
         }
 
@@ -382,29 +389,27 @@ private:
     {
         float value;
 
-        for (uint32_t i=0, count=fPlugin.getParameterCount(); i < count; ++i)
+        for (uint32_t i=0; fPlugin.takeNextChangedOutputParameter(i); ++i)
         {
-            if (fPlugin.isParameterOutput(i))
-            {
-                value = fLastControlValues[i] = fPlugin.getParameterValue(i);
+            value = fLastControlValues[i] = fPlugin.getParameterValue(i);
 
-                if (fPortControls[i] != nullptr)
-                    *fPortControls[i] = value;
-            }
-            else if ((fPlugin.getParameterHints(i) & kParameterIsTrigger) == kParameterIsTrigger)
-            {
-                // NOTE: no trigger support in LADSPA control ports, simulate it here
-                value = fPlugin.getParameterRanges(i).def;
+            if (fPortControls[i] != nullptr)
+                *fPortControls[i] = value;
+        }
 
-                if (d_isEqual(value, fPlugin.getParameterValue(i)))
-                    continue;
+        // NOTE: no trigger support in LADSPA control ports, simulate it here
+        for (uint32_t i=0; fPlugin.takeNextChangedTriggerParameter(i); ++i)
+        {
+            value = fPlugin.getParameterRanges(i).def;
 
-                fLastControlValues[i] = value;
-                fPlugin.setParameterValue(i, value);
+            if (d_isEqual(value, fPlugin.getParameterValue(i)))
+                continue;
 
-                if (fPortControls[i] != nullptr)
-                    *fPortControls[i] = value;
-            }
+            fLastControlValues[i] = value;
+            fPlugin.setParameterValue(i, value);
+
+            if (fPortControls[i] != nullptr)
+                *fPortControls[i] = value;
         }
 
 #if DISTRHO_PLUGIN_WANT_LATENCY
@@ -53,11 +53,16 @@
 
 #define DISTRHO_LV2_USE_EVENTS_IN  (DISTRHO_PLUGIN_WANT_MIDI_INPUT || DISTRHO_PLUGIN_WANT_TIMEPOS || (DISTRHO_PLUGIN_WANT_STATE && DISTRHO_PLUGIN_HAS_UI) || DISTRHO_PLUGIN_WANT_STATEFILES)
 #define DISTRHO_LV2_USE_EVENTS_OUT (DISTRHO_PLUGIN_WANT_MIDI_OUTPUT || (DISTRHO_PLUGIN_WANT_STATE && DISTRHO_PLUGIN_HAS_UI))
+#define DISTRHO_LV2_USE_WORKER     (DISTRHO_PLUGIN_WANT_STATE || DISTRHO_PLUGIN_WANT_WORKER)
 
 START_NAMESPACE_DISTRHO
 
-typedef std::map<const String, String> StringToStringMap;
-typedef std::map<const LV2_URID, String> UridToStringMap;
+typedef std::map<const LV2_URID, uint32_t> UridToIndexMap;
+
+#if DISTRHO_PLUGIN_WANT_STATE && DISTRHO_PLUGIN_HAS_UI
+// maximum amount of state data sent to the UI per run, larger values are split into fragments
+static const uint32_t kMaxUiStateBytesPerRun = 8192;
+#endif
 
 #if ! DISTRHO_PLUGIN_WANT_MIDI_OUTPUT
 static const writeMidiFunc writeMidiCallback = nullptr;
@@ -76,7 +81,13 @@ public:
               const LV2_Worker_Schedule* const worker,
               const LV2_ControlInputPort_Change_Request* const ctrlInPortChangeReq,
               const bool usingNominal)
+#if DISTRHO_PLUGIN_WANT_WORKER
+        // without a host worker, PluginExporter runs its own worker thread
+        : fPlugin(this, writeMidiCallback, requestParameterValueChangeCallback,
+                  worker != nullptr ? scheduleWorkCallback : nullptr),
+#else
         : fPlugin(this, writeMidiCallback, requestParameterValueChangeCallback),
+#endif
           fUsingNominal(usingNominal),
 #ifdef DISTRHO_PLUGIN_LICENSED_FOR_MOD
           fRunCount(0),
@@ -88,6 +99,9 @@ public:
           fUridMap(uridMap),
           fWorker(worker),
           fCtrlInPortChangeReq(ctrlInPortChangeReq)
+#if DISTRHO_PLUGIN_WANT_WORKER
+        , fWorkData(new uint8_t[sizeof(LV2_Atom) + kMaxWorkDataSize])
+#endif
     {
 #if DISTRHO_PLUGIN_NUM_INPUTS > 0
         for (uint32_t i=0; i < DISTRHO_PLUGIN_NUM_INPUTS; ++i)
@@ -126,34 +140,31 @@ public:
 #if DISTRHO_PLUGIN_WANT_LATENCY
         fPortLatency = nullptr;
 #endif
+        fPortFreewheel = nullptr;
 
 #if DISTRHO_PLUGIN_WANT_STATE
-        if (const uint32_t count = fPlugin.getStateCount())
-        {
-            fNeededUiSends = new bool[count];
-
-            for (uint32_t i=0; i < count; ++i)
-            {
-                fNeededUiSends[i] = false;
-
-                const String& dkey(fPlugin.getStateKey(i));
-                fStateMap[dkey] = fPlugin.getStateDefaultValue(i);
+        fStateStore.init(fPlugin);
+# if DISTRHO_PLUGIN_HAS_UI
+        fUiStateFragmentIndex      = -1;
+        fUiStateFragmentOffset     = 0;
+        fUiStateFragmentSize       = 0;
+        fUiStateFragmentGeneration = 0;
+# endif
 
 # if DISTRHO_PLUGIN_WANT_STATEFILES
-                if (fPlugin.isStateFile(i))
-                {
-                    const String dpf_lv2_key(DISTRHO_PLUGIN_URI "#" + dkey);
-                    const LV2_URID urid = uridMap->map(uridMap->handle, dpf_lv2_key.buffer());
-                    fUridStateFileMap[urid] = dkey;
-                }
-# endif
-            }
-        }
-        else
+        for (uint32_t i=0, count=fPlugin.getStateCount(); i < count; ++i)
         {
-            fNeededUiSends = nullptr;
+            if (fPlugin.isStateFile(i))
+            {
+                const String dpf_lv2_key(DISTRHO_PLUGIN_URI "#" + fPlugin.getStateKey(i));
+                const LV2_URID urid = uridMap->map(uridMap->handle, dpf_lv2_key.buffer());
+                fUridStateFileMap[urid] = i;
+            }
         }
-#else
+# endif
+#endif
+
+#if ! DISTRHO_LV2_USE_WORKER
         // unused
         (void)fWorker;
 #endif
@@ -173,14 +184,8 @@ public:
             fLastControlValues = nullptr;
         }
 
-#if DISTRHO_PLUGIN_WANT_STATE
-        if (fNeededUiSends != nullptr)
-        {
-            delete[] fNeededUiSends;
-            fNeededUiSends = nullptr;
-        }
-
-        fStateMap.clear();
+#if DISTRHO_PLUGIN_WANT_WORKER
+        delete[] fWorkData;
 #endif
     }
 
@@ -304,17 +309,32 @@ public:
             if (port == index++)
             {
                 fPortControls[i] = (float*)dataLocation;
+
+                // new output buffer, needs its value written on next run
+                if (fPlugin.isParameterOutput(i))
+                    fPlugin.setOutputParameterChanged(i);
                 return;
             }
         }
+
+        if (port == index++)
+        {
+            fPortFreewheel = (const float*)dataLocation;
+            return;
+        }
     }
 
     // -------------------------------------------------------------------
 
     void lv2_run(const uint32_t sampleCount)
     {
+        if (fPortFreewheel != nullptr)
+            fPlugin.setOfflineRendering(*fPortFreewheel > 0.5f);
+
         // cache midi input and time position first
 #if DISTRHO_PLUGIN_WANT_MIDI_INPUT
+        MidiEvent* const midiEvents = fPlugin.getMidiEventBuffer();
+        const uint32_t midiEventCapacity = fPlugin.getMidiEventCapacity();
         uint32_t midiEventCount = 0;
 #endif
 
@@ -327,12 +347,15 @@ public:
 # if DISTRHO_PLUGIN_WANT_MIDI_INPUT
             if (event->body.type == fURIDs.midiEvent)
             {
-                if (midiEventCount >= kMaxMidiEvents)
+                if (midiEventCount == midiEventCapacity)
+                {
+                    fPlugin.addDroppedMidiEvents(1);
                     continue;
+                }
 
                 const uint8_t* const data((const uint8_t*)(event + 1));
 
-                MidiEvent& midiEvent(fMidiEvents[midiEventCount++]);
+                MidiEvent& midiEvent(midiEvents[midiEventCount++]);
 
                 midiEvent.frame = event->time.frames;
                 midiEvent.size  = event->body.size;
@@ -555,8 +578,11 @@ public:
                 // check if this is our special message
                 if (std::strcmp((const char*)data, "__dpf_ui_data__") == 0)
                 {
-                    for (uint32_t i=0, count=fPlugin.getStateCount(); i < count; ++i)
-                        fNeededUiSends[i] = true;
+                    fStateStore.setAllNeedUiSend();
+# if DISTRHO_PLUGIN_HAS_UI
+                    // a new UI needs all fragments, start over
+                    fUiStateFragmentIndex = -1;
+# endif
                 }
                 // no, send to DSP as usual
                 else if (fWorker != nullptr)
@@ -596,6 +622,9 @@ public:
                 fLastControlValues[i] = curValue;
 
                 fPlugin.setParameterValue(i, curValue);
+#if DISTRHO_PLUGIN_WANT_PARAMETER_EVENTS
+                fPlugin.addParameterEvent(0, i, curValue);
+#endif
             }
         }
 
@@ -607,7 +636,7 @@ public:
 #endif
 
 #if DISTRHO_PLUGIN_WANT_MIDI_INPUT
-            fPlugin.run(fPortAudioIns, fPortAudioOuts, sampleCount, fMidiEvents, midiEventCount);
+            fPlugin.run(fPortAudioIns, fPortAudioOuts, sampleCount, midiEvents, midiEventCount);
 #else
             fPlugin.run(fPortAudioIns, fPortAudioOuts, sampleCount);
 #endif
@@ -681,50 +710,57 @@ public:
 #if DISTRHO_PLUGIN_WANT_STATE && DISTRHO_PLUGIN_HAS_UI
         fEventsOutData.initIfNeeded(fURIDs.atomSequence);
 
-        LV2_Atom_Event* aev;
-        const uint32_t capacity = fEventsOutData.capacity;
+        // states larger than this are sent in fragments, spread across multiple runs
+        const uint32_t maxEventSize = std::min(kMaxUiStateBytesPerRun, fEventsOutData.capacity - static_cast<uint32_t>(sizeof(LV2_Atom_Sequence_Body)));
+        uint32_t budget = kMaxUiStateBytesPerRun;
 
-        for (uint32_t i=0, count=fPlugin.getStateCount(); i < count; ++i)
+        // finish sending a large state first
+        if (fUiStateFragmentIndex < 0 || writeStateFragmentsToUI(budget))
         {
-            if (! fNeededUiSends[i])
-                continue;
-
-            const String& curKey(fPlugin.getStateKey(i));
-
-            for (StringToStringMap::const_iterator cit=fStateMap.begin(), cite=fStateMap.end(); cit != cite; ++cit)
+            for (uint32_t i=0; fStateStore.takeNextUiSend(i); ++i)
             {
-                const String& key(cit->first);
-
-                if (curKey != key)
-                    continue;
-
-                const String& value(cit->second);
+                const String& key(fStateStore.getKey(i));
+                const String& value(fStateStore.getValue(i));
 
                 // set msg size (key + value + separator + 2x null terminator)
-                const size_t msgSize = key.length()+value.length()+3;
+                const uint32_t msgSize = key.length()+value.length()+3;
+                const uint32_t eventSize = lv2_atom_pad_size(sizeof(LV2_Atom_Event) + msgSize);
 
-                if (sizeof(LV2_Atom_Event) + msgSize > capacity - fEventsOutData.offset)
+                if (eventSize <= getAvailableUiStateSpace(budget))
                 {
-                    d_stdout("Sending key '%s' to UI failed, out of space", key.buffer());
-                    break;
-                }
+                    LV2_Atom_Event* const aev = (LV2_Atom_Event*)(LV2_ATOM_CONTENTS(LV2_Atom_Sequence, fEventsOutData.port) + fEventsOutData.offset);
+                    aev->time.frames = 0;
+                    aev->body.type   = fURIDs.dpfKeyValue;
+                    aev->body.size   = msgSize;
 
-                // put data
-                aev = (LV2_Atom_Event*)(LV2_ATOM_CONTENTS(LV2_Atom_Sequence, fEventsOutData.port) + fEventsOutData.offset);
-                aev->time.frames = 0;
-                aev->body.type   = fURIDs.dpfKeyValue;
-                aev->body.size   = msgSize;
+                    uint8_t* const msgBuf = LV2_ATOM_BODY(&aev->body);
+                    std::memset(msgBuf, 0, msgSize);
 
-                uint8_t* const msgBuf = LV2_ATOM_BODY(&aev->body);
-                std::memset(msgBuf, 0, msgSize);
+                    // write key and value in atom buffer
+                    std::memcpy(msgBuf, key.buffer(), key.length()+1);
+                    std::memcpy(msgBuf+(key.length()+1), value.buffer(), value.length()+1);
 
-                // write key and value in atom buffer
-                std::memcpy(msgBuf, key.buffer(), key.length()+1);
-                std::memcpy(msgBuf+(key.length()+1), value.buffer(), value.length()+1);
+                    fEventsOutData.growBy(eventSize);
+                    budget -= eventSize;
+                    continue;
+                }
 
-                fEventsOutData.growBy(lv2_atom_pad_size(sizeof(LV2_Atom_Event) + msgSize));
+                if (eventSize > maxEventSize)
+                {
+                    fUiStateFragmentIndex      = static_cast<int32_t>(i);
+                    fUiStateFragmentOffset     = 0;
+                    fUiStateFragmentSize       = value.length();
+                    fUiStateFragmentGeneration = fStateStore.getGeneration(i);
+
+                    if (writeStateFragmentsToUI(budget))
+                        continue;
+                }
+                else
+                {
+                    // out of space for now, try again on the next run
+                    fStateStore.setNeedsUiSend(i);
+                }
 
-                fNeededUiSends[i] = false;
                 break;
             }
         }
@@ -828,11 +864,7 @@ public:
 
 # if DISTRHO_PLUGIN_WANT_FULL_STATE
         // Update state
-        for (StringToStringMap::const_iterator cit=fStateMap.begin(), cite=fStateMap.end(); cit != cite; ++cit)
-        {
-            const String& key = cit->first;
-            fStateMap[key] = fPlugin.getState(key);
-        }
+        fStateStore.updateFromPlugin();
 # endif
     }
 #endif
@@ -844,52 +876,39 @@ public:
     {
 # if DISTRHO_PLUGIN_WANT_FULL_STATE
         // Update current state
-        for (StringToStringMap::const_iterator cit=fStateMap.begin(), cite=fStateMap.end(); cit != cite; ++cit)
-        {
-            const String& key = cit->first;
-            fStateMap[key] = fPlugin.getState(key);
-        }
+        fStateStore.updateFromPlugin();
 # endif
 
         String dpf_lv2_key;
         LV2_URID urid;
 
-        for (uint32_t i=0, count=fPlugin.getStateCount(); i < count; ++i)
+        for (uint32_t i=0, count=fStateStore.getCount(); i < count; ++i)
         {
-            const String& curKey(fPlugin.getStateKey(i));
-
-            for (StringToStringMap::const_iterator cit=fStateMap.begin(), cite=fStateMap.end(); cit != cite; ++cit)
-            {
-                const String& key(cit->first);
-
-                if (curKey != key)
-                    continue;
-
-                const String& value(cit->second);
+            const String& key(fStateStore.getKey(i));
+            const String& value(fStateStore.getValue(i));
 
 # if DISTRHO_PLUGIN_WANT_STATEFILES
-                if (fPlugin.isStateFile(i))
-                {
-                    dpf_lv2_key = DISTRHO_PLUGIN_URI "#";
-                    urid = fURIDs.atomPath;
-                }
-                else
+            if (fPlugin.isStateFile(i))
+            {
+                dpf_lv2_key = DISTRHO_PLUGIN_URI "#";
+                urid = fURIDs.atomPath;
+            }
+            else
 # endif
-                {
-                    dpf_lv2_key = DISTRHO_PLUGIN_LV2_STATE_PREFIX;
-                    urid = fURIDs.atomString;
-                }
+            {
+                dpf_lv2_key = DISTRHO_PLUGIN_LV2_STATE_PREFIX;
+                urid = fURIDs.atomString;
+            }
 
-                dpf_lv2_key += key;
+            dpf_lv2_key += key;
 
-                // some hosts need +1 for the null terminator, even though the type is string
-                store(handle,
-                      fUridMap->map(fUridMap->handle, dpf_lv2_key.buffer()),
-                      value.buffer(),
-                      value.length()+1,
-                      urid,
-                      LV2_STATE_IS_POD|LV2_STATE_IS_PORTABLE);
-            }
+            // some hosts need +1 for the null terminator, even though the type is string
+            store(handle,
+                  fUridMap->map(fUridMap->handle, dpf_lv2_key.buffer()),
+                  value.buffer(),
+                  value.length()+1,
+                  urid,
+                  LV2_STATE_IS_POD|LV2_STATE_IS_PORTABLE);
         }
 
         return LV2_STATE_SUCCESS;
@@ -942,19 +961,38 @@ public:
 
 #if DISTRHO_LV2_USE_EVENTS_OUT
             // signal msg needed for UI
-            fNeededUiSends[i] = true;
+            fStateStore.setNeedsUiSend(i);
 #endif
         }
 
         return LV2_STATE_SUCCESS;
     }
+#endif
 
     // -------------------------------------------------------------------
 
-    LV2_Worker_Status lv2_work(const void* const data)
+#if DISTRHO_LV2_USE_WORKER
+    LV2_Worker_Status lv2_work(const LV2_Worker_Respond_Function respond,
+                               const LV2_Worker_Respond_Handle handle,
+                               const void* const data)
     {
         const LV2_Atom* const eventBody = (const LV2_Atom*)data;
 
+# if DISTRHO_PLUGIN_WANT_WORKER
+        if (eventBody->type == fURIDs.dpfWork)
+        {
+            WorkResponder responder = { respond, handle };
+
+            fPlugin.work(eventBody + 1, eventBody->size, writeWorkResponseCallback, &responder);
+            return LV2_WORKER_SUCCESS;
+        }
+# else
+        // unused
+        (void)respond;
+        (void)handle;
+# endif
+
+# if DISTRHO_PLUGIN_WANT_STATE
         if (eventBody->type == fURIDs.dpfKeyValue)
         {
             const char* const key   = (const char*)(eventBody + 1);
@@ -963,6 +1001,7 @@ public:
             setState(key, value);
             return LV2_WORKER_SUCCESS;
         }
+# endif
 
 # if DISTRHO_PLUGIN_WANT_STATEFILES
         if (eventBody->type == fURIDs.atomObject)
@@ -980,22 +1019,13 @@ public:
             const LV2_URID urid        = ((const LV2_Atom_URID*)property)->body;
             const char* const filename = (const char*)(value + 1);
 
-            String key;
-
-            try {
-                key = fUridStateFileMap[urid];
-            } DISTRHO_SAFE_EXCEPTION_RETURN("lv2_work fUridStateFileMap[urid]", LV2_WORKER_ERR_UNKNOWN);
+            const UridToIndexMap::const_iterator it = fUridStateFileMap.find(urid);
+            DISTRHO_SAFE_ASSERT_RETURN(it != fUridStateFileMap.end(), LV2_WORKER_ERR_UNKNOWN);
 
-            setState(key, filename);
+            const uint32_t index = it->second;
 
-            for (uint32_t i=0, count=fPlugin.getStateCount(); i < count; ++i)
-            {
-                if (fPlugin.getStateKey(i) == key)
-                {
-                    fNeededUiSends[i] = true;
-                    break;
-                }
-            }
+            setState(fPlugin.getStateKey(index), filename);
+            fStateStore.setNeedsUiSend(index);
 
             return LV2_WORKER_SUCCESS;
         }
@@ -1004,8 +1034,16 @@ public:
         return LV2_WORKER_ERR_UNKNOWN;
     }
 
-    LV2_Worker_Status lv2_work_response(uint32_t, const void*)
+    LV2_Worker_Status lv2_work_response(const uint32_t size, const void* const body)
     {
+# if DISTRHO_PLUGIN_WANT_WORKER
+        // state changes never respond, so this is always from the plugin
+        fPlugin.workResponse(body, size);
+# else
+        // unused
+        (void)size;
+        (void)body;
+# endif
         return LV2_WORKER_SUCCESS;
     }
 #endif
@@ -1047,13 +1085,11 @@ private:
 #if DISTRHO_PLUGIN_WANT_LATENCY
     float* fPortLatency;
 #endif
+    const float* fPortFreewheel;
 
     // Temporary data
     float* fLastControlValues;
     double fSampleRate;
-#if DISTRHO_PLUGIN_WANT_MIDI_INPUT
-    MidiEvent fMidiEvents[kMaxMidiEvents];
-#endif
 #if DISTRHO_PLUGIN_WANT_TIMEPOS
     TimePosition fTimePosition;
 
@@ -1132,6 +1168,8 @@ private:
         LV2_URID atomString;
         LV2_URID atomURID;
         LV2_URID dpfKeyValue;
+        LV2_URID dpfKeyValueFragment;
+        LV2_URID dpfWork;
         LV2_URID midiEvent;
         LV2_URID patchProperty;
         LV2_URID patchValue;
@@ -1158,6 +1196,8 @@ private:
               atomString(map(LV2_ATOM__String)),
               atomURID(map(LV2_ATOM__URID)),
               dpfKeyValue(map(DISTRHO_PLUGIN_LV2_STATE_PREFIX "KeyValueState")),
+              dpfKeyValueFragment(map(DISTRHO_PLUGIN_LV2_STATE_PREFIX "KeyValueStateFragment")),
+              dpfWork(map(DISTRHO_PLUGIN_LV2_STATE_PREFIX "Work")),
               midiEvent(map(LV2_MIDI__MidiEvent)),
               patchProperty(map(LV2_PATCH__property)),
               patchValue(map(LV2_PATCH__value)),
@@ -1182,35 +1222,106 @@ private:
     const LV2_Worker_Schedule* const fWorker;
     const LV2_ControlInputPort_Change_Request* const fCtrlInPortChangeReq;
 
+#if DISTRHO_PLUGIN_WANT_WORKER
+    // scratch space for tagging plugin work requests
+    uint8_t* const fWorkData;
+
+    struct WorkResponder {
+        LV2_Worker_Respond_Function respond;
+        LV2_Worker_Respond_Handle handle;
+    };
+#endif
+
 #if DISTRHO_PLUGIN_WANT_STATE
-    StringToStringMap fStateMap;
-    bool* fNeededUiSends;
+    PluginStateStore fStateStore;
 
     void setState(const char* const key, const char* const newValue)
     {
         fPlugin.setState(key, newValue);
 
-        // check if we want to save this key
-        if (! fPlugin.wantStateKey(key))
-            return;
+        // save this key if we want it, ignored otherwise
+        fStateStore.setValue(key, newValue);
+    }
+
+# if DISTRHO_PLUGIN_HAS_UI
+    // large state currently being sent to the UI in fragments, -1 if none
+    int32_t  fUiStateFragmentIndex;
+    uint32_t fUiStateFragmentOffset;
+    uint32_t fUiStateFragmentSize;
+    uint32_t fUiStateFragmentGeneration;
 
-        // check if key already exists
-        for (StringToStringMap::iterator it=fStateMap.begin(), ite=fStateMap.end(); it != ite; ++it)
+    uint32_t getAvailableUiStateSpace(const uint32_t budget) const noexcept
+    {
+        // capacity includes the sequence body, which comes before the events
+        const uint32_t used = sizeof(LV2_Atom_Sequence_Body) + fEventsOutData.offset;
+
+        if (used >= fEventsOutData.capacity)
+            return 0;
+
+        return std::min(budget, fEventsOutData.capacity - used);
+    }
+
+    /*
+       Write as many fragments of the current large state as the space and budget allow.
+       Each fragment atom contains the total value size, fragment offset and state generation (all uint32_t),
+       followed by the null-terminated key and the fragment data.
+       Returns true once the whole value has been sent.
+     */
+    bool writeStateFragmentsToUI(uint32_t& budget)
+    {
+        const uint32_t index = static_cast<uint32_t>(fUiStateFragmentIndex);
+        const String& key(fStateStore.getKey(index));
+        const String& value(fStateStore.getValue(index));
+
+        // value changed in the meantime, start over
+        const uint32_t generation = fStateStore.getGeneration(index);
+
+        if (generation != fUiStateFragmentGeneration)
         {
-            const String& dkey(it->first);
+            fUiStateFragmentOffset     = 0;
+            fUiStateFragmentSize       = value.length();
+            fUiStateFragmentGeneration = generation;
+        }
 
-            if (dkey == key)
-            {
-                it->second = newValue;
-                return;
-            }
+        const uint32_t headerSize = sizeof(LV2_Atom_Event) + sizeof(uint32_t)*3 + key.length()+1;
+
+        while (fUiStateFragmentOffset < fUiStateFragmentSize)
+        {
+            // round down to atom padding, so the padded event size still fits
+            const uint32_t space = getAvailableUiStateSpace(budget) & ~7U;
+
+            if (space <= headerSize)
+                return false;
+
+            const uint32_t dataSize = std::min(fUiStateFragmentSize - fUiStateFragmentOffset, space - headerSize);
+            const uint32_t msgSize  = headerSize - sizeof(LV2_Atom_Event) + dataSize;
+
+            LV2_Atom_Event* const aev = (LV2_Atom_Event*)(LV2_ATOM_CONTENTS(LV2_Atom_Sequence, fEventsOutData.port) + fEventsOutData.offset);
+            aev->time.frames = 0;
+            aev->body.type   = fURIDs.dpfKeyValueFragment;
+            aev->body.size   = msgSize;
+
+            uint8_t* const msgBuf = LV2_ATOM_BODY(&aev->body);
+
+            const uint32_t fragmentHeader[3] = { fUiStateFragmentSize, fUiStateFragmentOffset, fUiStateFragmentGeneration };
+            std::memcpy(msgBuf, fragmentHeader, sizeof(fragmentHeader));
+            std::memcpy(msgBuf + sizeof(fragmentHeader), key.buffer(), key.length()+1);
+            std::memcpy(msgBuf + sizeof(fragmentHeader) + key.length()+1, value.buffer() + fUiStateFragmentOffset, dataSize);
+
+            const uint32_t eventSize = lv2_atom_pad_size(sizeof(LV2_Atom_Event) + msgSize);
+            fEventsOutData.growBy(eventSize);
+            budget -= eventSize;
+
+            fUiStateFragmentOffset += dataSize;
         }
 
-        d_stderr("Failed to find plugin state with key \"%s\"", key);
+        fUiStateFragmentIndex = -1;
+        return true;
     }
+# endif
 
 # if DISTRHO_PLUGIN_WANT_STATEFILES
-    UridToStringMap fUridStateFileMap;
+    UridToIndexMap fUridStateFileMap;
 # endif
 #endif
 
@@ -1218,20 +1329,15 @@ private:
     {
         float curValue;
 
-        for (uint32_t i=0, count=fPlugin.getParameterCount(); i < count; ++i)
+        for (uint32_t i=0; fPlugin.takeNextChangedOutputParameter(i); ++i)
         {
-            if (fPlugin.isParameterOutput(i))
-            {
-                curValue = fLastControlValues[i] = fPlugin.getParameterValue(i);
+            curValue = fLastControlValues[i] = fPlugin.getParameterValue(i);
 
-                setPortControlValue(i, curValue);
-            }
-            else if ((fPlugin.getParameterHints(i) & kParameterIsTrigger) == kParameterIsTrigger)
-            {
-                // NOTE: host is responsible for auto-updating control port buffers
-            }
+            setPortControlValue(i, curValue);
         }
 
+        // NOTE: host is responsible for auto-updating control port buffers of triggers
+
 #if DISTRHO_PLUGIN_WANT_LATENCY
         if (fPortLatency != nullptr)
             *fPortLatency = fPlugin.getLatency();
@@ -1252,6 +1358,32 @@ private:
     }
 #endif
 
+#if DISTRHO_PLUGIN_WANT_WORKER
+    bool scheduleWork(const void* const data, const uint32_t size)
+    {
+        DISTRHO_SAFE_ASSERT_UINT2_RETURN(size <= kMaxWorkDataSize, size, kMaxWorkDataSize, false);
+
+        LV2_Atom* const atom = (LV2_Atom*)fWorkData;
+        atom->size = size;
+        atom->type = fURIDs.dpfWork;
+        std::memcpy(atom + 1, data, size);
+
+        return fWorker->schedule_work(fWorker->handle, sizeof(LV2_Atom) + size, atom) == LV2_WORKER_SUCCESS;
+    }
+
+    static bool scheduleWorkCallback(void* const ptr, const void* const data, const uint32_t size)
+    {
+        return ((PluginLv2*)ptr)->scheduleWork(data, size);
+    }
+
+    static bool writeWorkResponseCallback(void* const ptr, const void* const data, const uint32_t size)
+    {
+        const WorkResponder* const responder = (const WorkResponder*)ptr;
+
+        return responder->respond(responder->handle, size, data) == LV2_WORKER_SUCCESS;
+    }
+#endif
+
 #if DISTRHO_PLUGIN_WANT_MIDI_OUTPUT
     bool writeMidi(const MidiEvent& midiEvent)
     {
@@ -1293,6 +1425,7 @@ static LV2_Handle lv2_instantiate(const LV2_Descriptor*, double sampleRate, cons
     const LV2_URID_Map*       uridMap = nullptr;
     const LV2_Worker_Schedule* worker = nullptr;
     const LV2_ControlInputPort_Change_Request* ctrlInPortChangeReq = nullptr;
+    uint32_t blockSizeHints = 0x0;
 
     for (int i=0; features[i] != nullptr; ++i)
     {
@@ -1304,6 +1437,12 @@ static LV2_Handle lv2_instantiate(const LV2_Descriptor*, double sampleRate, cons
             worker = (const LV2_Worker_Schedule*)features[i]->data;
         else if (std::strcmp(features[i]->URI, LV2_CONTROL_INPUT_PORT_CHANGE_REQUEST_URI) == 0)
             ctrlInPortChangeReq = (const LV2_ControlInputPort_Change_Request*)features[i]->data;
+        else if (std::strcmp(features[i]->URI, LV2_BUF_SIZE__fixedBlockLength) == 0)
+            blockSizeHints |= kBlockSizeIsFixed;
+        else if (std::strcmp(features[i]->URI, LV2_BUF_SIZE__powerOf2BlockLength) == 0)
+            blockSizeHints |= kBlockSizeIsPowerOf2;
+        else if (std::strcmp(features[i]->URI, LV2_BUF_SIZE__coarseBlockLength) == 0)
+            blockSizeHints |= kBlockSizeIsCoarse;
     }
 
     if (options == nullptr)
@@ -1368,6 +1507,7 @@ static LV2_Handle lv2_instantiate(const LV2_Descriptor*, double sampleRate, cons
 
     d_lastSampleRate = sampleRate;
     d_lastCanRequestParameterValueChanges = ctrlInPortChangeReq != nullptr;
+    d_lastBlockSizeHints = blockSizeHints;
 
     return new PluginLv2(sampleRate, uridMap, worker, ctrlInPortChangeReq, usingNominal);
 }
@@ -1437,10 +1577,12 @@ static LV2_State_Status lv2_restore(LV2_Handle instance, LV2_State_Retrieve_Func
 {
     return instancePtr->lv2_restore(retrieve, handle);
 }
+#endif
 
-LV2_Worker_Status lv2_work(LV2_Handle instance, LV2_Worker_Respond_Function, LV2_Worker_Respond_Handle, uint32_t, const void* data)
+#if DISTRHO_LV2_USE_WORKER
+LV2_Worker_Status lv2_work(LV2_Handle instance, LV2_Worker_Respond_Function respond, LV2_Worker_Respond_Handle handle, uint32_t, const void* data)
 {
-    return instancePtr->lv2_work(data);
+    return instancePtr->lv2_work(respond, handle, data);
 }
 
 LV2_Worker_Status lv2_work_response(LV2_Handle instance, uint32_t size, const void* body)
@@ -1476,10 +1618,14 @@ static const void* lv2_extension_data(const char* uri)
 
 #if DISTRHO_PLUGIN_WANT_STATE
     static const LV2_State_Interface state = { lv2_save, lv2_restore };
-    static const LV2_Worker_Interface worker = { lv2_work, lv2_work_response, nullptr };
 
     if (std::strcmp(uri, LV2_STATE__interface) == 0)
         return &state;
+#endif
+
+#if DISTRHO_LV2_USE_WORKER
+    static const LV2_Worker_Interface worker = { lv2_work, lv2_work_response, nullptr };
+
     if (std::strcmp(uri, LV2_WORKER__interface) == 0)
         return &worker;
 #endif
@@ -76,6 +76,7 @@
 
 #define DISTRHO_LV2_USE_EVENTS_IN  (DISTRHO_PLUGIN_WANT_MIDI_INPUT || DISTRHO_PLUGIN_WANT_TIMEPOS || (DISTRHO_PLUGIN_WANT_STATE && DISTRHO_PLUGIN_HAS_UI) || DISTRHO_PLUGIN_WANT_STATEFILES)
 #define DISTRHO_LV2_USE_EVENTS_OUT (DISTRHO_PLUGIN_WANT_MIDI_OUTPUT || (DISTRHO_PLUGIN_WANT_STATE && DISTRHO_PLUGIN_HAS_UI))
+#define DISTRHO_LV2_USE_WORKER     (DISTRHO_PLUGIN_WANT_STATE || DISTRHO_PLUGIN_WANT_WORKER)
 
 #define DISTRHO_BYPASS_PARAMETER_NAME "lv2_enabled"
 
@@ -85,6 +86,8 @@ static const char* const lv2ManifestPluginExtensionData[] =
     "opts:interface",
 #if DISTRHO_PLUGIN_WANT_STATE
     LV2_STATE__interface,
+#endif
+#if DISTRHO_LV2_USE_WORKER
     LV2_WORKER__interface,
 #endif
 #if DISTRHO_PLUGIN_WANT_PROGRAMS
@@ -102,6 +105,13 @@ static const char* const lv2ManifestPluginOptionalFeatures[] =
     LV2_CORE__hardRTCapable,
 #endif
     LV2_BUF_SIZE__boundedBlockLength,
+    LV2_BUF_SIZE__coarseBlockLength,
+    LV2_BUF_SIZE__fixedBlockLength,
+    LV2_BUF_SIZE__powerOf2BlockLength,
+#if DISTRHO_PLUGIN_WANT_WORKER && ! DISTRHO_PLUGIN_WANT_STATE
+    // DPF runs its own worker thread when the host has none
+    LV2_WORKER__schedule,
+#endif
     nullptr
 };
 
@@ -860,6 +870,20 @@ void lv2_generate_ttl(const char* const basename)
                 else
                     pluginString += "    ] ,\n";
             }
+
+            // freewheel goes after all parameters, so existing port indices stay the same
+            pluginString += "    lv2:port [\n";
+            pluginString += "        a lv2:InputPort, lv2:ControlPort ;\n";
+            pluginString += "        lv2:index " + String(portIndex) + " ;\n";
+            pluginString += "        lv2:name \"Freewheel\" ;\n";
+            pluginString += "        lv2:symbol \"lv2_freewheel\" ;\n";
+            pluginString += "        lv2:default 0 ;\n";
+            pluginString += "        lv2:minimum 0 ;\n";
+            pluginString += "        lv2:maximum 1 ;\n";
+            pluginString += "        lv2:designation lv2:freeWheeling ;\n";
+            pluginString += "        lv2:portProperty lv2:toggled, <" LV2_PORT_PROPS__notOnGUI "> ;\n";
+            pluginString += "    ] ;\n\n";
+            ++portIndex;
         }
 
         // comment
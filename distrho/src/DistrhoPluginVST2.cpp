@@ -29,7 +29,7 @@
 
 #if DISTRHO_PLUGIN_HAS_UI
 # include "DistrhoUIInternal.hpp"
-# include "../extra/RingBuffer.hpp"
+# include "../extra/MessageQueue.hpp"
 #endif
 
 #ifndef __cdecl
@@ -42,12 +42,12 @@
 #define VST_FORCE_DEPRECATED 0
 
 #include <clocale>
-#include <map>
 #include <string>
 
 #if VESTIGE_HEADER
 # include "vestige/vestige.h"
 #define effFlagsProgramChunks (1 << 5)
+#define effFlagsCanDoubleReplacing (1 << 12)
 #define effSetProgramName 4
 #define effGetParamLabel 6
 #define effGetParamDisplay 7
@@ -57,8 +57,10 @@
 #define effGetProgramNameIndexed 29
 #define effGetPlugCategory 35
 #define effVendorSpecific 50
+#define effGetTailSize 52
 #define effEditKeyDown 59
 #define effEditKeyUp 60
+#define kVstProcessLevelOffline 4
 #define kVstVersion 2400
 struct ERect {
     int16_t top, left, bottom, right;
@@ -69,8 +71,6 @@ struct ERect {
 
 START_NAMESPACE_DISTRHO
 
-typedef std::map<const String, String> StringMap;
-
 static const int kVstMidiEventSize = static_cast<int>(sizeof(VstMidiEvent));
 
 #if ! DISTRHO_PLUGIN_WANT_MIDI_OUTPUT
@@ -119,7 +119,7 @@ struct ParameterAndNotesHelper
 #if DISTRHO_PLUGIN_HAS_UI
     bool* parameterChecks;
 # if DISTRHO_PLUGIN_WANT_MIDI_INPUT
-    SmallStackBuffer notesRingBuffer;
+    MessageQueue<MidiEvent, 128> notesQueue;
 # endif
 #endif
 
@@ -127,14 +127,8 @@ struct ParameterAndNotesHelper
         : parameterValues(nullptr)
 #if DISTRHO_PLUGIN_HAS_UI
         , parameterChecks(nullptr)
-# if DISTRHO_PLUGIN_WANT_MIDI_INPUT
-        , notesRingBuffer(StackBuffer_INIT)
-# endif
 #endif
     {
-#if DISTRHO_PLUGIN_HAS_UI && DISTRHO_PLUGIN_WANT_MIDI_INPUT && ! defined(DISTRHO_PROPER_CPP11_SUPPORT)
-        std::memset(&notesRingBuffer, 0, sizeof(notesRingBuffer));
-#endif
     }
 
     virtual ~ParameterAndNotesHelper()
@@ -193,14 +187,8 @@ public:
           fHasScaleFactor(d_isNotZero(scaleFactor))
 # if !DISTRHO_PLUGIN_HAS_EXTERNAL_UI
         , fKeyboardModifiers(0)
-# endif
-# if DISTRHO_PLUGIN_WANT_MIDI_INPUT
-        , fNotesRingBuffer()
 # endif
     {
-# if DISTRHO_PLUGIN_WANT_MIDI_INPUT
-        fNotesRingBuffer.setRingBuffer(&uiHelper->notesRingBuffer, false);
-# endif
     }
 
     // -------------------------------------------------------------------
@@ -413,12 +401,15 @@ protected:
 # if DISTRHO_PLUGIN_WANT_MIDI_INPUT
     void sendNote(const uint8_t channel, const uint8_t note, const uint8_t velocity)
     {
-        uint8_t midiData[3];
-        midiData[0] = (velocity != 0 ? 0x90 : 0x80) | channel;
-        midiData[1] = note;
-        midiData[2] = velocity;
-        fNotesRingBuffer.writeCustomData(midiData, 3);
-        fNotesRingBuffer.commitWrite();
+        MidiEvent midiEvent;
+        midiEvent.frame   = 0;
+        midiEvent.size    = 3;
+        midiEvent.data[0] = (velocity != 0 ? 0x90 : 0x80) | channel;
+        midiEvent.data[1] = note;
+        midiEvent.data[2] = velocity;
+        midiEvent.data[3] = 0;
+        midiEvent.dataExt = nullptr;
+        fUiHelper->notesQueue.push(midiEvent);
     }
 # endif
 
@@ -442,9 +433,6 @@ private:
 # if !DISTRHO_PLUGIN_HAS_EXTERNAL_UI
     uint16_t fKeyboardModifiers;
 # endif
-# if DISTRHO_PLUGIN_WANT_MIDI_INPUT
-    RingBufferControl<SmallStackBuffer> fNotesRingBuffer;
-# endif
 
     // -------------------------------------------------------------------
     // Callbacks
@@ -511,6 +499,10 @@ public:
         fMidiEventCount = 0;
 #endif
 
+#if DISTRHO_PLUGIN_WANT_PARAMETER_EVENTS
+        fChangedParameters.init(parameterCount);
+#endif
+
 #if DISTRHO_PLUGIN_HAS_UI
         fVstUI           = nullptr;
         fVstRect.top     = 0;
@@ -535,20 +527,11 @@ public:
         fUsingNsView = false;
 #  endif
 # endif // DISTRHO_OS_MAC
-
-# if DISTRHO_PLUGIN_WANT_MIDI_INPUT
-        fNotesRingBuffer.setRingBuffer(&notesRingBuffer, true);
-# endif
 #endif // DISTRHO_PLUGIN_HAS_UI
 
 #if DISTRHO_PLUGIN_WANT_STATE
         fStateChunk = nullptr;
-
-        for (uint32_t i=0, count=fPlugin.getStateCount(); i<count; ++i)
-        {
-            const String& dkey(fPlugin.getStateKey(i));
-            fStateMap[dkey] = fPlugin.getStateDefaultValue(i);
-        }
+        fStateStore.init(fPlugin);
 #endif
     }
 
@@ -560,8 +543,6 @@ public:
             delete[] fStateChunk;
             fStateChunk = nullptr;
         }
-
-        fStateMap.clear();
 #endif
     }
 
@@ -730,22 +711,13 @@ public:
 
 # if DISTRHO_PLUGIN_WANT_FULL_STATE
                 // Update current state from plugin side
-                for (StringMap::const_iterator cit=fStateMap.begin(), cite=fStateMap.end(); cit != cite; ++cit)
-                {
-                    const String& key = cit->first;
-                    fStateMap[key] = fPlugin.getState(key);
-                }
+                fStateStore.updateFromPlugin();
 # endif
 
 # if DISTRHO_PLUGIN_WANT_STATE
                 // Set state
-                for (StringMap::const_iterator cit=fStateMap.begin(), cite=fStateMap.end(); cit != cite; ++cit)
-                {
-                    const String& key   = cit->first;
-                    const String& value = cit->second;
-
-                    fVstUI->setStateFromPlugin(key, value);
-                }
+                for (uint32_t i=0, count=fStateStore.getCount(); i < count; ++i)
+                    fVstUI->setStateFromPlugin(fStateStore.getKey(i), fStateStore.getValue(i));
 # endif
                 for (uint32_t i=0, count=fPlugin.getParameterCount(); i < count; ++i)
                     setParameterValueFromPlugin(i, fPlugin.getParameterValue(i));
@@ -806,19 +778,15 @@ public:
             {
 # if DISTRHO_PLUGIN_WANT_FULL_STATE
                 // Update current state
-                for (StringMap::const_iterator cit=fStateMap.begin(), cite=fStateMap.end(); cit != cite; ++cit)
-                {
-                    const String& key = cit->first;
-                    fStateMap[key] = fPlugin.getState(key);
-                }
+                fStateStore.updateFromPlugin();
 # endif
 
                 String chunkStr;
 
-                for (StringMap::const_iterator cit=fStateMap.begin(), cite=fStateMap.end(); cit != cite; ++cit)
+                for (uint32_t i=0, count=fStateStore.getCount(); i < count; ++i)
                 {
-                    const String& key   = cit->first;
-                    const String& value = cit->second;
+                    const String& key(fStateStore.getKey(i));
+                    const String& value(fStateStore.getValue(i));
 
                     // join key and value
                     String tmpStr;
@@ -963,6 +931,9 @@ public:
                 if (events->numEvents == 0)
                     break;
 
+                MidiEvent* const midiEvents = fPlugin.getMidiEventBuffer();
+                const uint32_t midiEventCapacity = fPlugin.getMidiEventCapacity();
+
                 for (int i=0, count=events->numEvents; i < count; ++i)
                 {
                     const VstMidiEvent* const vstMidiEvent((const VstMidiEvent*)events->events[i]);
@@ -971,12 +942,16 @@ public:
                         break;
                     if (vstMidiEvent->type != kVstMidiType)
                         continue;
-                    if (fMidiEventCount >= kMaxMidiEvents)
-                        break;
+                    if (fMidiEventCount == midiEventCapacity)
+                    {
+                        fPlugin.addDroppedMidiEvents(1);
+                        continue;
+                    }
 
-                    MidiEvent& midiEvent(fMidiEvents[fMidiEventCount++]);
-                    midiEvent.frame  = vstMidiEvent->deltaFrames;
-                    midiEvent.size   = 3;
+                    MidiEvent& midiEvent(midiEvents[fMidiEventCount++]);
+                    midiEvent.frame   = vstMidiEvent->deltaFrames;
+                    midiEvent.size    = 3;
+                    midiEvent.dataExt = nullptr;
                     std::memcpy(midiEvent.data, vstMidiEvent->midiData, sizeof(uint8_t)*3);
                 }
             }
@@ -994,6 +969,19 @@ public:
             }
             break;
 
+        case effGetTailSize:
+        {
+            // 0 lets the host decide, 1 means no tail at all
+            const uint32_t tailLength = fPlugin.getTailLength();
+
+            if (tailLength == kTailLengthInfinite)
+                return 0;
+            if (tailLength == 0)
+                return 1;
+
+            return static_cast<intptr_t>(std::min<uint32_t>(tailLength, INT32_MAX));
+        }
+
         case effCanDo:
             if (const char* const canDo = (const char*)ptr)
             {
@@ -1082,13 +1070,20 @@ public:
 
         fPlugin.setParameterValue(index, realValue);
 
+#if DISTRHO_PLUGIN_WANT_PARAMETER_EVENTS
+        // VST2 automation has no timestamps, report the change on the next run() at frame 0
+        if (index >= 0 && static_cast<uint32_t>(index) < fPlugin.getParameterCount())
+            fChangedParameters.set(static_cast<uint32_t>(index));
+#endif
+
 #if DISTRHO_PLUGIN_HAS_UI
         if (fVstUI != nullptr)
             setParameterValueFromPlugin(index, realValue);
 #endif
     }
 
-    void vst_processReplacing(const float** const inputs, float** const outputs, const int32_t sampleFrames)
+    template <typename T>
+    void vst_processReplacing(const T** const inputs, T** const outputs, const int32_t sampleFrames)
     {
         if (! fPlugin.isActive())
         {
@@ -1102,6 +1097,8 @@ public:
             return;
         }
 
+        fPlugin.setOfflineRendering(hostCallback(audioMasterGetCurrentProcessLevel) == kVstProcessLevelOffline);
+
 #if DISTRHO_PLUGIN_WANT_TIMEPOS
         static const int kWantVstTimeFlags(kVstTransportPlaying|kVstPpqPosValid|kVstTempoValid|kVstTimeSigValid);
 
@@ -1156,30 +1153,32 @@ public:
         }
 #endif
 
+#if DISTRHO_PLUGIN_WANT_PARAMETER_EVENTS
+        for (uint32_t i=0; fChangedParameters.takeNext(i); ++i)
+            fPlugin.addParameterEvent(0, i, fPlugin.getParameterValue(i));
+#endif
+
 #if DISTRHO_PLUGIN_WANT_MIDI_INPUT
+        MidiEvent* const midiEvents = fPlugin.getMidiEventBuffer();
+
 # if DISTRHO_PLUGIN_HAS_UI
-        if (fMidiEventCount != kMaxMidiEvents && fNotesRingBuffer.isDataAvailableForReading())
-        {
-            uint8_t midiData[3];
-            uint32_t frame = fMidiEventCount != 0 ? fMidiEvents[fMidiEventCount-1].frame : 0;
+        const uint32_t midiEventCapacity = fPlugin.getMidiEventCapacity();
 
-            while (fNotesRingBuffer.isDataAvailableForReading())
-            {
-                if (! fNotesRingBuffer.readCustomData(midiData, 3))
-                    break;
+        if (fMidiEventCount != midiEventCapacity && ! notesQueue.isEmpty())
+        {
+            const uint32_t frame = fMidiEventCount != 0 ? midiEvents[fMidiEventCount-1].frame : 0;
+            MidiEvent* const notes = midiEvents + fMidiEventCount;
+            const uint32_t count = notesQueue.popBatch(notes, midiEventCapacity - fMidiEventCount);
 
-                MidiEvent& midiEvent(fMidiEvents[fMidiEventCount++]);
-                midiEvent.frame = frame;
-                midiEvent.size  = 3;
-                std::memcpy(midiEvent.data, midiData, 3);
+            // keep UI notes after host events, which are sorted by frame
+            for (uint32_t i=0; i < count; ++i)
+                notes[i].frame = frame;
 
-                if (fMidiEventCount == kMaxMidiEvents)
-                    break;
-            }
+            fMidiEventCount += count;
         }
 # endif
 
-        fPlugin.run(inputs, outputs, sampleFrames, fMidiEvents, fMidiEventCount);
+        fPlugin.run(inputs, outputs, sampleFrames, midiEvents, fMidiEventCount);
         fMidiEventCount = 0;
 #else
         fPlugin.run(inputs, outputs, sampleFrames);
@@ -1204,14 +1203,18 @@ private:
     char fProgramName[32+1];
 
 #if DISTRHO_PLUGIN_WANT_MIDI_INPUT
-    uint32_t  fMidiEventCount;
-    MidiEvent fMidiEvents[kMaxMidiEvents];
+    uint32_t fMidiEventCount;
 #endif
 
 #if DISTRHO_PLUGIN_WANT_TIMEPOS
     TimePosition fTimePosition;
 #endif
 
+#if DISTRHO_PLUGIN_WANT_PARAMETER_EVENTS
+    // parameters changed by the host since the last run
+    ParameterBitSet fChangedParameters;
+#endif
+
     // UI stuff
 #if DISTRHO_PLUGIN_HAS_UI
     UIVst* fVstUI;
@@ -1220,14 +1223,11 @@ private:
 # if DISTRHO_OS_MAC
     bool fUsingNsView;
 # endif
-# if DISTRHO_PLUGIN_WANT_MIDI_INPUT
-    RingBufferControl<SmallStackBuffer> fNotesRingBuffer;
-# endif
 #endif
 
 #if DISTRHO_PLUGIN_WANT_STATE
-    char*     fStateChunk;
-    StringMap fStateMap;
+    char* fStateChunk;
+    PluginStateStore fStateStore;
 #endif
 
     // -------------------------------------------------------------------
@@ -1249,48 +1249,43 @@ private:
     {
         float curValue;
 
-        for (uint32_t i=0, count=fPlugin.getParameterCount(); i < count; ++i)
+        for (uint32_t i=0; fPlugin.takeNextChangedOutputParameter(i); ++i)
         {
-            if (fPlugin.isParameterOutput(i))
-            {
-                // NOTE: no output parameter support in VST, simulate it here
-                curValue = fPlugin.getParameterValue(i);
+            // NOTE: no output parameter support in VST, simulate it here
+            curValue = fPlugin.getParameterValue(i);
 
-                if (d_isEqual(curValue, parameterValues[i]))
-                    continue;
+            if (d_isEqual(curValue, parameterValues[i]))
+                continue;
 
 #if DISTRHO_PLUGIN_HAS_UI
-                if (fVstUI != nullptr)
-                    setParameterValueFromPlugin(i, curValue);
-                else
+            if (fVstUI != nullptr)
+                setParameterValueFromPlugin(i, curValue);
+            else
 #endif
-                parameterValues[i] = curValue;
+            parameterValues[i] = curValue;
 
-#ifndef DPF_VST_SHOW_PARAMETER_OUTPUTS
-                // skip automating parameter outputs from plugin if we disable them on VST
-                continue;
+#ifdef DPF_VST_SHOW_PARAMETER_OUTPUTS
+            const ParameterRanges& ranges(fPlugin.getParameterRanges(i));
+            hostCallback(audioMasterAutomate, i, 0, nullptr, ranges.getNormalizedValue(curValue));
 #endif
-            }
-            else if ((fPlugin.getParameterHints(i) & kParameterIsTrigger) == kParameterIsTrigger)
-            {
-                // NOTE: no trigger support in VST parameters, simulate it here
-                curValue = fPlugin.getParameterValue(i);
+        }
+
+        for (uint32_t i=0; fPlugin.takeNextChangedTriggerParameter(i); ++i)
+        {
+            // NOTE: no trigger support in VST parameters, simulate it here
+            curValue = fPlugin.getParameterValue(i);
+
+            const ParameterRanges& ranges(fPlugin.getParameterRanges(i));
 
-                if (d_isEqual(curValue, fPlugin.getParameterRanges(i).def))
-                    continue;
+            if (d_isEqual(curValue, ranges.def))
+                continue;
 
 #if DISTRHO_PLUGIN_HAS_UI
-                if (fVstUI != nullptr)
-                    setParameterValueFromPlugin(i, curValue);
+            if (fVstUI != nullptr)
+                setParameterValueFromPlugin(i, curValue);
 #endif
-                fPlugin.setParameterValue(i, curValue);
-            }
-            else
-            {
-                continue;
-            }
+            fPlugin.setParameterValue(i, curValue);
 
-            const ParameterRanges& ranges(fPlugin.getParameterRanges(i));
             hostCallback(audioMasterAutomate, i, 0, nullptr, ranges.getNormalizedValue(curValue));
         }
     }
@@ -1359,23 +1354,8 @@ private:
     {
         fPlugin.setState(key, newValue);
 
-        // check if we want to save this key
-        if (! fPlugin.wantStateKey(key))
-            return;
-
-        // check if key already exists
-        for (StringMap::iterator it=fStateMap.begin(), ite=fStateMap.end(); it != ite; ++it)
-        {
-            const String& dkey(it->first);
-
-            if (dkey == key)
-            {
-                it->second = newValue;
-                return;
-            }
-        }
-
-        d_stderr("Failed to find plugin state with key \"%s\"", key);
+        // save this key if we want it, ignored otherwise
+        fStateStore.setValue(key, newValue);
     }
 #endif
 };
@@ -1638,6 +1618,14 @@ static void vst_processReplacingCallback(AEffect* effect, float** inputs, float*
         pluginPtr->vst_processReplacing(const_cast<const float**>(inputs), outputs, sampleFrames);
 }
 
+#if DISTRHO_PLUGIN_WANT_DOUBLE_PRECISION
+static void vst_processDoubleReplacingCallback(AEffect* effect, double** inputs, double** outputs, int32_t sampleFrames)
+{
+    if (validPlugin)
+        pluginPtr->vst_processReplacing(const_cast<const double**>(inputs), outputs, sampleFrames);
+}
+#endif
+
 #undef pluginPtr
 #undef validObject
 #undef validPlugin
@@ -1704,6 +1692,9 @@ const AEffect* VSTPluginMain(audioMasterCallback audioMaster)
 
     // plugin flags
     effect->flags |= effFlagsCanReplacing;
+#if DISTRHO_PLUGIN_WANT_DOUBLE_PRECISION
+    effect->flags |= effFlagsCanDoubleReplacing;
+#endif
 #if DISTRHO_PLUGIN_IS_SYNTH
     effect->flags |= effFlagsIsSynth;
 #endif
@@ -1720,6 +1711,9 @@ const AEffect* VSTPluginMain(audioMasterCallback audioMaster)
     effect->getParameter = vst_getParameterCallback;
     effect->setParameter = vst_setParameterCallback;
     effect->processReplacing = vst_processReplacingCallback;
+#if DISTRHO_PLUGIN_WANT_DOUBLE_PRECISION
+    effect->processDoubleReplacing = vst_processDoubleReplacingCallback;
+#endif
 
     // pointers
     VstObject* const obj(new VstObject());
@@ -17,6 +17,8 @@
 #include "DistrhoPluginInternal.hpp"
 #include "../extra/ScopedPointer.hpp"
 
+#include <atomic>
+
 #include "travesty/audio_processor.h"
 #include "travesty/component.h"
 #include "travesty/edit_controller.h"
@@ -43,55 +45,1041 @@ static constexpr const uint32_t dpf_id_ctrl  = d_cconst('c', 't', 'r', 'l');
 static constexpr const uint32_t dpf_id_proc  = d_cconst('p', 'r', 'o', 'c');
 static constexpr const uint32_t dpf_id_view  = d_cconst('v', 'i', 'e', 'w');
 
-static dpf_tuid dpf_tuid_class = { dpf_id_entry, dpf_id_clas, 0, 0 };
-static dpf_tuid dpf_tuid_component = { dpf_id_entry, dpf_id_comp, 0, 0 };
-static dpf_tuid dpf_tuid_controller = { dpf_id_entry, dpf_id_ctrl, 0, 0 };
-static dpf_tuid dpf_tuid_processor = { dpf_id_entry, dpf_id_proc, 0, 0 };
-static dpf_tuid dpf_tuid_view = { dpf_id_entry, dpf_id_view, 0, 0 };
+static dpf_tuid dpf_tuid_class = { dpf_id_entry, dpf_id_clas, 0, 0 };
+static dpf_tuid dpf_tuid_component = { dpf_id_entry, dpf_id_comp, 0, 0 };
+static dpf_tuid dpf_tuid_controller = { dpf_id_entry, dpf_id_ctrl, 0, 0 };
+static dpf_tuid dpf_tuid_processor = { dpf_id_entry, dpf_id_proc, 0, 0 };
+static dpf_tuid dpf_tuid_view = { dpf_id_entry, dpf_id_view, 0, 0 };
+
+// -----------------------------------------------------------------------
+
+void strncpy(char* const dst, const char* const src, const size_t size)
+{
+    DISTRHO_SAFE_ASSERT_RETURN(size > 0,);
+
+    if (const size_t len = std::min(std::strlen(src), size-1U))
+    {
+        std::memcpy(dst, src, len);
+        dst[len] = '\0';
+    }
+    else
+    {
+        dst[0] = '\0';
+    }
+}
+
+// -----------------------------------------------------------------------
+
+static void strncpy_16(int16_t* const dst, const char* const src, const size_t size)
+{
+    DISTRHO_SAFE_ASSERT_RETURN(size > 0,);
+
+    const size_t len = std::min(std::strlen(src), size-1U);
+
+    // NOTE: only ASCII is properly converted
+    for (size_t i=0; i<len; ++i)
+        dst[i] = static_cast<uint8_t>(src[i]);
+
+    dst[len] = 0;
+}
+
+// -----------------------------------------------------------------------
+// PluginVst3, component, audio processor and edit controller of a single plugin instance
+
+struct v3_bstream_cpp : v3_funknown, v3_bstream {};
+struct v3_component_handler_cpp : v3_funknown, v3_component_handler {};
+struct v3_event_list_cpp : v3_funknown, v3_event_list {};
+struct v3_param_changes_cpp : v3_funknown, v3_param_changes {};
+struct v3_param_value_queue_cpp : v3_funknown, v3_param_value_queue {};
+
+class PluginVst3
+{
+    // a parameter change from the host, with its frame inside the current block
+    struct ParameterChange {
+        uint32_t frame;
+        uint32_t index;
+        float value;
+    };
+
+public:
+    PluginVst3()
+        : fPlugin(this, writeMidiCallback, requestParameterValueChangeCallback),
+          fComponentHandler(nullptr),
+          fParameterChanges(nullptr),
+          fParameterChangeCapacity(0),
+          fParameterChangeCount(0),
+          fControllerValues(nullptr),
+          fDummyBuffer(nullptr),
+          fDummyBufferSize(0),
+          fFrameOffset(0)
+#if DISTRHO_PLUGIN_WANT_MIDI_OUTPUT
+        , fOutputEvents(nullptr)
+#endif
+#if DISTRHO_PLUGIN_WANT_LATENCY
+        , fLastKnownLatency(fPlugin.getLatency())
+#endif
+    {
+        // a few changes per parameter and block, extra points only keep the last value
+        fParameterChangeCapacity = std::max(fPlugin.getParameterCount() * 8U, 64U);
+        fParameterChanges = new ParameterChange[fParameterChangeCapacity];
+
+        if (const uint32_t parameterCount = fPlugin.getParameterCount())
+        {
+            fControllerValues = new double[parameterCount];
+            updateControllerValues();
+        }
+
+#if DISTRHO_PLUGIN_WANT_STATE
+        fStateStore.init(fPlugin);
+#endif
+    }
+
+    ~PluginVst3()
+    {
+        if (fComponentHandler != nullptr)
+            (*fComponentHandler)->unref(fComponentHandler);
+
+        delete[] fParameterChanges;
+        delete[] fControllerValues;
+        delete[] fDummyBuffer;
+    }
+
+    // ----------------------------------------------------------------------------------------------------------------
+    // v3_component interface calls
+
+    int32_t getBusCount(const int32_t mediaType, const int32_t busDirection) const noexcept
+    {
+        switch (mediaType)
+        {
+        case V3_AUDIO:
+            if (busDirection == V3_INPUT)
+                return DISTRHO_PLUGIN_NUM_INPUTS > 0 ? 1 : 0;
+            return DISTRHO_PLUGIN_NUM_OUTPUTS > 0 ? 1 : 0;
+        case V3_EVENT:
+            if (busDirection == V3_INPUT)
+                return DISTRHO_PLUGIN_WANT_MIDI_INPUT ? 1 : 0;
+            return DISTRHO_PLUGIN_WANT_MIDI_OUTPUT ? 1 : 0;
+        }
+
+        return 0;
+    }
+
+    v3_result getBusInfo(const int32_t mediaType, const int32_t busDirection,
+                         const int32_t busIndex, v3_bus_info* const info) const
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(info != nullptr, V3_INVALID_ARG);
+        DISTRHO_SAFE_ASSERT_RETURN(busIndex >= 0 && busIndex < getBusCount(mediaType, busDirection), V3_INVALID_ARG);
+
+        std::memset(info, 0, sizeof(v3_bus_info));
+        info->media_type = mediaType;
+        info->direction = busDirection;
+        info->bus_type = V3_MAIN;
+        info->flags = V3_DEFAULT_ACTIVE;
+
+        if (mediaType == V3_AUDIO)
+        {
+            info->channel_count = busDirection == V3_INPUT ? DISTRHO_PLUGIN_NUM_INPUTS : DISTRHO_PLUGIN_NUM_OUTPUTS;
+            strncpy_16(info->bus_name, busDirection == V3_INPUT ? "Audio Input" : "Audio Output", 128);
+        }
+        else
+        {
+            info->channel_count = 16;
+            strncpy_16(info->bus_name, busDirection == V3_INPUT ? "Event Input" : "Event Output", 128);
+        }
+
+        return V3_OK;
+    }
+
+    v3_result setActive(const bool active)
+    {
+        if (active)
+        {
+            if (! fPlugin.isActive())
+                fPlugin.activate();
+
+#if DISTRHO_PLUGIN_WANT_LATENCY
+            fLastKnownLatency = fPlugin.getLatency();
+#endif
+        }
+        else
+        {
+            fPlugin.deactivateIfNeeded();
+        }
+
+        return V3_OK;
+    }
+
+    // The component state has the same layout as the VST2 chunk, all strings null-terminated:
+    // state keys and values, an empty string, then the symbols and values of the input parameters.
+
+    v3_result getState(v3_bstream_cpp** const stream)
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(stream != nullptr, V3_INVALID_ARG);
+
+#if DISTRHO_PLUGIN_WANT_STATE
+# if DISTRHO_PLUGIN_WANT_FULL_STATE
+        // Update current state
+        fStateStore.updateFromPlugin();
+# endif
+
+        for (uint32_t i=0, count=fStateStore.getCount(); i < count; ++i)
+        {
+            if (! writeString(stream, fStateStore.getKey(i)) || ! writeString(stream, fStateStore.getValue(i)))
+                return V3_INTERNAL_ERR;
+        }
+#endif
+
+        if (! writeString(stream, ""))
+            return V3_INTERNAL_ERR;
+
+        for (uint32_t i=0, count=fPlugin.getParameterCount(); i < count; ++i)
+        {
+            if (fPlugin.isParameterOutputOrTrigger(i))
+                continue;
+
+            if (! writeString(stream, fPlugin.getParameterSymbol(i)) ||
+                ! writeString(stream, String(fPlugin.getParameterValue(i))))
+                return V3_INTERNAL_ERR;
+        }
+
+        return V3_OK;
+    }
+
+    v3_result setState(v3_bstream_cpp** const stream)
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(stream != nullptr, V3_INVALID_ARG);
+
+        uint32_t size = 0;
+        char* const data = readStream(stream, size);
+
+        const char* const end = data + size;
+        const char* key = data;
+        const char* value;
+
+        // states, until the empty string
+        for (; key < end && key[0] != '\0'; key = value + std::strlen(value) + 1)
+        {
+            value = key + std::strlen(key) + 1;
+
+            if (value >= end)
+                break;
+
+#if DISTRHO_PLUGIN_WANT_STATE
+            fPlugin.setState(key, value);
+
+            // save this key if we want it, ignored otherwise
+            fStateStore.setValue(key, value);
+#endif
+        }
+
+        // skip the empty string
+        ++key;
+
+        if (key < end)
+        {
+            const uint32_t parameterCount = fPlugin.getParameterCount();
+
+            // temporarily set locale to "C" while converting floats
+            const ScopedSafeLocale ssl;
+
+            for (; key < end && key[0] != '\0'; key = value + std::strlen(value) + 1)
+            {
+                value = key + std::strlen(key) + 1;
+
+                if (value >= end)
+                    break;
+
+                // find parameter with this symbol, and set its value
+                for (uint32_t i=0; i < parameterCount; ++i)
+                {
+                    if (fPlugin.isParameterOutputOrTrigger(i))
+                        continue;
+                    if (fPlugin.getParameterSymbol(i) != key)
+                        continue;
+
+                    fPlugin.setParameterValue(i, static_cast<float>(std::atof(value)));
+                    break;
+                }
+            }
+        }
+
+        delete[] data;
+        updateControllerValues();
+        return V3_OK;
+    }
+
+    // ----------------------------------------------------------------------------------------------------------------
+    // v3_audio_processor interface calls
+
+    v3_result setBusArrangements(v3_speaker_arrangement* const inputs, const int32_t numInputs,
+                                 v3_speaker_arrangement* const outputs, const int32_t numOutputs) const noexcept
+    {
+        // only our own fixed layout is supported
+        if (numInputs != getBusCount(V3_AUDIO, V3_INPUT) || numOutputs != getBusCount(V3_AUDIO, V3_OUTPUT))
+            return V3_FALSE;
+        if (numInputs > 0 && getChannelCount(inputs[0]) != DISTRHO_PLUGIN_NUM_INPUTS)
+            return V3_FALSE;
+        if (numOutputs > 0 && getChannelCount(outputs[0]) != DISTRHO_PLUGIN_NUM_OUTPUTS)
+            return V3_FALSE;
+
+        return V3_OK;
+    }
+
+    v3_result getBusArrangement(const int32_t busDirection, const int32_t busIndex,
+                                v3_speaker_arrangement* const arrangement) const noexcept
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(arrangement != nullptr, V3_INVALID_ARG);
+        DISTRHO_SAFE_ASSERT_RETURN(busIndex == 0 && busIndex < getBusCount(V3_AUDIO, busDirection), V3_INVALID_ARG);
+
+        const uint32_t channels = busDirection == V3_INPUT ? DISTRHO_PLUGIN_NUM_INPUTS : DISTRHO_PLUGIN_NUM_OUTPUTS;
+
+        switch (channels)
+        {
+        case 1:
+            *arrangement = V3_SPEAKER_M;
+            break;
+        case 2:
+            *arrangement = V3_SPEAKER_L | V3_SPEAKER_R;
+            break;
+        default:
+            *arrangement = (static_cast<v3_speaker_arrangement>(1) << channels) - 1;
+            break;
+        }
+
+        return V3_OK;
+    }
+
+    v3_result canProcessSampleSize(const int32_t symbolicSampleSize) const noexcept
+    {
+#if DISTRHO_PLUGIN_WANT_DOUBLE_PRECISION
+        if (symbolicSampleSize == V3_SAMPLE_64)
+            return V3_OK;
+#endif
+        return symbolicSampleSize == V3_SAMPLE_32 ? V3_OK : V3_FALSE;
+    }
+
+    uint32_t getLatencySamples() const noexcept
+    {
+#if DISTRHO_PLUGIN_WANT_LATENCY
+        return fPlugin.getLatency();
+#else
+        return 0;
+#endif
+    }
+
+    v3_result setupProcessing(v3_process_setup* const setup)
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(setup != nullptr, V3_INVALID_ARG);
+        DISTRHO_SAFE_ASSERT_RETURN(setup->max_block_size > 0, V3_INVALID_ARG);
+        DISTRHO_SAFE_ASSERT_RETURN(setup->sample_rate > 0.0, V3_INVALID_ARG);
+        DISTRHO_SAFE_ASSERT_RETURN(canProcessSampleSize(setup->symbolic_sample_size) == V3_OK, V3_INVALID_ARG);
+
+        const uint32_t bufferSize = static_cast<uint32_t>(setup->max_block_size);
+
+        fPlugin.setSampleRate(setup->sample_rate, true);
+        fPlugin.setBufferSize(bufferSize, true);
+
+        // silence for missing inputs, followed by scratch space for missing outputs
+        if (fDummyBufferSize < bufferSize)
+        {
+            delete[] fDummyBuffer;
+            fDummyBuffer = new double[bufferSize * 2];
+            fDummyBufferSize = bufferSize;
+        }
+
+        std::memset(fDummyBuffer, 0, sizeof(double) * bufferSize);
+        return V3_OK;
+    }
+
+    v3_result process(v3_process_data* const data)
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(data != nullptr, V3_INVALID_ARG);
+
+        if (! fPlugin.isActive())
+        {
+            // host has not activated the plugin yet, nasty!
+            fPlugin.activate();
+        }
+
+        const uint32_t frames = data->nframes > 0 ? static_cast<uint32_t>(data->nframes) : 0;
+
+        readParameterChanges((v3_param_changes_cpp**)data->input_params, frames);
+
+        // parameter flush, or nothing else to do
+        if (frames == 0)
+        {
+            for (uint32_t i=0; i < fParameterChangeCount; ++i)
+                fPlugin.setParameterValue(fParameterChanges[i].index, fParameterChanges[i].value);
+
+            writeParameterChanges((v3_param_changes_cpp**)data->output_params);
+            return V3_OK;
+        }
+
+        DISTRHO_SAFE_ASSERT_RETURN(fDummyBuffer != nullptr, V3_NOT_INITIALISED);
+
+        fPlugin.setOfflineRendering(data->process_mode == V3_OFFLINE);
+
+#if DISTRHO_PLUGIN_WANT_TIMEPOS
+        if (data->ctx != nullptr)
+            updateTimePosition(*data->ctx);
+#endif
+
+#if DISTRHO_PLUGIN_WANT_MIDI_INPUT
+        const uint32_t midiEventCount = readMidiEvents((v3_event_list_cpp**)data->input_events, frames);
+#else
+        static const uint32_t midiEventCount = 0;
+#endif
+
+#if DISTRHO_PLUGIN_WANT_MIDI_OUTPUT
+        fOutputEvents = (v3_event_list_cpp**)data->output_events;
+#endif
+
+#if DISTRHO_PLUGIN_WANT_DOUBLE_PRECISION
+        if (data->symbolic_sample_size == V3_SAMPLE_64)
+            processAudio<double>(data, frames, midiEventCount);
+        else
+#endif
+        processAudio<float>(data, frames, midiEventCount);
+
+#if DISTRHO_PLUGIN_WANT_MIDI_OUTPUT
+        fOutputEvents = nullptr;
+#endif
+
+        writeParameterChanges((v3_param_changes_cpp**)data->output_params);
+
+#if DISTRHO_PLUGIN_WANT_LATENCY
+        // a new latency value needs the host to query it again
+        const uint32_t latency = fPlugin.getLatency();
+
+        if (fLastKnownLatency != latency)
+        {
+            fLastKnownLatency = latency;
+
+            if (fComponentHandler != nullptr)
+                (*fComponentHandler)->restart_component(fComponentHandler, V3_RESTART_LATENCY_CHANGED);
+        }
+#endif
+
+        return V3_OK;
+    }
+
+    uint32_t getTailSamples() const
+    {
+        // kTailLengthInfinite matches the VST3 value for infinite tails
+        return fPlugin.getTailLength();
+    }
+
+    // ----------------------------------------------------------------------------------------------------------------
+    // v3_edit_controller interface calls
+
+    int32_t getParameterCount() const noexcept
+    {
+        return static_cast<int32_t>(fPlugin.getParameterCount());
+    }
+
+    v3_result getParameterInfo(const int32_t index, v3_param_info* const info) const
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(info != nullptr, V3_INVALID_ARG);
+        DISTRHO_SAFE_ASSERT_RETURN(index >= 0 && index < getParameterCount(), V3_INVALID_ARG);
+
+        const uint32_t hints = fPlugin.getParameterHints(index);
+        const ParameterRanges& ranges(fPlugin.getParameterRanges(index));
+
+        std::memset(info, 0, sizeof(v3_param_info));
+        info->param_id = static_cast<v3_param_id>(index);
+        info->default_normalised_value = ranges.getNormalizedValue(ranges.def);
+
+        if (hints & kParameterIsBoolean)
+            info->step_count = 1;
+        else if (hints & kParameterIsInteger)
+            info->step_count = static_cast<int32_t>(ranges.max - ranges.min);
+
+        if (hints & kParameterIsOutput)
+            info->flags |= V3_PARAM_READ_ONLY;
+        else if (hints & kParameterIsAutomable)
+            info->flags |= V3_PARAM_CAN_AUTOMATE;
+
+        if (fPlugin.getParameterDesignation(index) == kParameterDesignationBypass)
+            info->flags |= V3_PARAM_IS_BYPASS;
+
+        strncpy_16(info->title, fPlugin.getParameterName(index), 128);
+        strncpy_16(info->short_title, fPlugin.getParameterShortName(index), 128);
+        strncpy_16(info->units, fPlugin.getParameterUnit(index), 128);
+        return V3_OK;
+    }
+
+    v3_result getParameterStringForValue(const v3_param_id index, const double normalized, v3_str_128 output) const
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(index < fPlugin.getParameterCount(), V3_INVALID_ARG);
+
+        const float value = getPlainValue(index, normalized);
+        const ParameterEnumerationValues& enumValues(fPlugin.getParameterEnumValues(index));
+
+        for (uint8_t i=0; i < enumValues.count; ++i)
+        {
+            if (d_isEqual(enumValues.values[i].value, value))
+            {
+                strncpy_16(output, enumValues.values[i].label, 128);
+                return V3_OK;
+            }
+        }
+
+        char buffer[32];
+        if (fPlugin.getParameterHints(index) & kParameterIsInteger)
+            std::snprintf(buffer, sizeof(buffer), "%d", static_cast<int>(value));
+        else
+            std::snprintf(buffer, sizeof(buffer), "%f", static_cast<double>(value));
+
+        strncpy_16(output, buffer, 128);
+        return V3_OK;
+    }
+
+    v3_result getParameterValueForString(const v3_param_id index, int16_t* const input, double* const output) const
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(index < fPlugin.getParameterCount(), V3_INVALID_ARG);
+        DISTRHO_SAFE_ASSERT_RETURN(input != nullptr && output != nullptr, V3_INVALID_ARG);
+
+        char buffer[32];
+        size_t len = 0;
+
+        for (; len < sizeof(buffer) - 1 && input[len] != 0; ++len)
+            buffer[len] = static_cast<char>(input[len]);
+
+        buffer[len] = '\0';
+
+        *output = fPlugin.getParameterRanges(index).getNormalizedValue(static_cast<float>(std::atof(buffer)));
+        return V3_OK;
+    }
+
+    double normalizedParameterToPlain(const v3_param_id index, const double normalized) const
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(index < fPlugin.getParameterCount(), 0.0);
+
+        return getPlainValue(index, normalized);
+    }
+
+    double plainParameterToNormalized(const v3_param_id index, const double plain) const
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(index < fPlugin.getParameterCount(), 0.0);
+
+        return fPlugin.getParameterRanges(index).getNormalizedValue(static_cast<float>(plain));
+    }
+
+    double getParameterNormalized(const v3_param_id index) const
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(index < fPlugin.getParameterCount(), 0.0);
+
+        return fControllerValues[index];
+    }
+
+    // the processor receives the same change through its parameter queue, this is the controller side copy
+    v3_result setParameterNormalized(const v3_param_id index, const double normalized)
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(index < fPlugin.getParameterCount(), V3_INVALID_ARG);
+
+        fControllerValues[index] = std::max(0.0, std::min(1.0, normalized));
+        return V3_OK;
+    }
+
+    // the component state was loaded by the component interface of this same instance
+    v3_result setComponentState()
+    {
+        updateControllerValues();
+        return V3_OK;
+    }
+
+    v3_result setComponentHandler(v3_component_handler** const handler)
+    {
+        v3_component_handler_cpp** const newHandler = reinterpret_cast<v3_component_handler_cpp**>(handler);
+
+        if (newHandler != nullptr)
+            (*newHandler)->ref(newHandler);
+
+        if (fComponentHandler != nullptr)
+            (*fComponentHandler)->unref(fComponentHandler);
+
+        fComponentHandler = newHandler;
+        return V3_OK;
+    }
+
+private:
+    // Plugin
+    PluginExporter fPlugin;
+
+    // VST3 stuff
+    v3_component_handler_cpp** fComponentHandler;
+
+    // Temporary data
+    ParameterChange* fParameterChanges;
+    uint32_t fParameterChangeCapacity;
+    uint32_t fParameterChangeCount;
+    double* fControllerValues; // normalized parameter values as seen by the edit controller
+    double* fDummyBuffer;
+    uint32_t fDummyBufferSize;
+    uint32_t fFrameOffset; // start of the current plugin run() inside the host block
+#if DISTRHO_PLUGIN_WANT_MIDI_OUTPUT
+    v3_event_list_cpp** fOutputEvents;
+#endif
+#if DISTRHO_PLUGIN_WANT_LATENCY
+    uint32_t fLastKnownLatency;
+#endif
+#if DISTRHO_PLUGIN_WANT_TIMEPOS
+    TimePosition fTimePosition;
+#endif
+#if DISTRHO_PLUGIN_WANT_STATE
+    PluginStateStore fStateStore;
+#endif
+
+    // ----------------------------------------------------------------------------------------------------------------
+    // state helpers
+
+    void updateControllerValues()
+    {
+        for (uint32_t i=0, count=fPlugin.getParameterCount(); i < count; ++i)
+            fControllerValues[i] = fPlugin.getParameterRanges(i).getNormalizedValue(fPlugin.getParameterValue(i));
+    }
+
+    static bool writeString(v3_bstream_cpp** const stream, const char* const str)
+    {
+        const int32_t size = static_cast<int32_t>(std::strlen(str) + 1);
+        int32_t written = 0;
+
+        return (*stream)->write(stream, const_cast<char*>(str), size, &written) == V3_OK && written == size;
+    }
+
+    // read the whole stream, the returned data is always null-terminated and must be deleted by the caller
+    static char* readStream(v3_bstream_cpp** const stream, uint32_t& size)
+    {
+        uint32_t capacity = 4096;
+        char* data = new char[capacity + 1];
+        size = 0;
+
+        for (;;)
+        {
+            if (size == capacity)
+            {
+                char* const newData = new char[capacity * 2 + 1];
+                std::memcpy(newData, data, size);
+                delete[] data;
+                data = newData;
+                capacity *= 2;
+            }
+
+            int32_t read = 0;
+
+            if ((*stream)->read(stream, data + size, static_cast<int32_t>(capacity - size), &read) != V3_OK || read <= 0)
+                break;
+
+            size += static_cast<uint32_t>(read);
+        }
+
+        data[size] = '\0';
+        return data;
+    }
+
+    // ----------------------------------------------------------------------------------------------------------------
+    // processing helpers
+
+    static uint32_t getChannelCount(v3_speaker_arrangement arrangement) noexcept
+    {
+        uint32_t count = 0;
+
+        for (; arrangement != 0; arrangement &= arrangement - 1)
+            ++count;
+
+        return count;
+    }
+
+    static float** getChannelBuffers(const v3_audio_bus_buffers& bus, float*) noexcept
+    {
+        return bus.channel_buffers_32;
+    }
+
+    static double** getChannelBuffers(const v3_audio_bus_buffers& bus, double*) noexcept
+    {
+        return bus.channel_buffers_64;
+    }
+
+    float getPlainValue(const uint32_t index, const double normalized) const
+    {
+        const uint32_t hints = fPlugin.getParameterHints(index);
+        const ParameterRanges& ranges(fPlugin.getParameterRanges(index));
+
+        float value = ranges.getUnnormalizedValue(static_cast<float>(normalized));
+
+        if (hints & kParameterIsBoolean)
+        {
+            const float midRange = ranges.min + (ranges.max - ranges.min) / 2.0f;
+            value = value > midRange ? ranges.max : ranges.min;
+        }
+        else if (hints & kParameterIsInteger)
+        {
+            value = std::round(value);
+        }
+
+        return value;
+    }
+
+    // collect all parameter points of this block, sorted by frame
+    void readParameterChanges(v3_param_changes_cpp** const changes, const uint32_t frames)
+    {
+        fParameterChangeCount = 0;
+
+        if (changes == nullptr)
+            return;
+
+        const uint32_t parameterCount = fPlugin.getParameterCount();
+        const int32_t queueCount = (*changes)->get_param_count(changes);
+
+        for (int32_t q=0; q < queueCount; ++q)
+        {
+            v3_param_value_queue_cpp** const queue = (v3_param_value_queue_cpp**)(*changes)->get_param_data(changes, q);
+
+            if (queue == nullptr)
+                continue;
+
+            const v3_param_id index = (*queue)->get_param_id(queue);
+
+            if (index >= parameterCount || fPlugin.isParameterOutput(index))
+                continue;
+
+            const int32_t pointCount = (*queue)->get_point_count(queue);
+
+            for (int32_t p=0; p < pointCount; ++p)
+            {
+                // keep room for the last point of this queue and the ones after it
+                if (fParameterChangeCount + static_cast<uint32_t>(queueCount - q) >= fParameterChangeCapacity)
+                    p = pointCount - 1;
+
+                int32_t offset = 0;
+                double normalized = 0.0;
+
+                if ((*queue)->get_point(queue, p, &offset, &normalized) != V3_OK)
+                    continue;
+                if (fParameterChangeCount == fParameterChangeCapacity)
+                    break;
+
+                ParameterChange& change(fParameterChanges[fParameterChangeCount++]);
+                change.frame = offset <= 0 || frames == 0 ? 0 : std::min(static_cast<uint32_t>(offset), frames - 1);
+                change.index = index;
+                change.value = getPlainValue(index, normalized);
+            }
+        }
+
+        // points of each queue are already in order, this only merges the queues
+        for (uint32_t i=1; i < fParameterChangeCount; ++i)
+        {
+            const ParameterChange change(fParameterChanges[i]);
+            uint32_t j = i;
+
+            for (; j != 0 && fParameterChanges[j-1].frame > change.frame; --j)
+                fParameterChanges[j] = fParameterChanges[j-1];
+
+            fParameterChanges[j] = change;
+        }
+    }
+
+    // report changed output parameters through the host output queue
+    void writeParameterChanges(v3_param_changes_cpp** const changes)
+    {
+        for (uint32_t i=0; fPlugin.takeNextChangedOutputParameter(i); ++i)
+        {
+            if (changes == nullptr)
+                continue;
+
+            v3_param_id id = i;
+            int32_t queueIndex = 0;
+            v3_param_value_queue_cpp** const queue = (v3_param_value_queue_cpp**)(*changes)->add_param_data(changes, &id, &queueIndex);
+
+            if (queue == nullptr)
+                continue;
+
+            int32_t pointIndex = 0;
+            const double normalized = fPlugin.getParameterRanges(i).getNormalizedValue(fPlugin.getParameterValue(i));
+            (*queue)->add_point(queue, 0, normalized, &pointIndex);
+        }
+    }
+
+    template <typename T>
+    void processAudio(v3_process_data* const data, const uint32_t frames, const uint32_t midiEventCount)
+    {
+        DISTRHO_SAFE_ASSERT_UINT2_RETURN(frames <= fDummyBufferSize, frames, fDummyBufferSize,);
+
+        // host buffers are given to the plugin as-is, missing ones are replaced by silence or scratch space
+#if DISTRHO_PLUGIN_NUM_INPUTS > 0
+        const T* inputs[DISTRHO_PLUGIN_NUM_INPUTS];
+        const T* const silence = reinterpret_cast<const T*>(fDummyBuffer);
+        bool inputsSilent = true;
+
+        {
+            const bool hasBus = data->num_input_buses > 0 && data->inputs != nullptr;
+            T** const buffers = hasBus ? getChannelBuffers(data->inputs[0], static_cast<T*>(nullptr)) : nullptr;
+            const uint32_t channels = buffers != nullptr ? static_cast<uint32_t>(data->inputs[0].num_channels) : 0;
+
+            for (uint32_t i=0; i < DISTRHO_PLUGIN_NUM_INPUTS; ++i)
+            {
+                if (i < channels && buffers[i] != nullptr)
+                {
+                    inputs[i] = buffers[i];
+
+                    if (i >= 64 || (data->inputs[0].channel_silence_bitset & (static_cast<uint64_t>(1) << i)) == 0)
+                        inputsSilent = false;
+                }
+                else
+                {
+                    inputs[i] = silence;
+                }
+            }
+        }
+#else
+        const T** const inputs = nullptr;
+        static const bool inputsSilent = false;
+#endif
+
+#if DISTRHO_PLUGIN_NUM_OUTPUTS > 0
+        T* outputs[DISTRHO_PLUGIN_NUM_OUTPUTS];
+        T* const scratch = reinterpret_cast<T*>(fDummyBuffer + fDummyBufferSize);
+
+        {
+            const bool hasBus = data->num_output_buses > 0 && data->outputs != nullptr;
+            T** const buffers = hasBus ? getChannelBuffers(data->outputs[0], static_cast<T*>(nullptr)) : nullptr;
+            const uint32_t channels = buffers != nullptr ? static_cast<uint32_t>(data->outputs[0].num_channels) : 0;
+
+            for (uint32_t i=0; i < DISTRHO_PLUGIN_NUM_OUTPUTS; ++i)
+                outputs[i] = i < channels && buffers[i] != nullptr ? buffers[i] : scratch;
+        }
+#else
+        T** const outputs = nullptr;
+#endif
+
+#if DISTRHO_PLUGIN_NUM_INPUTS == 0 && DISTRHO_PLUGIN_NUM_OUTPUTS == 0
+        // unused
+        (void)data;
+#endif
+
+#if DISTRHO_PLUGIN_WANT_MIDI_INPUT
+        MidiEvent* const midiEvents = fPlugin.getMidiEventBuffer();
+#else
+        MidiEvent* const midiEvents = nullptr;
+#endif
+
+#if DISTRHO_PLUGIN_WANT_PARAMETER_EVENTS
+        // the plugin splits the block by itself
+        for (uint32_t i=0; i < fParameterChangeCount; ++i)
+        {
+            const ParameterChange& change(fParameterChanges[i]);
+
+            fPlugin.setParameterValue(change.index, change.value);
+            fPlugin.addParameterEvent(change.frame, change.index, change.value);
+        }
+
+        runPlugin(inputs, outputs, frames, midiEvents, midiEventCount, inputsSilent);
+#else
+        // run the plugin in slices, with parameter changes applied between them
+        uint32_t changeIndex = 0, midiEventIndex = 0;
+
+        for (uint32_t offset = 0, end; offset < frames; offset = end)
+        {
+            for (; changeIndex < fParameterChangeCount && fParameterChanges[changeIndex].frame <= offset; ++changeIndex)
+                fPlugin.setParameterValue(fParameterChanges[changeIndex].index, fParameterChanges[changeIndex].value);
+
+            end = changeIndex < fParameterChangeCount ? fParameterChanges[changeIndex].frame : frames;
+
+            // MIDI events are owned by us, so they can be re-based in place
+            const uint32_t firstMidiEventIndex = midiEventIndex;
 
-// -----------------------------------------------------------------------
+            for (; midiEventIndex < midiEventCount && midiEvents[midiEventIndex].frame < end; ++midiEventIndex)
+                midiEvents[midiEventIndex].frame -= offset;
 
-void strncpy(char* const dst, const char* const src, const size_t size)
-{
-    DISTRHO_SAFE_ASSERT_RETURN(size > 0,);
+# if DISTRHO_PLUGIN_NUM_INPUTS > 0
+            const T* sliceInputs[DISTRHO_PLUGIN_NUM_INPUTS];
 
-    if (const size_t len = std::min(std::strlen(src), size-1U))
+            for (uint32_t i=0; i < DISTRHO_PLUGIN_NUM_INPUTS; ++i)
+                sliceInputs[i] = inputs[i] + offset;
+# else
+            const T** const sliceInputs = inputs;
+# endif
+# if DISTRHO_PLUGIN_NUM_OUTPUTS > 0
+            T* sliceOutputs[DISTRHO_PLUGIN_NUM_OUTPUTS];
+
+            for (uint32_t i=0; i < DISTRHO_PLUGIN_NUM_OUTPUTS; ++i)
+                sliceOutputs[i] = outputs[i] + offset;
+# else
+            T** const sliceOutputs = outputs;
+# endif
+
+            fFrameOffset = offset;
+            runPlugin(sliceInputs, sliceOutputs, end - offset,
+                      midiEvents + firstMidiEventIndex, midiEventIndex - firstMidiEventIndex, inputsSilent);
+        }
+
+        fFrameOffset = 0;
+#endif
+
+#if DISTRHO_PLUGIN_NUM_OUTPUTS > 0
+        if (data->num_output_buses > 0 && data->outputs != nullptr)
+            data->outputs[0].channel_silence_bitset = fPlugin.areOutputsSilent() ? ~static_cast<uint64_t>(0) : 0;
+#endif
+    }
+
+    template <typename T>
+    void runPlugin(const T** const inputs, T** const outputs, const uint32_t frames,
+                   const MidiEvent* const midiEvents, const uint32_t midiEventCount, const bool inputsSilent)
     {
-        std::memcpy(dst, src, len);
-        dst[len] = '\0';
+        if (inputsSilent)
+            fPlugin.setInputsSilent();
+
+#if DISTRHO_PLUGIN_WANT_MIDI_INPUT
+        fPlugin.run(inputs, outputs, frames, midiEvents, midiEventCount);
+#else
+        fPlugin.run(inputs, outputs, frames);
+        // unused
+        (void)midiEvents;
+        (void)midiEventCount;
+#endif
     }
-    else
+
+#if DISTRHO_PLUGIN_WANT_MIDI_INPUT
+    static uint8_t normalizedToMidiValue(const float value) noexcept
     {
-        dst[0] = '\0';
+        return static_cast<uint8_t>(std::lround(std::max(0.0f, std::min(1.0f, value)) * 127.0f));
     }
-}
 
-// -----------------------------------------------------------------------
+    // convert host events into the plugin MIDI event pool
+    uint32_t readMidiEvents(v3_event_list_cpp** const events, const uint32_t frames)
+    {
+        if (events == nullptr)
+            return 0;
 
-// v3_funknown, v3_plugin_base, v3_component
+        MidiEvent* const midiEvents = fPlugin.getMidiEventBuffer();
+        const uint32_t midiEventCapacity = fPlugin.getMidiEventCapacity();
+        const uint32_t eventCount = (*events)->get_event_count(events);
+        uint32_t midiEventCount = 0;
 
-// audio_processor
+        v3_event event;
 
-class PluginVst3
-{
-public:
-    PluginVst3()
-        : fPlugin(this, writeMidiCallback, requestParameterValueChangeCallback)
-    {
+        for (uint32_t i=0; i < eventCount; ++i)
+        {
+            if ((*events)->get_event(events, static_cast<int32_t>(i), &event) != V3_OK)
+                continue;
+
+            if (midiEventCount == midiEventCapacity)
+            {
+                fPlugin.addDroppedMidiEvents(eventCount - i);
+                break;
+            }
+
+            MidiEvent& midiEvent(midiEvents[midiEventCount]);
+            midiEvent.frame = event.sample_offset <= 0 ? 0 : std::min(static_cast<uint32_t>(event.sample_offset), frames - 1);
+            midiEvent.size = 3;
+            midiEvent.dataExt = nullptr;
+
+            switch (event.type)
+            {
+            case V3_EVENT_NOTE_ON:
+                midiEvent.data[0] = 0x90 | (event.note_on.channel & 0xF);
+                midiEvent.data[1] = event.note_on.pitch & 0x7F;
+                midiEvent.data[2] = normalizedToMidiValue(event.note_on.velocity);
+                break;
+            case V3_EVENT_NOTE_OFF:
+                midiEvent.data[0] = 0x80 | (event.note_off.channel & 0xF);
+                midiEvent.data[1] = event.note_off.pitch & 0x7F;
+                midiEvent.data[2] = normalizedToMidiValue(event.note_off.velocity);
+                break;
+            case V3_EVENT_POLY_PRESSURE:
+                midiEvent.data[0] = 0xA0 | (event.poly_pressure.channel & 0xF);
+                midiEvent.data[1] = event.poly_pressure.pitch & 0x7F;
+                midiEvent.data[2] = normalizedToMidiValue(event.poly_pressure.pressure);
+                break;
+            case V3_EVENT_DATA:
+                // only SysEx, its data stays valid during process
+                if (event.data.type != 0 || event.data.bytes == nullptr || event.data.size == 0)
+                    continue;
+
+                midiEvent.size = event.data.size;
+
+                if (midiEvent.size > MidiEvent::kDataSize)
+                    midiEvent.dataExt = event.data.bytes;
+                else
+                    std::memcpy(midiEvent.data, event.data.bytes, midiEvent.size);
+                break;
+            default:
+                continue;
+            }
+
+            ++midiEventCount;
+        }
+
+        return midiEventCount;
     }
+#endif
 
-private:
-    // Plugin
-    PluginExporter fPlugin;
+#if DISTRHO_PLUGIN_WANT_TIMEPOS
+    void updateTimePosition(const v3_process_context& ctx)
+    {
+        fTimePosition.playing   = (ctx.state & V3_PROCESS_CTX_PLAYING) != 0;
+        fTimePosition.frame     = ctx.project_time_in_samples > 0 ? static_cast<uint64_t>(ctx.project_time_in_samples) : 0;
+        fTimePosition.bbt.valid = (ctx.state & (V3_PROCESS_CTX_TEMPO_VALID|V3_PROCESS_CTX_TIME_SIG_VALID)) != 0;
 
-    // VST3 stuff
-    // TODO
+        // ticksPerBeat is not possible with VST3
+        fTimePosition.bbt.ticksPerBeat = 1920.0;
+
+        if (ctx.state & V3_PROCESS_CTX_TEMPO_VALID)
+            fTimePosition.bbt.beatsPerMinute = ctx.bpm;
+        else
+            fTimePosition.bbt.beatsPerMinute = 120.0;
+
+        if ((ctx.state & V3_PROCESS_CTX_PROJECT_TIME_VALID) != 0 && (ctx.state & V3_PROCESS_CTX_TIME_SIG_VALID) != 0
+            && ctx.time_sig_numerator > 0 && ctx.time_sig_denom > 0)
+        {
+            const double ppqPos    = std::abs(ctx.project_time_quarters);
+            const double ppqPerBar = ctx.time_sig_numerator * 4.0 / ctx.time_sig_denom;
+            const double barBeats  = (std::fmod(ppqPos, ppqPerBar) / ppqPerBar) * ctx.time_sig_numerator;
+            const double rest      =  std::fmod(barBeats, 1.0);
+
+            fTimePosition.bbt.bar         = static_cast<int32_t>(ppqPos / ppqPerBar) + 1;
+            fTimePosition.bbt.beat        = static_cast<int32_t>(barBeats - rest + 0.5) + 1;
+            fTimePosition.bbt.tick        = rest * fTimePosition.bbt.ticksPerBeat;
+            fTimePosition.bbt.beatsPerBar = ctx.time_sig_numerator;
+            fTimePosition.bbt.beatType    = ctx.time_sig_denom;
+
+            if (ctx.project_time_quarters < 0.0)
+            {
+                --fTimePosition.bbt.bar;
+                fTimePosition.bbt.beat = ctx.time_sig_numerator - fTimePosition.bbt.beat + 1;
+                fTimePosition.bbt.tick = fTimePosition.bbt.ticksPerBeat - fTimePosition.bbt.tick - 1;
+            }
+        }
+        else
+        {
+            fTimePosition.bbt.bar         = 1;
+            fTimePosition.bbt.beat        = 1;
+            fTimePosition.bbt.tick        = 0.0;
+            fTimePosition.bbt.beatsPerBar = 4.0f;
+            fTimePosition.bbt.beatType    = 4.0f;
+        }
+
+        fTimePosition.bbt.barStartTick = fTimePosition.bbt.ticksPerBeat*
+                                         fTimePosition.bbt.beatsPerBar*
+                                         (fTimePosition.bbt.bar-1);
+
+        fPlugin.setTimePosition(fTimePosition);
+    }
+#endif
 
 #if DISTRHO_PLUGIN_WANT_PARAMETER_VALUE_CHANGE_REQUEST
-    bool requestParameterValueChange(uint32_t, float)
+    bool requestParameterValueChange(const uint32_t index, const float value)
     {
-        // TODO
-        return true;
+        if (fComponentHandler == nullptr)
+            return false;
+
+        const double normalized = fPlugin.getParameterRanges(index).getNormalizedValue(value);
+
+        (*fComponentHandler)->begin_edit(fComponentHandler, index);
+        const bool ok = (*fComponentHandler)->perform_edit(fComponentHandler, index, normalized) == V3_OK;
+        (*fComponentHandler)->end_edit(fComponentHandler, index);
+
+        return ok;
     }
 
     static bool requestParameterValueChangeCallback(void* const ptr, const uint32_t index, const float value)
@@ -103,8 +1091,84 @@ private:
 #if DISTRHO_PLUGIN_WANT_MIDI_OUTPUT
     bool writeMidi(const MidiEvent& midiEvent)
     {
-        // TODO
-        return true;
+        if (fOutputEvents == nullptr)
+            return false;
+
+        const uint8_t* const data = midiEvent.size > MidiEvent::kDataSize ? midiEvent.dataExt : midiEvent.data;
+
+        v3_event event;
+        std::memset(&event, 0, sizeof(event));
+        event.sample_offset = static_cast<int32_t>(fFrameOffset + midiEvent.frame);
+
+        const uint8_t status  = data[0] & 0xF0;
+        const uint8_t channel = data[0] & 0x0F;
+
+        if (data[0] == 0xF0)
+        {
+            event.type = V3_EVENT_DATA;
+            event.data.size = midiEvent.size;
+            event.data.type = 0; // SysEx
+            event.data.bytes = data;
+        }
+        else if (midiEvent.size < 2 || midiEvent.size > 3)
+        {
+            return false;
+        }
+        else if (status == 0x90 && midiEvent.size == 3 && data[2] != 0)
+        {
+            event.type = V3_EVENT_NOTE_ON;
+            event.note_on.channel = channel;
+            event.note_on.pitch = data[1];
+            event.note_on.velocity = static_cast<float>(data[2]) / 127.0f;
+            event.note_on.note_id = -1;
+        }
+        else if (status == 0x80 || status == 0x90)
+        {
+            event.type = V3_EVENT_NOTE_OFF;
+            event.note_off.channel = channel;
+            event.note_off.pitch = data[1];
+            event.note_off.velocity = midiEvent.size == 3 && status == 0x80 ? static_cast<float>(data[2]) / 127.0f : 0.0f;
+            event.note_off.note_id = -1;
+        }
+        else if (status == 0xA0 && midiEvent.size == 3)
+        {
+            event.type = V3_EVENT_POLY_PRESSURE;
+            event.poly_pressure.channel = channel;
+            event.poly_pressure.pitch = data[1];
+            event.poly_pressure.pressure = static_cast<float>(data[2]) / 127.0f;
+            event.poly_pressure.note_id = -1;
+        }
+        else
+        {
+            // everything else goes as legacy MIDI CC, with special numbers for non-CC messages
+            event.type = V3_EVENT_LEGACY_MIDI_CC_OUT;
+            event.midi_cc_out.channel = static_cast<int8_t>(channel);
+
+            switch (status)
+            {
+            case 0xB0:
+                event.midi_cc_out.cc_number = data[1];
+                event.midi_cc_out.value = static_cast<int8_t>(data[2]);
+                break;
+            case 0xC0:
+                event.midi_cc_out.cc_number = 130; // program change
+                event.midi_cc_out.value = static_cast<int8_t>(data[1]);
+                break;
+            case 0xD0:
+                event.midi_cc_out.cc_number = 128; // channel pressure
+                event.midi_cc_out.value = static_cast<int8_t>(data[1]);
+                break;
+            case 0xE0:
+                event.midi_cc_out.cc_number = 129; // pitch bend
+                event.midi_cc_out.value = static_cast<int8_t>(data[1]);
+                event.midi_cc_out.value2 = static_cast<int8_t>(data[2]);
+                break;
+            default:
+                return false;
+            }
+        }
+
+        return (*fOutputEvents)->add_event(fOutputEvents, &event) == V3_OK;
     }
 
     static bool writeMidiCallback(void* ptr, const MidiEvent& midiEvent)
@@ -113,66 +1177,405 @@ private:
     }
 #endif
 
+    DISTRHO_DECLARE_NON_COPYABLE(PluginVst3)
 };
 
-// -----------------------------------------------------------------------
-// WIP this whole section still TODO
+// --------------------------------------------------------------------------------------------------------------------
+// dpf_component, the object given to the host
+//
+// Component, audio processor and edit controller are all implemented by the same object.
+// Each interface is a pointer to its function table followed by a pointer back to the object,
+// so the interface pointer the host gets matches the COM layout that VST3 expects.
 
-struct ControllerComponent;
-struct ProcessorComponent;
+struct v3_component_cpp : v3_funknown, v3_plugin_base, v3_component {};
+struct v3_audio_processor_cpp : v3_funknown, v3_audio_processor {};
+struct v3_edit_controller_cpp : v3_funknown, v3_plugin_base, v3_edit_controller {};
 
-struct ComponentAdapter : v3_funknown, v3_plugin_base
-{
-    // needs atomic refcount, starts at 1
+struct dpf_component;
+
+struct dpf_interface {
+    const void* vtable;
+    dpf_component* self;
+};
 
-    ComponentAdapter()
+struct dpf_component {
+    dpf_interface component;
+    dpf_interface processor;
+    dpf_interface controller;
+    std::atomic<int> refcounter;
+    ScopedPointer<PluginVst3> vst3;
+    // the host initialises and terminates component and edit controller separately
+    bool componentInitialised;
+    bool controllerInitialised;
+
+    dpf_component();
+
+    static dpf_component* get(void* const self) noexcept
     {
-        static const uint8_t* kSupportedFactories[] = {
-            v3_funknown_iid,
-            v3_plugin_base_iid,
-            /*
-            v3_component_iid,
-            v3_edit_controller_iid,
-            v3_audio_processor_iid
-            */
+        return static_cast<dpf_interface*>(self)->self;
+    }
+
+    static PluginVst3* getPlugin(void* const self) noexcept
+    {
+        return get(self)->vst3.get();
+    }
+
+    // ----------------------------------------------------------------------------------------------------------------
+    // v3_funknown, shared by all interfaces
+
+    static v3_result V3_API query_interface(void* const self, const v3_tuid iid, void** const iface)
+    {
+        *iface = nullptr;
+        DISTRHO_SAFE_ASSERT_RETURN(self != nullptr, V3_NO_INTERFACE);
+
+        dpf_component* const component = get(self);
+
+        if (v3_tuid_match(iid, v3_funknown_iid) ||
+            v3_tuid_match(iid, v3_plugin_base_iid) ||
+            v3_tuid_match(iid, v3_component_iid))
+            *iface = &component->component;
+        else if (v3_tuid_match(iid, v3_audio_processor_iid))
+            *iface = &component->processor;
+        else if (v3_tuid_match(iid, v3_edit_controller_iid))
+            *iface = &component->controller;
+        else
+            return V3_NO_INTERFACE;
+
+        ++component->refcounter;
+        return V3_OK;
+    }
+
+    static uint32_t V3_API ref(void* const self)
+    {
+        return static_cast<uint32_t>(++get(self)->refcounter);
+    }
+
+    static uint32_t V3_API unref(void* const self)
+    {
+        dpf_component* const component = get(self);
+
+        if (const int refcount = --component->refcounter)
+            return static_cast<uint32_t>(refcount);
+
+        delete component;
+        return 0;
+    }
+
+    // ----------------------------------------------------------------------------------------------------------------
+    // v3_plugin_base, shared by component and edit controller
+
+    static bool& getInitialised(void* const self) noexcept
+    {
+        dpf_component* const component = get(self);
+
+        if (self == &component->controller)
+            return component->controllerInitialised;
+
+        return component->componentInitialised;
+    }
+
+    static v3_result V3_API initialise(void* const self, v3_plugin_base::v3_funknown*)
+    {
+        dpf_component* const component = get(self);
+        getInitialised(self) = true;
+
+        // already initialised through the other interface
+        if (component->vst3 != nullptr)
+            return V3_OK;
+
+        d_lastBufferSize = 512;
+        d_lastSampleRate = 44100.0;
+        component->vst3 = new PluginVst3();
+        d_lastBufferSize = 0;
+        d_lastSampleRate = 0.0;
+        return V3_OK;
+    }
+
+    static v3_result V3_API terminate(void* const self)
+    {
+        dpf_component* const component = get(self);
+        getInitialised(self) = false;
+
+        // the other interface might still be in use
+        if (! component->componentInitialised && ! component->controllerInitialised)
+            component->vst3 = nullptr;
+
+        return V3_OK;
+    }
+};
+
+struct dpf_component_vtable : v3_component_cpp {
+    dpf_component_vtable()
+    {
+        query_interface = dpf_component::query_interface;
+        ref = dpf_component::ref;
+        unref = dpf_component::unref;
+        initialise = dpf_component::initialise;
+        terminate = dpf_component::terminate;
+
+        get_controller_class_id = []V3_API(void*, v3_tuid) -> v3_result
+        {
+            // the edit controller is part of the component
+            return V3_NOT_IMPLEMENTED;
         };
 
-        // ------------------------------------------------------------------------------------------------------------
-        // v3_funknown
+        set_io_mode = []V3_API(void*, int32_t) -> v3_result
+        {
+            return V3_NOT_IMPLEMENTED;
+        };
 
-        query_interface = []V3_API(void* self, const v3_tuid iid, void** iface) -> v3_result
+        get_bus_count = []V3_API(void* self, int32_t mediaType, int32_t busDirection) -> int32_t
         {
-            d_stdout("ComponentAdapter::query_interface %p %p %p", self, iid, iface);
+            PluginVst3* const vst3 = dpf_component::getPlugin(self);
+            DISTRHO_SAFE_ASSERT_RETURN(vst3 != nullptr, 0);
 
-            *iface = NULL;
-            DISTRHO_SAFE_ASSERT_RETURN(self != nullptr, V3_NO_INTERFACE);
+            return vst3->getBusCount(mediaType, busDirection);
+        };
 
-            for (const uint8_t* factory_iid : kSupportedFactories)
-            {
-                if (v3_tuid_match(factory_iid, iid))
-                {
-                    *iface = self;
-                    return V3_OK;
-                }
-            }
+        get_bus_info = []V3_API(void* self, int32_t mediaType, int32_t busDirection,
+                                int32_t busIndex, v3_bus_info* info) -> v3_result
+        {
+            PluginVst3* const vst3 = dpf_component::getPlugin(self);
+            DISTRHO_SAFE_ASSERT_RETURN(vst3 != nullptr, V3_NOT_INITIALISED);
 
-            return V3_NO_INTERFACE;
+            return vst3->getBusInfo(mediaType, busDirection, busIndex, info);
         };
 
-        // TODO use atomic counter
-        ref = []V3_API(void*) -> uint32_t { return 1; };
-        unref = []V3_API(void*) -> uint32_t { return 0; };
+        get_routing_info = []V3_API(void*, v3_routing_info*, v3_routing_info*) -> v3_result
+        {
+            return V3_NOT_IMPLEMENTED;
+        };
+
+        activate_bus = []V3_API(void*, int32_t, int32_t, int32_t, v3_bool) -> v3_result
+        {
+            // buses are always active, missing buffers are handled during process
+            return V3_OK;
+        };
+
+        set_active = []V3_API(void* self, v3_bool state) -> v3_result
+        {
+            PluginVst3* const vst3 = dpf_component::getPlugin(self);
+            DISTRHO_SAFE_ASSERT_RETURN(vst3 != nullptr, V3_NOT_INITIALISED);
+
+            return vst3->setActive(state != 0);
+        };
+
+        set_state = []V3_API(void* self, v3_bstream** stream) -> v3_result
+        {
+            PluginVst3* const vst3 = dpf_component::getPlugin(self);
+            DISTRHO_SAFE_ASSERT_RETURN(vst3 != nullptr, V3_NOT_INITIALISED);
+
+            return vst3->setState(reinterpret_cast<v3_bstream_cpp**>(stream));
+        };
+
+        get_state = []V3_API(void* self, v3_bstream** stream) -> v3_result
+        {
+            PluginVst3* const vst3 = dpf_component::getPlugin(self);
+            DISTRHO_SAFE_ASSERT_RETURN(vst3 != nullptr, V3_NOT_INITIALISED);
+
+            return vst3->getState(reinterpret_cast<v3_bstream_cpp**>(stream));
+        };
     }
 };
 
-struct ControllerComponent : ComponentAdapter
-{
+struct dpf_audio_processor_vtable : v3_audio_processor_cpp {
+    dpf_audio_processor_vtable()
+    {
+        query_interface = dpf_component::query_interface;
+        ref = dpf_component::ref;
+        unref = dpf_component::unref;
+
+        set_bus_arrangements = []V3_API(void* self, v3_speaker_arrangement* inputs, int32_t numInputs,
+                                        v3_speaker_arrangement* outputs, int32_t numOutputs) -> v3_result
+        {
+            PluginVst3* const vst3 = dpf_component::getPlugin(self);
+            DISTRHO_SAFE_ASSERT_RETURN(vst3 != nullptr, V3_NOT_INITIALISED);
+
+            return vst3->setBusArrangements(inputs, numInputs, outputs, numOutputs);
+        };
+
+        get_bus_arrangement = []V3_API(void* self, int32_t busDirection, int32_t busIndex,
+                                       v3_speaker_arrangement* arrangement) -> v3_result
+        {
+            PluginVst3* const vst3 = dpf_component::getPlugin(self);
+            DISTRHO_SAFE_ASSERT_RETURN(vst3 != nullptr, V3_NOT_INITIALISED);
+
+            return vst3->getBusArrangement(busDirection, busIndex, arrangement);
+        };
+
+        can_process_sample_size = []V3_API(void* self, int32_t symbolicSampleSize) -> v3_result
+        {
+            PluginVst3* const vst3 = dpf_component::getPlugin(self);
+            DISTRHO_SAFE_ASSERT_RETURN(vst3 != nullptr, V3_NOT_INITIALISED);
+
+            return vst3->canProcessSampleSize(symbolicSampleSize);
+        };
+
+        get_latency_samples = []V3_API(void* self) -> uint32_t
+        {
+            PluginVst3* const vst3 = dpf_component::getPlugin(self);
+            DISTRHO_SAFE_ASSERT_RETURN(vst3 != nullptr, 0);
+
+            return vst3->getLatencySamples();
+        };
+
+        setup_processing = []V3_API(void* self, v3_process_setup* setup) -> v3_result
+        {
+            PluginVst3* const vst3 = dpf_component::getPlugin(self);
+            DISTRHO_SAFE_ASSERT_RETURN(vst3 != nullptr, V3_NOT_INITIALISED);
+
+            return vst3->setupProcessing(setup);
+        };
+
+        set_processing = []V3_API(void*, v3_bool) -> v3_result
+        {
+            return V3_OK;
+        };
+
+        process = []V3_API(void* self, v3_process_data* data) -> v3_result
+        {
+            PluginVst3* const vst3 = dpf_component::getPlugin(self);
+            DISTRHO_SAFE_ASSERT_RETURN(vst3 != nullptr, V3_NOT_INITIALISED);
+
+            return vst3->process(data);
+        };
+
+        get_tail_samples = []V3_API(void* self) -> uint32_t
+        {
+            PluginVst3* const vst3 = dpf_component::getPlugin(self);
+            DISTRHO_SAFE_ASSERT_RETURN(vst3 != nullptr, 0);
+
+            return vst3->getTailSamples();
+        };
+    }
 };
 
-struct ProcessorComponent : ComponentAdapter
-{
+struct dpf_edit_controller_vtable : v3_edit_controller_cpp {
+    dpf_edit_controller_vtable()
+    {
+        query_interface = dpf_component::query_interface;
+        ref = dpf_component::ref;
+        unref = dpf_component::unref;
+        initialise = dpf_component::initialise;
+        terminate = dpf_component::terminate;
+
+        set_component_state = []V3_API(void* self, v3_bstream*) -> v3_result
+        {
+            PluginVst3* const vst3 = dpf_component::getPlugin(self);
+            DISTRHO_SAFE_ASSERT_RETURN(vst3 != nullptr, V3_NOT_INITIALISED);
+
+            return vst3->setComponentState();
+        };
+
+        // the edit controller has no state of its own, everything is part of the component state
+        set_state = []V3_API(void*, v3_bstream*) -> v3_result
+        {
+            return V3_OK;
+        };
+
+        get_state = []V3_API(void*, v3_bstream*) -> v3_result
+        {
+            return V3_OK;
+        };
+
+        get_parameter_count = []V3_API(void* self) -> int32_t
+        {
+            PluginVst3* const vst3 = dpf_component::getPlugin(self);
+            DISTRHO_SAFE_ASSERT_RETURN(vst3 != nullptr, 0);
+
+            return vst3->getParameterCount();
+        };
+
+        get_param_info = []V3_API(void* self, int32_t index, v3_param_info* info) -> v3_result
+        {
+            PluginVst3* const vst3 = dpf_component::getPlugin(self);
+            DISTRHO_SAFE_ASSERT_RETURN(vst3 != nullptr, V3_NOT_INITIALISED);
+
+            return vst3->getParameterInfo(index, info);
+        };
+
+        get_param_string_for_value = []V3_API(void* self, v3_param_id index, double normalized,
+                                              v3_str_128 output) -> v3_result
+        {
+            PluginVst3* const vst3 = dpf_component::getPlugin(self);
+            DISTRHO_SAFE_ASSERT_RETURN(vst3 != nullptr, V3_NOT_INITIALISED);
+
+            return vst3->getParameterStringForValue(index, normalized, output);
+        };
+
+        get_param_value_for_string = []V3_API(void* self, v3_param_id index, int16_t* input, double* output) -> v3_result
+        {
+            PluginVst3* const vst3 = dpf_component::getPlugin(self);
+            DISTRHO_SAFE_ASSERT_RETURN(vst3 != nullptr, V3_NOT_INITIALISED);
+
+            return vst3->getParameterValueForString(index, input, output);
+        };
+
+        normalised_param_to_plain = []V3_API(void* self, v3_param_id index, double normalized) -> double
+        {
+            PluginVst3* const vst3 = dpf_component::getPlugin(self);
+            DISTRHO_SAFE_ASSERT_RETURN(vst3 != nullptr, 0.0);
+
+            return vst3->normalizedParameterToPlain(index, normalized);
+        };
+
+        plain_param_to_normalised = []V3_API(void* self, v3_param_id index, double plain) -> double
+        {
+            PluginVst3* const vst3 = dpf_component::getPlugin(self);
+            DISTRHO_SAFE_ASSERT_RETURN(vst3 != nullptr, 0.0);
+
+            return vst3->plainParameterToNormalized(index, plain);
+        };
+
+        get_param_normalised = []V3_API(void* self, v3_param_id index) -> double
+        {
+            PluginVst3* const vst3 = dpf_component::getPlugin(self);
+            DISTRHO_SAFE_ASSERT_RETURN(vst3 != nullptr, 0.0);
+
+            return vst3->getParameterNormalized(index);
+        };
+
+        set_param_normalised = []V3_API(void* self, v3_param_id index, double normalized) -> v3_result
+        {
+            PluginVst3* const vst3 = dpf_component::getPlugin(self);
+            DISTRHO_SAFE_ASSERT_RETURN(vst3 != nullptr, V3_NOT_INITIALISED);
+
+            return vst3->setParameterNormalized(index, normalized);
+        };
+
+        set_component_handler = []V3_API(void* self, v3_component_handler** handler) -> v3_result
+        {
+            PluginVst3* const vst3 = dpf_component::getPlugin(self);
+            DISTRHO_SAFE_ASSERT_RETURN(vst3 != nullptr, V3_NOT_INITIALISED);
+
+            return vst3->setComponentHandler(handler);
+        };
+
+        create_view = []V3_API(void*, const char*) -> v3_plug_view**
+        {
+            return nullptr;
+        };
+    }
 };
 
+dpf_component::dpf_component()
+    : refcounter(1),
+      vst3(nullptr),
+      componentInitialised(false),
+      controllerInitialised(false)
+{
+    static const dpf_component_vtable kComponentVtable;
+    static const dpf_audio_processor_vtable kAudioProcessorVtable;
+    static const dpf_edit_controller_vtable kEditControllerVtable;
+
+    component.vtable = &kComponentVtable;
+    component.self = this;
+    processor.vtable = &kAudioProcessorVtable;
+    processor.self = this;
+    controller.vtable = &kEditControllerVtable;
+    controller.self = this;
+}
+
 // --------------------------------------------------------------------------------------------------------------------
 // Dummy plugin to get data from
 
@@ -259,14 +1662,17 @@ struct dpf_factory : v3_plugin_factory_cpp {
             return V3_OK;
         };
 
-        create_instance = []V3_API(void* self, const v3_tuid class_id, const v3_tuid iid, void** instance) -> v3_result
+        create_instance = []V3_API(void*, const v3_tuid class_id, const v3_tuid iid, void** instance) -> v3_result
         {
-            d_stdout("%s %i %p %p %p %p", __PRETTY_FUNCTION__, __LINE__, self, class_id, iid, instance);
-            DISTRHO_SAFE_ASSERT_RETURN(v3_tuid_match(class_id, *(v3_tuid*)&dpf_tuid_class) &&
-                                       v3_tuid_match(iid, v3_component_iid), V3_NO_INTERFACE);
+            *instance = nullptr;
+            DISTRHO_SAFE_ASSERT_RETURN(v3_tuid_match(class_id, *(v3_tuid*)&dpf_tuid_class), V3_NO_INTERFACE);
 
-            *instance = nullptr; // new ComponentAdapter();
-            return V3_INTERNAL_ERR;
+            dpf_component* const component = new dpf_component();
+
+            // returns the requested interface with its own reference, then drops the initial one
+            const v3_result res = dpf_component::query_interface(&component->component, iid, instance);
+            dpf_component::unref(&component->component);
+            return res;
         };
 
         // ------------------------------------------------------------------------------------------------------------
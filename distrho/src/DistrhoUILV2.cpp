@@ -97,7 +97,15 @@ public:
           fURIDs(uridMap),
           fBypassParameterIndex(fUiPortMap != nullptr ? fUiPortMap->port_index(fUiPortMap->handle, "lv2_enabled")
                                                       : LV2UI_INVALID_PORT_INDEX),
+          fFreewheelPortIndex(fUiPortMap != nullptr ? fUiPortMap->port_index(fUiPortMap->handle, "lv2_freewheel")
+                                                    : LV2UI_INVALID_PORT_INDEX),
           fWinIdWasNull(winId == 0)
+#if DISTRHO_PLUGIN_WANT_STATE
+        , fStateFragmentData(nullptr),
+          fStateFragmentSize(0),
+          fStateFragmentOffset(0),
+          fStateFragmentGeneration(0)
+#endif
     {
         if (widget != nullptr)
             *widget = (LV2UI_Widget)fUI.getNativeWindowHandle();
@@ -149,6 +157,13 @@ public:
             fUI.setWindowTitle(DISTRHO_PLUGIN_NAME);
     }
 
+#if DISTRHO_PLUGIN_WANT_STATE
+    ~UiLv2()
+    {
+        delete[] fStateFragmentData;
+    }
+#endif
+
     // -------------------------------------------------------------------
 
     void lv2ui_port_event(const uint32_t rindex, const uint32_t bufferSize, const uint32_t format, const void* const buffer)
@@ -157,7 +172,7 @@ public:
         {
             const uint32_t parameterOffset = fUI.getParameterOffset();
 
-            if (rindex < parameterOffset)
+            if (rindex < parameterOffset || rindex == fFreewheelPortIndex)
                 return;
 
             DISTRHO_SAFE_ASSERT_RETURN(bufferSize == sizeof(float),)
@@ -181,6 +196,10 @@ public:
 
                 fUI.stateChanged(key, value);
             }
+            else if (atom->type == fURIDs.dpfKeyValueFragment)
+            {
+                receiveStateFragment(atom);
+            }
             else
             {
                 d_stdout("received atom not dpfKeyValue");
@@ -367,6 +386,7 @@ private:
     const struct URIDs {
         const LV2_URID_Map* _uridMap;
         LV2_URID dpfKeyValue;
+        LV2_URID dpfKeyValueFragment;
         LV2_URID atomEventTransfer;
         LV2_URID atomFloat;
         LV2_URID atomLong;
@@ -379,6 +399,7 @@ private:
         URIDs(const LV2_URID_Map* const uridMap)
             : _uridMap(uridMap),
               dpfKeyValue(map(DISTRHO_PLUGIN_LV2_STATE_PREFIX "KeyValueState")),
+              dpfKeyValueFragment(map(DISTRHO_PLUGIN_LV2_STATE_PREFIX "KeyValueStateFragment")),
               atomEventTransfer(map(LV2_ATOM__eventTransfer)),
               atomFloat(map(LV2_ATOM__Float)),
               atomLong(map(LV2_ATOM__Long)),
@@ -397,9 +418,76 @@ private:
     // index of bypass parameter, if present
     const uint32_t fBypassParameterIndex;
 
+    // index of freewheel port, placed after all parameters
+    const uint32_t fFreewheelPortIndex;
+
     // using ui:showInterface if true
     const bool fWinIdWasNull;
 
+#if DISTRHO_PLUGIN_WANT_STATE
+    // large state value being received from the DSP in fragments
+    String   fStateFragmentKey;
+    char*    fStateFragmentData;
+    uint32_t fStateFragmentSize;
+    uint32_t fStateFragmentOffset;
+    uint32_t fStateFragmentGeneration;
+
+    /*
+       Each fragment atom contains the total value size, fragment offset and state generation (all uint32_t),
+       followed by the null-terminated key and the fragment data.
+       Fragments arrive in order, a fragment at offset 0 starts a new value.
+       Fragments of a different generation belong to an older or newer value and are not mixed in.
+     */
+    void receiveStateFragment(const LV2_Atom* const atom)
+    {
+        uint32_t header[3];
+        DISTRHO_SAFE_ASSERT_RETURN(atom->size > sizeof(header),);
+
+        const uint8_t* const body = (const uint8_t*)LV2_ATOM_BODY_CONST(atom);
+        std::memcpy(header, body, sizeof(header));
+
+        const char* const key = (const char*)(body + sizeof(header));
+        const uint32_t keySize = std::strlen(key) + 1;
+        DISTRHO_SAFE_ASSERT_RETURN(atom->size >= sizeof(header) + keySize,);
+
+        const uint32_t size       = header[0];
+        const uint32_t offset     = header[1];
+        const uint32_t generation = header[2];
+        const uint32_t dataSize   = atom->size - sizeof(header) - keySize;
+
+        if (offset == 0)
+        {
+            delete[] fStateFragmentData;
+            fStateFragmentData   = new char[size + 1];
+            fStateFragmentKey        = key;
+            fStateFragmentSize       = size;
+            fStateFragmentOffset     = 0;
+            fStateFragmentGeneration = generation;
+        }
+        else if (fStateFragmentData == nullptr || fStateFragmentKey != key ||
+                 fStateFragmentSize != size || fStateFragmentOffset != offset ||
+                 fStateFragmentGeneration != generation)
+        {
+            // missed the start of this value, wait for the DSP to send it again
+            return;
+        }
+
+        DISTRHO_SAFE_ASSERT_RETURN(dataSize <= fStateFragmentSize - fStateFragmentOffset,);
+
+        std::memcpy(fStateFragmentData + fStateFragmentOffset, body + sizeof(header) + keySize, dataSize);
+        fStateFragmentOffset += dataSize;
+
+        if (fStateFragmentOffset != fStateFragmentSize)
+            return;
+
+        fStateFragmentData[fStateFragmentSize] = '\0';
+        fUI.stateChanged(fStateFragmentKey, fStateFragmentData);
+
+        delete[] fStateFragmentData;
+        fStateFragmentData = nullptr;
+    }
+#endif
+
     // -------------------------------------------------------------------
     // Callbacks
 
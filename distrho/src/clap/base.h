@@ -0,0 +1,67 @@
+/*
+ * DISTRHO Plugin Framework (DPF)
+ * Copyright (C) 2012-2021 Filipe Coelho <falktx@falktx.com>
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any purpose with
+ * or without fee is hereby granted, provided that the above copyright notice and this
+ * permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+ * TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+ * DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+ * IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+# define CLAP_ABI __cdecl
+# define CLAP_EXPORT __declspec(dllexport)
+#else
+# define CLAP_ABI
+# define CLAP_EXPORT __attribute__((visibility("default")))
+#endif
+
+/**
+ * version
+ */
+
+typedef struct clap_version {
+	uint32_t major;
+	uint32_t minor;
+	uint32_t revision;
+} clap_version_t;
+
+#define CLAP_VERSION_MAJOR 1
+#define CLAP_VERSION_MINOR 1
+#define CLAP_VERSION_REVISION 0
+#define CLAP_VERSION_INIT { CLAP_VERSION_MAJOR, CLAP_VERSION_MINOR, CLAP_VERSION_REVISION }
+
+static inline bool
+clap_version_is_compatible(const clap_version_t v)
+{
+	return v.major >= 1;
+}
+
+/**
+ * ids, string sizes and fixed point time
+ */
+
+typedef uint32_t clap_id;
+static const clap_id CLAP_INVALID_ID = UINT32_MAX;
+
+enum {
+	CLAP_NAME_SIZE = 256,
+	CLAP_PATH_SIZE = 1024
+};
+
+typedef int64_t clap_beattime;
+typedef int64_t clap_sectime;
+
+static const int64_t CLAP_BEATTIME_FACTOR = 1LL << 31;
+static const int64_t CLAP_SECTIME_FACTOR = 1LL << 31;
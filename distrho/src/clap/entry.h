@@ -0,0 +1,45 @@
+/*
+ * DISTRHO Plugin Framework (DPF)
+ * Copyright (C) 2012-2021 Filipe Coelho <falktx@falktx.com>
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any purpose with
+ * or without fee is hereby granted, provided that the above copyright notice and this
+ * permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+ * TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+ * DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+ * IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#pragma once
+
+#include "plugin.h"
+
+/**
+ * plugin factory
+ */
+
+static const char CLAP_PLUGIN_FACTORY_ID[] = "clap.plugin-factory";
+
+typedef struct clap_plugin_factory {
+	uint32_t (CLAP_ABI *get_plugin_count)(const struct clap_plugin_factory *factory);
+	const clap_plugin_descriptor_t *(CLAP_ABI *get_plugin_descriptor)(const struct clap_plugin_factory *factory,
+	                                                                  uint32_t index);
+	const clap_plugin_t *(CLAP_ABI *create_plugin)(const struct clap_plugin_factory *factory,
+	                                               const clap_host_t *host, const char *plugin_id);
+} clap_plugin_factory_t;
+
+/**
+ * entry point, exported as `clap_entry`
+ */
+
+typedef struct clap_plugin_entry {
+	clap_version_t clap_version;
+
+	bool (CLAP_ABI *init)(const char *plugin_path);
+	void (CLAP_ABI *deinit)(void);
+	const void *(CLAP_ABI *get_factory)(const char *factory_id);
+} clap_plugin_entry_t;
@@ -0,0 +1,44 @@
+/*
+ * DISTRHO Plugin Framework (DPF)
+ * Copyright (C) 2012-2021 Filipe Coelho <falktx@falktx.com>
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any purpose with
+ * or without fee is hereby granted, provided that the above copyright notice and this
+ * permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+ * TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+ * DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+ * IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#pragma once
+
+#include "../plugin.h"
+
+static const char CLAP_EXT_AUDIO_PORTS[] = "clap.audio-ports";
+static const char CLAP_PORT_MONO[] = "mono";
+static const char CLAP_PORT_STEREO[] = "stereo";
+
+enum {
+	CLAP_AUDIO_PORT_IS_MAIN = 1 << 0,
+	CLAP_AUDIO_PORT_SUPPORTS_64BITS = 1 << 1,
+	CLAP_AUDIO_PORT_PREFERS_64BITS = 1 << 2,
+	CLAP_AUDIO_PORT_REQUIRES_COMMON_SAMPLE_SIZE = 1 << 3
+};
+
+typedef struct clap_audio_port_info {
+	clap_id id;
+	char name[CLAP_NAME_SIZE];
+	uint32_t flags;
+	uint32_t channel_count;
+	const char *port_type;
+	clap_id in_place_pair;
+} clap_audio_port_info_t;
+
+typedef struct clap_plugin_audio_ports {
+	uint32_t (CLAP_ABI *count)(const clap_plugin_t *plugin, bool is_input);
+	bool (CLAP_ABI *get)(const clap_plugin_t *plugin, uint32_t index, bool is_input, clap_audio_port_info_t *info);
+} clap_plugin_audio_ports_t;
@@ -0,0 +1,40 @@
+/*
+ * DISTRHO Plugin Framework (DPF)
+ * Copyright (C) 2012-2021 Filipe Coelho <falktx@falktx.com>
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any purpose with
+ * or without fee is hereby granted, provided that the above copyright notice and this
+ * permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+ * TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+ * DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+ * IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#pragma once
+
+#include "../plugin.h"
+
+static const char CLAP_EXT_NOTE_PORTS[] = "clap.note-ports";
+
+enum clap_note_dialect {
+	CLAP_NOTE_DIALECT_CLAP = 1 << 0,
+	CLAP_NOTE_DIALECT_MIDI = 1 << 1,
+	CLAP_NOTE_DIALECT_MIDI_MPE = 1 << 2,
+	CLAP_NOTE_DIALECT_MIDI2 = 1 << 3
+};
+
+typedef struct clap_note_port_info {
+	clap_id id;
+	uint32_t supported_dialects;
+	uint32_t preferred_dialect;
+	char name[CLAP_NAME_SIZE];
+} clap_note_port_info_t;
+
+typedef struct clap_plugin_note_ports {
+	uint32_t (CLAP_ABI *count)(const clap_plugin_t *plugin, bool is_input);
+	bool (CLAP_ABI *get)(const clap_plugin_t *plugin, uint32_t index, bool is_input, clap_note_port_info_t *info);
+} clap_plugin_note_ports_t;
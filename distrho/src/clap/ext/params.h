@@ -0,0 +1,65 @@
+/*
+ * DISTRHO Plugin Framework (DPF)
+ * Copyright (C) 2012-2021 Filipe Coelho <falktx@falktx.com>
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any purpose with
+ * or without fee is hereby granted, provided that the above copyright notice and this
+ * permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+ * TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+ * DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+ * IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#pragma once
+
+#include "../plugin.h"
+
+static const char CLAP_EXT_PARAMS[] = "clap.params";
+
+enum {
+	CLAP_PARAM_IS_STEPPED = 1 << 0,
+	CLAP_PARAM_IS_PERIODIC = 1 << 1,
+	CLAP_PARAM_IS_HIDDEN = 1 << 2,
+	CLAP_PARAM_IS_READONLY = 1 << 3,
+	CLAP_PARAM_IS_BYPASS = 1 << 4,
+	CLAP_PARAM_IS_AUTOMATABLE = 1 << 5,
+	CLAP_PARAM_IS_AUTOMATABLE_PER_NOTE_ID = 1 << 6,
+	CLAP_PARAM_IS_AUTOMATABLE_PER_KEY = 1 << 7,
+	CLAP_PARAM_IS_AUTOMATABLE_PER_CHANNEL = 1 << 8,
+	CLAP_PARAM_IS_AUTOMATABLE_PER_PORT = 1 << 9,
+	CLAP_PARAM_IS_MODULATABLE = 1 << 10,
+	CLAP_PARAM_IS_MODULATABLE_PER_NOTE_ID = 1 << 11,
+	CLAP_PARAM_IS_MODULATABLE_PER_KEY = 1 << 12,
+	CLAP_PARAM_IS_MODULATABLE_PER_CHANNEL = 1 << 13,
+	CLAP_PARAM_IS_MODULATABLE_PER_PORT = 1 << 14,
+	CLAP_PARAM_REQUIRES_PROCESS = 1 << 15
+};
+
+typedef uint32_t clap_param_info_flags;
+
+typedef struct clap_param_info {
+	clap_id id;
+	clap_param_info_flags flags;
+	void *cookie;
+	char name[CLAP_NAME_SIZE];
+	char module[CLAP_PATH_SIZE];
+	double min_value;
+	double max_value;
+	double default_value;
+} clap_param_info_t;
+
+typedef struct clap_plugin_params {
+	uint32_t (CLAP_ABI *count)(const clap_plugin_t *plugin);
+	bool (CLAP_ABI *get_info)(const clap_plugin_t *plugin, uint32_t param_index, clap_param_info_t *param_info);
+	bool (CLAP_ABI *get_value)(const clap_plugin_t *plugin, clap_id param_id, double *out_value);
+	bool (CLAP_ABI *value_to_text)(const clap_plugin_t *plugin, clap_id param_id, double value,
+	                               char *out_buffer, uint32_t out_buffer_capacity);
+	bool (CLAP_ABI *text_to_value)(const clap_plugin_t *plugin, clap_id param_id,
+	                               const char *param_value_text, double *out_value);
+	void (CLAP_ABI *flush)(const clap_plugin_t *plugin,
+	                       const clap_input_events_t *in, const clap_output_events_t *out);
+} clap_plugin_params_t;
@@ -0,0 +1,38 @@
+/*
+ * DISTRHO Plugin Framework (DPF)
+ * Copyright (C) 2012-2021 Filipe Coelho <falktx@falktx.com>
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any purpose with
+ * or without fee is hereby granted, provided that the above copyright notice and this
+ * permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+ * TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+ * DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+ * IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#pragma once
+
+#include "base.h"
+
+/**
+ * host
+ */
+
+typedef struct clap_host {
+	clap_version_t clap_version;
+	void *host_data;
+
+	const char *name;
+	const char *vendor;
+	const char *url;
+	const char *version;
+
+	const void *(CLAP_ABI *get_extension)(const struct clap_host *host, const char *extension_id);
+	void (CLAP_ABI *request_restart)(const struct clap_host *host);
+	void (CLAP_ABI *request_process)(const struct clap_host *host);
+	void (CLAP_ABI *request_callback)(const struct clap_host *host);
+} clap_host_t;
@@ -0,0 +1,67 @@
+/*
+ * DISTRHO Plugin Framework (DPF)
+ * Copyright (C) 2012-2021 Filipe Coelho <falktx@falktx.com>
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any purpose with
+ * or without fee is hereby granted, provided that the above copyright notice and this
+ * permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+ * TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+ * DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+ * IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#pragma once
+
+#include "host.h"
+#include "process.h"
+
+/**
+ * plugin features
+ */
+
+#define CLAP_PLUGIN_FEATURE_INSTRUMENT "instrument"
+#define CLAP_PLUGIN_FEATURE_AUDIO_EFFECT "audio-effect"
+#define CLAP_PLUGIN_FEATURE_NOTE_EFFECT "note-effect"
+#define CLAP_PLUGIN_FEATURE_ANALYZER "analyzer"
+#define CLAP_PLUGIN_FEATURE_UTILITY "utility"
+#define CLAP_PLUGIN_FEATURE_MONO "mono"
+#define CLAP_PLUGIN_FEATURE_STEREO "stereo"
+
+/**
+ * plugin
+ */
+
+typedef struct clap_plugin_descriptor {
+	clap_version_t clap_version;
+
+	const char *id;
+	const char *name;
+	const char *vendor;
+	const char *url;
+	const char *manual_url;
+	const char *support_url;
+	const char *version;
+	const char *description;
+	const char *const *features; // null terminated
+} clap_plugin_descriptor_t;
+
+typedef struct clap_plugin {
+	const clap_plugin_descriptor_t *desc;
+	void *plugin_data;
+
+	bool (CLAP_ABI *init)(const struct clap_plugin *plugin);
+	void (CLAP_ABI *destroy)(const struct clap_plugin *plugin);
+	bool (CLAP_ABI *activate)(const struct clap_plugin *plugin, double sample_rate,
+	                          uint32_t min_frames_count, uint32_t max_frames_count);
+	void (CLAP_ABI *deactivate)(const struct clap_plugin *plugin);
+	bool (CLAP_ABI *start_processing)(const struct clap_plugin *plugin);
+	void (CLAP_ABI *stop_processing)(const struct clap_plugin *plugin);
+	void (CLAP_ABI *reset)(const struct clap_plugin *plugin);
+	clap_process_status (CLAP_ABI *process)(const struct clap_plugin *plugin, const clap_process_t *process);
+	const void *(CLAP_ABI *get_extension)(const struct clap_plugin *plugin, const char *id);
+	void (CLAP_ABI *on_main_thread)(const struct clap_plugin *plugin);
+} clap_plugin_t;
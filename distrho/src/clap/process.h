@@ -0,0 +1,59 @@
+/*
+ * DISTRHO Plugin Framework (DPF)
+ * Copyright (C) 2012-2021 Filipe Coelho <falktx@falktx.com>
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any purpose with
+ * or without fee is hereby granted, provided that the above copyright notice and this
+ * permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+ * TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+ * DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+ * IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#pragma once
+
+#include "events.h"
+
+/**
+ * audio buffers
+ */
+
+typedef struct clap_audio_buffer {
+	float **data32;
+	double **data64;
+	uint32_t channel_count;
+	uint32_t latency;
+	uint64_t constant_mask;
+} clap_audio_buffer_t;
+
+/**
+ * process
+ */
+
+enum {
+	CLAP_PROCESS_ERROR = 0,
+	CLAP_PROCESS_CONTINUE = 1,
+	CLAP_PROCESS_CONTINUE_IF_NOT_QUIET = 2,
+	CLAP_PROCESS_TAIL = 3,
+	CLAP_PROCESS_SLEEP = 4
+};
+
+typedef int32_t clap_process_status;
+
+typedef struct clap_process {
+	int64_t steady_time;
+	uint32_t frames_count;
+	const clap_event_transport_t *transport;
+
+	const clap_audio_buffer_t *audio_inputs;
+	clap_audio_buffer_t *audio_outputs;
+	uint32_t audio_inputs_count;
+	uint32_t audio_outputs_count;
+
+	const clap_input_events_t *in_events;
+	const clap_output_events_t *out_events;
+} clap_process_t;
@@ -29,7 +29,8 @@ typedef uint64_t v3_speaker_arrangement;
 
 enum {
 	V3_SPEAKER_L = 1,
-	V3_SPEAKER_R = 1 << 1
+	V3_SPEAKER_R = 1 << 1,
+	V3_SPEAKER_M = 1 << 19
 };
 
 /**
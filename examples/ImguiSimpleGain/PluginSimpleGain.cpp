@@ -33,7 +33,7 @@ START_NAMESPACE_DISTRHO
 PluginSimpleGain::PluginSimpleGain()
     : Plugin(paramCount, presetCount, 0)  // paramCount param(s), presetCount program(s), 0 states
 {
-    smooth_gain = new CParamSmooth(20.0f, getSampleRate());
+    smooth_gain.setup(ParameterSmoother::kTypeOnePole, getSampleRate(), 20.0f);
 
     for (unsigned p = 0; p < paramCount; ++p) {
         Parameter param;
@@ -42,10 +42,6 @@ PluginSimpleGain::PluginSimpleGain()
     }
 }
 
-PluginSimpleGain::~PluginSimpleGain() {
-    delete smooth_gain;
-}
-
 // -----------------------------------------------------------------------
 // Init
 
@@ -86,7 +82,7 @@ void PluginSimpleGain::initProgramName(uint32_t index, String& programName) {
 */
 void PluginSimpleGain::sampleRateChanged(double newSampleRate) {
     fSampleRate = newSampleRate;
-    smooth_gain->setSampleRate(newSampleRate);
+    smooth_gain.setSampleRate(newSampleRate);
 }
 
 /**
@@ -105,6 +101,7 @@ void PluginSimpleGain::setParameterValue(uint32_t index, float value) {
     switch (index) {
         case paramGain:
             gain = DB_CO(CLAMP(fParams[paramGain], -90.0, 30.0));
+            smooth_gain.setTarget(gain);
             break;
     }
 }
@@ -142,11 +139,30 @@ void PluginSimpleGain::run(const float** inputs, float** outputs,
     float* const outL = outputs[0];
     float* const outR = outputs[1];
 
-    // apply gain against all samples
-    for (uint32_t i=0; i < frames; ++i) {
-        float gainval = smooth_gain->process(gain);
-        outL[i] = inpL[i] * gainval;
-        outR[i] = inpR[i] * gainval;
+    uint32_t offset = 0;
+
+    // while the gain is moving, render its ramp in short chunks and apply it to both channels
+    while (offset < frames && ! smooth_gain.isSettled()) {
+        static const uint32_t kChunkSize = 64;
+
+        float gains[kChunkSize];
+        const uint32_t count = frames - offset < kChunkSize ? frames - offset : kChunkSize;
+
+        smooth_gain.process(gains, count);
+
+        for (uint32_t i=0; i < count; ++i) {
+            outL[offset + i] = inpL[offset + i] * gains[i];
+            outR[offset + i] = inpR[offset + i] * gains[i];
+        }
+
+        offset += count;
+    }
+
+    // the rest of the block has a constant gain
+    if (offset < frames) {
+        const float gainval = smooth_gain.getCurrentValue();
+        AudioBufferOps::copyWithGain(outL + offset, inpL + offset, gainval, frames - offset);
+        AudioBufferOps::copyWithGain(outR + offset, inpR + offset, gainval, frames - offset);
     }
 }
 
@@ -28,7 +28,8 @@
 #define PLUGIN_SIMPLEGAIN_H
 
 #include "DistrhoPlugin.hpp"
-#include "CParamSmooth.hpp"
+#include "DistrhoPluginUtils.hpp"
+#include "extra/AudioBufferOps.hpp"
 
 START_NAMESPACE_DISTRHO
 
@@ -59,8 +60,6 @@ public:
 
     PluginSimpleGain();
 
-    ~PluginSimpleGain();
-
 protected:
     // -------------------------------------------------------------------
     // Information
@@ -128,10 +127,10 @@ protected:
     // -------------------------------------------------------------------
 
 private:
-    float           fParams[paramCount];
-    double          fSampleRate;
-    float           gain;
-    CParamSmooth    *smooth_gain;
+    float             fParams[paramCount];
+    double            fSampleRate;
+    float             gain;
+    ParameterSmoother smooth_gain;
 
     DISTRHO_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PluginSimpleGain)
 };
@@ -26,5 +26,6 @@
 #define DISTRHO_PLUGIN_NUM_INPUTS   1
 #define DISTRHO_PLUGIN_NUM_OUTPUTS  1
 #define DISTRHO_PLUGIN_WANT_LATENCY 1
+#define DISTRHO_PLUGIN_WANT_AUTOMATIC_BYPASS 1
 
 #endif // DISTRHO_PLUGIN_INFO_H_INCLUDED
@@ -15,6 +15,9 @@
  */
 
 #include "DistrhoPlugin.hpp"
+#include "DistrhoPluginUtils.hpp"
+
+#include <algorithm>
 
 START_NAMESPACE_DISTRHO
 
@@ -27,21 +30,15 @@ class LatencyExamplePlugin : public Plugin
 {
 public:
     LatencyExamplePlugin()
-        : Plugin(1, 0, 0), // 1 parameter
+        : Plugin(2, 0, 0), // 2 parameters
           fLatency(1.0f),
-          fLatencyInFrames(0),
-          fBuffer(nullptr),
-          fBufferPos(0)
+          fBypass(0.0f),
+          fLatencyInFrames(0)
     {
-        // allocates buffer
+        // allocates delay line
         sampleRateChanged(getSampleRate());
     }
 
-    ~LatencyExamplePlugin() override
-    {
-        delete[] fBuffer;
-    }
-
 protected:
    /* --------------------------------------------------------------------------------------------------------
     * Information */
@@ -114,6 +111,13 @@ protected:
     */
     void initParameter(uint32_t index, Parameter& parameter) override
     {
+        // Bypass is handled by DPF, see DISTRHO_PLUGIN_WANT_AUTOMATIC_BYPASS in DistrhoPluginInfo.h
+        if (index == 1)
+        {
+            parameter.initDesignation(kParameterDesignationBypass);
+            return;
+        }
+
         if (index != 0)
             return;
 
@@ -135,6 +139,9 @@ protected:
     */
     float getParameterValue(uint32_t index) const override
     {
+        if (index == 1)
+            return fBypass;
+
         if (index != 0)
             return 0.0f;
 
@@ -149,15 +156,30 @@ protected:
     */
     void setParameterValue(uint32_t index, float value) override
     {
+        if (index == 1)
+        {
+            fBypass = value;
+            return;
+        }
+
         if (index != 0)
             return;
 
         fLatency = value;
-        fLatencyInFrames = value*getSampleRate();
+        fLatencyInFrames = std::min<uint32_t>(value*getSampleRate(), fDelayLine.getMaxDelay());
 
         setLatency(fLatencyInFrames);
     }
 
+   /**
+      Get the length of the plugin tail.
+      Audio keeps coming out for as long as the latency after the input stops.
+    */
+    uint32_t getTailLength() const override
+    {
+        return fLatencyInFrames;
+    }
+
    /* --------------------------------------------------------------------------------------------------------
     * Audio/MIDI Processing */
 
@@ -167,37 +189,9 @@ protected:
     */
     void run(const float** inputs, float** outputs, uint32_t frames) override
     {
-        const float* const in  = inputs[0];
-        /* */ float* const out = outputs[0];
-
-        if (fLatencyInFrames == 0)
-        {
-            if (out != in)
-                std::memcpy(out, in, sizeof(float)*frames);
-            return;
-        }
-
-        // Put the new audio in the buffer.
-        std::memcpy(fBuffer+fBufferPos, in, sizeof(float)*frames);
-        fBufferPos += frames;
-
-        // buffer is not filled enough yet
-        if (fBufferPos < fLatencyInFrames+frames)
-        {
-            // silence output
-            std::memset(out, 0, sizeof(float)*frames);
-        }
-        // buffer is ready to copy
-        else
-        {
-            // copy latency buffer to output
-            const uint32_t readPos = fBufferPos-fLatencyInFrames-frames;
-            std::memcpy(out, fBuffer+readPos, sizeof(float)*frames);
-
-            // move latency buffer back by some frames
-            std::memmove(fBuffer, fBuffer+frames, sizeof(float)*fBufferPos);
-            fBufferPos -= frames;
-        }
+        // The delay line keeps writing in a circle, so the cost only depends on the number of frames.
+        // Input and output may be the same buffer, which the delay line handles for us.
+        fDelayLine.process(inputs[0], outputs[0], frames, fLatencyInFrames);
     }
 
    /* --------------------------------------------------------------------------------------------------------
@@ -209,16 +203,11 @@ protected:
     */
     void sampleRateChanged(double newSampleRate) override
     {
-        if (fBuffer != nullptr)
-            delete[] fBuffer;
-
-        const uint32_t maxFrames = newSampleRate*6; // 6 seconds
-
-        fBuffer = new float[maxFrames];
-        std::memset(fBuffer, 0, sizeof(float)*maxFrames);
+        // 5 seconds, the maximum latency
+        fDelayLine.setMaxDelay(newSampleRate*5);
+        setMaxLatency(fDelayLine.getMaxDelay());
 
-        fLatencyInFrames = fLatency*newSampleRate;
-        fBufferPos       = 0;
+        fLatencyInFrames = std::min<uint32_t>(fLatency*newSampleRate, fDelayLine.getMaxDelay());
     }
 
     // -------------------------------------------------------------------------------------------------------
@@ -226,11 +215,11 @@ protected:
 private:
     // Parameters
     float fLatency;
+    float fBypass;
     uint32_t fLatencyInFrames;
 
-    // Buffer for previous audio, size depends on sample rate
-    float* fBuffer;
-    uint32_t fBufferPos;
+    // Delay line for previous audio, size depends on sample rate
+    DelayLine<float> fDelayLine;
 
    /**
       Set our plugin class as non-copyable and add a leak detector just in case.
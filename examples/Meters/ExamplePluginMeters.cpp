@@ -15,6 +15,7 @@
  */
 
 #include "DistrhoPlugin.hpp"
+#include "extra/AudioBufferOps.hpp"
 
 START_NAMESPACE_DISTRHO
 
@@ -205,24 +206,8 @@ protected:
     */
     void run(const float** inputs, float** outputs, uint32_t frames) override
     {
-        float tmp;
-        float tmpLeft  = 0.0f;
-        float tmpRight = 0.0f;
-
-        for (uint32_t i=0; i<frames; ++i)
-        {
-            // left
-            tmp = std::abs(inputs[0][i]);
-
-            if (tmp > tmpLeft)
-                tmpLeft = tmp;
-
-            // right
-            tmp = std::abs(inputs[1][i]);
-
-            if (tmp > tmpRight)
-                tmpRight = tmp;
-        }
+        float tmpLeft  = AudioBufferOps::getPeak(inputs[0], frames);
+        float tmpRight = AudioBufferOps::getPeak(inputs[1], frames);
 
         if (tmpLeft > 1.0f)
             tmpLeft = 1.0f;
@@ -244,11 +229,8 @@ protected:
         }
 
         // copy inputs over outputs if needed
-        if (outputs[0] != inputs[0])
-            std::memcpy(outputs[0], inputs[0], sizeof(float)*frames);
-
-        if (outputs[1] != inputs[1])
-            std::memcpy(outputs[1], inputs[1], sizeof(float)*frames);
+        AudioBufferOps::copy(outputs[0], inputs[0], frames);
+        AudioBufferOps::copy(outputs[1], inputs[1], frames);
     }
 
     // -------------------------------------------------------------------------------------------------------
@@ -16,6 +16,10 @@
  */
 
 #include "DistrhoPlugin.hpp"
+#include "DistrhoPluginUtils.hpp"
+
+#include <algorithm>
+#include <cmath>
 
 START_NAMESPACE_DISTRHO
 
@@ -57,6 +61,14 @@ public:
     {
         return value += kp * (input - value);
     }
+
+    /**
+      Same as calling process() @a frames times with the same input, but done in one step.
+     */
+    inline float process(const float input, const uint32_t frames)
+    {
+        return value = input + (value - input) * std::pow(1.0f - kp, static_cast<float>(frames));
+    }
 };
 
 // -----------------------------------------------------------------------------------------------------------
@@ -72,7 +84,6 @@ public:
         : Plugin(4, 0, 0), // 4 parameters, 0 programs, 0 states
           sampleRate(getSampleRate()),
           counter(0),
-          phase(0.0f),
           decay(0.0f),
           gain(0.5f),
           semitone(72),
@@ -285,32 +296,38 @@ protected:
             // Reset phase and frequency at the start of transpose.
             if (!wasPlaying)
             {
-                phase = 0.0f;
+                oscillator.reset();
 
                 deltaPhaseSmoother.value = deltaPhase;
                 envelopeSmoother.value = 0.0f;
                 gainSmoother.value = 0.0f;
             }
 
-            for (uint32_t i = 0; i < frames; ++i)
+            for (uint32_t i = 0; i < frames;)
             {
                 if (counter <= 0)
                 {
                     envelope = 1.0f;
-                    counter = static_cast<uint32_t>(framesPerBeat + 0.5);
+                    counter = std::max(static_cast<uint32_t>(framesPerBeat + 0.5), 1u);
                     octave = (!wasPlaying || timePos.bbt.beat == static_cast<int32_t>(timePos.bbt.beatsPerBar)) ? 2.0f
                                                                                                                 : 1.0f;
                 }
-                --counter;
 
-                envelope *= decay;
+                // Render the sine in blocks up to the next beat.
+                // Blocks are kept short so that frequency changes are still smooth.
+                const uint32_t remaining = std::min(frames - i, counter);
+                const uint32_t segment = remaining < kMaxSegmentFrames ? remaining : kMaxSegmentFrames;
+                counter -= segment;
 
-                phase += octave * deltaPhaseSmoother.process(deltaPhase);
-                phase -= std::floor(phase);
+                oscillator.setPhaseIncrement(octave * deltaPhaseSmoother.process(deltaPhase, segment));
+                oscillator.process(output + i, segment);
 
-                output[i] = gainSmoother.process(gain)
-                          * envelopeSmoother.process(envelope)
-                          * std::sin(float(2.0 * M_PI) * phase);
+                for (const uint32_t end = i + segment; i < end; ++i)
+                {
+                    envelope *= decay;
+
+                    output[i] *= gainSmoother.process(gain) * envelopeSmoother.process(envelope);
+                }
             }
         }
         else
@@ -342,13 +359,16 @@ protected:
     // -------------------------------------------------------------------------------------------------------
 
 private:
+    static const uint32_t kMaxSegmentFrames = 32;
+
     float sampleRate;
     uint32_t counter; // Stores number of frames to the next beat.
     bool wasPlaying;  // Used to reset phase and frequency at the start of transpose.
-    float phase;      // Sine wave phase. Normalized in [0, 1).
     float envelope;   // Current value of gain envelope.
     float decay;      // Coefficient to decay envelope in a frame.
 
+    WavetableOscillator oscillator;
+
     Smoother deltaPhaseSmoother;
     Smoother envelopeSmoother;
     Smoother gainSmoother;
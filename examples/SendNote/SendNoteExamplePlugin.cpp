@@ -15,6 +15,7 @@
  */
 
 #include "DistrhoPlugin.hpp"
+#include "DistrhoPluginUtils.hpp"
 
 #include <cmath>
 #include <cstring>
@@ -32,7 +33,6 @@ public:
     SendNoteExamplePlugin()
         : Plugin(0, 0, 0)
     {
-        std::memset(fNotesPlayed, 0, sizeof(fNotesPlayed));
         std::memset(fOscillatorPhases, 0, sizeof(fOscillatorPhases));
     }
 
@@ -112,66 +112,64 @@ protected:
    /**
       Run/process function for plugins with MIDI input.
       This synthesizes the MIDI voices with a sum of sine waves.
+      The voice manager splits the block on MIDI events, so notes start exactly on time,
+      and calls back into this class for each voice.
     */
     void run(const float**, float** outputs, uint32_t frames,
              const MidiEvent* midiEvents, uint32_t midiEventCount) override
     {
-        for (uint32_t i = 0; i < midiEventCount; ++i)
-        {
-            if (midiEvents[i].size <= 3)
-            {
-                uint8_t status = midiEvents[i].data[0];
-                uint8_t note = midiEvents[i].data[1] & 127;
-                uint8_t velocity = midiEvents[i].data[2] & 127;
-
-                switch (status & 0xf0)
-                {
-                case 0x90:
-                    if (velocity != 0)
-                    {
-                        fNotesPlayed[note] = velocity;
-                        break;
-                    }
-                    /* fall through */
-                case 0x80:
-                    fNotesPlayed[note] = 0;
-                    fOscillatorPhases[note] = 0;
-                    break;
-                }
-            }
-        }
+        fVoices.process(outputs, frames, midiEvents, midiEventCount, *this);
+    }
 
-        float* const output = outputs[0];
-        std::memset(output, 0, frames * sizeof(float));
+    // -------------------------------------------------------------------------------------------------------
 
-        for (uint32_t noteNumber = 0; noteNumber < 128; ++noteNumber)
-        {
-            if (fNotesPlayed[noteNumber] == 0)
-                continue;
+public:
+   /* --------------------------------------------------------------------------------------------------------
+    * Voice callbacks, called by VoiceManager during run() */
+
+    void voiceStarted(uint32_t voice, bool)
+    {
+        fOscillatorPhases[voice] = 0.0f;
+    }
+
+    void voiceReleased(uint32_t)
+    {
+    }
+
+    bool renderVoice(uint32_t voice, float** outputs, uint32_t frames)
+    {
+        // there is no envelope, notes stop as soon as they are released
+        if (fVoices.isVoiceReleased(voice))
+            return false;
 
-            float notePitch = 8.17579891564 * std::exp(0.0577622650 * noteNumber);
+        float* const output = outputs[0];
 
-            float phase = fOscillatorPhases[noteNumber];
-            float timeStep = notePitch / getSampleRate();
-            float k2pi = 2.0 * M_PI;
-            float gain = 0.1;
+        float notePitch = 8.17579891564 * std::exp(0.0577622650 * fVoices.getVoicePitch(voice));
 
-            for (uint32_t i = 0; i < frames; ++i)
-            {
-                output[i] += gain * std::sin(k2pi * phase);
-                phase += timeStep;
-                phase -= (int)phase;
-            }
+        float phase = fOscillatorPhases[voice];
+        float timeStep = notePitch / getSampleRate();
+        float k2pi = 2.0 * M_PI;
+        float gain = 0.1;
 
-            fOscillatorPhases[noteNumber] = phase;
+        for (uint32_t i = 0; i < frames; ++i)
+        {
+            output[i] += gain * std::sin(k2pi * phase);
+            phase += timeStep;
+            phase -= (int)phase;
         }
+
+        fOscillatorPhases[voice] = phase;
+        return true;
     }
 
     // -------------------------------------------------------------------------------------------------------
 
 private:
-    uint8_t fNotesPlayed[128];
-    float fOscillatorPhases[128];
+    // one voice per MIDI note number, so that all notes can sound at once
+    static const uint32_t kMaxVoices = 128;
+
+    VoiceManager<kMaxVoices> fVoices;
+    float fOscillatorPhases[kMaxVoices];
 
    /**
       Set our plugin class as non-copyable and add a leak detector just in case.
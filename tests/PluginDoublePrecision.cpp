@@ -0,0 +1,149 @@
+/*
+ * DISTRHO Plugin Framework (DPF)
+ * Copyright (C) 2012-2026 Filipe Coelho <falktx@falktx.com>
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any purpose with
+ * or without fee is hereby granted, provided that the above copyright notice and this
+ * permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+ * TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+ * DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+ * IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#define DISTRHO_PLUGIN_NAME                  "DoublePrecision"
+#define DISTRHO_PLUGIN_URI                   "urn:distrho:tests:DoublePrecision"
+#define DISTRHO_PLUGIN_NUM_INPUTS            1
+#define DISTRHO_PLUGIN_NUM_OUTPUTS           1
+#define DISTRHO_PLUGIN_WANT_MIDI_OUTPUT      1
+#define DISTRHO_PLUGIN_WANT_DOUBLE_PRECISION 1
+
+#include "tests.hpp"
+
+#include "distrho/src/DistrhoPlugin.cpp"
+
+// --------------------------------------------------------------------------------------------------------------------
+
+START_NAMESPACE_DISTRHO
+
+// doubles its input, writes a MIDI CC at frame 10 of every run() and records the frame count of each call
+class DoublePrecisionPlugin : public Plugin
+{
+public:
+    DoublePrecisionPlugin()
+        : Plugin(0, 0, 0),
+          runCount(0) {}
+
+    uint32_t runFrames[16];
+    uint32_t runCount;
+
+protected:
+    const char* getLabel() const override { return "DoublePrecision"; }
+    const char* getMaker() const override { return "DISTRHO"; }
+    const char* getLicense() const override { return "ISC"; }
+    uint32_t getVersion() const override { return 0; }
+    int64_t getUniqueId() const override { return d_cconst('d', 'D', 'b', 'l'); }
+    void initParameter(uint32_t, Parameter&) override {}
+    float getParameterValue(uint32_t) const override { return 0.0f; }
+    void setParameterValue(uint32_t, float) override {}
+
+    void run(const double** const inputs, double** const outputs, const uint32_t frames) override
+    {
+        if (runCount < 16)
+            runFrames[runCount++] = frames;
+
+        for (uint32_t i=0; i < frames; ++i)
+            outputs[0][i] = inputs[0][i] * 2.0;
+
+        MidiEvent midiEvent;
+        midiEvent.frame   = 10;
+        midiEvent.size    = 3;
+        midiEvent.data[0] = 0xB0;
+        midiEvent.data[1] = 1;
+        midiEvent.data[2] = 64;
+        midiEvent.data[3] = 0;
+        midiEvent.dataExt = nullptr;
+        writeMidiEvent(midiEvent);
+    }
+};
+
+Plugin* createPlugin()
+{
+    return new DoublePrecisionPlugin();
+}
+
+END_NAMESPACE_DISTRHO
+
+// --------------------------------------------------------------------------------------------------------------------
+
+struct MidiOutputCollector {
+    uint32_t frames[16];
+    uint32_t count;
+};
+
+static bool writeMidi(void* const ptr, const DISTRHO_NAMESPACE::MidiEvent& midiEvent)
+{
+    MidiOutputCollector* const collector = static_cast<MidiOutputCollector*>(ptr);
+
+    if (collector->count < 16)
+        collector->frames[collector->count++] = midiEvent.frame;
+
+    return true;
+}
+
+int main()
+{
+    USE_NAMESPACE_DISTRHO;
+
+    d_lastBufferSize = 64;
+    d_lastSampleRate = 48000.0;
+
+    MidiOutputCollector collector;
+    collector.count = 0;
+
+    PluginExporter plugin(&collector, writeMidi, nullptr);
+    plugin.activate();
+
+    float input[256];
+    float output[256];
+    const float* inputs[1] = { input };
+    float* outputs[1] = { output };
+
+    for (uint32_t i=0; i < 256; ++i)
+        input[i] = static_cast<float>(i) / 256.0f;
+
+    // single-precision blocks larger than the conversion buffer are split into slices of the buffer size
+    {
+        plugin.run(inputs, outputs, 256);
+
+        const DoublePrecisionPlugin* const doublePlugin = static_cast<const DoublePrecisionPlugin*>(plugin.getInstancePointer());
+        DISTRHO_ASSERT_EQUAL(doublePlugin->runCount, 4U, "plugin runs 4 times");
+
+        for (uint32_t i=0; i < doublePlugin->runCount; ++i)
+        {
+            DISTRHO_ASSERT_EQUAL(doublePlugin->runFrames[i], 64U, "slice has 64 frames");
+        }
+
+        for (uint32_t i=0; i < 256; ++i)
+        {
+            DISTRHO_ASSERT_EQUAL(output[i], input[i] * 2.0f, "output is converted back from double precision");
+        }
+    }
+
+    // MIDI output written during a slice is relative to the host block
+    {
+        DISTRHO_ASSERT_EQUAL(collector.count, 4U, "4 MIDI events are written");
+        DISTRHO_ASSERT_EQUAL(collector.frames[0], 10U, "first MIDI event is at frame 10");
+        DISTRHO_ASSERT_EQUAL(collector.frames[1], 74U, "second MIDI event is at frame 74");
+        DISTRHO_ASSERT_EQUAL(collector.frames[2], 138U, "third MIDI event is at frame 138");
+        DISTRHO_ASSERT_EQUAL(collector.frames[3], 202U, "fourth MIDI event is at frame 202");
+    }
+
+    plugin.deactivate();
+    return 0;
+}
+
+// --------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,472 @@
+/*
+ * DISTRHO Plugin Framework (DPF)
+ * Copyright (C) 2012-2021 Filipe Coelho <falktx@falktx.com>
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any purpose with
+ * or without fee is hereby granted, provided that the above copyright notice and this
+ * permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+ * TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+ * DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+ * IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+// Minimal command-line CLAP host, used to check the DPF CLAP processing path without a DAW.
+//
+// usage: clap_test_host /path/to/plugin.clap [blocks] [index=value@frame ...]
+//
+// The plugin is run with a 1kHz test tone as input, 4 blocks of 256 frames by default.
+// Parameter changes are given in plain values and sent during the first block, sorted by frame.
+// A note-on is sent at frame 0 and its note-off on the last block, for plugins with a note input.
+// The host thread pool runs each request on a few worker threads.
+// For every block the peak of each output channel and all output events are printed.
+
+#include "../../distrho/src/clap/entry.h"
+#include "../../distrho/src/clap/ext/audio-ports.h"
+#include "../../distrho/src/clap/ext/latency.h"
+#include "../../distrho/src/clap/ext/note-ports.h"
+#include "../../distrho/src/clap/ext/params.h"
+#include "../../distrho/src/clap/ext/tail.h"
+#include "../../distrho/src/clap/ext/thread-pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <dlfcn.h>
+
+static const uint32_t kBufferSize = 256;
+static const uint32_t kMaxChannels = 16;
+static const uint32_t kMaxEvents = 512;
+static const uint32_t kMaxWorkers = 4;
+static const double kSampleRate = 48000.0;
+
+// --------------------------------------------------------------------------------------------------------------------
+// event lists, events are copied into fixed-size slots
+
+union HostEvent {
+    clap_event_header_t header;
+    clap_event_note_t note;
+    clap_event_param_value_t param;
+    clap_event_param_gesture_t gesture;
+    clap_event_midi_t midi;
+    clap_event_midi_sysex_t sysex;
+};
+
+struct HostEventList {
+    HostEvent events[kMaxEvents];
+    uint32_t count;
+
+    bool add(const clap_event_header_t* const event)
+    {
+        if (count == kMaxEvents || event->size > sizeof(HostEvent))
+            return false;
+
+        std::memcpy(&events[count++], event, event->size);
+        return true;
+    }
+
+    // CLAP events must be sorted by time
+    void sort()
+    {
+        std::stable_sort(events, events + count, [](const HostEvent& a, const HostEvent& b) {
+            return a.header.time < b.header.time;
+        });
+    }
+};
+
+static HostEventList gInputEvents, gOutputEvents;
+
+static uint32_t CLAP_ABI input_events_size(const clap_input_events_t* const list)
+{
+    return static_cast<const HostEventList*>(list->ctx)->count;
+}
+
+static const clap_event_header_t* CLAP_ABI input_events_get(const clap_input_events_t* const list, const uint32_t index)
+{
+    const HostEventList* const events = static_cast<const HostEventList*>(list->ctx);
+    return index < events->count ? &events->events[index].header : nullptr;
+}
+
+static bool CLAP_ABI output_events_try_push(const clap_output_events_t* const list, const clap_event_header_t* const event)
+{
+    return static_cast<HostEventList*>(list->ctx)->add(event);
+}
+
+static void addNoteEvent(const bool noteOn, const uint32_t frame)
+{
+    clap_event_note_t event;
+    std::memset(&event, 0, sizeof(event));
+    event.header.size = sizeof(event);
+    event.header.time = frame;
+    event.header.space_id = CLAP_CORE_EVENT_SPACE_ID;
+    event.header.type = noteOn ? CLAP_EVENT_NOTE_ON : CLAP_EVENT_NOTE_OFF;
+    event.note_id = -1;
+    event.port_index = 0;
+    event.channel = 0;
+    event.key = 60;
+    event.velocity = noteOn ? 0.8 : 0.0;
+    gInputEvents.add(&event.header);
+}
+
+static void printOutputEvents()
+{
+    for (uint32_t i=0; i < gOutputEvents.count; ++i)
+    {
+        const HostEvent& event(gOutputEvents.events[i]);
+
+        switch (event.header.type)
+        {
+        case CLAP_EVENT_PARAM_VALUE:
+            printf("  parameter %u @%u: %f\n", event.param.param_id, event.header.time, event.param.value);
+            break;
+        case CLAP_EVENT_PARAM_GESTURE_BEGIN:
+            printf("  parameter %u @%u: gesture begin\n", event.gesture.param_id, event.header.time);
+            break;
+        case CLAP_EVENT_PARAM_GESTURE_END:
+            printf("  parameter %u @%u: gesture end\n", event.gesture.param_id, event.header.time);
+            break;
+        case CLAP_EVENT_MIDI:
+            printf("  event @%u: midi %02X %02X %02X\n", event.header.time,
+                   event.midi.data[0], event.midi.data[1], event.midi.data[2]);
+            break;
+        case CLAP_EVENT_MIDI_SYSEX:
+            printf("  event @%u: sysex, %u bytes\n", event.header.time, event.sysex.size);
+            break;
+        default:
+            printf("  event @%u: type %u\n", event.header.time, event.header.type);
+            break;
+        }
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// host and its thread pool
+
+static const clap_plugin_t* gPlugin = nullptr;
+static const clap_plugin_thread_pool_t* gPluginThreadPool = nullptr;
+static uint32_t gThreadPoolRequests = 0;
+
+static bool CLAP_ABI host_thread_pool_request_exec(const clap_host_t*, const uint32_t numTasks)
+{
+    if (gPluginThreadPool == nullptr)
+        return false;
+
+    ++gThreadPoolRequests;
+
+    std::atomic<uint32_t> nextTask(0);
+    std::thread workers[kMaxWorkers];
+    const uint32_t numWorkers = std::min(numTasks, kMaxWorkers);
+
+    for (uint32_t i=0; i < numWorkers; ++i)
+    {
+        workers[i] = std::thread([&nextTask, numTasks]() {
+            for (uint32_t task; (task = nextTask++) < numTasks;)
+                gPluginThreadPool->exec(gPlugin, task);
+        });
+    }
+
+    for (uint32_t i=0; i < numWorkers; ++i)
+        workers[i].join();
+
+    return true;
+}
+
+static const clap_host_thread_pool_t kHostThreadPool = {
+    host_thread_pool_request_exec
+};
+
+static const void* CLAP_ABI host_get_extension(const clap_host_t*, const char* const id)
+{
+    if (std::strcmp(id, CLAP_EXT_THREAD_POOL) == 0)
+        return &kHostThreadPool;
+
+    return nullptr;
+}
+
+static void CLAP_ABI host_request_restart(const clap_host_t*)
+{
+    printf("  host: restart requested\n");
+}
+
+static void CLAP_ABI host_request(const clap_host_t*)
+{
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        printf("usage: %s /path/to/plugin.clap [blocks] [index=value@frame ...]\n", argv[0]);
+        return 1;
+    }
+
+    void* const handle = dlopen(argv[1], RTLD_NOW);
+
+    if (handle == nullptr)
+    {
+        printf("Failed to open plugin, error was:\n%s\n", dlerror());
+        return 2;
+    }
+
+    const clap_plugin_entry_t* const entry = (const clap_plugin_entry_t*)dlsym(handle, "clap_entry");
+
+    if (entry == nullptr || ! clap_version_is_compatible(entry->clap_version) || ! entry->init(argv[1]))
+    {
+        printf("Not a CLAP plugin\n");
+        dlclose(handle);
+        return 2;
+    }
+
+    const clap_plugin_factory_t* const factory = (const clap_plugin_factory_t*)entry->get_factory(CLAP_PLUGIN_FACTORY_ID);
+    const clap_plugin_descriptor_t* const descriptor = factory != nullptr && factory->get_plugin_count(factory) != 0
+                                                     ? factory->get_plugin_descriptor(factory, 0)
+                                                     : nullptr;
+
+    if (descriptor == nullptr)
+    {
+        printf("Plugin has no factory or descriptor\n");
+        entry->deinit();
+        dlclose(handle);
+        return 3;
+    }
+
+    const clap_host_t host = {
+        CLAP_VERSION_INIT,
+        nullptr,
+        "clap_test_host",
+        "DISTRHO",
+        "https://github.com/DISTRHO/DPF",
+        "1.0",
+        host_get_extension,
+        host_request_restart,
+        host_request,
+        host_request
+    };
+
+    const clap_plugin_t* const plugin = factory->create_plugin(factory, &host, descriptor->id);
+
+    if (plugin == nullptr || ! plugin->init(plugin))
+    {
+        printf("Failed to create plugin instance\n");
+        entry->deinit();
+        dlclose(handle);
+        return 3;
+    }
+
+    gPlugin = plugin;
+    gPluginThreadPool = (const clap_plugin_thread_pool_t*)plugin->get_extension(plugin, CLAP_EXT_THREAD_POOL);
+
+    printf("Plugin: %s (%s) version %s; features:", descriptor->name, descriptor->id, descriptor->version);
+
+    for (const char* const* feature = descriptor->features; feature != nullptr && *feature != nullptr; ++feature)
+        printf(" %s", *feature);
+
+    printf("\n");
+
+    // ports
+    const clap_plugin_audio_ports_t* const audioPorts = (const clap_plugin_audio_ports_t*)plugin->get_extension(plugin, CLAP_EXT_AUDIO_PORTS);
+    const clap_plugin_note_ports_t* const notePorts = (const clap_plugin_note_ports_t*)plugin->get_extension(plugin, CLAP_EXT_NOTE_PORTS);
+    const clap_plugin_latency_t* const latency = (const clap_plugin_latency_t*)plugin->get_extension(plugin, CLAP_EXT_LATENCY);
+    const clap_plugin_tail_t* const tail = (const clap_plugin_tail_t*)plugin->get_extension(plugin, CLAP_EXT_TAIL);
+    const clap_plugin_params_t* const params = (const clap_plugin_params_t*)plugin->get_extension(plugin, CLAP_EXT_PARAMS);
+
+    uint32_t numInputs = 0, numOutputs = 0;
+    clap_audio_port_info_t portInfo;
+
+    if (audioPorts != nullptr && audioPorts->count(plugin, true) != 0 && audioPorts->get(plugin, 0, true, &portInfo))
+        numInputs = portInfo.channel_count;
+    if (audioPorts != nullptr && audioPorts->count(plugin, false) != 0 && audioPorts->get(plugin, 0, false, &portInfo))
+        numOutputs = portInfo.channel_count;
+
+    const bool hasNoteInput = notePorts != nullptr && notePorts->count(plugin, true) != 0;
+
+    if (numInputs > kMaxChannels || numOutputs > kMaxChannels)
+    {
+        printf("Too many channels\n");
+        return 3;
+    }
+
+    // parameters
+    const uint32_t paramCount = params != nullptr ? params->count(plugin) : 0;
+
+    for (uint32_t i=0; i < paramCount; ++i)
+    {
+        clap_param_info_t info;
+        params->get_info(plugin, i, &info);
+
+        char text[64] = {};
+        params->value_to_text(plugin, info.id, info.default_value, text, sizeof(text));
+
+        printf("Parameter %u: '%s', default %f ('%s')%s\n", i, info.name, info.default_value, text,
+               (info.flags & CLAP_PARAM_IS_READONLY) ? " (output)" : "");
+    }
+
+    // parameter changes from the command line, sent with the first block
+    const uint32_t blocks = argc > 2 ? static_cast<uint32_t>(std::atoi(argv[2])) : 4;
+
+    for (int i=3; i < argc; ++i)
+    {
+        int index = 0, frame = 0;
+        double value = 0.0;
+
+        if (std::sscanf(argv[i], "%d=%lf@%d", &index, &value, &frame) < 2
+            || index < 0 || static_cast<uint32_t>(index) >= paramCount || frame < 0)
+        {
+            printf("Invalid parameter change '%s'\n", argv[i]);
+            continue;
+        }
+
+        clap_event_param_value_t event;
+        std::memset(&event, 0, sizeof(event));
+        event.header.size = sizeof(event);
+        event.header.time = static_cast<uint32_t>(frame);
+        event.header.space_id = CLAP_CORE_EVENT_SPACE_ID;
+        event.header.type = CLAP_EVENT_PARAM_VALUE;
+        event.param_id = static_cast<clap_id>(index);
+        event.note_id = -1;
+        event.port_index = -1;
+        event.channel = -1;
+        event.key = -1;
+        event.value = value;
+        gInputEvents.add(&event.header);
+    }
+
+    // setup
+    if (! plugin->activate(plugin, kSampleRate, 1, kBufferSize) || ! plugin->start_processing(plugin))
+    {
+        printf("Failed to activate plugin\n");
+        return 4;
+    }
+
+    printf("Audio: %u inputs, %u outputs; Latency: %u; Tail: %u\n",
+           numInputs, numOutputs,
+           latency != nullptr ? latency->get(plugin) : 0, tail != nullptr ? tail->get(plugin) : 0);
+
+    static float inputData[kMaxChannels][kBufferSize];
+    static float outputData[kMaxChannels][kBufferSize];
+    float* inputPtrs[kMaxChannels];
+    float* outputPtrs[kMaxChannels];
+
+    for (uint32_t i=0; i < kMaxChannels; ++i)
+    {
+        inputPtrs[i] = inputData[i];
+        outputPtrs[i] = outputData[i];
+    }
+
+    clap_audio_buffer_t inputPort, outputPort;
+    std::memset(&inputPort, 0, sizeof(inputPort));
+    std::memset(&outputPort, 0, sizeof(outputPort));
+    inputPort.data32 = inputPtrs;
+    inputPort.channel_count = numInputs;
+    outputPort.data32 = outputPtrs;
+    outputPort.channel_count = numOutputs;
+
+    const clap_input_events_t inEvents = { &gInputEvents, input_events_size, input_events_get };
+    const clap_output_events_t outEvents = { &gOutputEvents, output_events_try_push };
+
+    clap_event_transport_t transport;
+    std::memset(&transport, 0, sizeof(transport));
+    transport.header.size = sizeof(transport);
+    transport.header.type = CLAP_EVENT_TRANSPORT;
+    transport.flags = CLAP_TRANSPORT_HAS_TEMPO|CLAP_TRANSPORT_HAS_BEATS_TIMELINE|CLAP_TRANSPORT_HAS_SECONDS_TIMELINE
+                    | CLAP_TRANSPORT_HAS_TIME_SIGNATURE|CLAP_TRANSPORT_IS_PLAYING;
+    transport.tempo = 120.0;
+    transport.tsig_num = 4;
+    transport.tsig_denom = 4;
+
+    clap_process_t process;
+    std::memset(&process, 0, sizeof(process));
+    process.frames_count = kBufferSize;
+    process.transport = &transport;
+    process.audio_inputs = &inputPort;
+    process.audio_outputs = &outputPort;
+    process.audio_inputs_count = numInputs != 0 ? 1 : 0;
+    process.audio_outputs_count = numOutputs != 0 ? 1 : 0;
+    process.in_events = &inEvents;
+    process.out_events = &outEvents;
+
+    uint64_t frame = 0;
+
+    for (uint32_t b=0; b < blocks; ++b, frame += kBufferSize)
+    {
+        for (uint32_t i=0; i < kBufferSize; ++i)
+        {
+            const float sample = 0.5f * std::sin(static_cast<float>(2.0 * M_PI * 1000.0 * (frame + i) / kSampleRate));
+
+            for (uint32_t c=0; c < numInputs; ++c)
+                inputData[c][i] = sample;
+        }
+
+        if (hasNoteInput && b == 0)
+            addNoteEvent(true, 0);
+        if (hasNoteInput && b + 1 == blocks && blocks > 1)
+            addNoteEvent(false, kBufferSize / 2);
+
+        gInputEvents.sort();
+
+        const double seconds = frame / kSampleRate;
+        const double beats = seconds * transport.tempo / 60.0;
+        transport.song_pos_seconds = static_cast<clap_sectime>(std::round(seconds * CLAP_SECTIME_FACTOR));
+        transport.song_pos_beats = static_cast<clap_beattime>(std::round(beats * CLAP_BEATTIME_FACTOR));
+        transport.bar_number = static_cast<int32_t>(beats / 4.0);
+        transport.bar_start = static_cast<clap_beattime>(transport.bar_number * 4.0 * CLAP_BEATTIME_FACTOR);
+
+        process.steady_time = static_cast<int64_t>(frame);
+        outputPort.constant_mask = 0;
+        gOutputEvents.count = 0;
+        gThreadPoolRequests = 0;
+
+        const clap_process_status status = plugin->process(plugin, &process);
+
+        if (status == CLAP_PROCESS_ERROR)
+        {
+            printf("Block %u: process failed\n", b);
+            break;
+        }
+
+        printf("Block %u:", b);
+
+        for (uint32_t c=0; c < numOutputs; ++c)
+        {
+            float peak = 0.0f;
+
+            for (uint32_t i=0; i < kBufferSize; ++i)
+                peak = std::max(peak, std::abs(outputData[c][i]));
+
+            printf(" out%u peak %.6f;", c + 1, peak);
+        }
+
+        printf("%s", outputPort.constant_mask != 0 ? " (silent)" : "");
+
+        if (gThreadPoolRequests != 0)
+            printf(" thread pool requests %u;", gThreadPoolRequests);
+
+        printf("\n");
+        printOutputEvents();
+
+        // parameter changes and events are only sent once
+        gInputEvents.count = 0;
+    }
+
+    // flush outside of processing, as hosts do for parameter changes without audio
+    gOutputEvents.count = 0;
+    if (params != nullptr)
+        params->flush(plugin, &inEvents, &outEvents);
+
+    plugin->stop_processing(plugin);
+    plugin->deactivate(plugin);
+    plugin->destroy(plugin);
+
+    entry->deinit();
+    dlclose(handle);
+    return 0;
+}
@@ -0,0 +1,675 @@
+/*
+ * DISTRHO Plugin Framework (DPF)
+ * Copyright (C) 2012-2021 Filipe Coelho <falktx@falktx.com>
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any purpose with
+ * or without fee is hereby granted, provided that the above copyright notice and this
+ * permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+ * TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+ * DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+ * IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+// Minimal command-line VST3 host, used to check the DPF VST3 processing path without a DAW.
+//
+// usage: vst3_test_host /path/to/plugin.so [blocks] [index=value@frame ...]
+//
+// The plugin is run with a 1kHz test tone as input, 4 blocks of 256 frames by default.
+// Parameter changes are given in plain (non-normalized) values and sent during the first block.
+// A note-on is sent at frame 0 and its note-off on the last block, for plugins with MIDI input.
+// For every block the peak of each output channel, output parameter changes and output events are printed.
+// Afterwards the component state is saved, printed and loaded back.
+
+#include "../../distrho/src/travesty/audio_processor.h"
+#include "../../distrho/src/travesty/component.h"
+#include "../../distrho/src/travesty/edit_controller.h"
+#include "../../distrho/src/travesty/factory.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <dlfcn.h>
+
+// --------------------------------------------------------------------------------------------------------------------
+// C++ views of the travesty interfaces, with the v3_funknown methods in front
+
+struct v3_plugin_factory_cpp : v3_funknown, v3_plugin_factory {};
+struct v3_component_cpp : v3_funknown, v3_plugin_base, v3_component {};
+struct v3_audio_processor_cpp : v3_funknown, v3_audio_processor {};
+struct v3_edit_controller_cpp : v3_funknown, v3_plugin_base, v3_edit_controller {};
+struct v3_param_value_queue_cpp : v3_funknown, v3_param_value_queue {};
+struct v3_param_changes_cpp : v3_funknown, v3_param_changes {};
+struct v3_event_list_cpp : v3_funknown, v3_event_list {};
+struct v3_bstream_cpp : v3_funknown, v3_bstream {};
+
+static const uint32_t kBufferSize = 256;
+static const uint32_t kMaxChannels = 16;
+static const uint32_t kMaxPoints = 64;
+static const uint32_t kMaxQueues = 64;
+static const uint32_t kMaxEvents = 512;
+static const uint32_t kMaxStateSize = 65536;
+static const double kSampleRate = 48000.0;
+
+// host-side objects are owned by main(), reference counting is not needed for them
+static v3_result V3_API host_query_interface(void*, const v3_tuid, void** obj)
+{
+    *obj = nullptr;
+    return V3_NO_INTERFACE;
+}
+
+static uint32_t V3_API host_ref(void*)
+{
+    return 1;
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// parameter value queue
+
+struct HostParamQueue {
+    const v3_param_value_queue_cpp* vtable;
+    v3_param_id id;
+    int32_t count;
+    int32_t offsets[kMaxPoints];
+    double values[kMaxPoints];
+};
+
+struct HostParamQueueVtable : v3_param_value_queue_cpp {
+    HostParamQueueVtable()
+    {
+        query_interface = host_query_interface;
+        ref = host_ref;
+        unref = host_ref;
+
+        get_param_id = [](void* self) -> v3_param_id
+        {
+            return static_cast<HostParamQueue*>(self)->id;
+        };
+
+        get_point_count = [](void* self) -> int32_t
+        {
+            return static_cast<HostParamQueue*>(self)->count;
+        };
+
+        get_point = [](void* self, int32_t idx, int32_t* offset, double* value) -> v3_result
+        {
+            HostParamQueue* const queue = static_cast<HostParamQueue*>(self);
+
+            if (idx < 0 || idx >= queue->count)
+                return V3_INVALID_ARG;
+
+            *offset = queue->offsets[idx];
+            *value = queue->values[idx];
+            return V3_OK;
+        };
+
+        add_point = [](void* self, int32_t offset, double value, int32_t* idx) -> v3_result
+        {
+            HostParamQueue* const queue = static_cast<HostParamQueue*>(self);
+
+            if (queue->count == static_cast<int32_t>(kMaxPoints))
+                return V3_INVALID_ARG;
+
+            *idx = queue->count;
+            queue->offsets[queue->count] = offset;
+            queue->values[queue->count++] = value;
+            return V3_OK;
+        };
+    }
+};
+
+// --------------------------------------------------------------------------------------------------------------------
+// parameter changes, a list of queues
+
+struct HostParamChanges {
+    const v3_param_changes_cpp* vtable;
+    int32_t count;
+    HostParamQueue queues[kMaxQueues];
+
+    HostParamChanges();
+
+    HostParamQueue* getQueue(const v3_param_id id)
+    {
+        for (int32_t i=0; i < count; ++i)
+            if (queues[i].id == id)
+                return &queues[i];
+
+        if (count == static_cast<int32_t>(kMaxQueues))
+            return nullptr;
+
+        queues[count].id = id;
+        queues[count].count = 0;
+        return &queues[count++];
+    }
+};
+
+struct HostParamChangesVtable : v3_param_changes_cpp {
+    HostParamChangesVtable()
+    {
+        query_interface = host_query_interface;
+        ref = host_ref;
+        unref = host_ref;
+
+        get_param_count = [](void* self) -> int32_t
+        {
+            return static_cast<HostParamChanges*>(self)->count;
+        };
+
+        get_param_data = [](void* self, int32_t idx) -> v3_param_value_queue**
+        {
+            HostParamChanges* const changes = static_cast<HostParamChanges*>(self);
+
+            if (idx < 0 || idx >= changes->count)
+                return nullptr;
+
+            return reinterpret_cast<v3_param_value_queue**>(&changes->queues[idx]);
+        };
+
+        add_param_data = [](void* self, v3_param_id* id, int32_t* index) -> v3_param_value_queue**
+        {
+            HostParamChanges* const changes = static_cast<HostParamChanges*>(self);
+            HostParamQueue* const queue = changes->getQueue(*id);
+
+            if (queue == nullptr)
+                return nullptr;
+
+            *index = static_cast<int32_t>(queue - changes->queues);
+            return reinterpret_cast<v3_param_value_queue**>(queue);
+        };
+    }
+};
+
+HostParamChanges::HostParamChanges()
+    : count(0)
+{
+    static const HostParamQueueVtable kQueueVtable;
+    static const HostParamChangesVtable kChangesVtable;
+
+    vtable = &kChangesVtable;
+
+    for (uint32_t i=0; i < kMaxQueues; ++i)
+        queues[i].vtable = &kQueueVtable;
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// event list
+
+struct HostEventList {
+    const v3_event_list_cpp* vtable;
+    uint32_t count;
+    v3_event events[kMaxEvents];
+
+    HostEventList();
+};
+
+struct HostEventListVtable : v3_event_list_cpp {
+    HostEventListVtable()
+    {
+        query_interface = host_query_interface;
+        ref = host_ref;
+        unref = host_ref;
+
+        get_event_count = [](void* self) -> uint32_t
+        {
+            return static_cast<HostEventList*>(self)->count;
+        };
+
+        get_event = [](void* self, int32_t idx, v3_event* event) -> v3_result
+        {
+            HostEventList* const list = static_cast<HostEventList*>(self);
+
+            if (idx < 0 || static_cast<uint32_t>(idx) >= list->count)
+                return V3_INVALID_ARG;
+
+            *event = list->events[idx];
+            return V3_OK;
+        };
+
+        add_event = [](void* self, v3_event* event) -> v3_result
+        {
+            HostEventList* const list = static_cast<HostEventList*>(self);
+
+            if (list->count == kMaxEvents)
+                return V3_INVALID_ARG;
+
+            list->events[list->count++] = *event;
+            return V3_OK;
+        };
+    }
+};
+
+HostEventList::HostEventList()
+    : count(0)
+{
+    static const HostEventListVtable kEventListVtable;
+
+    vtable = &kEventListVtable;
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// memory stream, for saving and loading state
+
+struct HostMemoryStream {
+    const v3_bstream_cpp* vtable;
+    int64_t size;
+    int64_t pos;
+    char data[kMaxStateSize];
+
+    HostMemoryStream();
+};
+
+struct HostMemoryStreamVtable : v3_bstream_cpp {
+    HostMemoryStreamVtable()
+    {
+        query_interface = host_query_interface;
+        ref = host_ref;
+        unref = host_ref;
+
+        read = [](void* self, void* buffer, int32_t num_bytes, int32_t* bytes_read) -> v3_result
+        {
+            HostMemoryStream* const stream = static_cast<HostMemoryStream*>(self);
+            const int32_t size = static_cast<int32_t>(std::min<int64_t>(num_bytes, stream->size - stream->pos));
+
+            std::memcpy(buffer, stream->data + stream->pos, size);
+            stream->pos += size;
+
+            if (bytes_read != nullptr)
+                *bytes_read = size;
+            return V3_OK;
+        };
+
+        write = [](void* self, void* buffer, int32_t num_bytes, int32_t* bytes_written) -> v3_result
+        {
+            HostMemoryStream* const stream = static_cast<HostMemoryStream*>(self);
+
+            if (num_bytes < 0 || stream->pos + num_bytes > static_cast<int64_t>(kMaxStateSize))
+                return V3_INVALID_ARG;
+
+            std::memcpy(stream->data + stream->pos, buffer, num_bytes);
+            stream->pos += num_bytes;
+            stream->size = std::max(stream->size, stream->pos);
+
+            if (bytes_written != nullptr)
+                *bytes_written = num_bytes;
+            return V3_OK;
+        };
+
+        seek = [](void* self, int64_t pos, int32_t seek_mode, int64_t* result) -> v3_result
+        {
+            HostMemoryStream* const stream = static_cast<HostMemoryStream*>(self);
+
+            switch (seek_mode)
+            {
+            case V3_SEEK_CUR:
+                pos += stream->pos;
+                break;
+            case V3_SEEK_END:
+                pos += stream->size;
+                break;
+            }
+
+            if (pos < 0 || pos > stream->size)
+                return V3_INVALID_ARG;
+
+            stream->pos = pos;
+
+            if (result != nullptr)
+                *result = pos;
+            return V3_OK;
+        };
+
+        tell = [](void* self, int64_t* pos) -> v3_result
+        {
+            *pos = static_cast<HostMemoryStream*>(self)->pos;
+            return V3_OK;
+        };
+    }
+};
+
+HostMemoryStream::HostMemoryStream()
+    : size(0),
+      pos(0)
+{
+    static const HostMemoryStreamVtable kMemoryStreamVtable;
+
+    vtable = &kMemoryStreamVtable;
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+
+static HostEventList gInputEvents, gOutputEvents;
+static HostParamChanges gInputParams, gOutputParams;
+
+static void addNoteEvent(const bool noteOn, const int32_t frame)
+{
+    v3_event& event(gInputEvents.events[gInputEvents.count++]);
+    std::memset(&event, 0, sizeof(event));
+    event.sample_offset = frame;
+
+    if (noteOn)
+    {
+        event.type = V3_EVENT_NOTE_ON;
+        event.note_on.pitch = 60;
+        event.note_on.velocity = 0.8f;
+        event.note_on.note_id = -1;
+    }
+    else
+    {
+        event.type = V3_EVENT_NOTE_OFF;
+        event.note_off.pitch = 60;
+        event.note_off.note_id = -1;
+    }
+}
+
+static void printOutputEvents()
+{
+    for (uint32_t i=0; i < gOutputEvents.count; ++i)
+    {
+        const v3_event& event(gOutputEvents.events[i]);
+
+        switch (event.type)
+        {
+        case V3_EVENT_NOTE_ON:
+            printf("  event @%d: note-on %d, velocity %.3f\n",
+                   event.sample_offset, event.note_on.pitch, event.note_on.velocity);
+            break;
+        case V3_EVENT_NOTE_OFF:
+            printf("  event @%d: note-off %d\n", event.sample_offset, event.note_off.pitch);
+            break;
+        case V3_EVENT_DATA:
+            printf("  event @%d: sysex, %u bytes\n", event.sample_offset, event.data.size);
+            break;
+        case V3_EVENT_LEGACY_MIDI_CC_OUT:
+            printf("  event @%d: cc %u, value %d %d\n", event.sample_offset,
+                   event.midi_cc_out.cc_number, event.midi_cc_out.value, event.midi_cc_out.value2);
+            break;
+        default:
+            printf("  event @%d: type %u\n", event.sample_offset, event.type);
+            break;
+        }
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        printf("usage: %s /path/to/plugin.so [blocks] [index=value@frame ...]\n", argv[0]);
+        return 1;
+    }
+
+    void* const handle = dlopen(argv[1], RTLD_NOW);
+
+    if (handle == nullptr)
+    {
+        printf("Failed to open plugin, error was:\n%s\n", dlerror());
+        return 2;
+    }
+
+    typedef bool (*ModuleEntryFn)(void*);
+    typedef bool (*ModuleExitFn)(void);
+    typedef void* (*GetPluginFactoryFn)(void);
+
+    const ModuleEntryFn moduleEntry = (ModuleEntryFn)dlsym(handle, "ModuleEntry");
+    const ModuleExitFn moduleExit = (ModuleExitFn)dlsym(handle, "ModuleExit");
+    const GetPluginFactoryFn getPluginFactory = (GetPluginFactoryFn)dlsym(handle, "GetPluginFactory");
+
+    if (moduleEntry == nullptr || moduleExit == nullptr || getPluginFactory == nullptr)
+    {
+        printf("Not a VST3 plugin\n");
+        dlclose(handle);
+        return 2;
+    }
+
+    moduleEntry(handle);
+
+    v3_plugin_factory_cpp** const factory = static_cast<v3_plugin_factory_cpp**>(getPluginFactory());
+
+    v3_class_info classInfo;
+    std::memset(&classInfo, 0, sizeof(classInfo));
+    (*factory)->get_class_info(factory, 0, &classInfo);
+
+    v3_component_cpp** component = nullptr;
+    v3_audio_processor_cpp** processor = nullptr;
+    v3_edit_controller_cpp** controller = nullptr;
+
+    if ((*factory)->create_instance(factory, classInfo.class_id, v3_component_iid, (void**)&component) != V3_OK)
+    {
+        printf("Failed to create plugin instance\n");
+        moduleExit();
+        dlclose(handle);
+        return 3;
+    }
+
+    (*component)->initialise(component, nullptr);
+    (*component)->query_interface(component, v3_audio_processor_iid, (void**)&processor);
+    (*component)->query_interface(component, v3_edit_controller_iid, (void**)&controller);
+
+    if (processor == nullptr || controller == nullptr)
+    {
+        printf("Plugin does not provide audio processor and edit controller interfaces\n");
+        return 3;
+    }
+
+    printf("Plugin: %s\n", classInfo.name);
+
+    // buses
+    const int32_t numInputBuses = (*component)->get_bus_count(component, V3_AUDIO, V3_INPUT);
+    const int32_t numOutputBuses = (*component)->get_bus_count(component, V3_AUDIO, V3_OUTPUT);
+    uint32_t numInputs = 0, numOutputs = 0;
+
+    v3_bus_info busInfo;
+
+    if (numInputBuses > 0 && (*component)->get_bus_info(component, V3_AUDIO, V3_INPUT, 0, &busInfo) == V3_OK)
+        numInputs = busInfo.channel_count;
+    if (numOutputBuses > 0 && (*component)->get_bus_info(component, V3_AUDIO, V3_OUTPUT, 0, &busInfo) == V3_OK)
+        numOutputs = busInfo.channel_count;
+
+    const bool hasEventInput = (*component)->get_bus_count(component, V3_EVENT, V3_INPUT) > 0;
+
+    if (numInputs > kMaxChannels || numOutputs > kMaxChannels)
+    {
+        printf("Too many channels\n");
+        return 3;
+    }
+
+    printf("Audio: %u inputs, %u outputs; Latency: %u; Tail: %u\n",
+           numInputs, numOutputs,
+           (*processor)->get_latency_samples(processor), (*processor)->get_tail_samples(processor));
+
+    // parameters
+    const int32_t paramCount = (*controller)->get_parameter_count(controller);
+
+    for (int32_t i=0; i < paramCount; ++i)
+    {
+        v3_param_info info;
+        (*controller)->get_param_info(controller, i, &info);
+
+        char title[128];
+        for (int j=0; j < 128; ++j)
+            title[j] = static_cast<char>(info.title[j]);
+
+        printf("Parameter %d: '%s', default %f%s\n", i, title,
+               (*controller)->normalised_param_to_plain(controller, info.param_id, info.default_normalised_value),
+               (info.flags & V3_PARAM_READ_ONLY) ? " (output)" : "");
+    }
+
+    // parameter changes from the command line, sent with the first block
+    const uint32_t blocks = argc > 2 ? static_cast<uint32_t>(std::atoi(argv[2])) : 4;
+
+    for (int i=3; i < argc; ++i)
+    {
+        int index = 0, frame = 0;
+        double value = 0.0;
+
+        if (std::sscanf(argv[i], "%d=%lf@%d", &index, &value, &frame) < 2 || index < 0 || index >= paramCount)
+        {
+            printf("Invalid parameter change '%s'\n", argv[i]);
+            continue;
+        }
+
+        HostParamQueue* const queue = gInputParams.getQueue(static_cast<v3_param_id>(index));
+        int32_t pointIndex;
+
+        if (queue != nullptr)
+            (*queue->vtable).add_point(queue, frame,
+                                       (*controller)->plain_param_to_normalised(controller, index, value),
+                                       &pointIndex);
+    }
+
+    // setup
+    v3_process_setup setup;
+    setup.process_mode = V3_REALTIME;
+    setup.symbolic_sample_size = V3_SAMPLE_32;
+    setup.max_block_size = kBufferSize;
+    setup.sample_rate = kSampleRate;
+
+    if ((*processor)->setup_processing(processor, &setup) != V3_OK)
+    {
+        printf("Failed to setup processing\n");
+        return 4;
+    }
+
+    (*component)->set_active(component, true);
+    (*processor)->set_processing(processor, true);
+
+    static float inputData[kMaxChannels][kBufferSize];
+    static float outputData[kMaxChannels][kBufferSize];
+    float* inputPtrs[kMaxChannels];
+    float* outputPtrs[kMaxChannels];
+
+    for (uint32_t i=0; i < kMaxChannels; ++i)
+    {
+        inputPtrs[i] = inputData[i];
+        outputPtrs[i] = outputData[i];
+    }
+
+    v3_audio_bus_buffers inputBus, outputBus;
+    std::memset(&inputBus, 0, sizeof(inputBus));
+    std::memset(&outputBus, 0, sizeof(outputBus));
+    inputBus.num_channels = static_cast<int32_t>(numInputs);
+    inputBus.channel_buffers_32 = inputPtrs;
+    outputBus.num_channels = static_cast<int32_t>(numOutputs);
+    outputBus.channel_buffers_32 = outputPtrs;
+
+    v3_process_context ctx;
+    std::memset(&ctx, 0, sizeof(ctx));
+    ctx.state = V3_PROCESS_CTX_PLAYING|V3_PROCESS_CTX_PROJECT_TIME_VALID|V3_PROCESS_CTX_TEMPO_VALID|V3_PROCESS_CTX_TIME_SIG_VALID;
+    ctx.sample_rate = kSampleRate;
+    ctx.bpm = 120.0;
+    ctx.time_sig_numerator = 4;
+    ctx.time_sig_denom = 4;
+
+    v3_process_data data;
+    std::memset(&data, 0, sizeof(data));
+    data.process_mode = V3_REALTIME;
+    data.symbolic_sample_size = V3_SAMPLE_32;
+    data.nframes = kBufferSize;
+    data.num_input_buses = numInputBuses > 0 ? 1 : 0;
+    data.num_output_buses = numOutputBuses > 0 ? 1 : 0;
+    data.inputs = &inputBus;
+    data.outputs = &outputBus;
+    data.input_params = reinterpret_cast<v3_param_changes**>(&gInputParams);
+    data.output_params = reinterpret_cast<v3_param_changes**>(&gOutputParams);
+    data.input_events = reinterpret_cast<v3_event_list**>(&gInputEvents);
+    data.output_events = reinterpret_cast<v3_event_list**>(&gOutputEvents);
+    data.ctx = &ctx;
+
+    uint64_t frame = 0;
+
+    for (uint32_t b=0; b < blocks; ++b, frame += kBufferSize)
+    {
+        for (uint32_t i=0; i < kBufferSize; ++i)
+        {
+            const float sample = 0.5f * std::sin(static_cast<float>(2.0 * M_PI * 1000.0 * (frame + i) / kSampleRate));
+
+            for (uint32_t c=0; c < numInputs; ++c)
+                inputData[c][i] = sample;
+        }
+
+        if (hasEventInput && b == 0)
+            addNoteEvent(true, 0);
+        if (hasEventInput && b + 1 == blocks && blocks > 1)
+            addNoteEvent(false, kBufferSize / 2);
+
+        ctx.project_time_in_samples = static_cast<int64_t>(frame);
+        ctx.project_time_quarters = frame / kSampleRate * ctx.bpm / 60.0;
+
+        gOutputParams.count = 0;
+        gOutputEvents.count = 0;
+
+        if ((*processor)->process(processor, &data) != V3_OK)
+        {
+            printf("Block %u: process failed\n", b);
+            break;
+        }
+
+        printf("Block %u:", b);
+
+        for (uint32_t c=0; c < numOutputs; ++c)
+        {
+            float peak = 0.0f;
+
+            for (uint32_t i=0; i < kBufferSize; ++i)
+                peak = std::max(peak, std::abs(outputData[c][i]));
+
+            printf(" out%u peak %.6f;", c + 1, peak);
+        }
+
+        printf("%s\n", outputBus.channel_silence_bitset != 0 ? " (silent)" : "");
+
+        for (int32_t q=0; q < gOutputParams.count; ++q)
+        {
+            const HostParamQueue& queue(gOutputParams.queues[q]);
+
+            for (int32_t p=0; p < queue.count; ++p)
+                printf("  parameter %u @%d: %f\n", queue.id, queue.offsets[p],
+                       (*controller)->normalised_param_to_plain(controller, queue.id, queue.values[p]));
+        }
+
+        printOutputEvents();
+
+        // parameter changes and events are only sent once
+        gInputParams.count = 0;
+        gInputEvents.count = 0;
+    }
+
+    (*processor)->set_processing(processor, false);
+    (*component)->set_active(component, false);
+
+    // state round-trip, the strings are printed as they are stored
+    static HostMemoryStream stateStream;
+    v3_bstream** const stream = reinterpret_cast<v3_bstream**>(&stateStream);
+
+    if ((*component)->get_state(component, stream) == V3_OK)
+    {
+        printf("State: %d bytes\n", static_cast<int>(stateStream.size));
+
+        for (int64_t i=0; i < stateStream.size; i += std::strlen(stateStream.data + i) + 1)
+            printf("  '%s'\n", stateStream.data + i);
+
+        stateStream.pos = 0;
+        printf("State load: %s\n", (*component)->set_state(component, stream) == V3_OK ? "ok" : "failed");
+    }
+    else
+    {
+        printf("State: save failed\n");
+    }
+
+    (*component)->terminate(component);
+
+    (*controller)->unref(controller);
+    (*processor)->unref(processor);
+    (*component)->unref(component);
+
+    moduleExit();
+    dlclose(handle);
+    return 0;
+}